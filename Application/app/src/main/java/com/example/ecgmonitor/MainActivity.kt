@@ -25,6 +25,7 @@ import com.github.mikephil.charting.data.LineDataSet
 import kotlinx.coroutines.*
 import java.io.IOException
 import java.io.InputStream
+import java.io.OutputStream
 import java.util.UUID
 
 /**
@@ -40,6 +41,7 @@ class MainActivity : AppCompatActivity() {
     private var bluetoothAdapter: BluetoothAdapter? = null
     private var bluetoothSocket: BluetoothSocket? = null
     private var inputStream: InputStream? = null
+    private var outputStream: OutputStream? = null
 
     /* Connection state */
     private var isConnected = false
@@ -59,10 +61,39 @@ class MainActivity : AppCompatActivity() {
         private const val SWEEP_WINDOW_POINTS = 250   /* width of one sweep (number of points) */
         private const val Y_MIN = 0f
         private const val Y_MAX = 4095f
+
+        /* Binary protocol (Embedded/include/ecg_proto.h) */
+        private const val PROTO_VERSION = 1
+        private const val PROTO_TYPE_SAMPLES = 1
+        private const val PROTO_TYPE_BEAT = 2
+        private const val PROTO_TYPE_RICE = 3
+        private const val PROTO_TYPE_TEXT = 4
+        private const val PROTO_HEADER_SIZE = 7
+        private const val PROTO_CRC_SIZE = 2
+        private const val PROTO_MAX_ENCODED = 512   /* longer runs without 0x00 are noise */
+
+        /* Rice block codec (Embedded/include/ecg_rice.h) */
+        private const val RICE_BLOCK = 128
+        private const val RICE_PART = 16
+        private const val RICE_K_RAW = 15
+        private const val RICE_ESC = 16
     }
 
     /* current "write head" position (0..SWEEP_WINDOW_POINTS-1) */
     private var sweepIndex = 0
+
+    /* Binary stream state: COBS bytes since the last 0x00, sequence tracking */
+    private val frameBuffer = ByteArray(PROTO_MAX_ENCODED)
+    private var frameLength = 0
+    private var frameOverflow = false
+    private var frameSynced = false     /* bytes before the first 0x00 belong to a cut frame */
+    @Volatile
+    private var binaryMode = false      /* set by the first valid binary frame or a "K" record */
+    private var nextSeq = -1
+    private var lostFrames = 0L
+
+    /* WDT_RESETS of the last "G" record: a watchdog reset is reported once, not every second */
+    private var lastWdtResets = 0L
     override fun onCreate(savedInstanceState: Bundle?) {
         super.onCreate(savedInstanceState)
         initUI()
@@ -314,6 +345,7 @@ class MainActivity : AppCompatActivity() {
                         bluetoothSocket = device.createRfcommSocketToServiceRecord(MY_UUID)
                         bluetoothSocket?.connect()
                         inputStream = bluetoothSocket?.inputStream
+                        outputStream = bluetoothSocket?.outputStream
                         isConnected = true
 
                         withContext(Dispatchers.Main) {
@@ -345,9 +377,17 @@ class MainActivity : AppCompatActivity() {
 
     /**
      * Starts continuous data reading from Bluetooth input stream
-     * Parses incoming data line by line and updates UI
+     * Parses incoming data line by line (text formats) or frame by frame (binary
+     * protocol, detected by its first valid frame) and updates UI
      */
     private fun startReadingData() {
+        frameLength = 0
+        frameOverflow = false
+        frameSynced = false
+        binaryMode = false
+        nextSeq = -1
+        lostFrames = 0L
+
         readJob = CoroutineScope(Dispatchers.IO).launch {
             val buffer = ByteArray(1024)
             var bytes: Int
@@ -357,17 +397,44 @@ class MainActivity : AppCompatActivity() {
                 try {
                     if (inputStream != null && inputStream!!.available() > 0) {
                         bytes = inputStream!!.read(buffer)
+
+                        /* Binary frames end at 0x00, which never occurs in the text formats */
+                        for (i in 0 until bytes) {
+                            val b = buffer[i]
+                            if (b.toInt() == 0) {
+                                val frame = decodeFrame()
+                                if (frame != null) {
+                                    binaryMode = true
+                                    withContext(Dispatchers.Main) {
+                                        processFrame(frame)
+                                    }
+                                }
+                            } else if (frameLength < PROTO_MAX_ENCODED) {
+                                frameBuffer[frameLength++] = b
+                            } else {
+                                frameOverflow = true
+                            }
+                        }
+                        if (binaryMode) {
+                            stringBuilder.setLength(0)
+                            continue
+                        }
+
                         val incoming = String(buffer, 0, bytes)
                         stringBuilder.append(incoming)
 
-                        val endOfLineIndex = stringBuilder.indexOf("\n")
-                        if (endOfLineIndex > 0) {
+                        /* A read may carry several lines (beat-mode frames arrive back to back) */
+                        var endOfLineIndex = stringBuilder.indexOf("\n")
+                        while (endOfLineIndex >= 0) {
                             val dataLine = stringBuilder.substring(0, endOfLineIndex).trim()
                             stringBuilder.delete(0, endOfLineIndex + 1)
 
-                            withContext(Dispatchers.Main) {
-                                processData(dataLine)
+                            if (dataLine.isNotEmpty()) {
+                                withContext(Dispatchers.Main) {
+                                    processData(dataLine)
+                                }
                             }
+                            endOfLineIndex = stringBuilder.indexOf("\n")
                         }
                     }
                 } catch (e: IOException) {
@@ -378,15 +445,195 @@ class MainActivity : AppCompatActivity() {
         }
     }
 
+    /**
+     * Closes the binary frame collected in frameBuffer: COBS decode, CRC-16/CCITT-FALSE
+     * and version check. Sequence gaps are logged as lost frames.
+     * @return the frame without CRC, or null if it is not a valid frame
+     */
+    private fun decodeFrame(): ByteArray? {
+        val length = frameLength
+        val overflow = frameOverflow
+        val synced = frameSynced
+        frameLength = 0
+        frameOverflow = false
+        frameSynced = true
+        if (!synced || overflow || length == 0) return null
+
+        /* COBS: every block but a full one (0xFF) and the last stands for a zero */
+        val raw = ByteArray(length)
+        var n = 0
+        var i = 0
+        while (i < length) {
+            val code = frameBuffer[i++].toInt() and 0xFF
+            if (i + code - 1 > length) return null
+            for (k in 0 until code - 1) raw[n++] = frameBuffer[i++]
+            if (code != 0xFF && i < length) raw[n++] = 0
+        }
+        if (n < PROTO_HEADER_SIZE + PROTO_CRC_SIZE) return null
+
+        var crc = 0xFFFF
+        for (k in 0 until n - PROTO_CRC_SIZE) {
+            crc = crc xor ((raw[k].toInt() and 0xFF) shl 8)
+            for (bit in 0 until 8) {
+                crc = if (crc and 0x8000 != 0) ((crc shl 1) xor 0x1021) and 0xFFFF else (crc shl 1) and 0xFFFF
+            }
+        }
+        val rxCrc = (raw[n - 2].toInt() and 0xFF) or ((raw[n - 1].toInt() and 0xFF) shl 8)
+        if (crc != rxCrc || (raw[0].toInt() and 0xFF) shr 4 != PROTO_VERSION) {
+            Log.w("ECG", "Dropped corrupt frame")
+            return null
+        }
+
+        val seq = (raw[1].toInt() and 0xFF) or ((raw[2].toInt() and 0xFF) shl 8)
+        if (nextSeq >= 0 && seq != nextSeq) {
+            lostFrames += ((seq - nextSeq) and 0xFFFF).toLong()
+            Log.w("ECG", "Lost ${(seq - nextSeq) and 0xFFFF} frames ($lostFrames total)")
+        }
+        nextSeq = (seq + 1) and 0xFFFF
+        return raw.copyOf(n - PROTO_CRC_SIZE)
+    }
+
+    /**
+     * Decodes one Rice block (first sample, predictor order, then per partition a
+     * parameter k and zigzag residuals) running from start to the end of data
+     * @return The n samples, or null if the block does not end exactly at the end of data
+     */
+    private fun riceDecode(data: ByteArray, start: Int, n: Int): IntArray? {
+        if (n < 1 || n > RICE_BLOCK) return null
+        val x = IntArray(n)
+        var pos = start
+        var acc = 0
+        var bits = 0
+
+        /* MSB-first; past the end reads zeros and leaves pos > data.size */
+        fun get(count: Int): Int {
+            while (bits < count) {
+                acc = (acc shl 8) or (if (pos < data.size) data[pos].toInt() and 0xFF else 0)
+                pos++
+                bits += 8
+            }
+            bits -= count
+            return (acc ushr bits) and ((1 shl count) - 1)
+        }
+
+        x[0] = get(12)
+        val order2 = get(1) == 1
+        var i = 1
+        while (i < n && pos <= data.size) {
+            val k = get(4)
+            val end = minOf(n, i + RICE_PART)
+            while (i < end) {
+                if (k == RICE_K_RAW) {
+                    x[i] = get(12)
+                } else {
+                    var q = 0
+                    while (q < RICE_ESC && get(1) == 1) q++
+                    val u = if (q < RICE_ESC) (q shl k) or (if (k != 0) get(k) else 0) else get(15)
+                    val r = if ((u and 1) == 1) -((u + 1) shr 1) else u shr 1
+                    val pred = if (order2 && i >= 2) 2 * x[i - 1] - x[i - 2] else x[i - 1]
+                    x[i] = (pred + r) and 0x0FFF
+                }
+                i++
+            }
+        }
+        return if (pos == data.size) x else null
+    }
+
+    /**
+     * Processes one valid binary frame (header: version/type, seq, tick)
+     *  - SAMPLES: n, bpm, n packed 12-bit samples (n = 0: leads off)
+     *  - BEAT: rr, bpm
+     *  - RICE: n, bpm, Rice-coded block of n samples
+     *  - TEXT: a text-stream record, e.g. a command acknowledgement
+     * @param frame Decoded frame without CRC
+     */
+    private fun processFrame(frame: ByteArray) {
+        val type = frame[0].toInt() and 0x0F
+        val body = PROTO_HEADER_SIZE
+
+        if (type == PROTO_TYPE_SAMPLES && frame.size >= body + 2) {
+            val n = frame[body].toInt() and 0xFF
+            val bpm = frame[body + 1].toInt() and 0xFF
+            if (frame.size != body + 2 + (n / 2) * 3 + (n and 1) * 2) return
+
+            var p = body + 2
+            var i = 0
+            while (i < n) {
+                val b0 = frame[p].toInt() and 0xFF
+                val b1 = frame[p + 1].toInt() and 0xFF
+                addEntry((b0 or ((b1 and 0x0F) shl 8)).toFloat())
+                if (i + 1 < n) {
+                    val b2 = frame[p + 2].toInt() and 0xFF
+                    addEntry(((b1 shr 4) or (b2 shl 4)).toFloat())
+                }
+                p += 3
+                i += 2
+            }
+
+            currentBpm = bpm
+            binding.tvBPM.text = bpm.toString()
+            updateStatus(bpm)
+        } else if (type == PROTO_TYPE_RICE && frame.size >= body + 3) {
+            val n = frame[body].toInt() and 0xFF
+            val bpm = frame[body + 1].toInt() and 0xFF
+            val samples = riceDecode(frame, body + 2, n) ?: return
+
+            for (v in samples) addEntry(v.toFloat())
+
+            currentBpm = bpm
+            binding.tvBPM.text = bpm.toString()
+            updateStatus(bpm)
+        } else if (type == PROTO_TYPE_TEXT) {
+            processData(String(frame, body, frame.size - body, Charsets.US_ASCII))
+        } else if (type == PROTO_TYPE_BEAT && frame.size == body + 3) {
+            val bpm = frame[body + 2].toInt() and 0xFF
+
+            currentBpm = bpm
+            binding.tvBPM.text = bpm.toString()
+            updateStatus(bpm)
+        }
+    }
+
     /**
      * Processes incoming ECG data string
-     * Expected format: "ecgValue,bpm" (e.g., "512,75")
+     * Expected formats:
+     *  - "ecgValue,bpm" (e.g., "512,75"), one line per sample
+     *  - beat mode: "W,tick,v0,...,vN" waveform frames and
+     *    "B,rTick,rr,amplitude,signal,noise,bpm" beat records
+     *  - "K,cmd,status,stream,rate,sim,mask,decim" command acknowledgements
+     *  - "G,acquired,processed,overruns,late,txBytes,txDropped,dbgDropped,loopMaxUs,
+     *    leadsOffMs,resetCause,wdtResets,stallTask" health counters, once a second
      * @param data Raw data string from Bluetooth
      */
     private fun processData(data: String) {
         try {
             val parts = data.split(",")
-            if (parts.size == 2) {
+            if (parts[0] == "W" && parts.size >= 3) {
+                /* Waveform frame: parts[1] is the tick of the first sample */
+                for (i in 2 until parts.size) {
+                    addEntry(parts[i].toFloat())
+                }
+            } else if (parts[0] == "B" && parts.size == 7) {
+                /* Beat record: only the BPM is shown, RR/levels are for logging */
+                val bpm = parts[6].toInt()
+
+                currentBpm = bpm
+                binding.tvBPM.text = bpm.toString()
+                updateStatus(bpm)
+            } else if (parts[0] == "K" && parts.size == 8) {
+                /* Command acknowledgement: the firmware streams in parts[3] from now on */
+                if (parts[2] != "0") Log.w("ECG", "Command ${parts[1]} refused: $data")
+                binaryMode = parts[3].toInt() >= 2
+            } else if (parts[0] == "G" && parts.size == 13) {
+                /* Health counters: lost samples, late processing, dropped output, watchdog resets */
+                val lost = parts[3].toInt() + parts[4].toInt() + parts[6].toInt()
+                if (lost != 0) Log.w("ECG", "Device health: $data")
+                val wdtResets = parts[11].toLong()
+                if (wdtResets != lastWdtResets) {
+                    if (wdtResets > lastWdtResets) Log.w("ECG", "Device watchdog reset, stalled task ${parts[12]}: $data")
+                    lastWdtResets = wdtResets
+                }
+            } else if (parts.size == 2) {
                 val ecgValue = parts[0].toFloat()
                 val bpm = parts[1].toInt()
 
@@ -402,6 +649,23 @@ class MainActivity : AppCompatActivity() {
         }
     }
 
+    /**
+     * Sends one command line to the firmware (Embedded/include/ecg_cmd.h), e.g. "M,3" for
+     * the RICE stream or "S,1" for the simulator; the answer is a "K" record
+     * @param command Command without line end
+     */
+    fun sendCommand(command: String) {
+        val out = outputStream ?: return
+        CoroutineScope(Dispatchers.IO).launch {
+            try {
+                out.write("$command\n".toByteArray(Charsets.US_ASCII))
+                out.flush()
+            } catch (e: IOException) {
+                Log.e("ECG", "Error sending: $command")
+            }
+        }
+    }
+
     /**
      * Updates heart rate status based on BPM value
      * @param bpm Current beats per minute value
@@ -0,0 +1,118 @@
+#ifndef ECG_PROTO_DECODER_HPP
+#define ECG_PROTO_DECODER_HPP
+
+/*
+ * Host decoder of the binary ECG link protocol (include/ecg_proto.h, version 1).
+ *
+ * Feed it the raw byte stream in chunks of any size; every frame that passes COBS,
+ * CRC-16 and length checks is handed to a callback. Sequence gaps count the frames
+ * lost on the way (dropped by the firmware's full transmit ring, lost on the link or
+ * rejected here), so loss is visible without trusting the link. SAMPLES and RICE
+ * frames both arrive as Samples; the RICE block is decoded here (include/ecg_rice.h).
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ecg_proto {
+
+constexpr uint8_t kVersion     = 1;
+constexpr uint8_t kTypeSamples = 1;
+constexpr uint8_t kTypeBeat    = 2;
+constexpr uint8_t kTypeRice    = 3;
+constexpr uint8_t kTypeText    = 4;
+constexpr uint8_t kTypeProf    = 5;
+
+/* Histogram bins of a PROF frame: < 16 cycles, then [2^(b+3), 2^(b+4)), the last open-ended */
+constexpr std::size_t kProfBins = 16;
+
+/* Longest encoded frame accepted before its 0x00; anything longer is noise */
+constexpr std::size_t kMaxEncoded = 512;
+
+struct Samples {
+    uint16_t seq;
+    uint32_t tick;                  /* tick of values[0] */
+    uint8_t  bpm;
+    std::vector<uint16_t> values;   /* 12-bit ADC samples; empty = leads off */
+};
+
+struct Beat {
+    uint16_t seq;
+    uint32_t r_tick;
+    uint16_t rr;                    /* samples since the previous beat, 0 = unknown */
+    uint8_t  bpm;
+};
+
+struct Text {
+    uint16_t seq;
+    uint32_t tick;
+    std::string record;             /* text-stream record without "\r\n", e.g. a "K" acknowledgement */
+};
+
+struct Prof {
+    uint16_t seq;
+    uint32_t tick;
+    uint8_t  probe;                 /* include/prof.h Prof_Probe */
+    uint32_t count;                 /* intervals since the probe's previous report */
+    uint32_t sum;                   /* cycles, saturating */
+    uint32_t min;
+    uint32_t max;
+    uint16_t hist[kProfBins];
+};
+
+struct Stats {
+    uint64_t bytes = 0;             /* bytes fed */
+    uint64_t frames = 0;            /* valid frames */
+    uint64_t samples = 0;           /* samples in valid SAMPLES and RICE frames */
+    uint64_t lost_frames = 0;       /* sequence numbers skipped between valid frames */
+    uint64_t crc_errors = 0;
+    uint64_t bad_frames = 0;        /* COBS, length, version or type errors */
+};
+
+/* CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) */
+uint16_t crc16(const uint8_t *data, std::size_t n);
+
+/* Decode one ecg_rice.h block of values.size() samples; the block must be exactly n bytes */
+bool rice_decode(const uint8_t *in, std::size_t n, std::vector<uint16_t> &values);
+
+/* Decode one COBS block (delimiter stripped) into out; false if malformed */
+bool cobs_decode(const uint8_t *in, std::size_t n, std::vector<uint8_t> &out);
+
+class Decoder {
+public:
+    using SamplesHandler = std::function<void(const Samples &)>;
+    using BeatHandler    = std::function<void(const Beat &)>;
+    using TextHandler    = std::function<void(const Text &)>;
+    using ProfHandler    = std::function<void(const Prof &)>;
+
+    Decoder(SamplesHandler on_samples, BeatHandler on_beat, TextHandler on_text = nullptr,
+            ProfHandler on_prof = nullptr);
+
+    /* Consume link bytes; callbacks run from inside for every complete valid frame */
+    void feed(const uint8_t *data, std::size_t n);
+
+    const Stats &stats() const { return stats_; }
+
+private:
+    void frame_end();
+    bool parse(const std::vector<uint8_t> &raw);
+
+    SamplesHandler on_samples_;
+    BeatHandler on_beat_;
+    TextHandler on_text_;
+    ProfHandler on_prof_;
+    std::vector<uint8_t> encoded_;
+    std::vector<uint8_t> raw_;
+    bool synced_ = false;           /* bytes before the first 0x00 belong to a cut frame */
+    bool overflow_ = false;
+    bool have_seq_ = false;
+    uint16_t next_seq_ = 0;
+    Stats stats_;
+};
+
+}  // namespace ecg_proto
+
+#endif /* ECG_PROTO_DECODER_HPP */
@@ -0,0 +1,52 @@
+#ifndef STM32F4XX_HOST_H
+#define STM32F4XX_HOST_H
+
+/*
+ * Host (Linux) stand-in for the CMSIS device header.
+ * Only the signal-chain modules (pan_tompkins*, hrv*, sample_ring, ecg_sim) are built
+ * against it; they use nothing from the device header beyond the standard integer types,
+ * the barrier intrinsics and the DWT cycle counter, so no peripheral registers are
+ * declared here.
+ * The CMSIS-DSP sources pick their generic-C path from __GNUC_PYTHON__ (set by CMake).
+ */
+
+#include <stdint.h>
+
+#define __NOP()          do { } while (0)
+#define __disable_irq()  do { } while (0)
+#define __enable_irq()   do { } while (0)
+#define __DMB()          __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+/*
+ * DWT->CYCCNT reads a free-running host counter (TSC on x86, ns elsewhere), so code
+ * that times itself with the DWT cycle counter builds unchanged. Only CYCCNT reads work.
+ * With HOST_DWT_MANUAL defined it reads host_dwt_cyccnt instead, a counter the program
+ * advances itself (tests of timing logic, host/tests/test_sched.c).
+ */
+#if defined(HOST_DWT_MANUAL)
+extern uint32_t host_dwt_cyccnt;
+#define HOST_CYCLES()    (host_dwt_cyccnt)
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HOST_CYCLES()    ((uint32_t)__rdtsc())
+#else
+#include <time.h>
+static inline uint32_t HOST_CYCLES(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+#endif
+
+typedef struct {
+    uint32_t CYCCNT;
+} HOST_DWT_Type;
+
+static inline const HOST_DWT_Type *HOST_DWT(void) {
+    static HOST_DWT_Type dwt;
+    dwt.CYCCNT = HOST_CYCLES();
+    return &dwt;
+}
+#define DWT              (HOST_DWT())
+
+#endif /* STM32F4XX_HOST_H */
@@ -0,0 +1,212 @@
+#include "ecg_proto_decoder.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace ecg_proto {
+
+namespace {
+
+constexpr std::size_t kHeaderSize = 7;
+constexpr std::size_t kCrcSize = 2;
+
+uint16_t get_u16(const uint8_t *p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t get_u32(const uint8_t *p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+std::size_t packed_size(std::size_t n) {
+    return (n / 2) * 3 + (n & 1) * 2;
+}
+
+constexpr std::size_t kRiceBlock = 128;
+constexpr std::size_t kRicePart = 16;
+constexpr uint32_t kRiceKRaw = 15;
+constexpr uint32_t kRiceEsc = 16;
+
+/* MSB-first reader; reads past the end return zeros and set overrun */
+class BitReader {
+public:
+    BitReader(const uint8_t *p, std::size_t n) : p_(p), n_(n) {}
+
+    uint32_t get(uint32_t bits) {
+        while (bits_ < bits) {
+            acc_ = (acc_ << 8) | ((pos_ < n_) ? p_[pos_] : 0u);
+            pos_++;
+            bits_ += 8;
+        }
+        bits_ -= bits;
+        return (acc_ >> bits_) & ((1u << bits) - 1u);
+    }
+
+    std::size_t used() const { return pos_; }
+    bool overrun() const { return pos_ > n_; }
+
+private:
+    const uint8_t *p_;
+    std::size_t n_;
+    std::size_t pos_ = 0;
+    uint32_t acc_ = 0;
+    uint32_t bits_ = 0;
+};
+
+}  // namespace
+
+uint16_t crc16(const uint8_t *data, std::size_t n) {
+    uint16_t crc = 0xFFFF;
+    for (std::size_t i = 0; i < n; i++) {
+        crc ^= static_cast<uint16_t>(data[i] << 8);
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+bool rice_decode(const uint8_t *in, std::size_t n, std::vector<uint16_t> &values) {
+    const std::size_t count = values.size();
+    if (count == 0 || count > kRiceBlock) return false;
+
+    BitReader r(in, n);
+    values[0] = static_cast<uint16_t>(r.get(12));
+    const bool order2 = r.get(1) != 0;
+
+    for (std::size_t i = 1; i < count && !r.overrun();) {
+        const std::size_t end = std::min(count, i + kRicePart);
+        const uint32_t k = r.get(4);
+        for (; i < end; i++) {
+            if (k == kRiceKRaw) {
+                values[i] = static_cast<uint16_t>(r.get(12));
+                continue;
+            }
+            uint32_t q = 0;
+            while (q < kRiceEsc && r.get(1)) q++;
+            const uint32_t u = (q < kRiceEsc) ? ((q << k) | (k ? r.get(k) : 0u)) : r.get(15);
+            const int32_t residual = (u & 1u) ? -static_cast<int32_t>((u + 1) >> 1) : static_cast<int32_t>(u >> 1);
+            const int32_t pred = (order2 && i >= 2) ? 2 * values[i - 1] - values[i - 2] : values[i - 1];
+            values[i] = static_cast<uint16_t>((pred + residual) & 0x0FFF);
+        }
+    }
+    return !r.overrun() && r.used() == n;
+}
+
+bool cobs_decode(const uint8_t *in, std::size_t n, std::vector<uint8_t> &out) {
+    out.clear();
+    std::size_t i = 0;
+    while (i < n) {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > n) return false;
+        out.insert(out.end(), in + i, in + i + code - 1);
+        i += code - 1;
+        /* Every block but a full one (0xFF) and the last stands for a zero */
+        if (code != 0xFF && i < n) out.push_back(0);
+    }
+    return true;
+}
+
+Decoder::Decoder(SamplesHandler on_samples, BeatHandler on_beat, TextHandler on_text, ProfHandler on_prof)
+    : on_samples_(std::move(on_samples)), on_beat_(std::move(on_beat)), on_text_(std::move(on_text)),
+      on_prof_(std::move(on_prof)) {
+    encoded_.reserve(kMaxEncoded);
+}
+
+void Decoder::feed(const uint8_t *data, std::size_t n) {
+    stats_.bytes += n;
+    for (std::size_t i = 0; i < n; i++) {
+        if (data[i] == 0) {
+            frame_end();
+        } else if (encoded_.size() < kMaxEncoded) {
+            encoded_.push_back(data[i]);
+        } else {
+            overflow_ = true;
+        }
+    }
+}
+
+void Decoder::frame_end() {
+    bool synced = synced_;
+    synced_ = true;
+
+    if (!synced || encoded_.empty()) {
+        /* Tail of a frame cut by the start of the capture, or back-to-back delimiters */
+    } else if (overflow_ || !cobs_decode(encoded_.data(), encoded_.size(), raw_)) {
+        stats_.bad_frames++;
+    } else if (raw_.size() < kHeaderSize + kCrcSize) {
+        stats_.bad_frames++;
+    } else if (crc16(raw_.data(), raw_.size() - kCrcSize) != get_u16(&raw_[raw_.size() - kCrcSize])) {
+        stats_.crc_errors++;
+    } else if (!parse(raw_)) {
+        stats_.bad_frames++;
+    }
+    encoded_.clear();
+    overflow_ = false;
+}
+
+bool Decoder::parse(const std::vector<uint8_t> &raw) {
+    const uint8_t version = raw[0] >> 4;
+    const uint8_t type = raw[0] & 0x0F;
+    const uint16_t seq = get_u16(&raw[1]);
+    const uint32_t tick = get_u32(&raw[3]);
+    const uint8_t *body = &raw[kHeaderSize];
+    const std::size_t body_len = raw.size() - kHeaderSize - kCrcSize;
+
+    if (version != kVersion) return false;
+
+    if (type == kTypeSamples) {
+        if (body_len < 2) return false;
+        const std::size_t n = body[0];
+        if (body_len != 2 + packed_size(n)) return false;
+
+        Samples s{seq, tick, body[1], {}};
+        s.values.resize(n);
+        const uint8_t *p = body + 2;
+        std::size_t i = 0;
+        for (; i + 1 < n; i += 2, p += 3) {
+            s.values[i]     = static_cast<uint16_t>(p[0] | ((p[1] & 0x0F) << 8));
+            s.values[i + 1] = static_cast<uint16_t>((p[1] >> 4) | (p[2] << 4));
+        }
+        if (i < n) {
+            s.values[i] = static_cast<uint16_t>(p[0] | ((p[1] & 0x0F) << 8));
+        }
+        stats_.samples += n;
+        if (have_seq_) stats_.lost_frames += static_cast<uint16_t>(seq - next_seq_);
+        if (on_samples_) on_samples_(s);
+    } else if (type == kTypeRice) {
+        if (body_len < 3) return false;
+        const std::size_t n = body[0];
+        Samples s{seq, tick, body[1], std::vector<uint16_t>(n)};
+        if (!rice_decode(body + 2, body_len - 2, s.values)) return false;
+
+        stats_.samples += n;
+        if (have_seq_) stats_.lost_frames += static_cast<uint16_t>(seq - next_seq_);
+        if (on_samples_) on_samples_(s);
+    } else if (type == kTypeBeat) {
+        if (body_len != 3) return false;
+        Beat b{seq, tick, get_u16(body), body[2]};
+        if (have_seq_) stats_.lost_frames += static_cast<uint16_t>(seq - next_seq_);
+        if (on_beat_) on_beat_(b);
+    } else if (type == kTypeText) {
+        Text t{seq, tick, std::string(reinterpret_cast<const char *>(body), body_len)};
+        if (have_seq_) stats_.lost_frames += static_cast<uint16_t>(seq - next_seq_);
+        if (on_text_) on_text_(t);
+    } else if (type == kTypeProf) {
+        if (body_len != 1 + 4 * 4 + 2 * kProfBins) return false;
+        Prof p{seq, tick, body[0], get_u32(body + 1), get_u32(body + 5), get_u32(body + 9), get_u32(body + 13), {}};
+        for (std::size_t b = 0; b < kProfBins; b++) p.hist[b] = get_u16(body + 17 + 2 * b);
+        if (have_seq_) stats_.lost_frames += static_cast<uint16_t>(seq - next_seq_);
+        if (on_prof_) on_prof_(p);
+    } else {
+        return false;
+    }
+
+    have_seq_ = true;
+    next_seq_ = static_cast<uint16_t>(seq + 1);
+    stats_.frames++;
+    return true;
+}
+
+}  // namespace ecg_proto
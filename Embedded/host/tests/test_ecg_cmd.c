@@ -0,0 +1,219 @@
+/*
+ * test_ecg_cmd: the HC-05 command path on the host. Covers ECG_Cmd_Parse (valid,
+ * malformed and out-of-range commands; cfg untouched on error), ECG_Cmd_FormatAck and
+ * the receive line queue the USART1 interrupt feeds (ECG_Cmd_RxByte / ECG_Cmd_RxEnd /
+ * ECG_Cmd_RxRead): CR/LF/CRLF and idle-terminated lines, over-long lines and lines
+ * arriving with the queue full.
+ */
+#include "ecg_cmd.h"
+#include <stdio.h>
+#include <string.h>
+
+static uint32_t fail;
+
+#define CHECK(cond, ...) do {                                       \
+        if (!(cond)) {                                              \
+            fprintf(stderr, "test_ecg_cmd:%d: ", __LINE__);         \
+            fprintf(stderr, __VA_ARGS__);                           \
+            fputc('\n', stderr);                                    \
+            fail++;                                                 \
+        }                                                           \
+    } while (0)
+
+static const ECG_Cmd_Config cfg0 = { ECG_STREAM_TEXT, 360u, 0u, 0u, 1u };
+
+/* Parse line on a copy of cfg0: expected status, and cfg0 unchanged unless OK */
+static ECG_Cmd_Config parse(const char *line, uint8_t expect) {
+    ECG_Cmd_Config cfg = cfg0;
+    uint8_t status = ECG_Cmd_Parse(line, &cfg);
+
+    CHECK(status == expect, "\"%s\": status %u, expected %u", line, status, expect);
+    if (status != ECG_CMD_OK) {
+        CHECK(memcmp(&cfg, &cfg0, sizeof(cfg)) == 0, "\"%s\": cfg changed on error", line);
+    }
+    return cfg;
+}
+
+static void test_parse(void) {
+    ECG_Cmd_Config cfg;
+
+    /* Valid */
+    cfg = parse("M,3", ECG_CMD_OK);
+    CHECK(cfg.stream == ECG_STREAM_RICE, "M,3: stream %u", cfg.stream);
+    cfg = parse("M,0", ECG_CMD_OK);
+    CHECK(cfg.stream == ECG_STREAM_TEXT, "M,0: stream %u", cfg.stream);
+    cfg = parse("R,250", ECG_CMD_OK);
+    CHECK(cfg.sample_rate_hz == 250u, "R,250: rate %u", cfg.sample_rate_hz);
+    cfg = parse("D,7,10", ECG_CMD_OK);
+    CHECK((cfg.log_mask == 7u) && (cfg.log_decim == 10u), "D,7,10: mask %u decim %u", cfg.log_mask, cfg.log_decim);
+    cfg = parse("D,0,1", ECG_CMD_OK);
+    CHECK(cfg.log_mask == 0u, "D,0,1: mask %u", cfg.log_mask);
+    cfg = parse("S,1", ECG_CMD_OK);
+    CHECK(cfg.sim == 1u, "S,1: sim %u", cfg.sim);
+    cfg = parse("?", ECG_CMD_OK);
+    CHECK(memcmp(&cfg, &cfg0, sizeof(cfg)) == 0, "?: cfg changed");
+    cfg = parse("R,999999999", ECG_CMD_OK);
+    CHECK(cfg.sample_rate_hz == 999999999u, "R,999999999: rate %u", cfg.sample_rate_hz);
+
+    /* Unknown letter */
+    parse("X,1", ECG_CMD_UNKNOWN);
+    parse("m,1", ECG_CMD_UNKNOWN);
+    parse("", ECG_CMD_UNKNOWN);
+
+    /* Malformed: missing, empty, extra or non-decimal arguments, trailing junk */
+    parse("M", ECG_CMD_BAD_ARG);
+    parse("M,", ECG_CMD_BAD_ARG);
+    parse("M,,1", ECG_CMD_BAD_ARG);
+    parse("M,1x", ECG_CMD_BAD_ARG);
+    parse("M,-1", ECG_CMD_BAD_ARG);
+    parse("M,+1", ECG_CMD_BAD_ARG);
+    parse("M, 1", ECG_CMD_BAD_ARG);
+    parse("M1", ECG_CMD_BAD_ARG);
+    parse("M,1,2", ECG_CMD_BAD_ARG);
+    parse("M,1,2,3", ECG_CMD_BAD_ARG);
+    parse("D,7", ECG_CMD_BAD_ARG);
+    parse("?,0", ECG_CMD_BAD_ARG);
+    parse("?x", ECG_CMD_BAD_ARG);
+
+    /* Out of range */
+    parse("M,4", ECG_CMD_BAD_ARG);
+    parse("S,2", ECG_CMD_BAD_ARG);
+    parse("R,0", ECG_CMD_BAD_ARG);
+    parse("D,1,0", ECG_CMD_BAD_ARG);
+    parse("R,1000000000", ECG_CMD_BAD_ARG);             /* more than 9 digits */
+    parse("R,99999999999999999999", ECG_CMD_BAD_ARG);   /* would wrap a uint32_t */
+    parse("M,4294967296", ECG_CMD_BAD_ARG);             /* 2^32: would wrap to 0 */
+}
+
+static void test_ack(void) {
+    ECG_Cmd_Config cfg = { ECG_STREAM_BINARY, 250u, 1u, 7u, 10u };
+    char out[ECG_CMD_ACK_MAX];
+    uint32_t len;
+
+    len = ECG_Cmd_FormatAck(out, 'M', ECG_CMD_OK, &cfg);
+    CHECK((len == strlen("K,M,0,2,250,1,7,10\r\n")) && (memcmp(out, "K,M,0,2,250,1,7,10\r\n", len) == 0),
+          "ack M: \"%.*s\"", (int)len, out);
+
+    /* Characters that would break the record become '?' */
+    len = ECG_Cmd_FormatAck(out, ',', ECG_CMD_UNKNOWN, &cfg);
+    CHECK((len == strlen("K,?,1,2,250,1,7,10\r\n")) && (memcmp(out, "K,?,1,2,250,1,7,10\r\n", len) == 0),
+          "ack ',': \"%.*s\"", (int)len, out);
+    len = ECG_Cmd_FormatAck(out, '\0', ECG_CMD_UNKNOWN, &cfg);
+    CHECK((len >= 4u) && (out[2] == '?'), "ack NUL: \"%.*s\"", (int)len, out);
+
+    /* Largest fields still fit */
+    ECG_Cmd_Config big = { 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu };
+    len = ECG_Cmd_FormatAck(out, 'D', ECG_CMD_BAD_ARG, &big);
+    CHECK((len != 0u) && (len <= ECG_CMD_ACK_MAX) && (memcmp(&out[len - 2u], "\r\n", 2u) == 0),
+          "ack max: length %u", len);
+}
+
+/* Feed s to the producer one character at a time, as the RXNE interrupt does */
+static void rx_feed(ECG_Cmd_Rx_t *rx, const char *s) {
+    while (*s) ECG_Cmd_RxByte(rx, *s++);
+}
+
+static void rx_expect(ECG_Cmd_Rx_t *rx, const char *expect) {
+    char line[ECG_CMD_LINE_MAX + 1u];
+
+    if (expect == NULL) {
+        CHECK(ECG_Cmd_RxRead(rx, line) == 0, "rx: unexpected line \"%.*s\"", (int)ECG_CMD_LINE_MAX, line);
+        return;
+    }
+    memset(line, 0x55, sizeof(line));
+    if (!ECG_Cmd_RxRead(rx, line)) {
+        CHECK(0, "rx: no line, expected \"%s\"", expect);
+    } else {
+        CHECK(strcmp(line, expect) == 0, "rx: line \"%.*s\", expected \"%s\"", (int)ECG_CMD_LINE_MAX, line, expect);
+    }
+}
+
+static void test_rx(void) {
+    static ECG_Cmd_Rx_t rx;
+    char max[ECG_CMD_LINE_MAX + 2u];
+
+    memset(&rx, 0, sizeof(rx));
+
+    /* CR, LF and CRLF terminate one line each; empty lines are ignored */
+    rx_feed(&rx, "M,1\r");
+    rx_feed(&rx, "R,250\n");
+    rx_feed(&rx, "S,0\r\n\r\n");
+    CHECK(ECG_Cmd_RxCount(&rx) == 3u, "rx: %u lines queued, expected 3", ECG_Cmd_RxCount(&rx));
+    rx_expect(&rx, "M,1");
+    rx_expect(&rx, "R,250");
+    rx_expect(&rx, "S,0");
+    rx_expect(&rx, NULL);
+
+    /* Idle-terminated: a command sent without terminator, then the IDLE interrupt */
+    rx_feed(&rx, "?");
+    CHECK(ECG_Cmd_RxCount(&rx) == 0u, "rx: line published before its end");
+    ECG_Cmd_RxEnd(&rx);
+    ECG_Cmd_RxEnd(&rx);                 /* a second idle line is empty */
+    rx_expect(&rx, "?");
+    rx_expect(&rx, NULL);
+
+    /* Over-long: ECG_CMD_LINE_MAX characters pass, one more drops the whole line */
+    memset(max, 'D', ECG_CMD_LINE_MAX);
+    max[ECG_CMD_LINE_MAX] = '\0';
+    rx_feed(&rx, max);
+    rx_feed(&rx, "\r");
+    rx_expect(&rx, max);
+    max[ECG_CMD_LINE_MAX] = 'D';
+    max[ECG_CMD_LINE_MAX + 1u] = '\0';
+    rx_feed(&rx, max);
+    rx_feed(&rx, "\r");
+    rx_expect(&rx, NULL);
+    CHECK(rx.dropped == 1u, "rx: dropped %u after an over-long line, expected 1", rx.dropped);
+    rx_feed(&rx, "M,2\r");              /* the next line is intact */
+    rx_expect(&rx, "M,2");
+
+    /* Queue full: ECG_CMD_RX_LINES unread lines, the next one is dropped, not the oldest */
+    for (uint32_t i = 0; i < ECG_CMD_RX_LINES; i++) {
+        char cmd[8];
+        snprintf(cmd, sizeof(cmd), "M,%u\n", i);
+        rx_feed(&rx, cmd);
+    }
+    rx_feed(&rx, "R,500\n");
+    CHECK(ECG_Cmd_RxCount(&rx) == ECG_CMD_RX_LINES, "rx: %u lines queued", ECG_Cmd_RxCount(&rx));
+    CHECK(rx.dropped == 2u, "rx: dropped %u with the queue full, expected 2", rx.dropped);
+    for (uint32_t i = 0; i < ECG_CMD_RX_LINES; i++) {
+        char cmd[8];
+        snprintf(cmd, sizeof(cmd), "M,%u", i);
+        rx_expect(&rx, cmd);
+    }
+    rx_expect(&rx, NULL);
+
+    /* A line that starts before a slot frees stays dropped even if one frees mid-line */
+    for (uint32_t i = 0; i < ECG_CMD_RX_LINES; i++) rx_feed(&rx, "?\n");
+    rx_feed(&rx, "S,");
+    rx_expect(&rx, "?");
+    rx_feed(&rx, "1\n");
+    CHECK(rx.dropped == 3u, "rx: dropped %u, expected 3", rx.dropped);
+    for (uint32_t i = 1; i < ECG_CMD_RX_LINES; i++) rx_expect(&rx, "?");
+    rx_expect(&rx, NULL);
+
+    /* Free-running counters wrap */
+    rx.head = rx.tail = 0xFFFFFFFEu;
+    rx_feed(&rx, "M,1\nM,2\nM,3\n");
+    rx_expect(&rx, "M,1");
+    rx_expect(&rx, "M,2");
+    rx_expect(&rx, "M,3");
+    rx_expect(&rx, NULL);
+
+    /* End to end: every queued line parses */
+    ECG_Cmd_Config cfg = cfg0;
+    char line[ECG_CMD_LINE_MAX + 1u];
+    rx_feed(&rx, "D,3,4\r\nM,9\r\n");
+    CHECK(ECG_Cmd_RxRead(&rx, line) && (ECG_Cmd_Parse(line, &cfg) == ECG_CMD_OK), "rx: D,3,4 rejected");
+    CHECK(ECG_Cmd_RxRead(&rx, line) && (ECG_Cmd_Parse(line, &cfg) == ECG_CMD_BAD_ARG), "rx: M,9 accepted");
+    CHECK((cfg.log_mask == 3u) && (cfg.log_decim == 4u) && (cfg.stream == cfg0.stream), "rx: cfg after D,3,4 / M,9");
+}
+
+int main(void) {
+    test_parse();
+    test_ack();
+    test_rx();
+
+    printf("test_ecg_cmd: parse, ack, rx queue: %s\n", fail ? "FAIL" : "ok");
+    return fail ? 1 : 0;
+}
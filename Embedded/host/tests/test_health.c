@@ -0,0 +1,121 @@
+/*
+ * test_health: the watchdog stall path. A model of the firmware main loop runs on the
+ * scheduler (sched.c, HOST_DWT_MANUAL, 1 cycle = 1us): a DMA acquisition that pushes
+ * AD8232_BLOCK_SIZE samples per block, the hard sample task, and the 1s self-test and
+ * stack-check tasks that run with LOW_POWER 0. After every slice the loop refreshes a
+ * model IWDG when Health_WatchdogFeed allows it, as Health_Slice does.
+ *
+ * For sample rates of 100..1000Hz and watchdog timeouts across the LSI tolerance
+ * (0.7..1.9s for HEALTH_WDT_MS):
+ *  - while the acquisition runs, the watchdog never expires
+ *  - once it stops, the watchdog expires within one block plus the timeout, although
+ *    the periodic tasks keep running slices
+ * and, as the reference, refreshing after every slice never expires once the timeout
+ * is longer than the task period (a slow LSI).
+ */
+#include "health.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_BLOCK          32u             /* ad8232.h AD8232_BLOCK_SIZE */
+#define TEST_US(ms)         ((ms) * 1000u)
+#define TEST_RUN_MS         10000u          /* acquisition running */
+#define TEST_STALL_MS       10000u          /* then stopped */
+
+uint32_t host_dwt_cyccnt;
+Health_t health;
+
+static uint32_t fail;
+
+/* Model state */
+static uint32_t ring;                       /* samples waiting */
+static uint32_t next_block;                 /* time of the next DMA block */
+static uint32_t block_us;
+
+static uint8_t sample_ready(void) {
+    return ring != 0u;
+}
+
+static uint8_t sample_run(void) {
+    ring--;
+    Health_Sample();
+    host_dwt_cyccnt += 20u;
+    return ring == 0u;
+}
+
+static uint8_t selftest_run(void) {
+    host_dwt_cyccnt += 300u;
+    return 1;
+}
+
+/*
+ * Run the loop until the watchdog expires or the time is up; the acquisition stops at
+ * TEST_RUN_MS. feed_any: refresh after every slice instead of Health_WatchdogFeed.
+ * - Returns: time of expiry in ms, 0 if it never expired
+ */
+static uint32_t run_loop(uint32_t rate_hz, uint32_t timeout_ms, uint8_t feed_any) {
+    static Sched_t s;
+    uint32_t wdt_last = 0;
+
+    host_dwt_cyccnt = 0;
+    memset(&health, 0, sizeof(health));
+    ring = 0;
+    block_us = TEST_BLOCK * 1000000u / rate_hz;
+    next_block = block_us;
+
+    Sched_Init(&s);
+    Sched_Add(&s, "sample", SCHED_HARD, sample_ready, sample_run, 0u, 0u);
+    Sched_Add(&s, "selftest", SCHED_SOFT, NULL, selftest_run, TEST_US(1000u), 0u);
+    Sched_Add(&s, "stack", SCHED_IDLE, NULL, selftest_run, TEST_US(1000u), 0u);
+
+    while (host_dwt_cyccnt < TEST_US(TEST_RUN_MS + TEST_STALL_MS)) {
+        /* DMA half/full transfer: one block, while the acquisition runs */
+        if ((int32_t)(host_dwt_cyccnt - next_block) >= 0) {
+            if (host_dwt_cyccnt < TEST_US(TEST_RUN_MS)) ring += TEST_BLOCK;
+            next_block += block_us;
+        }
+
+        if (Sched_Step(&s) == SCHED_NONE) {
+            host_dwt_cyccnt += 100u;        /* idle until the next event */
+        } else if (feed_any || Health_WatchdogFeed(&health)) {
+            wdt_last = host_dwt_cyccnt;
+        }
+
+        if (host_dwt_cyccnt - wdt_last > TEST_US(timeout_ms)) return host_dwt_cyccnt / 1000u;
+    }
+    return 0;
+}
+
+int main(void) {
+    static const uint32_t rates[] = { 100u, 250u, 360u, 500u, 1000u };
+    static const uint32_t timeouts[] = { 700u, HEALTH_WDT_MS, 1900u };
+
+    for (uint32_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        for (uint32_t t = 0; t < sizeof(timeouts) / sizeof(timeouts[0]); t++) {
+            uint32_t rate = rates[r];
+            uint32_t timeout = timeouts[t];
+            uint32_t block_ms = (TEST_BLOCK * 1000u + rate - 1u) / rate;
+            uint32_t expired = run_loop(rate, timeout, 0);
+
+            if ((expired != 0u) && (expired <= TEST_RUN_MS)) {
+                fprintf(stderr, "test_health: %uHz, timeout %ums: reset at %ums with samples moving\n",
+                        rate, timeout, expired);
+                fail++;
+            } else if ((expired == 0u) || (expired > TEST_RUN_MS + block_ms + timeout + 1u)) {
+                fprintf(stderr, "test_health: %uHz, timeout %ums: acquisition stopped at %ums, reset at %ums\n",
+                        rate, timeout, TEST_RUN_MS, expired);
+                fail++;
+            }
+
+            /* Reference: with a slow LSI the 1s tasks alone keep a refresh-every-slice watchdog alive */
+            if ((timeout > 1000u) && (run_loop(rate, timeout, 1) != 0u)) {
+                fprintf(stderr, "test_health: %uHz, timeout %ums: model reset with any-slice refresh\n",
+                        rate, timeout);
+                fail++;
+            }
+        }
+    }
+
+    printf("test_health: watchdog with the acquisition running and stopped: %s\n", fail ? "FAIL" : "ok");
+    return fail ? 1 : 0;
+}
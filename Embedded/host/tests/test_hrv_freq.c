@@ -0,0 +1,132 @@
+/*
+ * test_hrv_freq: frequency-domain HRV on synthetic tachograms. RR intervals around
+ * 830ms (72 BPM), modulated by a sine at 0.1Hz (LF) or 0.25Hz (HF), go through
+ * HRV_AddRR at several ECG sample rates, and the analysis runs slice by slice to the
+ * end. A sine of amplitude A carries A^2/2 of power: it must show up in its own band
+ * within 10% (the Hermite resampling of one RR per beat loses about 6% at 0.25Hz), and
+ * the other band must stay near the quantization floor.
+ *
+ * Also covers HRV_FreqStart with too few intervals (returns 0 and stays idle) and a run
+ * cut by HRV_Break (only the newest gap-free part is analysed).
+ */
+#include "hrv_freq.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_RR_MS          830.0
+#define TEST_AMP_MS         30.0            /* A^2/2 = 450 ms^2 */
+#define TEST_SECONDS        360u            /* fills the 5 min window */
+#define TEST_MAX_SLICES     100000u
+
+static uint32_t fail;
+
+#define CHECK(cond, ...) do {                                       \
+        if (!(cond)) {                                              \
+            fprintf(stderr, "test_hrv_freq:%d: ", __LINE__);        \
+            fprintf(stderr, __VA_ARGS__);                           \
+            fputc('\n', stderr);                                    \
+            fail++;                                                 \
+        }                                                           \
+    } while (0)
+
+static HRV_Handle_t hrv;
+static HRV_Freq_Handle_t hf;
+
+/*
+ * Feed seconds of beats whose RR is TEST_RR_MS + amp_ms * sin(2*pi*f*t), t at the
+ * start of the beat, rounded to ECG samples. Returns the time reached in seconds.
+ */
+static double feed(uint32_t fs, double t, double seconds, double f_hz, double amp_ms) {
+    double end = t + seconds;
+
+    while (t < end) {
+        double rr_ms = TEST_RR_MS + amp_ms * sin(2.0 * M_PI * f_hz * t);
+        uint32_t rr = (uint32_t)lround(rr_ms * (double)fs / 1000.0);
+        HRV_AddRR(&hrv, rr);
+        t += (double)rr / (double)fs;
+    }
+    return t;
+}
+
+/* Run the analysis started by HRV_FreqStart to the end; returns 1 if it produced a result */
+static uint8_t run(HRV_FreqResult *r) {
+    uint32_t before = hf.n_results;
+    uint32_t slices = 0;
+
+    while (HRV_FreqStep(&hf) && (slices < TEST_MAX_SLICES)) slices++;
+    CHECK(hf.state == HRV_FREQ_IDLE, "analysis still running after %u slices", slices);
+    return (hf.n_results != before) && HRV_FreqGetResult(&hf, r);
+}
+
+static void test_band(uint32_t fs, double f_hz, uint8_t lf_band) {
+    HRV_FreqResult r;
+    const double expect = TEST_AMP_MS * TEST_AMP_MS / 2.0;
+
+    HRV_Init(&hrv, fs);
+    HRV_FreqInit(&hf, &hrv);
+    feed(fs, 0.0, TEST_SECONDS, f_hz, TEST_AMP_MS);
+
+    CHECK(HRV_FreqStart(&hf) == 1u, "%uHz, %.2fHz: start refused", fs, f_hz);
+    if (!run(&r)) {
+        CHECK(0, "%uHz, %.2fHz: no result", fs, f_hz);
+        return;
+    }
+
+    double in  = lf_band ? r.lf_ms2 : r.hf_ms2;
+    double out = lf_band ? r.hf_ms2 : r.lf_ms2;
+    CHECK(fabs(in - expect) < 0.1 * expect, "%uHz, %.2fHz: %s %.1f ms^2, expected %.1f",
+          fs, f_hz, lf_band ? "LF" : "HF", in, expect);
+    CHECK(out < 0.02 * expect, "%uHz, %.2fHz: %s %.1f ms^2 leaked", fs, f_hz, lf_band ? "HF" : "LF", out);
+    CHECK(r.vlf_ms2 < 0.02 * expect, "%uHz, %.2fHz: VLF %.1f ms^2 leaked", fs, f_hz, r.vlf_ms2);
+    CHECK(lf_band ? (r.lf_hf > 20.0f) : (r.lf_hf < 0.05f), "%uHz, %.2fHz: LF/HF %.3f", fs, f_hz, r.lf_hf);
+    CHECK((r.n_segments == 8u) && (r.span_s >= 295u), "%uHz, %.2fHz: %u segments over %us",
+          fs, f_hz, r.n_segments, r.span_s);
+}
+
+static void test_start(void) {
+    HRV_FreqResult r;
+
+    HRV_Init(&hrv, 360u);
+    HRV_FreqInit(&hf, &hrv);
+
+    /* Nothing to resample: refused, and the task it would release has nothing to do */
+    CHECK(HRV_FreqStart(&hf) == 0u, "start with no interval");
+    CHECK(hf.state == HRV_FREQ_IDLE, "state %u with no interval", hf.state);
+    HRV_AddRR(&hrv, 288u);
+    CHECK(HRV_FreqStart(&hf) == 0u, "start with one interval");
+    CHECK(hf.state == HRV_FREQ_IDLE, "state %u with one interval", hf.state);
+
+    /* Two intervals: it starts and finishes without a result (shorter than a segment) */
+    HRV_AddRR(&hrv, 288u);
+    CHECK(HRV_FreqStart(&hf) == 1u, "start with two intervals refused");
+    CHECK(HRV_FreqStart(&hf) == 0u, "second start while running");
+    CHECK(!run(&r), "result from two intervals");
+
+    /* A break 100s before the end: only the newest 100s are analysed */
+    HRV_Init(&hrv, 360u);
+    HRV_FreqInit(&hf, &hrv);
+    double t = feed(360u, 0.0, 200.0, 0.25, TEST_AMP_MS);
+    HRV_Break(&hrv);
+    feed(360u, t, 100.0, 0.25, TEST_AMP_MS);
+    CHECK(HRV_FreqStart(&hf) == 1u, "start after a break refused");
+    if (run(&r)) {
+        CHECK((r.span_s >= 95u) && (r.span_s <= 100u) && (r.n_segments == 2u),
+              "after a break: %u segments over %us", r.n_segments, r.span_s);
+    } else {
+        CHECK(0, "no result after a break");
+    }
+}
+
+int main(void) {
+    static const uint32_t rates[] = { 250u, 360u, 500u, 1000u };
+
+    test_start();
+    for (uint32_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        test_band(rates[i], 0.1, 1u);
+        test_band(rates[i], 0.25, 0u);
+    }
+
+    printf("test_hrv_freq: start, LF and HF tachograms: %s\n", fail ? "FAIL" : "ok");
+    return fail ? 1 : 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * test_pt_block: PT_ProcessBlock against the per-sample reference PT_Process. The
+ * block path runs the filters through CMSIS-DSP kernels with the same rounding, so the
+ * two must agree bit for bit, not within a tolerance.
+ *
+ * For each sample rate (250/360/500/1000Hz) one minute of the simulator goes through
+ * PT_Process sample by sample, and through PT_ProcessBlock in chunks of several sizes
+ * (shorter than, equal to and longer than PT_BLOCK_SIZE, and the whole minute at once),
+ * and alternating with PT_Process on one handle. Checked:
+ *  - the same beat ticks, in the same order
+ *  - out_integrated after every chunk equal to the reference at that sample
+ *  - the same tick, thresholds, levels, BPM and last beat event at the end
+ */
+#include "pan_tompkins.h"
+#include "ecg_sim.h"
+#include <stdio.h>
+#include <string.h>
+
+#define PT_TEST_SECONDS     60u
+#define PT_TEST_MAX_SAMPLES (PT_TEST_SECONDS * PT_MAX_SAMPLE_RATE_HZ)
+#define PT_TEST_MAX_BEATS   256u
+
+static uint32_t fail;
+
+#define CHECK(cond, ...) do {                                       \
+        if (!(cond)) {                                              \
+            fprintf(stderr, "test_pt_block:%d: ", __LINE__);        \
+            fprintf(stderr, __VA_ARGS__);                           \
+            fputc('\n', stderr);                                    \
+            fail++;                                                 \
+        }                                                           \
+    } while (0)
+
+static uint16_t input[PT_TEST_MAX_SAMPLES];
+static float32_t ref_integrated[PT_TEST_MAX_SAMPLES];
+static uint32_t ref_beats[PT_TEST_MAX_BEATS];
+static uint32_t blk_beats[PT_TEST_MAX_BEATS];
+static uint32_t n_ref;
+
+static PanTompkins_Handle_t ref, blk;
+
+static uint8_t same_f32(float32_t a, float32_t b) {
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+/* Per-sample reference over n samples: beats and out_integrated after every sample */
+static void run_ref(const PT_Config *cfg, uint32_t n) {
+    PT_InitConfig(&ref, cfg);
+    n_ref = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        if (PT_Process(&ref, input[i]) && (n_ref < PT_TEST_MAX_BEATS)) {
+            ref_beats[n_ref++] = ref.last_beat_tick;
+        }
+        ref_integrated[i] = ref.out_integrated;
+    }
+}
+
+/*
+ * The same input in chunks of `chunk` samples through PT_ProcessBlock; mixed: every
+ * other chunk through PT_Process instead
+ */
+static void run_block(const PT_Config *cfg, uint32_t n, uint32_t chunk, uint8_t mixed) {
+    const uint32_t fs = cfg->sample_rate_hz;
+    uint32_t n_blk = 0;
+    uint32_t bad_int = 0;
+
+    PT_InitConfig(&blk, cfg);
+    for (uint32_t i = 0, k = 0; i < n; i += chunk, k++) {
+        uint32_t m = (n - i < chunk) ? n - i : chunk;
+
+        if (mixed && (k & 1u)) {
+            for (uint32_t j = 0; j < m; j++) {
+                if (PT_Process(&blk, input[i + j]) && (n_blk < PT_TEST_MAX_BEATS)) {
+                    blk_beats[n_blk++] = blk.last_beat_tick;
+                }
+            }
+        } else {
+            n_blk += PT_ProcessBlock(&blk, &input[i], m, &blk_beats[n_blk], PT_TEST_MAX_BEATS - n_blk);
+        }
+
+        if (!same_f32(blk.out_integrated, ref_integrated[i + m - 1u]) && (bad_int++ == 0u)) {
+            CHECK(0, "%uHz, chunk %u%s: out_integrated %.9g at sample %u, reference %.9g", fs, chunk,
+                  mixed ? " mixed" : "", (double)blk.out_integrated, i + m - 1u, (double)ref_integrated[i + m - 1u]);
+        }
+    }
+
+    CHECK(n_blk == n_ref, "%uHz, chunk %u%s: %u beats, reference %u", fs, chunk, mixed ? " mixed" : "", n_blk, n_ref);
+    for (uint32_t b = 0; (b < n_blk) && (b < n_ref); b++) {
+        if (blk_beats[b] != ref_beats[b]) {
+            CHECK(0, "%uHz, chunk %u%s: beat %u at tick %u, reference %u", fs, chunk, mixed ? " mixed" : "",
+                  b, blk_beats[b], ref_beats[b]);
+            break;
+        }
+    }
+
+    CHECK((blk.current_tick == ref.current_tick) && (blk.current_bpm == ref.current_bpm) &&
+          same_f32(blk.threshold_i, ref.threshold_i) && same_f32(blk.signal_level, ref.signal_level) &&
+          same_f32(blk.noise_level, ref.noise_level) && same_f32(blk.out_y_hpf, ref.out_y_hpf) &&
+          (blk.beat_event.r_tick == ref.beat_event.r_tick) && (blk.beat_event.rr == ref.beat_event.rr),
+          "%uHz, chunk %u%s: final state differs", fs, chunk, mixed ? " mixed" : "");
+}
+
+int main(void) {
+    static const uint32_t rates[] = { 250u, 360u, 500u, 1000u };
+    static const uint32_t chunks[] = { 1u, 7u, PT_BLOCK_SIZE - 1u, PT_BLOCK_SIZE, PT_BLOCK_SIZE + 1u, 100u, 360u };
+
+    for (uint32_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        const uint32_t fs = rates[r];
+        const uint32_t n = PT_TEST_SECONDS * fs;
+        PT_Config cfg;
+
+        CHECK(PT_ConfigInit(&cfg, fs), "%uHz refused", fs);
+        ECG_Sim_Init(fs);
+        for (uint32_t i = 0; i < n; i++) input[i] = ECG_Sim_GetSample();
+
+        run_ref(&cfg, n);
+        CHECK((n_ref >= PT_TEST_SECONDS - 5u) && (n_ref <= PT_TEST_SECONDS + 1u),
+              "%uHz: %u reference beats for a 60 BPM minute", fs, n_ref);
+
+        for (uint32_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+            run_block(&cfg, n, chunks[c], 0u);
+            run_block(&cfg, n, chunks[c], 1u);
+        }
+        run_block(&cfg, n, n, 0u);
+    }
+
+    printf("test_pt_block: block path against PT_Process at 250..1000Hz: %s\n", fail ? "FAIL" : "ok");
+    return fail ? 1 : 0;
+}
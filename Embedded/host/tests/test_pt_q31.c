@@ -0,0 +1,142 @@
+/*
+ * test_pt_q31: the integer engine (PT_ProcessQ31) against the float reference
+ * (PT_Process) on a fixed input vector.
+ *
+ * The vector is generated here, independent of the C library: the simulator's beat
+ * shape (ecg_lut) stretched to an RR that sweeps 55..105 BPM over 10 minutes, with
+ * per-beat amplitude changes, 0.3Hz baseline wander, 50Hz mains and +-16 LSB noise
+ * from a fixed LCG.
+ *
+ * Beats are paired by nearest tick, so a missing or extra beat cannot shift the
+ * comparison of the ones after it. Checked:
+ *  - both engines find the same number of beats
+ *  - every pair is within PT_TEST_TICK_TOL samples, except at most PT_TEST_MAX_SPLIT
+ *    beats, which must stay within one integration window. Those are QRS whose
+ *    integrated peak has two near-equal humps, where the float running sum's rounding
+ *    and the exact integer sum pick different humps.
+ *  - the BPM after each beat is equal whenever that beat and the one before it paired
+ *    within PT_TEST_TICK_TOL (same RR), and the final BPM is equal
+ *
+ * Outside this vector the engines can also part on a tie: at sustained rates above
+ * ~140 BPM the sparsely sampled synthetic QRS lets the integer window sum repeat a
+ * value exactly, which hides a noise peak the float sum still shows, and the
+ * thresholds and one beat then differ.
+ */
+#include "pan_tompkins.h"
+#include "pan_tompkins_q31.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PT_TEST_SECONDS     600u
+#define PT_TEST_SAMPLES     (PT_TEST_SECONDS * 360u)
+#define PT_TEST_MAX_BEATS   2048u
+#define PT_TEST_TICK_TOL    1u          /* samples: 2.8ms @ 360Hz */
+#define PT_TEST_MAX_SPLIT   3u          /* beats allowed beyond PT_TEST_TICK_TOL */
+
+/* ecg_sim.c: one beat, 200 entries */
+extern const int16_t ecg_lut[200];
+
+typedef struct {
+    uint32_t tick;
+    int bpm;
+} Beat;
+
+static uint16_t input[PT_TEST_SAMPLES];
+static Beat beats_f[PT_TEST_MAX_BEATS];
+static Beat beats_q[PT_TEST_MAX_BEATS];
+
+static void make_input(void) {
+    uint32_t lcg = 12345u;
+    double phase = 0.0;
+    double amp = 1.0;
+
+    for (uint32_t i = 0; i < PT_TEST_SAMPLES; i++) {
+        double t = (double)i / 360.0;
+        double bpm = 80.0 + 25.0 * sin(2.0 * M_PI * t / 97.0);
+
+        phase += 200.0 * bpm / (60.0 * 360.0);
+        if (phase >= 200.0) {
+            phase -= 200.0;
+            amp = 0.6 + 0.1 * (double)((i / 7u) % 9u);     /* 0.6 .. 1.4 */
+        }
+        lcg = lcg * 1664525u + 1013904223u;
+        double v = 2048.0 + amp * ecg_lut[(uint32_t)phase]
+                 + 150.0 * sin(2.0 * M_PI * 0.3 * t)
+                 + 30.0 * sin(2.0 * M_PI * 50.0 * t)
+                 + (double)((int32_t)(lcg >> 27) - 16);
+        input[i] = (uint16_t)((v < 0.0) ? 0.0 : (v > 4095.0) ? 4095.0 : v);
+    }
+}
+
+static uint32_t tick_dist(uint32_t a, uint32_t b) {
+    return (a > b) ? a - b : b - a;
+}
+
+int main(void) {
+    static PanTompkins_Handle_t pf;
+    static PanTompkinsQ31_Handle_t pq;
+    uint32_t nf = 0;
+    uint32_t nq = 0;
+    uint32_t fail = 0;
+
+    make_input();
+    PT_Init(&pf);
+    PT_InitQ31(&pq);
+    for (uint32_t i = 0; i < PT_TEST_SAMPLES; i++) {
+        if (PT_Process(&pf, input[i]) && (nf < PT_TEST_MAX_BEATS)) {
+            beats_f[nf].tick = pf.last_beat_tick;
+            beats_f[nf++].bpm = PT_GetBPM(&pf);
+        }
+        if (PT_ProcessQ31(&pq, input[i]) && (nq < PT_TEST_MAX_BEATS)) {
+            beats_q[nq].tick = pq.last_beat_tick;
+            beats_q[nq++].bpm = PT_GetBPMQ31(&pq);
+        }
+    }
+
+    if ((nf != nq) || (nf == 0u)) {
+        fprintf(stderr, "test_pt_q31: beats float %u, q31 %u\n", nf, nq);
+        fail++;
+    }
+
+    /* Pair every float beat with the nearest Q31 beat (both lists are in tick order) */
+    uint32_t split = 0;
+    uint32_t exact = 0;
+    uint8_t prev_close = 0;
+    for (uint32_t i = 0, j = 0; (i < nf) && (nq != 0u); i++) {
+        while ((j + 1u < nq) &&
+               (tick_dist(beats_q[j + 1u].tick, beats_f[i].tick) < tick_dist(beats_q[j].tick, beats_f[i].tick))) {
+            j++;
+        }
+        uint32_t d = tick_dist(beats_q[j].tick, beats_f[i].tick);
+        uint8_t close = (d <= PT_TEST_TICK_TOL);
+
+        exact += (d == 0u);
+        if (!close) {
+            split++;
+            if (d >= INTEGRATION_WINDOW) {
+                fprintf(stderr, "test_pt_q31: beat %u at %u, nearest q31 beat %u ticks away\n",
+                        i, beats_f[i].tick, d);
+                fail++;
+            }
+        } else if ((i == 0u || prev_close) && (beats_f[i].bpm != beats_q[j].bpm)) {
+            fprintf(stderr, "test_pt_q31: beat %u at %u, bpm float %d, q31 %d\n",
+                    i, beats_f[i].tick, beats_f[i].bpm, beats_q[j].bpm);
+            fail++;
+        }
+        prev_close = close;
+    }
+    if (split > PT_TEST_MAX_SPLIT) {
+        fprintf(stderr, "test_pt_q31: %u beats beyond %u ticks, at most %u allowed\n",
+                split, PT_TEST_TICK_TOL, PT_TEST_MAX_SPLIT);
+        fail++;
+    }
+    if (PT_GetBPM(&pf) != PT_GetBPMQ31(&pq)) {
+        fprintf(stderr, "test_pt_q31: final bpm float %d, q31 %d\n", PT_GetBPM(&pf), PT_GetBPMQ31(&pq));
+        fail++;
+    }
+
+    printf("test_pt_q31: beats %u/%u, same tick %u, beyond %u ticks %u, bpm %d/%d: %s\n",
+           nf, nq, exact, PT_TEST_TICK_TOL, split, PT_GetBPM(&pf), PT_GetBPMQ31(&pq), fail ? "FAIL" : "ok");
+    return fail ? 1 : 0;
+}
@@ -0,0 +1,327 @@
+/*
+ * test_sched: the main-loop scheduler (sched.c) against a manual cycle counter
+ * (HOST_DWT_MANUAL): every slice advances host_dwt_cyccnt by the cycles its task is
+ * given, so releases, response times and deadline misses are exact.
+ *
+ * Checked: run order across classes and within one, ids and the full table, ready()
+ * polls, periodic releases, merging of releases into a pending job, skipping of lost
+ * periods, multi-slice jobs and their WCET, deadline misses, the slice trace, Sched_Ready,
+ * Sched_ClearStats and a cycle counter that wraps.
+ */
+#include "sched.h"
+#include <stdio.h>
+#include <string.h>
+
+uint32_t host_dwt_cyccnt;
+
+static uint32_t fail;
+
+#define CHECK(cond, ...) do {                                       \
+        if (!(cond)) {                                              \
+            fprintf(stderr, "test_sched:%d: ", __LINE__);           \
+            fprintf(stderr, __VA_ARGS__);                           \
+            fputc('\n', stderr);                                    \
+            fail++;                                                 \
+        }                                                           \
+    } while (0)
+
+/* Behaviour of the task with the same id */
+typedef struct {
+    uint8_t  ready;             /* ready() result */
+    uint32_t slices;            /* slices per job, 0 = 1 */
+    uint32_t cycles;            /* cycles each slice takes */
+    uint32_t done;              /* slices of the current job run */
+    uint32_t trace_seen;        /* *trace during the last slice */
+} TestTask;
+
+static TestTask tt[SCHED_MAX_TASKS];
+static volatile uint32_t *trace;
+
+/* Ids in the order their slices ran */
+static uint8_t ran[64];
+static uint32_t n_ran;
+
+static uint8_t test_run(uint8_t id) {
+    TestTask *c = &tt[id];
+
+    if (n_ran < sizeof(ran)) ran[n_ran++] = id;
+    c->trace_seen = (trace != NULL) ? *trace : SCHED_NONE;
+    host_dwt_cyccnt += c->cycles;
+    if (++c->done < ((c->slices != 0u) ? c->slices : 1u)) return 0;
+    c->done = 0;
+    return 1;
+}
+
+#define TEST_TASK(n)                                                \
+    static uint8_t run##n(void) { return test_run(n); }             \
+    static uint8_t ready##n(void) { return tt[n].ready; }
+
+TEST_TASK(0)
+TEST_TASK(1)
+TEST_TASK(2)
+TEST_TASK(3)
+TEST_TASK(4)
+TEST_TASK(5)
+TEST_TASK(6)
+TEST_TASK(7)
+
+static const Sched_Fn runs[SCHED_MAX_TASKS] = { run0, run1, run2, run3, run4, run5, run6, run7 };
+static const Sched_Fn readies[SCHED_MAX_TASKS] = { ready0, ready1, ready2, ready3, ready4, ready5, ready6, ready7 };
+
+static void reset(Sched_t *s, uint32_t now) {
+    Sched_Init(s);
+    memset(tt, 0, sizeof(tt));
+    n_ran = 0;
+    trace = NULL;
+    host_dwt_cyccnt = now;
+}
+
+/* Add the next task, with or without its ready() poll */
+static uint8_t add(Sched_t *s, Sched_Class cls, uint8_t poll, uint32_t period, uint32_t deadline) {
+    uint32_t id = s->n_tasks;
+    return Sched_Add(s, "t", cls, (poll && id < SCHED_MAX_TASKS) ? readies[id] : NULL,
+                     (id < SCHED_MAX_TASKS) ? runs[id] : run0, period, deadline);
+}
+
+/* Step until idle (at most max steps); the slices that ran are in ran[] */
+static void run_all(Sched_t *s, uint32_t max) {
+    n_ran = 0;
+    for (uint32_t i = 0; (i < max) && (Sched_Step(s) != SCHED_NONE); i++) {
+    }
+}
+
+static void expect_ran(const uint8_t *ids, uint32_t n, int line) {
+    uint8_t same = (n_ran == n) && (memcmp(ran, ids, n) == 0);
+
+    if (!same) {
+        fprintf(stderr, "test_sched:%d: ran", line);
+        for (uint32_t i = 0; i < n_ran; i++) fprintf(stderr, " %u", ran[i]);
+        fprintf(stderr, ", expected");
+        for (uint32_t i = 0; i < n; i++) fprintf(stderr, " %u", ids[i]);
+        fputc('\n', stderr);
+        fail++;
+    }
+}
+#define EXPECT_RAN(...) do {                                        \
+        const uint8_t ids_[] = { __VA_ARGS__ };                     \
+        expect_ran(ids_, sizeof(ids_), __LINE__);                   \
+    } while (0)
+
+static void test_order(void) {
+    static Sched_t s;
+
+    reset(&s, 0);
+    /* Ids follow the calls; the run order follows the class, then the calls */
+    CHECK(add(&s, SCHED_IDLE, 0, 0, 0) == 0u, "first id");
+    CHECK(add(&s, SCHED_SOFT, 0, 0, 0) == 1u, "second id");
+    CHECK(add(&s, SCHED_HARD, 0, 0, 0) == 2u, "third id");
+    CHECK(add(&s, SCHED_SOFT, 0, 0, 0) == 3u, "fourth id");
+    CHECK(add(&s, SCHED_HARD, 0, 0, 0) == 4u, "fifth id");
+    CHECK(add(&s, SCHED_IDLE, 0, 0, 0) == 5u, "sixth id");
+
+    CHECK(Sched_Step(&s) == SCHED_NONE, "step with nothing released");
+    CHECK(s.idle_steps == 1u, "idle_steps %u", s.idle_steps);
+    CHECK(!Sched_Ready(&s), "ready with nothing released");
+
+    for (uint8_t id = 0; id < 6u; id++) Sched_Release(&s, id);
+    CHECK(Sched_Ready(&s), "not ready with jobs released");
+    run_all(&s, 16);
+    EXPECT_RAN(2, 4, 1, 3, 0, 5);
+
+    /* A hard job released while a soft one is in its slices runs before its next slice */
+    tt[1].slices = 3;
+    Sched_Release(&s, 1);
+    n_ran = 0;
+    Sched_Step(&s);
+    Sched_Release(&s, 4);
+    Sched_Release(&s, 0);
+    Sched_Step(&s);
+    Sched_Step(&s);
+    Sched_Step(&s);
+    Sched_Step(&s);
+    EXPECT_RAN(1, 4, 1, 1, 0);
+
+    /* ready() is polled only without a pending job; idle work waits for everything else */
+    reset(&s, 0);
+    add(&s, SCHED_IDLE, 1, 0, 0);
+    add(&s, SCHED_HARD, 1, 0, 0);
+    tt[0].ready = 1;
+    tt[1].ready = 1;
+    tt[1].slices = 2;
+    n_ran = 0;
+    for (uint32_t i = 0; i < 4u; i++) Sched_Step(&s);
+    EXPECT_RAN(1, 1, 1, 1);
+    tt[1].ready = 0;
+    run_all(&s, 8);
+    EXPECT_RAN(0, 0, 0, 0, 0, 0, 0, 0);
+    tt[0].ready = 0;
+    run_all(&s, 8);
+    CHECK(n_ran == 0u, "%u slices ran with nothing ready", n_ran);
+    CHECK(Sched_Get(&s, 1)->jobs == 2u, "hard jobs %u, expected 2", Sched_Get(&s, 1)->jobs);
+    CHECK(Sched_Get(&s, 0)->jobs == 8u, "idle jobs %u, expected 8", Sched_Get(&s, 0)->jobs);
+
+    /* Full table */
+    reset(&s, 0);
+    for (uint32_t i = 0; i < SCHED_MAX_TASKS; i++) add(&s, SCHED_SOFT, 0, 0, 0);
+    CHECK(add(&s, SCHED_HARD, 0, 0, 0) == SCHED_NONE, "task added to a full table");
+    CHECK(s.n_tasks == SCHED_MAX_TASKS, "n_tasks %u", s.n_tasks);
+}
+
+static void test_periodic(uint32_t t0) {
+    static Sched_t s;
+    const Sched_Task *p;
+
+    /* Period 100 from t0 (the wrap case starts just below 2^32) */
+    reset(&s, t0);
+    uint8_t id = add(&s, SCHED_HARD, 0, 100, 0);
+    p = Sched_Get(&s, id);
+    tt[id].cycles = 10;
+
+    host_dwt_cyccnt = t0 + 99u;
+    CHECK(!Sched_Ready(&s), "t0=%u: ready before the period", t0);
+    CHECK(Sched_Step(&s) == SCHED_NONE, "t0=%u: released before the period", t0);
+    host_dwt_cyccnt = t0 + 100u;
+    CHECK(Sched_Ready(&s), "t0=%u: not ready at the period", t0);
+    CHECK(p->jobs == 0u, "t0=%u: Sched_Ready ran a job", t0);
+    CHECK(Sched_Step(&s) == id, "t0=%u: period not released", t0);
+    CHECK((p->jobs == 1u) && (p->max_response == 10u), "t0=%u: jobs %u response %u", t0, p->jobs, p->max_response);
+    CHECK(Sched_Step(&s) == SCHED_NONE, "t0=%u: released twice", t0);
+
+    /* Released at its period, not when the step came: response counts from t0 + 200 */
+    host_dwt_cyccnt = t0 + 230u;
+    Sched_Step(&s);
+    CHECK((p->jobs == 2u) && (p->max_response == 40u), "t0=%u: late step: jobs %u response %u",
+          t0, p->jobs, p->max_response);
+
+    /* A job still pending at the next period absorbs it */
+    tt[id].slices = 3;
+    tt[id].cycles = 60;
+    host_dwt_cyccnt = t0 + 300u;
+    Sched_Step(&s);                 /* 300..360 */
+    Sched_Step(&s);                 /* 360..420, period 400 due at the next step */
+    Sched_Step(&s);                 /* merges 400, 420..480: done */
+    CHECK((p->jobs == 3u) && (p->merged == 1u), "t0=%u: jobs %u merged %u", t0, p->jobs, p->merged);
+    CHECK(p->max_response == 180u, "t0=%u: response %u, expected 180", t0, p->max_response);
+    CHECK(p->wcet == 60u, "t0=%u: wcet %u, expected 60", t0, p->wcet);
+    CHECK(Sched_Step(&s) == SCHED_NONE, "t0=%u: merged period ran again", t0);
+
+    /* Lost periods are skipped: 10 periods late runs once, the next release is a period on */
+    tt[id].slices = 1;
+    tt[id].cycles = 10;
+    host_dwt_cyccnt = t0 + 1550u;
+    run_all(&s, 8);
+    EXPECT_RAN(id);
+    CHECK(p->jobs == 4u, "t0=%u: jobs %u after a stall, expected 4", t0, p->jobs);
+    host_dwt_cyccnt = t0 + 1649u;
+    CHECK(Sched_Step(&s) == SCHED_NONE, "t0=%u: released early after a stall", t0);
+    host_dwt_cyccnt = t0 + 1650u;
+    CHECK(Sched_Step(&s) == id, "t0=%u: not released a period after the stall", t0);
+
+    /* A new period counts from the change */
+    Sched_SetTiming(&s, id, 500, 0);
+    host_dwt_cyccnt = t0 + 2159u;
+    CHECK(Sched_Step(&s) == SCHED_NONE, "t0=%u: released before the new period", t0);
+    host_dwt_cyccnt = t0 + 2160u;
+    CHECK(Sched_Step(&s) == id, "t0=%u: not released at the new period", t0);
+
+    /* Sched_Release merges into a pending job too */
+    Sched_Release(&s, id);
+    Sched_Release(&s, id);
+    run_all(&s, 8);
+    EXPECT_RAN(id);
+    CHECK(p->merged == 2u, "t0=%u: merged %u, expected 2", t0, p->merged);
+}
+
+static void test_misses(void) {
+    static Sched_t s;
+    const Sched_Task *p;
+
+    reset(&s, 1000);
+    uint8_t id = add(&s, SCHED_SOFT, 0, 0, 25);
+    uint8_t hog = add(&s, SCHED_HARD, 0, 0, 0);
+    p = Sched_Get(&s, id);
+
+    /* Response 20 and exactly the deadline: no miss */
+    tt[id].cycles = 20;
+    Sched_Release(&s, id);
+    run_all(&s, 4);
+    tt[id].cycles = 25;
+    Sched_Release(&s, id);
+    run_all(&s, 4);
+    CHECK((p->jobs == 2u) && (p->misses == 0u), "jobs %u misses %u, expected 2/0", p->jobs, p->misses);
+
+    /* One past it, in one slice or over several */
+    tt[id].cycles = 26;
+    Sched_Release(&s, id);
+    run_all(&s, 4);
+    tt[id].cycles = 10;
+    tt[id].slices = 3;
+    Sched_Release(&s, id);
+    run_all(&s, 8);
+    CHECK((p->jobs == 4u) && (p->misses == 2u), "jobs %u misses %u, expected 4/2", p->jobs, p->misses);
+    CHECK((p->wcet == 26u) && (p->max_response == 30u), "wcet %u response %u", p->wcet, p->max_response);
+
+    /* Waiting behind a higher class counts: release, then a 20-cycle hard job runs first */
+    tt[id].slices = 1;
+    tt[id].cycles = 10;
+    tt[hog].cycles = 20;
+    Sched_Release(&s, id);
+    Sched_Release(&s, hog);
+    run_all(&s, 4);
+    EXPECT_RAN(hog, id);
+    CHECK(p->misses == 3u, "misses %u after waiting, expected 3", p->misses);
+
+    /* No deadline: never a miss */
+    CHECK(Sched_Get(&s, hog)->misses == 0u, "miss without a deadline");
+
+    Sched_ClearStats(&s);
+    CHECK((p->jobs == 0u) && (p->misses == 0u) && (p->merged == 0u) && (p->wcet == 0u) &&
+          (p->max_response == 0u) && (s.idle_steps == 0u), "statistics not cleared");
+    CHECK(p->deadline == 25u, "ClearStats changed the deadline");
+}
+
+static void test_trace(void) {
+    static Sched_t s;
+    static volatile uint32_t word;
+
+    reset(&s, 0);
+    add(&s, SCHED_SOFT, 0, 0, 0);
+    add(&s, SCHED_HARD, 0, 0, 0);
+
+    word = 0x1234u;
+    trace = &word;
+    Sched_SetTrace(&s, &word);
+    CHECK(word == SCHED_NONE, "trace %#x after Sched_SetTrace", word);
+
+    tt[0].slices = 2;
+    Sched_Release(&s, 0);
+    Sched_Release(&s, 1);
+    CHECK(Sched_Step(&s) == 1u, "hard task did not run first");
+    CHECK(tt[1].trace_seen == 1u, "trace %#x during task 1", tt[1].trace_seen);
+    CHECK(word == SCHED_NONE, "trace %#x after a slice", word);
+    Sched_Step(&s);
+    CHECK(tt[0].trace_seen == 0u, "trace %#x during task 0", tt[0].trace_seen);
+    CHECK(word == SCHED_NONE, "trace %#x between the slices of a job", word);
+    Sched_Step(&s);
+    CHECK(word == SCHED_NONE, "trace %#x after the job", word);
+    Sched_Step(&s);
+    CHECK(word == SCHED_NONE, "trace %#x after an idle step", word);
+
+    /* Off: the word is left alone */
+    Sched_SetTrace(&s, NULL);
+    word = 0x5678u;
+    Sched_Release(&s, 1);
+    Sched_Step(&s);
+    CHECK(word == 0x5678u, "trace written while off");
+}
+
+int main(void) {
+    test_order();
+    test_periodic(0);
+    test_periodic(0xFFFFFF00u);
+    test_misses();
+    test_trace();
+
+    printf("test_sched: order, periods, merging, slices, misses, trace: %s\n", fail ? "FAIL" : "ok");
+    return fail ? 1 : 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * ecg_proto_dump: decode a capture of the binary HC-05 stream (HC05_STREAM_BINARY).
+ *
+ *   ecg_proto_dump [-b beats.txt] <capture.bin | ->   decode to "ECG_VALUE,BPM" lines on stdout
+ *   ecg_proto_dump -g <seconds> [-z] > capture.bin    encode the simulator like the firmware
+ *                                                     (-z: RICE frames, HC05_STREAM_BINARY 2)
+ *
+ * The decoded lines are the text stream's CSV, so pt_replay reads them directly
+ * (pt_replay -l beats.txt capture.csv). Samples of lost frames are filled by holding the
+ * last value, so line numbers stay equal to ticks and beat indices stay aligned.
+ * Frame, loss and CRC statistics, the link bytes per sample and TEXT records (command
+ * acknowledgements) go to stderr.
+ */
+extern "C" {
+#include "ecg_proto.h"
+#include "ecg_sim.h"
+#include "pan_tompkins.h"
+}
+
+#include "ecg_proto_decoder.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+namespace {
+
+/* Simulator through PT_Process and the firmware encoder, framed as main.c does */
+int generate(uint32_t seconds, bool rice) {
+    PanTompkins_Handle_t pt;
+    ECG_Proto_t proto;
+    const uint32_t frame_samples = rice ? ECG_RICE_BLOCK : ECG_PROTO_SAMPLES;
+    uint16_t frame[ECG_RICE_BLOCK];
+    uint32_t frame_len = 0;
+    uint32_t frame_tick = 0;
+    uint32_t prev_r_tick = 0;
+    uint8_t out[ECG_PROTO_MAX_FRAME];
+
+    PT_Init(&pt);
+    ECG_Sim_Init(360u);
+    ECG_Proto_Init(&proto);
+
+    for (uint32_t i = 0; i < seconds * 360u; i++) {
+        uint16_t x = ECG_Sim_GetSample();
+        uint8_t is_beat = PT_Process(&pt, x);
+        int bpm = PT_GetBPM(&pt);
+
+        if (frame_len == 0u) frame_tick = pt.current_tick;
+        frame[frame_len++] = x;
+        if (frame_len == frame_samples) {
+            uint32_t len = rice ? ECG_Proto_Rice(&proto, out, frame_tick, frame, frame_len, bpm)
+                                : ECG_Proto_Samples(&proto, out, frame_tick, frame, frame_len, bpm);
+            fwrite(out, 1, len, stdout);
+            frame_len = 0;
+        }
+        if (is_beat) {
+            uint32_t r_tick = pt.beat_event.r_tick;
+            uint32_t rr = (prev_r_tick != 0u) ? r_tick - prev_r_tick : 0u;
+            prev_r_tick = r_tick;
+            fwrite(out, 1, ECG_Proto_Beat(&proto, out, r_tick, rr, bpm), stdout);
+        }
+    }
+    return 0;
+}
+
+int usage() {
+    std::fprintf(stderr, "usage: ecg_proto_dump [-b beats.txt] <capture.bin | ->\n"
+                         "       ecg_proto_dump -g <seconds> [-z] > capture.bin\n");
+    return 2;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    const char *beats_path = nullptr;
+    uint32_t gen_seconds = 0;
+    bool rice = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:g:z")) != -1) {
+        switch (opt) {
+        case 'b': beats_path = optarg; break;
+        case 'g': gen_seconds = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10)); break;
+        case 'z': rice = true; break;
+        default:  return usage();
+        }
+    }
+    if (gen_seconds > 0) return generate(gen_seconds, rice);
+    if (optind != argc - 1) return usage();
+
+    FILE *in = (std::strcmp(argv[optind], "-") == 0) ? stdin : std::fopen(argv[optind], "rb");
+    if (in == nullptr) {
+        std::fprintf(stderr, "ecg_proto_dump: cannot open %s\n", argv[optind]);
+        return 1;
+    }
+    FILE *beats = nullptr;
+    if (beats_path != nullptr && (beats = std::fopen(beats_path, "w")) == nullptr) {
+        std::fprintf(stderr, "ecg_proto_dump: cannot write %s\n", beats_path);
+        return 1;
+    }
+
+    /* Ticks are relative to the first sample; gaps are held at the last value */
+    bool started = false;
+    uint32_t first_tick = 0;
+    uint32_t next_tick = 0;
+    uint16_t last = 2048;
+    uint64_t filled = 0;
+    uint64_t leads_off = 0;
+
+    ecg_proto::Decoder dec(
+        [&](const ecg_proto::Samples &s) {
+            if (s.values.empty()) {
+                leads_off++;
+                return;
+            }
+            if (!started) {
+                started = true;
+                first_tick = next_tick = s.tick;
+            }
+            for (; static_cast<int32_t>(s.tick - next_tick) > 0; next_tick++, filled++) {
+                std::printf("%u,%u\n", (unsigned)last, (unsigned)s.bpm);
+            }
+            for (std::size_t i = 0; i < s.values.size(); i++) {
+                /* Ticks already written (a repeated or overlapping frame) are skipped */
+                if (static_cast<int32_t>(s.tick + i - next_tick) < 0) continue;
+                std::printf("%u,%u\n", (unsigned)s.values[i], (unsigned)s.bpm);
+                last = s.values[i];
+                next_tick++;
+            }
+        },
+        [&](const ecg_proto::Beat &b) {
+            if (beats != nullptr && started) std::fprintf(beats, "%u\n", b.r_tick - first_tick);
+        },
+        [&](const ecg_proto::Text &t) { std::fprintf(stderr, "%s\n", t.record.c_str()); });
+
+    uint8_t buf[4096];
+    std::size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), in)) > 0) {
+        dec.feed(buf, n);
+    }
+    if (in != stdin) std::fclose(in);
+    if (beats != nullptr) std::fclose(beats);
+
+    const ecg_proto::Stats &st = dec.stats();
+    std::fprintf(stderr, "frames %llu, samples %llu, lost frames %llu, crc errors %llu, bad frames %llu\n",
+                 (unsigned long long)st.frames, (unsigned long long)st.samples,
+                 (unsigned long long)st.lost_frames, (unsigned long long)st.crc_errors,
+                 (unsigned long long)st.bad_frames);
+    std::fprintf(stderr, "leads-off frames %llu, samples filled %llu, link bytes/sample %.2f\n",
+                 (unsigned long long)leads_off, (unsigned long long)filled,
+                 st.samples ? (double)st.bytes / (double)st.samples : 0.0);
+    return 0;
+}
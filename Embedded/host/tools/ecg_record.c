@@ -0,0 +1,327 @@
+#include "ecg_record.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WFDB_MAX_SIGNALS   32u
+#define WFDB_LINE_LEN      512u
+#define WFDB_DEFAULT_GAIN  200.0f   /* adu/mV when the header gives none */
+
+/* MIT annotation codes (ecgcodes.h) */
+#define ANN_SKIP  59u
+#define ANN_NUM   60u
+#define ANN_SUB   61u
+#define ANN_CHN   62u
+#define ANN_AUX   63u
+
+typedef struct {
+    char    file[WFDB_LINE_LEN];
+    int     format;
+    float   gain;
+    int32_t baseline;
+} WFDB_Signal;
+
+/* Beat annotation codes counted by WFDB isqrs() */
+static int ann_is_qrs(uint32_t code) {
+    switch (code) {
+    case 1: case 2: case 3: case 4: case 5: case 6: case 7: case 8: case 9: case 10:
+    case 11: case 12: case 13: case 25: case 30: case 34: case 35: case 37: case 38: case 41:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static uint16_t adc_from_adu(int32_t adu, int32_t baseline, float gain, float counts_per_mv) {
+    float v = 2048.0f + (float)(adu - baseline) * counts_per_mv / gain;
+
+    if (v < 0.0f)    v = 0.0f;
+    if (v > 4095.0f) v = 4095.0f;
+    return (uint16_t)(v + 0.5f);
+}
+
+/* Next non-comment line of a header file, newline stripped */
+static char *wfdb_next_line(FILE *f, char *line) {
+    while (fgets(line, WFDB_LINE_LEN, f) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if ((line[0] != '#') && (line[strspn(line, " \t")] != '\0')) return line;
+    }
+    return NULL;
+}
+
+static int wfdb_parse_signal(const char *line, WFDB_Signal *sig) {
+    char gain_field[64] = "";
+    int32_t adcres = 0;
+    int32_t adczero = 0;
+    int fields = sscanf(line, "%511s %d %63s %d %d", sig->file, &sig->format, gain_field, &adcres, &adczero);
+
+    if (fields < 2) return -1;
+
+    /* gain[(baseline)][/units]; baseline defaults to adczero */
+    char *end = gain_field;
+    sig->gain = (fields >= 3) ? strtof(gain_field, &end) : 0.0f;
+    if (sig->gain == 0.0f) sig->gain = WFDB_DEFAULT_GAIN;
+    sig->baseline = (fields >= 5) ? adczero : 0;
+    if (*end == '(') sig->baseline = (int32_t)strtol(end + 1, NULL, 10);
+
+    return 0;
+}
+
+/* Decode n values of the interleaved stream in `path` (format 16, 80 or 212) */
+static int32_t *wfdb_read_samples(const char *path, int format, uint32_t n) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "ecg_record: cannot open %s\n", path);
+        return NULL;
+    }
+
+    int32_t *v = malloc((size_t)n * sizeof(*v));
+    uint32_t got = 0;
+
+    if (v != NULL) {
+        if (format == 16) {
+            uint8_t b[2];
+            while ((got < n) && (fread(b, 1, 2, f) == 2)) {
+                v[got++] = (int16_t)(b[0] | (b[1] << 8));
+            }
+        } else if (format == 80) {
+            int c;
+            while ((got < n) && ((c = fgetc(f)) != EOF)) {
+                v[got++] = c - 128;
+            }
+        } else {
+            /* 212: two 12-bit samples in three bytes, second sample's high nibble in b[1] bits 7..4 */
+            uint8_t b[3];
+            while ((got < n) && (fread(b, 1, 3, f) == 3)) {
+                int32_t s0 = b[0] | ((b[1] & 0x0F) << 8);
+                int32_t s1 = b[2] | ((b[1] & 0xF0) << 4);
+                v[got++] = (s0 > 2047) ? (s0 - 4096) : s0;
+                if (got < n) v[got++] = (s1 > 2047) ? (s1 - 4096) : s1;
+            }
+        }
+    }
+    fclose(f);
+
+    if ((v != NULL) && (got < n)) {
+        fprintf(stderr, "ecg_record: %s ends after %u of %u values\n", path, got, n);
+        free(v);
+        return NULL;
+    }
+    return v;
+}
+
+int ECG_RecordLoadWFDB(ECG_Record *rec, const char *record, uint32_t channel, float counts_per_mv) {
+    char path[WFDB_LINE_LEN];
+    char line[WFDB_LINE_LEN];
+    char name[WFDB_LINE_LEN];
+    WFDB_Signal sigs[WFDB_MAX_SIGNALS];
+    uint32_t nsig = 0;
+    float fs = 0.0f;
+    long n_samples = 0;
+
+    memset(rec, 0, sizeof(*rec));
+
+    snprintf(path, sizeof(path), "%s.hea", record);
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        fprintf(stderr, "ecg_record: cannot open %s\n", path);
+        return -1;
+    }
+
+    /* Record line: name nsig [fs[/counter][(base)] [nsamples ...]] */
+    if ((wfdb_next_line(f, line) == NULL) ||
+        (sscanf(line, "%511s %u %f %ld", name, &nsig, &fs, &n_samples) < 2)) {
+        fprintf(stderr, "ecg_record: bad record line in %s\n", path);
+        fclose(f);
+        return -1;
+    }
+    if ((nsig == 0u) || (nsig > WFDB_MAX_SIGNALS) || (channel >= nsig) || (n_samples <= 0)) {
+        fprintf(stderr, "ecg_record: %s has %u signals / %ld samples, channel %u not usable\n",
+                path, nsig, n_samples, channel);
+        fclose(f);
+        return -1;
+    }
+    if (fs <= 0.0f) fs = 250.0f;   /* WFDB default */
+
+    for (uint32_t i = 0; i < nsig; i++) {
+        if ((wfdb_next_line(f, line) == NULL) || (wfdb_parse_signal(line, &sigs[i]) != 0)) {
+            fprintf(stderr, "ecg_record: bad signal line %u in %s\n", i, path);
+            fclose(f);
+            return -1;
+        }
+    }
+    fclose(f);
+
+    /* Signals stored in the same file are interleaved, in header order */
+    const WFDB_Signal *sig = &sigs[channel];
+    uint32_t group_n = 0;
+    uint32_t group_pos = 0;
+    for (uint32_t i = 0; i < nsig; i++) {
+        if (strcmp(sigs[i].file, sig->file) != 0) continue;
+        if (sigs[i].format != sig->format) {
+            fprintf(stderr, "ecg_record: mixed formats in %s are not supported\n", sig->file);
+            return -1;
+        }
+        if (i == channel) group_pos = group_n;
+        group_n++;
+    }
+    if ((sig->format != 16) && (sig->format != 80) && (sig->format != 212)) {
+        fprintf(stderr, "ecg_record: signal format %d is not supported (16, 80, 212)\n", sig->format);
+        return -1;
+    }
+
+    /* Signal file name is relative to the header's directory */
+    const char *slash = strrchr(record, '/');
+    int dir_len = (slash != NULL) ? (int)(slash - record + 1) : 0;
+    snprintf(path, sizeof(path), "%.*s%s", dir_len, record, sig->file);
+
+    int32_t *raw = wfdb_read_samples(path, sig->format, (uint32_t)n_samples * group_n);
+    if (raw == NULL) return -1;
+
+    rec->fs_hz = (uint32_t)(fs + 0.5f);
+    rec->n_samples = (uint32_t)n_samples;
+    rec->adc = malloc((size_t)rec->n_samples * sizeof(*rec->adc));
+    if (rec->adc == NULL) {
+        free(raw);
+        return -1;
+    }
+    for (uint32_t i = 0; i < rec->n_samples; i++) {
+        rec->adc[i] = adc_from_adu(raw[i * group_n + group_pos], sig->baseline, sig->gain, counts_per_mv);
+    }
+    free(raw);
+
+    return 0;
+}
+
+int ECG_RecordLoadCSV(ECG_Record *rec, const char *path, uint32_t fs_hz) {
+    char line[WFDB_LINE_LEN];
+    uint32_t cap = 65536u;
+
+    memset(rec, 0, sizeof(*rec));
+
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        fprintf(stderr, "ecg_record: cannot open %s\n", path);
+        return -1;
+    }
+
+    rec->fs_hz = fs_hz;
+    rec->adc = malloc(cap * sizeof(*rec->adc));
+    rec->device_bpm = malloc(cap * sizeof(*rec->device_bpm));
+
+    while ((rec->adc != NULL) && (rec->device_bpm != NULL) && (fgets(line, sizeof(line), f) != NULL)) {
+        int ecg = 0;
+        int bpm = 0;
+
+        /* Header or partial lines (e.g. a capture cut mid-line) are skipped */
+        if (sscanf(line, "%d,%d", &ecg, &bpm) != 2) continue;
+
+        if (rec->n_samples == cap) {
+            cap *= 2u;
+            uint16_t *adc = realloc(rec->adc, cap * sizeof(*rec->adc));
+            int16_t  *dev = realloc(rec->device_bpm, cap * sizeof(*rec->device_bpm));
+            if (adc != NULL) rec->adc = adc;
+            if (dev != NULL) rec->device_bpm = dev;
+            if ((adc == NULL) || (dev == NULL)) break;
+        }
+        rec->adc[rec->n_samples] = (uint16_t)((ecg < 0) ? 0 : ((ecg > 4095) ? 4095 : ecg));
+        rec->device_bpm[rec->n_samples] = (int16_t)bpm;
+        rec->n_samples++;
+    }
+    fclose(f);
+
+    if ((rec->adc == NULL) || (rec->device_bpm == NULL) || (rec->n_samples == 0u)) {
+        fprintf(stderr, "ecg_record: no ECG_VALUE,BPM samples in %s\n", path);
+        ECG_RecordFree(rec);
+        return -1;
+    }
+    return 0;
+}
+
+static int ref_push(ECG_Record *rec, uint32_t *cap, uint32_t sample) {
+    if (rec->n_ref == *cap) {
+        *cap = (*cap == 0u) ? 4096u : (*cap * 2u);
+        uint32_t *p = realloc(rec->ref_beats, *cap * sizeof(*p));
+        if (p == NULL) return -1;
+        rec->ref_beats = p;
+    }
+    rec->ref_beats[rec->n_ref++] = sample;
+    return 0;
+}
+
+int ECG_RecordLoadAnnotations(ECG_Record *rec, const char *path) {
+    uint32_t cap = 0;
+    int64_t t = 0;
+    uint8_t b[4];
+
+    free(rec->ref_beats);
+    rec->ref_beats = NULL;
+    rec->n_ref = 0;
+
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "ecg_record: cannot open %s\n", path);
+        return -1;
+    }
+
+    /* 16-bit little-endian words: code in bits 15..10, time increment (or length) in 9..0 */
+    while (fread(b, 1, 2, f) == 2) {
+        uint32_t word = (uint32_t)b[0] | ((uint32_t)b[1] << 8);
+        uint32_t code = word >> 10;
+        uint32_t data = word & 0x3FFu;
+
+        if ((code == 0u) && (data == 0u)) break;
+
+        if (code == ANN_SKIP) {
+            /* 32-bit interval follows, high word first */
+            if (fread(b, 1, 4, f) != 4) break;
+            t += (int32_t)(((uint32_t)b[0] << 16) | ((uint32_t)b[1] << 24) | b[2] | ((uint32_t)b[3] << 8));
+        } else if (code == ANN_AUX) {
+            fseek(f, (long)((data + 1u) & ~1u), SEEK_CUR);
+        } else if ((code == ANN_NUM) || (code == ANN_SUB) || (code == ANN_CHN)) {
+            /* modifiers of the previous annotation */
+        } else {
+            t += data;
+            if (ann_is_qrs(code) && (t >= 0) && (ref_push(rec, &cap, (uint32_t)t) != 0)) break;
+        }
+    }
+    fclose(f);
+
+    if (rec->n_ref == 0u) {
+        fprintf(stderr, "ecg_record: no beat annotations in %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+int ECG_RecordLoadBeatList(ECG_Record *rec, const char *path) {
+    uint32_t cap = 0;
+    unsigned long sample;
+
+    free(rec->ref_beats);
+    rec->ref_beats = NULL;
+    rec->n_ref = 0;
+
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        fprintf(stderr, "ecg_record: cannot open %s\n", path);
+        return -1;
+    }
+    while (fscanf(f, "%lu", &sample) == 1) {
+        if (ref_push(rec, &cap, (uint32_t)sample) != 0) break;
+    }
+    fclose(f);
+
+    if (rec->n_ref == 0u) {
+        fprintf(stderr, "ecg_record: no beat indices in %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+void ECG_RecordFree(ECG_Record *rec) {
+    free(rec->adc);
+    free(rec->device_bpm);
+    free(rec->ref_beats);
+    memset(rec, 0, sizeof(*rec));
+}
@@ -0,0 +1,45 @@
+#ifndef ECG_RECORD_H
+#define ECG_RECORD_H
+
+#include <stdint.h>
+
+/*
+ * Recorded ECG input for the host tools, converted to what PT_Process expects:
+ * 12-bit ADC samples centred on 2048 (AD8232 on the STM32 ADC).
+ *
+ * Supported inputs:
+ *  - WFDB records: <record>.hea header plus signal file in format 16, 80 or 212
+ *  - CSV streams:  one "ECG_VALUE,BPM" line per sample, as sent over HC-05
+ *  - Reference beats: MIT-format annotation files (.atr) or a text file with one
+ *    sample index per line
+ * All loaders return 0 on success, -1 after printing the reason to stderr.
+ */
+
+/* AD8232 (gain 1100) into a 3.3V 12-bit ADC: 1.1V per mV -> 1365 counts */
+#define ECG_RECORD_COUNTS_PER_MV  1365.0f
+
+typedef struct {
+    uint32_t  fs_hz;
+    uint32_t  n_samples;
+    uint16_t *adc;              /* n_samples 12-bit samples */
+    int16_t  *device_bpm;       /* CSV only: BPM column as streamed by the firmware, else NULL */
+
+    uint32_t  n_ref;
+    uint32_t *ref_beats;        /* reference beat sample indices (ascending), NULL if none */
+} ECG_Record;
+
+/* Load signal `channel` of a WFDB record (path without extension), scaled by counts_per_mv */
+int ECG_RecordLoadWFDB(ECG_Record *rec, const char *record, uint32_t channel, float counts_per_mv);
+
+/* Load an "ECG_VALUE,BPM" CSV stream recorded at fs_hz */
+int ECG_RecordLoadCSV(ECG_Record *rec, const char *path, uint32_t fs_hz);
+
+/* Load reference beats (QRS annotation codes only) from an MIT-format annotation file */
+int ECG_RecordLoadAnnotations(ECG_Record *rec, const char *path);
+
+/* Load reference beats from a text file, one sample index per line */
+int ECG_RecordLoadBeatList(ECG_Record *rec, const char *path);
+
+void ECG_RecordFree(ECG_Record *rec);
+
+#endif /* ECG_RECORD_H */
@@ -0,0 +1,147 @@
+/*
+ * ecg_rice_bench: compression ratio and cost of the ecg_rice codec on a recording.
+ *
+ *   ecg_rice_bench [options] <record | file.csv>
+ *
+ * Encodes the record in blocks as the firmware does (HC05_STREAM_BINARY 2), decodes
+ * every block and checks it is lossless, and reports bits/sample, encode and decode
+ * cycles/sample (DWT->CYCCNT, TSC on x86 hosts) and what each stream format costs on
+ * the HC-05 link: text lines, 12-bit SAMPLES frames and RICE frames, all with their
+ * framing, as samples/s that fit in 115200 baud.
+ *
+ * -s runs the firmware's ECG simulator: +-20 LSB of noise and 30 LSB of 50Hz mains.
+ * The cycles here are the host's; RICE_BENCHMARK in main.c measures them on the target.
+ */
+#define _GNU_SOURCE
+#include "ecg_proto.h"
+#include "ecg_rice.h"
+#include "ecg_sim.h"
+#include "ecg_record.h"
+#include "stm32f4xx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* 115200 baud 8N1 */
+#define BENCH_LINK_BYTES_S  11520.0
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [options] <record | file.csv>\n"
+            "  -b n       samples per block, 2..%u (default %u)\n"
+            "  -c n       WFDB signal (default 0)\n"
+            "  -r hz      sample rate of a CSV stream (default 360)\n"
+            "  -s sec     use the built-in ECG simulator instead of a record\n"
+            "  -g counts  ADC counts per mV for WFDB signals (default %.0f)\n",
+            prog, ECG_RICE_BLOCK, ECG_RICE_BLOCK, (double)ECG_RECORD_COUNTS_PER_MV);
+}
+
+static int ends_with(const char *s, const char *suffix) {
+    size_t ls = strlen(s);
+    size_t lx = strlen(suffix);
+    return (ls >= lx) && (strcmp(s + ls - lx, suffix) == 0);
+}
+
+int main(int argc, char **argv) {
+    uint32_t block = ECG_RICE_BLOCK;
+    uint32_t channel = 0;
+    uint32_t csv_fs_hz = 360u;
+    uint32_t sim_seconds = 0;
+    float counts_per_mv = ECG_RECORD_COUNTS_PER_MV;
+    ECG_Record rec;
+    int c;
+
+    while ((c = getopt(argc, argv, "b:c:r:s:g:h")) != -1) {
+        switch (c) {
+        case 'b': block         = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'c': channel       = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'r': csv_fs_hz     = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 's': sim_seconds   = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'g': counts_per_mv = strtof(optarg, NULL); break;
+        default:  usage(argv[0]); return 2;
+        }
+    }
+    if ((block < 2u) || (block > ECG_RICE_BLOCK)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    /* Input */
+    if (sim_seconds > 0u) {
+        memset(&rec, 0, sizeof(rec));
+        rec.fs_hz = 360u;
+        rec.n_samples = sim_seconds * rec.fs_hz;
+        rec.adc = malloc((size_t)rec.n_samples * sizeof(*rec.adc));
+        if (rec.adc == NULL) return 1;
+        ECG_Sim_Init(rec.fs_hz);
+        for (uint32_t i = 0; i < rec.n_samples; i++) rec.adc[i] = ECG_Sim_GetSample();
+        printf("input       simulator, %u s\n", sim_seconds);
+    } else if (optind < argc) {
+        const char *path = argv[optind];
+        if (ends_with(path, ".csv")) {
+            if (ECG_RecordLoadCSV(&rec, path, csv_fs_hz) != 0) return 1;
+        } else {
+            if (ECG_RecordLoadWFDB(&rec, path, channel, counts_per_mv) != 0) return 1;
+        }
+        printf("input       %s\n", path);
+    } else {
+        usage(argv[0]);
+        return 2;
+    }
+
+    uint8_t coded[ECG_RICE_MAX_BYTES(ECG_RICE_BLOCK)];
+    uint8_t frame[ECG_PROTO_MAX_FRAME];
+    uint16_t dec[ECG_RICE_BLOCK];
+    char line[32];
+    ECG_Proto_t proto;
+    uint64_t code_bytes = 0, rice_link = 0, packed_link = 0, text_link = 0;
+    uint64_t enc_cycles = 0, dec_cycles = 0;
+    uint32_t mismatches = 0, blocks = 0;
+
+    ECG_Proto_Init(&proto);
+    for (uint32_t i = 0; i < rec.n_samples; i += block) {
+        uint32_t n = rec.n_samples - i;
+        if (n > block) n = block;
+        const uint16_t *x = &rec.adc[i];
+
+        uint32_t t0 = DWT->CYCCNT;
+        uint32_t len = ECG_Rice_Encode(x, n, coded);
+        uint32_t t1 = DWT->CYCCNT;
+        uint32_t used = ECG_Rice_Decode(coded, len, dec, n);
+        uint32_t t2 = DWT->CYCCNT;
+        enc_cycles += t1 - t0;
+        dec_cycles += t2 - t1;
+
+        if ((used != len) || (memcmp(dec, x, n * sizeof(*x)) != 0)) mismatches++;
+        code_bytes += len;
+        blocks++;
+
+        /* Link cost with framing: one RICE frame, or ceil(n / 24) SAMPLES frames, or text */
+        rice_link += ECG_Proto_Rice(&proto, frame, i, x, n, 75);
+        for (uint32_t j = 0; j < n; j += ECG_PROTO_SAMPLES) {
+            uint32_t m = (n - j < ECG_PROTO_SAMPLES) ? n - j : ECG_PROTO_SAMPLES;
+            packed_link += ECG_Proto_Samples(&proto, frame, i + j, &x[j], m, 75);
+        }
+        for (uint32_t j = 0; j < n; j++) {
+            text_link += (uint64_t)snprintf(line, sizeof(line), "%u,%d\r\n", x[j], 75);
+        }
+    }
+
+    double ns = (double)rec.n_samples;
+    printf("samples     %u in %u blocks of %u, %s\n", rec.n_samples, blocks, block,
+           mismatches ? "LOSSY" : "lossless");
+    printf("rice        %.2f bits/sample, %.2fx vs 12-bit packing\n",
+           8.0 * (double)code_bytes / ns, 12.0 * ns / (8.0 * (double)code_bytes));
+    printf("cycles      encode %.1f/sample, decode %.1f/sample\n",
+           (double)enc_cycles / ns, (double)dec_cycles / ns);
+    printf("link        bytes/sample   samples/s @ 115200\n");
+    printf("  text      %8.2f       %8.0f\n", (double)text_link / ns, BENCH_LINK_BYTES_S * ns / (double)text_link);
+    printf("  samples   %8.2f       %8.0f\n", (double)packed_link / ns, BENCH_LINK_BYTES_S * ns / (double)packed_link);
+    printf("  rice      %8.2f       %8.0f   (%.2fx samples, %.2fx text)\n", (double)rice_link / ns,
+           BENCH_LINK_BYTES_S * ns / (double)rice_link,
+           (double)packed_link / (double)rice_link, (double)text_link / (double)rice_link);
+
+    ECG_RecordFree(&rec);
+    return mismatches ? 1 : 0;
+}
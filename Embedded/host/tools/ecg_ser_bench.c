@@ -0,0 +1,191 @@
+/*
+ * ecg_ser_bench: cost of the ecg_ser.h record serializer against sprintf.
+ *
+ *   ecg_ser_bench [-n records]
+ *
+ * Formats the firmware's three hottest text records from simulator samples, n times
+ * each (default 1000000): the text stream line "ECG_VALUE,BPM", a 4-signal USART2 log
+ * line and a "B" beat record. The sprintf path formats into a buffer and copies it into
+ * a 1 KB ring (the old HC05_Write path); the ecg_ser path writes straight into the ring.
+ * Reports cycles per record (DWT->CYCCNT, TSC on x86 hosts; both include one read of
+ * the counter) and checks that both produce the same bytes. A second pass checks the
+ * conversions on edge values (0, limits, every power of ten, zero padding, fixed
+ * point) against sprintf.
+ * SER_BENCHMARK in main.c runs the same records on the target.
+ */
+#define _GNU_SOURCE
+#include "ecg_ser.h"
+#include "ecg_sim.h"
+#include "stm32f4xx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define BENCH_KINDS 3u
+#define BENCH_RING  1024u
+
+static uint8_t ring_printf[BENCH_RING];
+static uint8_t ring_ser[BENCH_RING];
+
+static const char *const bench_kind[BENCH_KINDS] = { "sample", "log", "beat" };
+
+/* Record kind k with sprintf, as Ser_BenchPrintf in main.c */
+static uint32_t bench_printf(uint32_t k, char *out, int32_t x, int32_t i) {
+    switch (k) {
+    case 0:  return (uint32_t)sprintf(out, "%d,%d\r\n", (int)x, 72);
+    case 1:  return (uint32_t)sprintf(out, "%ld,%ld,%ld,%ld\r\n", (long)(x - 2048), (long)(x * 3),
+                                      (long)(-i * 37), (long)(i * 1001));
+    default: return (uint32_t)sprintf(out, "B,%lu,%lu,%ld,%ld,%ld,%d\r\n", (unsigned long)(uint32_t)(i * 300),
+                                      300ul, (long)x, (long)(x * 40), (long)(x * 9), 72);
+    }
+}
+
+/* The same record with ecg_ser.h, as Ser_BenchSer in main.c */
+static void bench_ser(uint32_t k, ECG_Ser_t *w, int32_t x, int32_t i) {
+    switch (k) {
+    case 0:
+        ECG_Ser_DecS(w, x);
+        ECG_Ser_FieldS(w, 72, 2u);
+        break;
+    case 1:
+        ECG_Ser_DecS(w, x - 2048);
+        ECG_Ser_FieldS(w, x * 3, 4u);
+        ECG_Ser_FieldS(w, -i * 37, 4u);
+        ECG_Ser_FieldS(w, i * 1001, 4u);
+        break;
+    default:
+        ECG_Ser_Tag(w, 'B');
+        ECG_Ser_FieldU(w, (uint32_t)(i * 300), 4u);
+        ECG_Ser_FieldU(w, 300u, 4u);
+        ECG_Ser_FieldS(w, x, 4u);
+        ECG_Ser_FieldS(w, x * 40, 4u);
+        ECG_Ser_FieldS(w, x * 9, 4u);
+        ECG_Ser_FieldS(w, 72, 2u);
+        break;
+    }
+    ECG_Ser_End(w);
+}
+
+/* Compare one conversion with its sprintf; returns 1 if equal */
+static int check(const char *what, const char *expect, void (*fn)(ECG_Ser_t *, const void *), const void *arg) {
+    char buf[32];
+    ECG_Ser_t w;
+
+    ECG_Ser_Buffer(&w, buf, sizeof(buf) - 1u, ECG_SER_TEXT);
+    fn(&w, arg);
+    buf[ECG_Ser_Len(&w)] = '\0';
+    if (strcmp(buf, expect) != 0) {
+        fprintf(stderr, "ecg_ser_bench: %s: \"%s\", sprintf \"%s\"\n", what, buf, expect);
+        return 0;
+    }
+    return 1;
+}
+
+static void call_dec(ECG_Ser_t *w, const void *a)  { ECG_Ser_Dec(w, *(const uint32_t *)a); }
+static void call_decs(ECG_Ser_t *w, const void *a) { ECG_Ser_DecS(w, *(const int32_t *)a); }
+static void call_decw(ECG_Ser_t *w, const void *a) { ECG_Ser_DecW(w, *(const uint32_t *)a, 4u); }
+static void call_fix(ECG_Ser_t *w, const void *a)  { ECG_Ser_Fix(w, *(const int32_t *)a, 2u); }
+
+static uint32_t check_edges(void) {
+    char expect[32];
+    uint32_t bad = 0;
+    uint32_t u[64];
+    uint32_t n = 0;
+
+    u[n++] = 0u;
+    u[n++] = UINT32_MAX;
+    u[n++] = (uint32_t)INT32_MAX;
+    u[n++] = 0x80000000u;
+    for (uint32_t p = 1u; p <= 1000000000u; p *= 10u) {
+        u[n++] = p - 1u;
+        u[n++] = p;
+        u[n++] = p + 1u;
+        if (p == 1000000000u) break;
+    }
+
+    for (uint32_t j = 0; j < n; j++) {
+        int32_t s = (int32_t)u[j];
+        int32_t neg = (int32_t)(0u - u[j]);
+
+        sprintf(expect, "%lu", (unsigned long)u[j]);
+        bad += !check("Dec", expect, call_dec, &u[j]);
+        sprintf(expect, "%ld", (long)s);
+        bad += !check("DecS", expect, call_decs, &s);
+        sprintf(expect, "%ld", (long)neg);
+        bad += !check("DecS", expect, call_decs, &neg);
+        sprintf(expect, "%04lu", (unsigned long)u[j]);
+        bad += !check("DecW", expect, call_decw, &u[j]);
+
+        /* Fixed point as the "F" record wrote it: "%ld.%02ld" of the magnitude, sign in front */
+        long m = labs((long)s);
+        sprintf(expect, "%s%ld.%02ld", (s < 0) ? "-" : "", m / 100, m % 100);
+        if (s != INT32_MIN) bad += !check("Fix", expect, call_fix, &s);
+    }
+    return bad;
+}
+
+int main(int argc, char **argv) {
+    uint32_t records = 1000000u;
+    uint64_t cyc_printf[BENCH_KINDS] = { 0 };
+    uint64_t cyc_ser[BENCH_KINDS] = { 0 };
+    uint64_t bytes[BENCH_KINDS] = { 0 };
+    uint32_t mismatches = 0;
+    uint32_t pos = 0;
+    char buff[96];
+    int c;
+
+    while ((c = getopt(argc, argv, "n:h")) != -1) {
+        switch (c) {
+        case 'n': records = (uint32_t)strtoul(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "usage: %s [-n records]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (records == 0u) return 2;
+
+    ECG_Sim_Init(360u);
+    for (uint32_t i = 0; i < records; i++) {
+        int32_t x = (int32_t)ECG_Sim_GetSample();
+
+        for (uint32_t k = 0; k < BENCH_KINDS; k++) {
+            uint32_t t0 = DWT->CYCCNT;
+            uint32_t len = bench_printf(k, buff, x, (int32_t)i);
+            uint32_t off = pos & (BENCH_RING - 1u);
+            uint32_t first = (len < BENCH_RING - off) ? len : BENCH_RING - off;
+            memcpy(&ring_printf[off], buff, first);
+            memcpy(ring_printf, &buff[first], len - first);
+            uint32_t t1 = DWT->CYCCNT;
+
+            ECG_Ser_t w;
+            ECG_Ser_Ring(&w, ring_ser, BENCH_RING, pos, BENCH_RING, ECG_SER_TEXT);
+            bench_ser(k, &w, x, (int32_t)i);
+            uint32_t t2 = DWT->CYCCNT;
+
+            cyc_printf[k] += t1 - t0;
+            cyc_ser[k] += t2 - t1;
+            bytes[k] += len;
+
+            int same = (ECG_Ser_Len(&w) == len);
+            for (uint32_t b = 0; same && (b < len); b++) {
+                uint32_t o = (pos + b) & (BENCH_RING - 1u);
+                same = (ring_printf[o] == ring_ser[o]);
+            }
+            mismatches += !same;
+            pos += len;
+        }
+    }
+
+    printf("%-8s %8s %12s %12s %7s\n", "record", "bytes", "sprintf cyc", "ecg_ser cyc", "speedup");
+    for (uint32_t k = 0; k < BENCH_KINDS; k++) {
+        double cp = (double)cyc_printf[k] / records;
+        double cs = (double)cyc_ser[k] / records;
+        printf("%-8s %8.1f %12.1f %12.1f %6.1fx\n", bench_kind[k], (double)bytes[k] / records, cp, cs,
+               (cs > 0.0) ? cp / cs : 0.0);
+    }
+
+    uint32_t edge_bad = check_edges();
+    printf("records %u x %u, mismatches %u, edge-value mismatches %u\n", records, BENCH_KINDS, mismatches, edge_bad);
+    return (mismatches == 0u && edge_bad == 0u) ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+/*
+ * gen_decim_fir: writes src/adc_decim_taps.c, the anti-alias filters adc_decim uses to
+ * take the oversampled ADC stream down to the analysis rate.
+ *
+ *   gen_decim_fir > src/adc_decim_taps.c
+ *
+ * One lowpass per supported factor M, designed relative to the output rate Fo:
+ * passband to ADC_DECIM_PASS * Fo, stopband from Fo / 2, so nothing folds into the
+ * output band. Windowed sinc (Kaiser) with the length from Kaiser's formula for the
+ * stopband attenuation, unity DC gain. Every filter is checked on a dense frequency
+ * grid before anything is printed.
+ */
+#include "adc_decim.h"
+#include <math.h>
+#include <stdio.h>
+
+#define GEN_PI          3.14159265358979323846
+#define GEN_ATTEN_DB    60.0
+#define GEN_GRID        8192u
+
+static double gen_taps[ADC_DECIM_MAX_TAPS];
+
+/* Modified Bessel function of the first kind, order 0 (series) */
+static double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 50; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < 1e-12 * sum) break;
+    }
+    return sum;
+}
+
+/* Kaiser-windowed sinc for factor m; returns the number of taps */
+static uint32_t gen_design(uint32_t m) {
+    double f_pass = ADC_DECIM_PASS / m;             /* cycles per input sample */
+    double f_stop = 0.5 / m;
+    double fc = 0.5 * (f_pass + f_stop);
+    double dw = 2.0 * GEN_PI * (f_stop - f_pass);
+    double beta = 0.1102 * (GEN_ATTEN_DB - 8.7);
+    uint32_t n = (uint32_t)ceil((GEN_ATTEN_DB - 8.0) / (2.285 * dw)) + 1u;
+    double sum = 0.0;
+
+    if (n > ADC_DECIM_MAX_TAPS) return 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        double t = (double)i - 0.5 * (double)(n - 1u);
+        double r = 2.0 * t / (double)(n - 1u);
+        double sinc = (t == 0.0) ? 2.0 * fc : sin(2.0 * GEN_PI * fc * t) / (GEN_PI * t);
+        gen_taps[i] = sinc * bessel_i0(beta * sqrt(1.0 - r * r)) / bessel_i0(beta);
+        sum += gen_taps[i];
+    }
+    for (uint32_t i = 0; i < n; i++) gen_taps[i] /= sum;
+    return n;
+}
+
+/* Worst passband deviation and worst stopband gain (dB) of the float32 taps */
+static void gen_check(uint32_t m, uint32_t n, double *pass_db, double *stop_db) {
+    *pass_db = 0.0;
+    *stop_db = -1000.0;
+    for (uint32_t g = 0; g <= GEN_GRID; g++) {
+        double f = 0.5 * g / GEN_GRID;              /* cycles per input sample */
+        double re = 0.0, im = 0.0;
+        for (uint32_t i = 0; i < n; i++) {
+            double h = (float32_t)gen_taps[i];
+            re += h * cos(2.0 * GEN_PI * f * i);
+            im -= h * sin(2.0 * GEN_PI * f * i);
+        }
+        double db = 20.0 * log10(hypot(re, im) + 1e-300);
+        if ((f <= ADC_DECIM_PASS / m) && (fabs(db) > *pass_db)) *pass_db = fabs(db);
+        if ((f >= 0.5 / m) && (db > *stop_db)) *stop_db = db;
+    }
+}
+
+int main(void) {
+    static const uint32_t factors[ADC_DECIM_N_FACTORS] = ADC_DECIM_FACTORS;
+    uint32_t lens[ADC_DECIM_N_FACTORS];
+
+    printf("#include \"adc_decim.h\"\n\n");
+    printf("/*\n * Anti-alias lowpass filters for adc_decim, generated by host/tools/gen_decim_fir.c.\n"
+           " * Kaiser windowed sinc, passband %.2f * Fo, stopband from 0.5 * Fo, %.0fdB. Do not edit.\n */\n",
+           ADC_DECIM_PASS, GEN_ATTEN_DB);
+
+    for (uint32_t k = 0; k < ADC_DECIM_N_FACTORS; k++) {
+        uint32_t m = factors[k];
+        uint32_t n = gen_design(m);
+        double pass_db, stop_db;
+
+        if (n == 0u) {
+            fprintf(stderr, "gen_decim_fir: M=%u needs more than ADC_DECIM_MAX_TAPS taps\n", m);
+            return 1;
+        }
+        gen_check(m, n, &pass_db, &stop_db);
+        if ((pass_db > 0.02) || (stop_db > -GEN_ATTEN_DB + 1.0)) {
+            fprintf(stderr, "gen_decim_fir: M=%u misses the spec: passband %.4fdB, stopband %.1fdB\n",
+                    m, pass_db, stop_db);
+            return 1;
+        }
+        fprintf(stderr, "gen_decim_fir: M=%u %u taps, passband +-%.4fdB, stopband %.1fdB\n",
+                m, n, pass_db, stop_db);
+
+        lens[k] = n;
+        printf("\nstatic const float32_t adc_decim_taps_%u[%u] = {\n", m, n);
+        for (uint32_t i = 0; i < n; i++) {
+            printf("%s%.9ef,%s", (i % 4u) ? " " : "    ", (double)(float32_t)gen_taps[i],
+                   ((i % 4u) == 3u || i + 1u == n) ? "\n" : "");
+        }
+        printf("};\n");
+    }
+
+    printf("\nconst ADC_Decim_Filter adc_decim_filters[ADC_DECIM_N_FACTORS] = {\n");
+    for (uint32_t k = 0; k < ADC_DECIM_N_FACTORS; k++) {
+        printf("    { %u, %u, adc_decim_taps_%u },\n", factors[k], lens[k], factors[k]);
+    }
+    printf("};\n");
+    return 0;
+}
@@ -0,0 +1,141 @@
+/*
+ * gen_rfft_tables: writes src/hrv_fft_tables.c, the tables arm_rfft_fast_f32 needs for
+ * one transform length (lib/DSP does not carry CommonTables/arm_common_tables.c).
+ *
+ *   gen_rfft_tables > src/hrv_fft_tables.c
+ *
+ * Twiddles follow the CMSIS definitions:
+ *   cfft (N/2 points): w[2i] = cos(2*pi*i/(N/2)), w[2i+1] = sin(2*pi*i/(N/2)), i < N/2
+ *   rfft (N points):   w[2i] = sin(2*pi*i/N),     w[2i+1] = cos(2*pi*i/N),     i < N/2
+ *                      (the split step's i*e^(-j*2*pi*i/N))
+ * The bit-reversal table is derived rather than transcribed: an impulse is run through
+ * arm_cfft_f32 without reordering, the bin at every output position is read off its
+ * phase, and the permutation is written as the in-place swaps arm_bitreversal_32 walks
+ * (pairs of byte offsets of complex elements). The finished tables are checked against
+ * a direct DFT before anything is printed.
+ */
+#include "arm_math.h"
+#include <math.h>
+#include <stdio.h>
+
+#define GEN_RFFT_LEN   256u
+#define GEN_CFFT_LEN   (GEN_RFFT_LEN / 2u)
+#define GEN_PI         3.14159265358979323846
+
+static float32_t cfft_twiddle[2u * GEN_CFFT_LEN];
+static float32_t rfft_twiddle[GEN_RFFT_LEN];
+static uint16_t  bitrev[2u * GEN_CFFT_LEN];
+static uint16_t  bitrev_len;
+
+/* Derive the swap list from the unreordered output of an impulse at n = 1: X[k] = e^(-j*2*pi*k/L) */
+static int gen_bitrev(void) {
+    arm_cfft_instance_f32 c = { 0 };
+    float32_t buf[2u * GEN_CFFT_LEN] = { 0 };
+    uint32_t at[GEN_CFFT_LEN];      /* bin currently at each position */
+    uint32_t seen[GEN_CFFT_LEN] = { 0 };
+
+    c.fftLen = GEN_CFFT_LEN;
+    c.pTwiddle = cfft_twiddle;
+    buf[2] = 1.0f;
+    arm_cfft_f32(&c, buf, 0, 0);
+
+    for (uint32_t p = 0; p < GEN_CFFT_LEN; p++) {
+        double ph = -atan2(buf[2u * p + 1u], buf[2u * p]);
+        long k = lround(ph * GEN_CFFT_LEN / (2.0 * GEN_PI));
+        at[p] = (uint32_t)((k + (long)GEN_CFFT_LEN) % (long)GEN_CFFT_LEN);
+        if (seen[at[p]]++) return 0;
+    }
+
+    /* Place bin pos at position pos, one swap each, in order */
+    bitrev_len = 0;
+    for (uint32_t pos = 0; pos < GEN_CFFT_LEN; pos++) {
+        if (at[pos] == pos) continue;
+        uint32_t q = pos + 1u;
+        while (at[q] != pos) q++;
+        at[q] = at[pos];
+        at[pos] = pos;
+        bitrev[bitrev_len++] = (uint16_t)(pos * 8u);
+        bitrev[bitrev_len++] = (uint16_t)(q * 8u);
+    }
+    return 1;
+}
+
+/* arm_rfft_fast_f32 against a direct DFT of a pseudo-random input */
+static double gen_check(void) {
+    arm_rfft_fast_instance_f32 s = { 0 };
+    float32_t in[GEN_RFFT_LEN], x[GEN_RFFT_LEN], out[GEN_RFFT_LEN];
+    uint32_t seed = 12345u;
+    double err = 0.0;
+
+    s.Sint.fftLen = GEN_CFFT_LEN;
+    s.Sint.pTwiddle = cfft_twiddle;
+    s.Sint.pBitRevTable = bitrev;
+    s.Sint.bitRevLength = bitrev_len;
+    s.fftLenRFFT = GEN_RFFT_LEN;
+    s.pTwiddleRFFT = rfft_twiddle;
+
+    for (uint32_t n = 0; n < GEN_RFFT_LEN; n++) {
+        seed = seed * 1103515245u + 12345u;
+        x[n] = in[n] = (float32_t)((seed >> 8) & 0xFFFFu) / 32768.0f - 1.0f;
+    }
+    arm_rfft_fast_f32(&s, in, out, 0);
+
+    /* out: [X0.re, X(N/2).re, X1.re, X1.im, ...] */
+    for (uint32_t k = 0; k <= GEN_RFFT_LEN / 2u; k++) {
+        double re = 0.0, im = 0.0;
+        for (uint32_t n = 0; n < GEN_RFFT_LEN; n++) {
+            re += x[n] * cos(2.0 * GEN_PI * k * n / GEN_RFFT_LEN);
+            im -= x[n] * sin(2.0 * GEN_PI * k * n / GEN_RFFT_LEN);
+        }
+        double gre, gim;
+        if (k == 0u)                      { gre = out[0]; gim = 0.0; }
+        else if (k == GEN_RFFT_LEN / 2u)  { gre = out[1]; gim = 0.0; }
+        else                              { gre = out[2u * k]; gim = out[2u * k + 1u]; }
+        double e = hypot(gre - re, gim - im);
+        if (e > err) err = e;
+    }
+    return err;
+}
+
+static void print_f32(const char *name, const float32_t *v, uint32_t n) {
+    printf("const float32_t %s[%u] = {\n", name, n);
+    for (uint32_t i = 0; i < n; i++) {
+        printf("%s%.9ef,%s", (i % 4u) ? " " : "    ", (double)v[i], ((i % 4u) == 3u) ? "\n" : "");
+    }
+    printf("};\n\n");
+}
+
+int main(void) {
+    for (uint32_t i = 0; i < GEN_CFFT_LEN; i++) {
+        cfft_twiddle[2u * i]      = (float32_t)cos(2.0 * GEN_PI * i / GEN_CFFT_LEN);
+        cfft_twiddle[2u * i + 1u] = (float32_t)sin(2.0 * GEN_PI * i / GEN_CFFT_LEN);
+    }
+    for (uint32_t i = 0; i < GEN_RFFT_LEN / 2u; i++) {
+        rfft_twiddle[2u * i]      = (float32_t)sin(2.0 * GEN_PI * i / GEN_RFFT_LEN);
+        rfft_twiddle[2u * i + 1u] = (float32_t)cos(2.0 * GEN_PI * i / GEN_RFFT_LEN);
+    }
+
+    if (!gen_bitrev()) {
+        fprintf(stderr, "gen_rfft_tables: cfft output is not a permutation of the bins\n");
+        return 1;
+    }
+    double err = gen_check();
+    if (err > 1e-3) {
+        fprintf(stderr, "gen_rfft_tables: rfft differs from the DFT by %g\n", err);
+        return 1;
+    }
+    fprintf(stderr, "gen_rfft_tables: %u swaps, max |rfft - dft| = %.2e\n", bitrev_len / 2u, err);
+
+    printf("#include \"hrv_freq.h\"\n\n");
+    printf("/*\n * arm_rfft_fast_f32 tables for HRV_FREQ_FFT_LEN = %u, generated by\n"
+           " * host/tools/gen_rfft_tables.c (lib/DSP has no arm_common_tables.c). Do not edit.\n */\n\n",
+           GEN_RFFT_LEN);
+    print_f32("hrv_fft_cfft_twiddle", cfft_twiddle, 2u * GEN_CFFT_LEN);
+    print_f32("hrv_fft_rfft_twiddle", rfft_twiddle, GEN_RFFT_LEN);
+    printf("const uint16_t hrv_fft_bitrev[%u] = {\n", bitrev_len);
+    for (uint32_t i = 0; i < bitrev_len; i++) {
+        printf("%s%4u,%s", (i % 12u) ? " " : "    ", bitrev[i], ((i % 12u) == 11u || i + 1u == bitrev_len) ? "\n" : "");
+    }
+    printf("};\n");
+    return 0;
+}
@@ -0,0 +1,195 @@
+/*
+ * prof_dump: per-probe cost from the profile report of a PROF_ENABLE build (prof.h).
+ *
+ *   prof_dump [-f hz] [-r] <usart2.bin | ->   decode a USART2 capture: text log lines and
+ *                                             PROF frames; the text is skipped
+ *   prof_dump [-f hz] [-r] -g <seconds>       run the simulator through the probed main-loop
+ *                                             path on the host and decode its own report
+ *
+ * Reports of the same probe are merged: count, average, min and max cycles, the 50th and
+ * 99th percentiles as the upper edge of their histogram bin, and cycles per processed
+ * sample. -f converts cycles to microseconds (default 84 MHz, SYSCLK of the firmware;
+ * give the TSC rate for -g); -r also prints every report as it arrives.
+ *
+ * With -g the probes time with DWT->CYCCNT, i.e. rdtsc on x86 and clock_gettime
+ * nanoseconds elsewhere (host/include/stm32f4xx.h); the PT stages are only timed when
+ * the library is built with -DPT_HOST_PROF=ON.
+ */
+extern "C" {
+#include "ecg_ser.h"
+#include "ecg_sim.h"
+#include "pan_tompkins.h"
+#include "prof.h"
+}
+
+#include "ecg_proto_decoder.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+/* Report period of the host run, as PROF_REPORT_S in main.c */
+constexpr uint32_t kReportSeconds = 10;
+
+struct Total {
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint32_t min = 0xFFFFFFFFu;
+    uint32_t max = 0;
+    uint64_t hist[ecg_proto::kProfBins] = {};
+};
+
+Total totals[PROF_COUNT];
+uint32_t first_tick, last_tick;
+bool have_tick = false;
+
+/* Upper edge of the bin holding the q-th fraction of the intervals */
+uint32_t percentile(const Total &t, double q) {
+    uint64_t target = (uint64_t)(q * (double)t.count + 0.5);
+    uint64_t seen = 0;
+    for (std::size_t b = 0; b < ecg_proto::kProfBins; b++) {
+        seen += t.hist[b];
+        if (seen >= target && seen != 0u) {
+            return (b + 1 < ecg_proto::kProfBins) ? (16u << b) : t.max;
+        }
+    }
+    return t.max;
+}
+
+void on_prof(const ecg_proto::Prof &p, bool print_reports) {
+    if (p.probe >= PROF_COUNT) return;
+    Total &t = totals[p.probe];
+
+    if (!have_tick) first_tick = p.tick;
+    have_tick = true;
+    last_tick = p.tick;
+
+    t.count += p.count;
+    t.sum += p.sum;
+    if (p.count != 0u && p.min < t.min) t.min = p.min;
+    if (p.max > t.max) t.max = p.max;
+    for (std::size_t b = 0; b < ecg_proto::kProfBins; b++) t.hist[b] += p.hist[b];
+
+    if (print_reports) {
+        std::printf("tick %10u  %-12s n %7u  avg %9.1f  min %8u  max %8u\n", p.tick, Prof_Name(p.probe),
+                    p.count, p.count ? (double)p.sum / p.count : 0.0, p.count ? p.min : 0u, p.max);
+    }
+}
+
+/* The firmware's main-loop path for the text stream, probed the same way (main.c) */
+int generate(uint32_t seconds, ecg_proto::Decoder &dec) {
+    PanTompkins_Handle_t pt;
+    std::vector<uint8_t> sink(1u << 16);
+    uint32_t sink_len = 0;
+    uint8_t frame[PROF_FRAME_MAX];
+
+    PT_Init(&pt);
+    ECG_Sim_Init(360u);
+    Prof_Init();
+
+    for (uint32_t i = 0; i < seconds * 360u; i++) {
+        uint32_t t_sample = Prof_Begin();
+        uint16_t x = ECG_Sim_GetSample();
+
+        uint32_t t_pt = Prof_Begin();
+        PT_Process(&pt, x);
+        Prof_End(PROF_PT_PROCESS, t_pt);
+
+        /* HC05_SendSample: the line formatted in place, then committed */
+        uint32_t t_stream = Prof_Begin();
+        uint32_t t_format = Prof_Begin();
+        ECG_Ser_t w;
+        if (sink.size() - sink_len < 16u) sink_len = 0;
+        ECG_Ser_Buffer(&w, &sink[sink_len], (uint32_t)(sink.size() - sink_len), ECG_SER_TEXT);
+        ECG_Ser_Dec(&w, x);
+        ECG_Ser_FieldS(&w, PT_GetBPM(&pt), 2u);
+        ECG_Ser_End(&w);
+
+        /* HC05_Commit stand-in: publish the bytes */
+        uint32_t t_write = Prof_Begin();
+        sink_len += ECG_Ser_Len(&w);
+        Prof_End(PROF_HC05_WRITE, t_write);
+        Prof_End(PROF_FORMAT, t_format);
+        Prof_End(PROF_STREAM, t_stream);
+
+        uint32_t n = Prof_ReportStep(pt.current_tick, kReportSeconds * 360u, PROF_FRAME_MAX, frame);
+        if (n != 0u) dec.feed(frame, n);
+        Prof_End(PROF_SAMPLE, t_sample);
+    }
+
+    /* Flush what the last period collected: restart the report, due at once */
+    prof.report_next = PROF_COUNT;
+    for (uint32_t p = 0; p < PROF_COUNT; p++) {
+        uint32_t n = Prof_ReportStep(pt.current_tick, 0u, PROF_FRAME_MAX, frame);
+        dec.feed(frame, n);
+    }
+    uint8_t end = 0x00;
+    dec.feed(&end, 1);
+    return 0;
+}
+
+int usage() {
+    std::fprintf(stderr, "usage: prof_dump [-f hz] [-r] <usart2.bin | ->\n"
+                         "       prof_dump [-f hz] [-r] -g <seconds>\n");
+    return 2;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    double clock_hz = 84e6;
+    uint32_t gen_seconds = 0;
+    bool print_reports = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:g:r")) != -1) {
+        switch (opt) {
+        case 'f': clock_hz = std::strtod(optarg, nullptr); break;
+        case 'g': gen_seconds = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10)); break;
+        case 'r': print_reports = true; break;
+        default:  return usage();
+        }
+    }
+    if (clock_hz <= 0.0) return usage();
+
+    ecg_proto::Decoder dec(nullptr, nullptr, nullptr,
+                           [&](const ecg_proto::Prof &p) { on_prof(p, print_reports); });
+
+    if (gen_seconds > 0) {
+        generate(gen_seconds, dec);
+    } else {
+        if (optind != argc - 1) return usage();
+        FILE *in = (std::strcmp(argv[optind], "-") == 0) ? stdin : std::fopen(argv[optind], "rb");
+        if (in == nullptr) {
+            std::fprintf(stderr, "prof_dump: cannot open %s\n", argv[optind]);
+            return 1;
+        }
+        uint8_t buf[4096];
+        std::size_t n;
+        while ((n = std::fread(buf, 1, sizeof(buf), in)) > 0) dec.feed(buf, n);
+        if (in != stdin) std::fclose(in);
+    }
+
+    /* Processed samples, from the PT_PROCESS count */
+    const double samples = (double)totals[PROF_PT_PROCESS].count;
+    std::printf("%-12s %9s %10s %8s %8s %8s %8s %8s %7s\n", "probe", "count", "avg cyc", "avg us",
+                "min", "p50<=", "p99<=", "max", "cyc/smp");
+    for (uint32_t i = 0; i < PROF_COUNT; i++) {
+        const Total &t = totals[i];
+        if (t.count == 0u) continue;
+        double avg = (double)t.sum / (double)t.count;
+        std::printf("%-12s %9llu %10.1f %8.2f %8u %8u %8u %8u %7.1f\n", Prof_Name(i), (unsigned long long)t.count,
+                    avg, avg * 1e6 / clock_hz, t.min, percentile(t, 0.50), percentile(t, 0.99), t.max,
+                    samples > 0.0 ? (double)t.sum / samples : 0.0);
+    }
+
+    const ecg_proto::Stats &st = dec.stats();
+    std::fprintf(stderr, "prof frames %llu, lost %llu, crc errors %llu, other records %llu, ticks %u..%u\n",
+                 (unsigned long long)st.frames, (unsigned long long)st.lost_frames,
+                 (unsigned long long)st.crc_errors, (unsigned long long)st.bad_frames, first_tick, last_tick);
+    return 0;
+}
@@ -0,0 +1,117 @@
+/*
+ * pt_mc_bench: channel-scaling benchmark of the multi-channel engine.
+ *
+ * For 1, 2, 4 ... max_channels (default 4096) channels, runs the same interleaved
+ * input through PT_MC_ProcessBlock (structure of arrays) and through one
+ * PanTompkins_Handle_t per channel fed frame by frame with PT_Process (array of
+ * structs), and reports ns per channel-sample for both. The total beat count, and every
+ * channel's last beat tick and BPM, must agree between the two engines.
+ *
+ *   pt_mc_bench [max_channels]
+ */
+#define _GNU_SOURCE
+#include "pan_tompkins.h"
+#include "pan_tompkins_mc.h"
+#include "ecg_sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_SIM_SECONDS      60u
+#define BENCH_WORK_SAMPLES     (1u << 23)   /* channel-samples per point */
+#define BENCH_MIN_FRAMES       3600u        /* 10s @ 360Hz */
+#define BENCH_MAX_CHANNELS     4096u
+#define BENCH_CHANNEL_OFFSET   997u         /* de-phases the channels' copies of the simulator */
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+int main(int argc, char **argv) {
+    uint32_t max_ch = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : BENCH_MAX_CHANNELS;
+    PT_Config cfg;
+    int ok = 1;
+
+    PT_ConfigInit(&cfg, (uint32_t)SAMPLE_RATE_HZ);
+
+    /* One simulated lead, each channel reads it from a different offset */
+    uint32_t sim_len = BENCH_SIM_SECONDS * cfg.sample_rate_hz;
+    uint16_t *sim = malloc(sim_len * sizeof(*sim));
+    if (sim == NULL) return 1;
+    ECG_Sim_Init(cfg.sample_rate_hz);
+    for (uint32_t i = 0; i < sim_len; i++) sim[i] = ECG_Sim_GetSample();
+
+    printf("%8s %10s %12s %12s %8s %14s\n",
+           "channels", "frames", "AoS ns/smp", "SoA ns/smp", "speedup", "SoA ch@360Hz");
+
+    for (uint32_t n_ch = 1; n_ch <= max_ch; n_ch *= 2u) {
+        uint32_t frames = BENCH_WORK_SAMPLES / n_ch;
+        if (frames < BENCH_MIN_FRAMES) frames = BENCH_MIN_FRAMES;
+
+        uint16_t *in = malloc((size_t)frames * n_ch * sizeof(*in));
+        PanTompkins_Handle_t *aos = malloc((size_t)n_ch * sizeof(*aos));
+        size_t mem_size = (PT_MC_MemSize(&cfg, n_ch) + 63u) & ~(size_t)63u;
+        void *mem = aligned_alloc(64, mem_size);
+        uint32_t aos_beats = 0;
+        PanTompkinsMC_Handle_t mc;
+
+        if ((in == NULL) || (aos == NULL) || (mem == NULL)) {
+            fprintf(stderr, "pt_mc_bench: out of memory at %u channels\n", n_ch);
+            return 1;
+        }
+
+        for (uint32_t i = 0; i < frames; i++) {
+            for (uint32_t ch = 0; ch < n_ch; ch++) {
+                in[(size_t)i * n_ch + ch] = sim[(i + ch * BENCH_CHANNEL_OFFSET) % sim_len];
+            }
+        }
+
+        /* Array of structs: one handle per channel */
+        for (uint32_t ch = 0; ch < n_ch; ch++) PT_InitConfig(&aos[ch], &cfg);
+        double t0 = now_ns();
+        for (uint32_t i = 0; i < frames; i++) {
+            const uint16_t *frame = &in[(size_t)i * n_ch];
+            for (uint32_t ch = 0; ch < n_ch; ch++) {
+                aos_beats += PT_Process(&aos[ch], frame[ch]);
+            }
+        }
+        double t_aos = now_ns() - t0;
+
+        /* Structure of arrays: the whole block in one call, no per-frame flags */
+        PT_MC_Init(&mc, &cfg, n_ch, mem);
+        t0 = now_ns();
+        uint32_t soa_beats = PT_MC_ProcessBlock(&mc, in, frames, NULL);
+        double t_soa = now_ns() - t0;
+
+        if (aos_beats != soa_beats) {
+            printf("MISMATCH at %u channels: beats %u/%u\n", n_ch, aos_beats, soa_beats);
+            ok = 0;
+        }
+        for (uint32_t ch = 0; ch < n_ch; ch++) {
+            if ((aos[ch].last_beat_tick != mc.last_beat_tick[ch]) ||
+                (PT_GetBPM(&aos[ch]) != PT_MC_GetBPM(&mc, ch))) {
+                printf("MISMATCH channel %u of %u: last beat %u/%u, bpm %d/%d\n", ch, n_ch,
+                       aos[ch].last_beat_tick, mc.last_beat_tick[ch], PT_GetBPM(&aos[ch]), PT_MC_GetBPM(&mc, ch));
+                ok = 0;
+                break;
+            }
+        }
+
+        double work = (double)frames * (double)n_ch;
+        double ns_aos = t_aos / work;
+        double ns_soa = t_soa / work;
+        printf("%8u %10u %12.2f %12.2f %7.2fx %14.0f\n",
+               n_ch, frames, ns_aos, ns_soa, ns_aos / ns_soa, 1e9 / (ns_soa * (double)cfg.sample_rate_hz));
+
+        free(in);
+        free(aos);
+        free(mem);
+    }
+
+    free(sim);
+    printf("%s\n", ok ? "all channels MATCH PT_Process" : "MISMATCH");
+    return ok ? 0 : 1;
+}
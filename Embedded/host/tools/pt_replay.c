@@ -0,0 +1,398 @@
+/*
+ * pt_replay: stream a recorded ECG through the Pan-Tompkins detector on the host.
+ *
+ * Reports throughput (samples/s), the per-stage cost of PT_Process in ns/sample and,
+ * when reference beats are available, sensitivity (Se) and positive predictivity (+P)
+ * with the usual 150ms match window. The detected RR intervals also run through the
+ * HRV windows, which report the last 1 min and 5 min of the record, and through the
+ * sliced LF/HF analysis, which also reports its worst slice in DWT (here TSC) cycles.
+ *
+ *   pt_replay [options] <record>
+ *
+ * <record> is a WFDB record path without extension (reads .hea, the signal file and,
+ * if present, .atr) or a .csv file of "ECG_VALUE,BPM" lines as streamed over HC-05.
+ */
+#define _GNU_SOURCE
+#include "pan_tompkins.h"
+#include "pan_tompkins_q31.h"
+#include "ecg_sim.h"
+#include "hrv.h"
+#include "hrv_freq.h"
+#include "ecg_record.h"
+#include "pt_stage_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define REPLAY_MATCH_WINDOW_MS  150u
+#define REPLAY_CALIB_ROUNDS     100000u
+
+typedef enum {
+    ENGINE_FLOAT = 0,   /* PT_Process */
+    ENGINE_BLOCK,       /* PT_ProcessBlock */
+    ENGINE_Q31          /* PT_ProcessQ31 */
+} Replay_Engine;
+
+typedef struct {
+    Replay_Engine engine;
+    uint32_t channel;
+    uint32_t csv_fs_hz;
+    uint32_t sim_seconds;
+    const char *ann_path;
+    const char *list_path;
+    float counts_per_mv;
+    int32_t delay;          /* -1: derive from the detector config */
+    uint32_t window_ms;
+    int realtime;
+    int r_peak;             /* score beat-event R-peak ticks instead of detection ticks */
+} Replay_Options;
+
+static const char *const stage_names[PT_STAGE_COUNT] = {
+    "dc", "lpf", "hpf", "deriv", "square", "mwi", "detect"
+};
+
+static PanTompkins_Handle_t    pt;
+static PanTompkinsQ31_Handle_t pt_q31;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [options] <record | file.csv>\n"
+            "  -e engine  float (PT_Process, default), block (PT_ProcessBlock), q31 (PT_ProcessQ31)\n"
+            "  -c n       WFDB signal to replay (default 0)\n"
+            "  -r hz      sample rate of a CSV stream (default 360)\n"
+            "  -s sec     replay the built-in ECG simulator instead of a record\n"
+            "  -a file    MIT-format reference annotations (default <record>.atr)\n"
+            "  -l file    reference beats as text, one sample index per line\n"
+            "  -g counts  ADC counts per mV for WFDB signals (default %.0f)\n"
+            "  -d n       detector delay in samples subtracted before matching\n"
+            "             (default: group delay of LPF+HPF+derivative plus half the MWI window)\n"
+            "  -w ms      beat match window (default %u)\n"
+            "  -t         pace samples at real time instead of full speed\n"
+            "  -R         score the beat event's R-peak tick (float engine, no delay needed)\n",
+            prog, (double)ECG_RECORD_COUNTS_PER_MV, REPLAY_MATCH_WINDOW_MS);
+}
+
+static int ends_with(const char *s, const char *suffix) {
+    size_t ls = strlen(s);
+    size_t lx = strlen(suffix);
+    return (ls >= lx) && (strcmp(s + ls - lx, suffix) == 0);
+}
+
+/* Detection -> R-peak offset: LPF (M-1) + HPF N + derivative 2, MWI peak about W/2 later */
+static uint32_t default_delay(const PT_Config *cfg) {
+    return (cfg->lpf_delay_m - 1u) + cfg->hpf_delay_n + 2u + cfg->integration_window / 2u;
+}
+
+static void wait_until(double t_ns) {
+    struct timespec ts;
+    ts.tv_sec  = (time_t)(t_ns / 1e9);
+    ts.tv_nsec = (long)(t_ns - (double)ts.tv_sec * 1e9);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) { }
+}
+
+/*
+ * Timed pass over the whole record with the selected engine. Detected beats are
+ * stored as sample indices (peak tick - 1). Returns the elapsed time in ns.
+ */
+static double replay_run(const Replay_Options *opt, const ECG_Record *rec, const PT_Config *cfg,
+                         uint32_t *det, uint32_t max_det, uint32_t *n_det, int *bpm) {
+    const double period_ns = 1e9 / (double)rec->fs_hz;
+    uint64_t latency_sum = 0;
+    uint32_t latency_max = 0;
+    uint32_t n = 0;
+    double t0;
+
+    if (opt->engine == ENGINE_Q31) PT_InitQ31(&pt_q31);
+    else                           PT_InitConfig(&pt, cfg);
+
+    t0 = now_ns();
+
+    if (opt->engine == ENGINE_BLOCK) {
+        /* Real-time pacing hands the engine one PT_BLOCK_SIZE chunk per block period */
+        for (uint32_t i = 0; i < rec->n_samples; i += PT_BLOCK_SIZE) {
+            uint32_t m = rec->n_samples - i;
+            if (m > PT_BLOCK_SIZE) m = PT_BLOCK_SIZE;
+            if (opt->realtime) wait_until(t0 + (double)(i + m) * period_ns);
+            n += PT_ProcessBlock(&pt, &rec->adc[i], m, &det[n], max_det - n);
+        }
+        for (uint32_t k = 0; k < n; k++) det[k] -= 1u;
+        *bpm = PT_GetBPM(&pt);
+    } else {
+        for (uint32_t i = 0; i < rec->n_samples; i++) {
+            uint8_t beat;
+            if (opt->realtime) wait_until(t0 + (double)i * period_ns);
+            if (opt->engine == ENGINE_Q31) {
+                beat = PT_ProcessQ31(&pt_q31, rec->adc[i]);
+                if (beat && (n < max_det)) det[n++] = pt_q31.last_beat_tick - 1u;
+            } else if (opt->r_peak) {
+                PT_BeatEvent ev;
+                beat = PT_ProcessEvent(&pt, rec->adc[i], &ev);
+                if (beat && (n < max_det)) {
+                    det[n++] = ev.r_tick - 1u;
+                    latency_sum += ev.latency;
+                    if (ev.latency > latency_max) latency_max = ev.latency;
+                }
+            } else {
+                beat = PT_Process(&pt, rec->adc[i]);
+                if (beat && (n < max_det)) det[n++] = pt.last_beat_tick - 1u;
+            }
+        }
+        *bpm = (opt->engine == ENGINE_Q31) ? PT_GetBPMQ31(&pt_q31) : PT_GetBPM(&pt);
+    }
+
+    double elapsed = now_ns() - t0;
+
+    if (opt->r_peak && (n > 0u)) {
+        printf("latency     R peak -> beat event: mean %.1f ms, max %.1f ms\n",
+               1e3 * (double)latency_sum / (double)n / (double)rec->fs_hz,
+               1e3 * (double)latency_max / (double)rec->fs_hz);
+    }
+
+    *n_det = n;
+    return elapsed;
+}
+
+/* HRV of the detected beats, as the device would report it at the end of the record */
+static void replay_hrv(const uint32_t *det, uint32_t n_det, uint32_t fs_hz) {
+    static const char *const window_names[HRV_N_WINDOWS] = { "1 min", "5 min" };
+    static const char *const slice_names[HRV_FREQ_SLICE_COUNT] = {
+        "idle", "scan", "resample", "window", "fft", "accum", "bands"
+    };
+    static HRV_Handle_t hrv;
+    static HRV_Freq_Handle_t hrv_freq;
+    HRV_FreqResult fr;
+
+    HRV_Init(&hrv, fs_hz);
+    for (uint32_t k = 1; k < n_det; k++) HRV_AddRR(&hrv, det[k] - det[k - 1u]);
+
+    for (uint32_t w = 0; w < HRV_N_WINDOWS; w++) {
+        HRV_Metrics m;
+        HRV_GetMetrics(&hrv, w, &m);
+        printf("hrv %-7s %u RR, mean %.1f ms, SDNN %.1f ms, RMSSD %.1f ms, pNN50 %.1f%%, HR %u-%u\n",
+               window_names[w], m.n_rr, (double)m.mean_rr_ms, (double)m.sdnn_ms, (double)m.rmssd_ms,
+               (double)m.pnn50, m.hr_min, m.hr_max);
+    }
+    if (hrv.rejected > 0u) printf("hrv         %u RR intervals rejected as out of range\n", hrv.rejected);
+
+    uint32_t slices = 0;
+    HRV_FreqInit(&hrv_freq, &hrv);
+    HRV_FreqStart(&hrv_freq);
+    while (HRV_FreqStep(&hrv_freq)) slices++;
+    if (HRV_FreqGetResult(&hrv_freq, &fr)) {
+        printf("hrv freq    %u s, %u segments: VLF %.1f LF %.1f HF %.1f total %.1f ms^2, LF/HF %.2f\n",
+               fr.span_s, fr.n_segments, (double)fr.vlf_ms2, (double)fr.lf_ms2, (double)fr.hf_ms2,
+               (double)fr.total_ms2, (double)fr.lf_hf);
+        printf("hrv slices  %u, worst %u cycles:", slices, hrv_freq.slice_cycles_worst);
+        for (uint32_t k = HRV_FREQ_SCAN; k < HRV_FREQ_SLICE_COUNT; k++) {
+            printf(" %s %u", slice_names[k], hrv_freq.slice_cycles_max[k]);
+        }
+        printf("\n");
+    } else {
+        printf("hrv freq    no gap-free run of %u s\n", HRV_FREQ_FFT_LEN / HRV_FREQ_FS_HZ);
+    }
+}
+
+/*
+ * Per-stage pass with the instrumented copy of PT_Process. The cost of a mark is
+ * measured on an empty stage first and taken off every stage. Also compares the
+ * BPM after every sample with the BPM column of a CSV capture.
+ */
+static void replay_stages(const ECG_Record *rec, const PT_Config *cfg) {
+    uint32_t bpm_same = 0;
+
+    memset(pt_stage_ticks, 0, sizeof(pt_stage_ticks));
+    for (uint32_t i = 0; i < REPLAY_CALIB_ROUNDS; i++) {
+        pt_stage_start();
+        pt_stage_mark(PT_STAGE_DC);
+    }
+    double mark_ticks = (double)pt_stage_ticks[PT_STAGE_DC] / (double)REPLAY_CALIB_ROUNDS;
+
+    memset(pt_stage_ticks, 0, sizeof(pt_stage_ticks));
+    PTS_InitConfig(&pt, cfg);
+
+    double   t0_ns = now_ns();
+    uint64_t t0_tk = pt_stage_now();
+    for (uint32_t i = 0; i < rec->n_samples; i++) {
+        pt_stage_start();
+        PTS_Process(&pt, rec->adc[i]);
+        if ((rec->device_bpm != NULL) && (pt.current_bpm == rec->device_bpm[i])) bpm_same++;
+    }
+    double ns_per_tick = (now_ns() - t0_ns) / (double)(pt_stage_now() - t0_tk);
+
+    double total = 0.0;
+    /* Marks perturb the pipeline, so the per-stage sum is only a guide next to the timed pass */
+    printf("stages      instrumented PT_Process, ns/sample (mark overhead %.1f ns removed)\n",
+           mark_ticks * ns_per_tick);
+    for (uint32_t s = 0; s < PT_STAGE_COUNT; s++) {
+        double ns = ((double)pt_stage_ticks[s] / (double)rec->n_samples - mark_ticks) * ns_per_tick;
+        if (ns < 0.0) ns = 0.0;
+        total += ns;
+        printf("  %-8s %7.2f\n", stage_names[s], ns);
+    }
+    printf("  %-8s %7.2f\n", "total", total);
+
+    if (rec->device_bpm != NULL) {
+        printf("bpm agreement with capture: %.2f%% of samples\n",
+               100.0 * (double)bpm_same / (double)rec->n_samples);
+    }
+}
+
+/* Beat-by-beat comparison: one detection may match one reference beat within +-window */
+static void replay_score(const ECG_Record *rec, const uint32_t *det, uint32_t n_det,
+                         uint32_t delay, uint32_t window) {
+    uint32_t tp = 0, fp = 0, fn = 0;
+    uint32_t i = 0, j = 0;
+    int64_t *offs = malloc(((size_t)rec->n_ref + 1u) * sizeof(*offs));
+
+    while ((i < rec->n_ref) && (j < n_det)) {
+        int64_t d = ((int64_t)det[j] - (int64_t)delay) - (int64_t)rec->ref_beats[i];
+        if ((d <= (int64_t)window) && (d >= -(int64_t)window)) {
+            if (offs != NULL) offs[tp] = d;
+            tp++; i++; j++;
+        } else if (d < 0) {
+            fp++; j++;
+        } else {
+            fn++; i++;
+        }
+    }
+    fn += rec->n_ref - i;
+    fp += n_det - j;
+
+    printf("reference   %u beats, detected %u (delay %u samples, window +-%u)\n",
+           rec->n_ref, n_det, delay, window);
+    printf("TP %u  FN %u  FP %u\n", tp, fn, fp);
+    printf("Se %.2f%%  +P %.2f%%\n",
+           (tp + fn) ? 100.0 * (double)tp / (double)(tp + fn) : 0.0,
+           (tp + fp) ? 100.0 * (double)tp / (double)(tp + fp) : 0.0);
+
+    /* Median residual offset: a large value means -d should be adjusted */
+    if ((offs != NULL) && (tp > 0u)) {
+        for (uint32_t a = 1; a < tp; a++) {
+            int64_t v = offs[a];
+            uint32_t b = a;
+            while ((b > 0u) && (offs[b - 1u] > v)) { offs[b] = offs[b - 1u]; b--; }
+            offs[b] = v;
+        }
+        printf("median offset after delay: %+lld samples\n", (long long)offs[tp / 2u]);
+    }
+    free(offs);
+}
+
+int main(int argc, char **argv) {
+    Replay_Options opt = {
+        .engine = ENGINE_FLOAT, .channel = 0, .csv_fs_hz = (uint32_t)SAMPLE_RATE_HZ,
+        .sim_seconds = 0, .ann_path = NULL, .list_path = NULL,
+        .counts_per_mv = ECG_RECORD_COUNTS_PER_MV, .delay = -1,
+        .window_ms = REPLAY_MATCH_WINDOW_MS, .realtime = 0, .r_peak = 0
+    };
+    ECG_Record rec;
+    PT_Config cfg;
+    char ann_default[512];
+    int c;
+
+    while ((c = getopt(argc, argv, "e:c:r:s:a:l:g:d:w:tRh")) != -1) {
+        switch (c) {
+        case 'e':
+            if      (strcmp(optarg, "float") == 0) opt.engine = ENGINE_FLOAT;
+            else if (strcmp(optarg, "block") == 0) opt.engine = ENGINE_BLOCK;
+            else if (strcmp(optarg, "q31") == 0)   opt.engine = ENGINE_Q31;
+            else { usage(argv[0]); return 2; }
+            break;
+        case 'c': opt.channel       = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'r': opt.csv_fs_hz     = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 's': opt.sim_seconds   = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'a': opt.ann_path      = optarg; break;
+        case 'l': opt.list_path     = optarg; break;
+        case 'g': opt.counts_per_mv = strtof(optarg, NULL); break;
+        case 'd': opt.delay         = (int32_t)strtol(optarg, NULL, 10); break;
+        case 'w': opt.window_ms     = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 't': opt.realtime      = 1; break;
+        case 'R': opt.r_peak        = 1; break;
+        default:  usage(argv[0]); return 2;
+        }
+    }
+
+    /* Input */
+    if (opt.sim_seconds > 0u) {
+        memset(&rec, 0, sizeof(rec));
+        rec.fs_hz = (uint32_t)SAMPLE_RATE_HZ;
+        rec.n_samples = opt.sim_seconds * rec.fs_hz;
+        rec.adc = malloc((size_t)rec.n_samples * sizeof(*rec.adc));
+        if (rec.adc == NULL) return 1;
+        ECG_Sim_Init(rec.fs_hz);
+        for (uint32_t i = 0; i < rec.n_samples; i++) rec.adc[i] = ECG_Sim_GetSample();
+        printf("input       simulator, %u s\n", opt.sim_seconds);
+    } else if (optind < argc) {
+        const char *path = argv[optind];
+        if (ends_with(path, ".csv")) {
+            if (ECG_RecordLoadCSV(&rec, path, opt.csv_fs_hz) != 0) return 1;
+        } else {
+            if (ECG_RecordLoadWFDB(&rec, path, opt.channel, opt.counts_per_mv) != 0) return 1;
+            snprintf(ann_default, sizeof(ann_default), "%s.atr", path);
+            if ((opt.ann_path == NULL) && (opt.list_path == NULL) && (access(ann_default, R_OK) == 0)) {
+                opt.ann_path = ann_default;
+            }
+        }
+        printf("input       %s\n", path);
+    } else {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if ((opt.ann_path != NULL) && (ECG_RecordLoadAnnotations(&rec, opt.ann_path) != 0)) return 1;
+    if ((opt.list_path != NULL) && (ECG_RecordLoadBeatList(&rec, opt.list_path) != 0)) return 1;
+
+    if (!PT_ConfigInit(&cfg, rec.fs_hz)) {
+        fprintf(stderr, "pt_replay: %u Hz is outside %u..%u Hz\n",
+                rec.fs_hz, PT_MIN_SAMPLE_RATE_HZ, PT_MAX_SAMPLE_RATE_HZ);
+        return 1;
+    }
+    if (opt.r_peak && (opt.engine != ENGINE_FLOAT)) {
+        fprintf(stderr, "pt_replay: -R needs the float engine\n");
+        return 1;
+    }
+    if ((opt.engine == ENGINE_Q31) && (rec.fs_hz != (uint32_t)SAMPLE_RATE_HZ)) {
+        fprintf(stderr, "pt_replay: the Q31 engine only runs at %u Hz\n", (uint32_t)SAMPLE_RATE_HZ);
+        return 1;
+    }
+    printf("samples     %u @ %u Hz (%.1f s)\n", rec.n_samples, rec.fs_hz,
+           (double)rec.n_samples / (double)rec.fs_hz);
+
+    /* Beats cannot be closer than the refractory period */
+    uint32_t max_det = rec.n_samples / cfg.refractory_samples + 1u;
+    uint32_t *det = malloc((size_t)max_det * sizeof(*det));
+    uint32_t n_det = 0;
+    int bpm = 0;
+    if (det == NULL) return 1;
+
+    /* Timed pass */
+    static const char *const engine_names[] = { "PT_Process", "PT_ProcessBlock", "PT_ProcessQ31" };
+    double ns = replay_run(&opt, &rec, &cfg, det, max_det, &n_det, &bpm);
+    printf("engine      %s%s\n", engine_names[opt.engine], opt.realtime ? " (real time)" : "");
+    printf("throughput  %.0f samples/s, %.2f ns/sample, %.0fx real time\n",
+           (double)rec.n_samples / ns * 1e9, ns / (double)rec.n_samples,
+           (double)rec.n_samples / (double)rec.fs_hz * 1e9 / ns);
+    printf("beats       %u, final BPM %d\n", n_det, bpm);
+    replay_hrv(det, n_det, rec.fs_hz);
+
+    /* Per-stage pass (the other engines have no per-sample stage boundaries) */
+    if (!opt.realtime) replay_stages(&rec, &cfg);
+
+    if (rec.n_ref > 0u) {
+        uint32_t delay  = (opt.delay >= 0) ? (uint32_t)opt.delay : (opt.r_peak ? 0u : default_delay(&cfg));
+        uint32_t window = (opt.window_ms * rec.fs_hz + 500u) / 1000u;
+        replay_score(&rec, det, n_det, delay, window);
+    }
+
+    free(det);
+    ECG_RecordFree(&rec);
+    return 0;
+}
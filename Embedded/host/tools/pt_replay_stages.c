@@ -0,0 +1,22 @@
+/*
+ * Second build of src/pan_tompkins.c with PT_STAGE_MARK timing every stage.
+ * The public functions are renamed (PT_* -> PTS_*) so this copy links next to the
+ * uninstrumented engine in libpan_tompkins, whose timings pt_replay reports as throughput.
+ */
+#define PT_ConfigInit    PTS_ConfigInit
+#define PT_Init          PTS_Init
+#define PT_InitConfig    PTS_InitConfig
+#define PT_Process       PTS_Process
+#define PT_ProcessBlock  PTS_ProcessBlock
+#define PT_ProcessEvent  PTS_ProcessEvent
+#define PT_Rearm         PTS_Rearm
+#define PT_GetBPM        PTS_GetBPM
+
+#include "pt_stage_timer.h"
+
+#define PT_STAGE_MARK(stage) pt_stage_mark(stage)
+
+uint64_t pt_stage_ticks[PT_STAGE_COUNT];
+uint64_t pt_stage_last;
+
+#include "../../src/pan_tompkins.c"
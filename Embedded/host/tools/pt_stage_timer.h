@@ -0,0 +1,45 @@
+#ifndef PT_STAGE_TIMER_H
+#define PT_STAGE_TIMER_H
+
+#include "pan_tompkins.h"
+#include <stdint.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/*
+ * Per-stage accumulators for the instrumented PT_Process copy (pt_replay_stages.c).
+ * pt_stage_start() is called before each sample, PT_STAGE_MARK(stage) charges the
+ * time since the previous mark to `stage`. Ticks are TSC cycles on x86 and
+ * CLOCK_MONOTONIC nanoseconds elsewhere; pt_replay converts them to ns.
+ */
+
+extern uint64_t pt_stage_ticks[PT_STAGE_COUNT];
+extern uint64_t pt_stage_last;
+
+static inline uint64_t pt_stage_now(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static inline void pt_stage_start(void) {
+    pt_stage_last = pt_stage_now();
+}
+
+static inline void pt_stage_mark(PT_Stage stage) {
+    uint64_t t = pt_stage_now();
+    pt_stage_ticks[stage] += t - pt_stage_last;
+    pt_stage_last = t;
+}
+
+/* Instrumented engine, same code as PT_InitConfig/PT_Process */
+void    PTS_InitConfig(PanTompkins_Handle_t *ht, const PT_Config *cfg);
+uint8_t PTS_Process(PanTompkins_Handle_t *ht, uint16_t raw_adc);
+
+#endif /* PT_STAGE_TIMER_H */
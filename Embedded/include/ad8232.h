@@ -2,20 +2,89 @@
 #define AD8232_H
 
 #include "stm32f4xx.h"
+#include "adc_decim.h"
+#include "sample_ring.h"
 #include <stdint.h>
 
+/*
+ * Acquisition: TIM3 TRGO starts every ADC1 conversion in hardware and DMA2 Stream0
+ * writes the results into a circular buffer of two halves. The half-transfer and
+ * transfer-complete interrupts each push one block of AD8232_BLOCK_SIZE samples into
+ * ad8232_ring, so no interrupt runs per sample and sampling has no ISR jitter; the
+ * main loop pops them with SampleRing_Pop().
+ *
+ * With oversampling (ADC_DECIM_FACTORS) the ADC converts at oversample * sample_rate_hz
+ * and the same interrupt decimates each half with adc_decim before queueing it, so the
+ * ring and everything after it still see sample_rate_hz.
+ *
+ * Scan mode: every trigger converts the whole channel list (ADC1 SCAN), so the DMA
+ * buffer holds interleaved frames and every ring entry is one frame in scan order.
+ * Lead channels are decimated with the anti-alias FIR, auxiliary channels (electrode
+ * impedance, battery, accelerometer axis) by averaging each group of conversions.
+ * AD8232_GetChannels() picks the channels of one kind out of a frame, e.g. the lead
+ * frame for PT_Process / PT_MC_Process or the auxiliary values for telemetry.
+ * The timer, the trigger and the block handoff are the same for any channel list.
+ */
+
+/* Output samples per block (one DMA half buffer): 32 = 89ms @ 360Hz, PT_BLOCK_SIZE */
+#define AD8232_BLOCK_SIZE       32u
+
+/* Scan list limits: channels (one ring entry), FIR-decimated leads, conversions per sample */
+#define AD8232_MAX_CHANNELS     SAMPLE_RING_CHANNELS
+#define AD8232_MAX_LEADS        2u
+#define AD8232_MAX_CONVERSIONS  64u     /* channels * oversample: 4 x 16, 2 x 32 */
+#define AD8232_DMA_BUF_SIZE     (2u * AD8232_BLOCK_SIZE * AD8232_MAX_CONVERSIONS)
+
+/* What a scanned input carries */
+typedef enum {
+    AD8232_CH_LEAD = 0,         /* ECG lead (AD8232 OUT) */
+    AD8232_CH_AUX,              /* slow auxiliary input: electrode impedance, battery */
+    AD8232_CH_MOTION            /* accelerometer axis, for motion-artifact flagging */
+} AD8232_ChannelKind;
+
+typedef struct {
+    uint8_t adc_channel;        /* ADC1 IN0-15 (PA0-7, PB0-1, PC0-5); not IN1/IN4 (leads-off pins) */
+    uint8_t kind;               /* AD8232_ChannelKind */
+} AD8232_Channel;
+
 /**
  * Initialize AD8232 ECG module
  * - sample_rate_hz: Desired sampling rate
- * - Configures ADC1 on PA0
- * - Configures TIM3 to generate periodic interrupt
+ * - oversample: conversions per sample, 1 or one of ADC_DECIM_FACTORS (others fall back to 1)
+ * - Configures ADC1 on PA0 (AD8232_InitScan with one lead on IN0)
+ * - Configures TIM3 TRGO at sample_rate_hz * oversample to trigger ADC1
+ * - Configures DMA2 Stream0 (circular, half/full interrupts) for ADC1
  * - Configures PA1, PA4 for Leads Off detection
  */
-void AD8232_Init(uint32_t sample_rate_hz);
+void AD8232_Init(uint32_t sample_rate_hz, uint32_t oversample);
+
+/**
+ * Initialize scanned acquisition of n_ch channels, converted in list order on every
+ * trigger. Same rate and oversample rules as AD8232_Init; channels * oversample is
+ * limited to AD8232_MAX_CONVERSIONS (oversample falls back to 1 beyond it).
+ * - Returns: 0 (nothing started) if the list is empty, too long, has more than
+ *   AD8232_MAX_LEADS leads or uses a leads-off pin, 1 otherwise
+ */
+uint8_t AD8232_InitScan(uint32_t sample_rate_hz, uint32_t oversample, const AD8232_Channel *ch, uint32_t n_ch);
+
+/**
+ * Change the sample rate while running (TIM3 only: scan list, oversampling and the
+ * sample ring are kept; the leads-off debounce follows the new rate). Also re-derives
+ * TIM3 from the current clock tree after an HCLK change (power.h).
+ * - sample_rate_hz: 0 = 360Hz
+ */
+void AD8232_SetRate(uint32_t sample_rate_hz);
+
+/**
+ * De-interleave one frame: copy the values of every channel of `kind` in scan order.
+ * - out: room for AD8232_MAX_CHANNELS values
+ * - Returns: number of values copied
+ */
+uint32_t AD8232_GetChannels(const SampleRing_Entry *s, uint8_t kind, uint16_t *out);
 
 /**
  * Reads ADC value from AD8232 module (blocking).
- * NOTE: in report-matching mode, TIM3_IRQHandler already performs ADC sampling.
+ * NOTE: not for use while acquisition runs, the DMA stream takes every ADC1 result.
  */
 uint16_t AD8232_ReadValue(void);
 
@@ -25,15 +94,41 @@ uint16_t AD8232_ReadValue(void);
  */
 uint8_t AD8232_IsLeadsOff(void);
 
+/*
+ * Leads-off tracking: EXTI1/EXTI4 interrupt on both edges of LO+ (PA1) and LO- (PA4)
+ * latch the pin state and count edges, so even a glitch shorter than a sample period
+ * is seen. AD8232_UpdateLeads() turns that into a debounced state per sample: off at
+ * once, back on only after AD8232_LEADS_DEBOUNCE_MS without any edge.
+ */
+#define AD8232_LEADS_DEBOUNCE_MS  250u
+
+typedef enum {
+    AD8232_LEADS_ON = 0,
+    AD8232_LEADS_OFF,
+    AD8232_LEADS_REARM          /* first sample on after an off period: restart the pipeline */
+} AD8232_LeadsState;
+
+/**
+ * Debounced leads state for the sample with sequence number seq (ring entries in order).
+ * - Returns: AD8232_LeadsState; AD8232_LEADS_REARM once per reconnection
+ */
+uint8_t AD8232_UpdateLeads(uint32_t seq);
+
+/**
+ * Leads-off pin edges seen by the EXTI handlers since boot.
+ */
+extern volatile uint32_t ad8232_lo_edges;
+
 /**
- * Global flag indicating sample ready (set in Timer interrupt)
- * Main loop will check this variable.
+ * Sample ring filled in DMA2_Stream0_IRQHandler: sequence numbers count every
+ * converted sample, `dropped` and `high_water` show whether the main loop keeps up.
  */
-extern volatile uint8_t ad8232_sample_ready;
+extern SampleRing_t ad8232_ring;
 
 /**
- * Latest ADC sample captured in TIM3_IRQHandler.
+ * Longest DMA2_Stream0_IRQHandler run in DWT cycles (queueing and decimation of one
+ * block), to compare with one block period.
  */
-extern volatile uint16_t ad8232_latest_adc;
+extern volatile uint32_t ad8232_isr_cycles_max;
 
 #endif /* AD8232_H */
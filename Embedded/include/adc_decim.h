@@ -0,0 +1,64 @@
+#ifndef ADC_DECIM_H
+#define ADC_DECIM_H
+
+#include "arm_math.h"
+#include <stdint.h>
+
+/*
+ * Oversampled acquisition: the ADC runs at M times the analysis rate and every block of
+ * M * n raw conversions is lowpass filtered and decimated to n output samples with
+ * arm_fir_decimate_f32 (only every M-th output is computed).
+ *
+ * Averaging M conversions lowers the white noise floor by sqrt(M), and the anti-alias
+ * filter removes what lies above half the output rate (mains harmonics, EMG, switching
+ * noise) before it can fold into the ECG band. Outputs are rounded back to ADC units.
+ *
+ * Filters are generated per factor by host/tools/gen_decim_fir.c (src/adc_decim_taps.c)
+ * and designed relative to the output rate, so one table serves 360Hz and 500Hz alike.
+ */
+
+/* Supported factors; the generated filter table follows this order */
+#define ADC_DECIM_FACTORS       { 16u, 32u }
+#define ADC_DECIM_N_FACTORS     2u
+#define ADC_DECIM_MAX_FACTOR    32u
+
+/* Passband edge as a fraction of the output rate (126Hz @ 360Hz); stopband starts at 0.5 */
+#define ADC_DECIM_PASS          0.35
+
+/* Largest filter (generator limit) and output samples per ADC_DecimBlock call */
+#define ADC_DECIM_MAX_TAPS      1024u
+#define ADC_DECIM_MAX_BLOCK     32u
+#define ADC_DECIM_MAX_IN        (ADC_DECIM_MAX_FACTOR * ADC_DECIM_MAX_BLOCK)
+
+typedef struct {
+    uint16_t factor;
+    uint16_t n_taps;
+    const float32_t *taps;
+} ADC_Decim_Filter;
+
+/* src/adc_decim_taps.c */
+extern const ADC_Decim_Filter adc_decim_filters[ADC_DECIM_N_FACTORS];
+
+/* Input conversion to float goes through one scratch buffer shared by all decimators */
+typedef struct {
+    arm_fir_decimate_instance_f32 fir;
+    uint32_t factor;
+    uint32_t block_out;         /* output samples per block */
+    float32_t out[ADC_DECIM_MAX_BLOCK];
+    float32_t state[ADC_DECIM_MAX_TAPS + ADC_DECIM_MAX_IN - 1u];
+} ADC_Decim_t;
+
+/*
+ * Set up decimation by `factor` (one of ADC_DECIM_FACTORS) for blocks of block_out
+ * output samples (<= ADC_DECIM_MAX_BLOCK). Returns 0 if either is unsupported.
+ */
+uint8_t ADC_DecimInit(ADC_Decim_t *d, uint32_t factor, uint32_t block_out);
+
+/*
+ * Filter factor * block_out raw conversions into block_out samples in ADC units.
+ * Both sides are strided for interleaved scan frames: raw[i * stride], out[j * stride]
+ * (stride 1 for a single channel). Not reentrant (shared input scratch).
+ */
+void ADC_DecimBlock(ADC_Decim_t *d, const volatile uint16_t *raw, uint32_t stride, uint16_t *out);
+
+#endif /* ADC_DECIM_H */
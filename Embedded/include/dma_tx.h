@@ -0,0 +1,75 @@
+#ifndef DMA_TX_H
+#define DMA_TX_H
+
+#include "stm32f4xx.h"
+#include "ecg_ser.h"
+#include <stdint.h>
+
+/*
+ * Non-blocking UART transmission through a DMA stream (HC-05 link, hc05.h; debug
+ * output, usart2.h). Writes only copy bytes into a ring; one memory-to-peripheral
+ * transfer covers the contiguous bytes from the tail to the head or the end of the
+ * buffer, and its transfer-complete interrupt (DMA_Tx_IRQHandler) advances the tail and
+ * starts the next region.
+ *
+ * The main loop is the only producer and the DMA interrupt the only consumer, with
+ * free-running head/tail counters as in sample_ring. A record that does not fit in full
+ * is dropped and counted, never cut, so the receiver only loses whole records. Text
+ * records can be formatted in place in the free part of the ring (DMA_Tx_Begin,
+ * ecg_ser.h) and queued by DMA_Tx_Commit, without a copy.
+ *
+ * The owner configures the stream (channel, PAR, CR with DIR_0, MINC, TCIE and TEIE)
+ * and its NVIC line after DMA_Tx_Init, and calls DMA_Tx_IRQHandler from the stream's
+ * interrupt.
+ */
+
+typedef struct {
+    uint8_t *buf;
+    uint32_t size;                  /* bytes, power of two */
+    DMA_Stream_TypeDef *stream;
+    volatile uint32_t *isr;         /* LISR or HISR of the stream's controller */
+    volatile uint32_t *ifcr;        /* LIFCR or HIFCR */
+    uint32_t flag_pos;              /* bit position of the stream's flags in them */
+
+    volatile uint32_t head;         /* producer: bytes queued */
+    volatile uint32_t tail;         /* consumer: bytes handed to the UART */
+    volatile uint32_t dma_len;      /* bytes of the transfer in flight, 0 when idle */
+
+    /* Producer statistics */
+    uint32_t dropped;               /* records that did not fit */
+    uint32_t dropped_bytes;
+    uint32_t high_water;            /* largest occupancy seen after a write */
+} DMA_Tx_t;
+
+/**
+ * Set up an empty ring on stream n (0..7) of controller dma, and disable the stream
+ * and clear its flags
+ * - buf: size bytes, size a power of two
+ */
+void DMA_Tx_Init(DMA_Tx_t *tx, uint8_t *buf, uint32_t size,
+                 DMA_TypeDef *dma, DMA_Stream_TypeDef *stream, uint32_t n);
+
+/**
+ * Queue len bytes for transmission (non-blocking).
+ * - Returns: 1 if queued, 0 if dropped because the ring has less than len bytes free
+ */
+uint8_t DMA_Tx_Write(DMA_Tx_t *tx, const void *data, uint32_t len);
+
+/* Start a text record in the free part of the ring (ECG_SER_TEXT writer); producer only */
+void DMA_Tx_Begin(DMA_Tx_t *tx, ECG_Ser_t *w);
+
+/**
+ * Queue the record written since DMA_Tx_Begin.
+ * - Returns: 1 if queued, 0 if dropped because it did not fit (counted)
+ */
+uint8_t DMA_Tx_Commit(DMA_Tx_t *tx, const ECG_Ser_t *w);
+
+/* Stream interrupt: release the region sent (or failed) and chain the next one */
+void DMA_Tx_IRQHandler(DMA_Tx_t *tx);
+
+/* Bytes that can be queued right now */
+static inline uint32_t DMA_Tx_Free(const DMA_Tx_t *tx) {
+    return tx->size - (tx->head - tx->tail);
+}
+
+#endif /* DMA_TX_H */
@@ -0,0 +1,102 @@
+#ifndef ECG_CMD_H
+#define ECG_CMD_H
+
+#include <stdint.h>
+
+/*
+ * Run-time commands received on the HC-05 RX line, one per line ('\r', '\n' or an idle
+ * line ends it), in the style of the records sent the other way:
+ *
+ *   M,<stream>          stream format: ECG_STREAM_TEXT / BEATS / BINARY / RICE
+ *   R,<hz>              sample rate (restarts the detector and the HRV windows)
+ *   D,<mask>,<decim>    USART2 debug log: USART2_SIG_BIT() mask (0 = off), every decim-th sample
+ *   S,<0|1>             ECG simulator instead of the AD8232
+ *   ?                   no change, only the acknowledgement
+ *
+ * Every command is answered with one record carrying the resulting configuration:
+ *
+ *   K,<cmd>,<status>,<stream>,<rate>,<sim>,<mask>,<decim>
+ *
+ * sent in the stream format that was active when the command arrived (a TEXT frame in
+ * the binary formats), so the receiver can follow a format change.
+ */
+
+#define ECG_STREAM_TEXT     0u      /* "ECG_VALUE,BPM" per sample */
+#define ECG_STREAM_BEATS    1u      /* "W" frames, "B" beats and the periodic records */
+#define ECG_STREAM_BINARY   2u      /* ecg_proto.h SAMPLES and BEAT frames */
+#define ECG_STREAM_RICE     3u      /* ecg_proto.h RICE and BEAT frames */
+#define ECG_STREAM_COUNT    4u
+
+#define ECG_STREAM_IS_BINARY(stream) ((stream) >= ECG_STREAM_BINARY)
+
+/* Status field of the acknowledgement */
+#define ECG_CMD_OK          0u
+#define ECG_CMD_UNKNOWN     1u      /* unknown command letter */
+#define ECG_CMD_BAD_ARG     2u      /* missing, malformed or out-of-range argument */
+
+/* Longest command line, terminator excluded; longer lines are discarded */
+#define ECG_CMD_LINE_MAX    31u
+
+/* Longest acknowledgement record, "\r\n" included */
+#define ECG_CMD_ACK_MAX     64u
+
+/* Complete lines waiting for the main loop, power of two */
+#define ECG_CMD_RX_LINES    4u
+
+/* Settings the commands change */
+typedef struct {
+    uint32_t stream;                /* ECG_STREAM_* */
+    uint32_t sample_rate_hz;
+    uint32_t sim;                   /* 1: ECG simulator */
+    uint32_t log_mask;
+    uint32_t log_decim;
+} ECG_Cmd_Config;
+
+/**
+ * Parse one command line and apply it to cfg; cfg is unchanged unless it returns ECG_CMD_OK.
+ * The sample rate is only checked for being non-zero: the caller validates it against the
+ * detector (PT_ConfigInit) before using it.
+ * - Returns: ECG_CMD_OK, ECG_CMD_UNKNOWN or ECG_CMD_BAD_ARG
+ */
+uint8_t ECG_Cmd_Parse(const char *line, ECG_Cmd_Config *cfg);
+
+/**
+ * Format the acknowledgement of a command (first character of its line) into out
+ * (ECG_CMD_ACK_MAX bytes), "\r\n" included.
+ * - Returns: length
+ */
+uint32_t ECG_Cmd_FormatAck(char *out, char cmd, uint8_t status, const ECG_Cmd_Config *cfg);
+
+/*
+ * Line assembly between the receive interrupt (producer: ECG_Cmd_RxByte, ECG_Cmd_RxEnd)
+ * and the main loop (consumer: ECG_Cmd_RxRead), lock-free like sample_ring.h. A line
+ * longer than ECG_CMD_LINE_MAX, or one that starts while all ECG_CMD_RX_LINES slots
+ * hold unread lines, is discarded at its end and counted in `dropped`; empty lines
+ * (the '\n' of "\r\n", an idle line after a terminator) are ignored.
+ */
+typedef struct {
+    char line[ECG_CMD_RX_LINES][ECG_CMD_LINE_MAX + 1u];
+    volatile uint32_t head;         /* producer: lines completed */
+    volatile uint32_t tail;         /* consumer: lines read */
+
+    /* Producer state and statistics */
+    uint32_t fill;                  /* characters of the line being received */
+    uint8_t  discard;               /* current line too long or no free slot: drop it at its end */
+    uint32_t dropped;               /* lines too long or with the queue full */
+} ECG_Cmd_Rx_t;
+
+/* Producer: one received character; '\r' and '\n' end the line */
+void ECG_Cmd_RxByte(ECG_Cmd_Rx_t *rx, char c);
+
+/* Producer: end of the line being received (terminator or idle line) */
+void ECG_Cmd_RxEnd(ECG_Cmd_Rx_t *rx);
+
+/* Consumer: copy the oldest line, NUL-terminated, into line (ECG_CMD_LINE_MAX + 1 bytes); 0 if none */
+uint8_t ECG_Cmd_RxRead(ECG_Cmd_Rx_t *rx, char *line);
+
+/* Lines waiting (either side) */
+static inline uint32_t ECG_Cmd_RxCount(const ECG_Cmd_Rx_t *rx) {
+    return rx->head - rx->tail;
+}
+
+#endif /* ECG_CMD_H */
@@ -0,0 +1,120 @@
+#ifndef ECG_PROTO_H
+#define ECG_PROTO_H
+
+#include "ecg_rice.h"
+#include <stdint.h>
+
+/*
+ * Binary ECG link protocol, version 1 (HC05_STREAM_BINARY).
+ *
+ * Every frame is CRC-protected, COBS-encoded and terminated by one 0x00 byte, so a
+ * receiver resynchronises at the next 0x00 after any loss or corruption. Before COBS
+ * a frame is (multi-byte fields little-endian):
+ *
+ *   0  ver_type   version << 4 | type
+ *   1  seq        uint16, +1 per frame of any type: a gap counts the frames lost
+ *   3  tick       uint32, tick of the first sample (SAMPLES) or of the R peak (BEAT)
+ *   7  body       per type, below
+ *   .  crc        uint16, CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) of bytes 0 .. body end
+ *
+ *   SAMPLES body: n (uint8, 0..ECG_PROTO_SAMPLES), bpm (uint8),
+ *                 n 12-bit samples packed in pairs, 3 bytes per pair:
+ *                 s0[7:0], s1[3:0] << 4 | s0[11:8], s1[11:4]; an odd last sample takes
+ *                 2 bytes: s[7:0], s[11:8]. n = 0 marks leads off (bpm 0).
+ *   BEAT body:    rr (uint16, samples since the previous beat, 0 = first beat), bpm (uint8)
+ *   RICE body:    n (uint8, 1..ECG_RICE_BLOCK), bpm (uint8), one ecg_rice.h block of n
+ *                 samples up to the CRC (HC05_STREAM_BINARY 2)
+ *   TEXT body:    an ASCII record of the text streams without its "\r\n", up to the CRC
+ *                 (command acknowledgements, ecg_cmd.h); tick = current sample tick
+ *   PROF body:    probe (uint8, prof.h Prof_Probe), count, sum, min, max (uint32 cycles),
+ *                 ECG_PROTO_PROF_BINS log2 histogram counts (uint16); sent on USART2 by
+ *                 PROF_ENABLE builds, tick = current sample tick
+ *
+ * A full SAMPLES frame of 24 samples is 47 bytes, 49 on the link: 2.04 bytes per sample
+ * against 9 for an "ECG_VALUE,BPM\r\n" line. A RICE frame of 128 samples is 1.02 bytes
+ * per sample on the link for the simulator's +-20 LSB and 50Hz mains, 2.07x less than
+ * SAMPLES frames (ecg_rice_bench -s 600), short of the 2.5x goal. The noise alone sets the
+ * limit: even with the waveform predicted exactly, its residuals Rice-code to about 6
+ * bits, 0.87 bytes per sample framed (2.4x). Recorded leads are not measured yet.
+ */
+
+#define ECG_PROTO_VERSION       1u
+
+#define ECG_PROTO_TYPE_SAMPLES  1u
+#define ECG_PROTO_TYPE_BEAT     2u
+#define ECG_PROTO_TYPE_RICE     3u
+#define ECG_PROTO_TYPE_TEXT     4u
+#define ECG_PROTO_TYPE_PROF     5u
+
+/* Longest TEXT record */
+#define ECG_PROTO_TEXT_MAX      64u
+
+/* Histogram bins of a PROF frame */
+#define ECG_PROTO_PROF_BINS     16u
+
+/* Samples per SAMPLES frame: 24 = 67ms @ 360Hz */
+#define ECG_PROTO_SAMPLES       24u
+
+#define ECG_PROTO_HEADER_SIZE   7u
+#define ECG_PROTO_CRC_SIZE      2u
+#define ECG_PROTO_PACKED_SIZE(n) (((n) / 2u) * 3u + ((n) & 1u) * 2u)
+
+/* Largest frame before COBS (a RICE block of verbatim samples), and on the link (COBS adds 1 byte per 254, then the 0x00) */
+#define ECG_PROTO_MAX_RAW       (ECG_PROTO_HEADER_SIZE + 2u + ECG_RICE_MAX_BYTES(ECG_RICE_BLOCK) + ECG_PROTO_CRC_SIZE)
+#define ECG_PROTO_MAX_FRAME     (ECG_PROTO_MAX_RAW + ECG_PROTO_MAX_RAW / 254u + 2u)
+
+typedef struct {
+    uint16_t seq;               /* sequence number of the next frame */
+} ECG_Proto_t;
+
+void ECG_Proto_Init(ECG_Proto_t *p);
+
+/**
+ * Encode a SAMPLES frame into out (ECG_PROTO_MAX_FRAME bytes), 0x00 delimiter included.
+ * - tick: tick of samples[0]
+ * - n: number of samples, at most ECG_PROTO_SAMPLES (0 = leads off)
+ * - bpm: current BPM, clamped to 0..255
+ * - Returns: bytes written
+ */
+uint32_t ECG_Proto_Samples(ECG_Proto_t *p, uint8_t *out, uint32_t tick, const uint16_t *samples, uint32_t n, int bpm);
+
+/**
+ * Encode a BEAT frame into out (ECG_PROTO_MAX_FRAME bytes), 0x00 delimiter included.
+ * - r_tick: R-peak tick, same numbering as the samples
+ * - rr: samples since the previous beat (0 if unknown), clamped to 65535
+ * - Returns: bytes written
+ */
+uint32_t ECG_Proto_Beat(ECG_Proto_t *p, uint8_t *out, uint32_t r_tick, uint32_t rr, int bpm);
+
+/**
+ * Encode a RICE frame (n samples compressed with ecg_rice.h) into out (ECG_PROTO_MAX_FRAME
+ * bytes), 0x00 delimiter included.
+ * - tick: tick of samples[0]
+ * - n: number of samples, 1..ECG_RICE_BLOCK
+ * - Returns: bytes written
+ */
+uint32_t ECG_Proto_Rice(ECG_Proto_t *p, uint8_t *out, uint32_t tick, const uint16_t *samples, uint32_t n, int bpm);
+
+/**
+ * Encode a TEXT frame into out (ECG_PROTO_MAX_FRAME bytes), 0x00 delimiter included.
+ * - len: record length, cut to ECG_PROTO_TEXT_MAX
+ * - Returns: bytes written
+ */
+uint32_t ECG_Proto_Text(ECG_Proto_t *p, uint8_t *out, uint32_t tick, const char *text, uint32_t len);
+
+/**
+ * Encode a PROF frame into out (ECG_PROTO_MAX_FRAME bytes), 0x00 delimiter included.
+ * - stats: count, sum, min, max of the probe
+ * - hist: ECG_PROTO_PROF_BINS histogram counts
+ * - Returns: bytes written
+ */
+uint32_t ECG_Proto_Prof(ECG_Proto_t *p, uint8_t *out, uint32_t tick, uint8_t probe,
+                        const uint32_t *stats, const uint16_t *hist);
+
+/* CRC-16/CCITT-FALSE */
+uint16_t ECG_Proto_CRC16(const uint8_t *data, uint32_t n);
+
+/* COBS-encode n bytes and append the 0x00 delimiter; returns bytes written (<= n + n / 254 + 2) */
+uint32_t ECG_Proto_COBS(const uint8_t *in, uint32_t n, uint8_t *out);
+
+#endif /* ECG_PROTO_H */
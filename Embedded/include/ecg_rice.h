@@ -0,0 +1,47 @@
+#ifndef ECG_RICE_H
+#define ECG_RICE_H
+
+#include <stdint.h>
+
+/*
+ * Lossless block codec for 12-bit ECG samples: fixed linear prediction plus adaptive
+ * Rice coding, in self-contained blocks so every block is a resync point.
+ *
+ * Block bit stream (MSB first):
+ *   x0        12 bits, first sample verbatim
+ *   order      1 bit: 0 = first order (x[i-1]), 1 = second order (2x[i-1] - x[i-2]);
+ *              x1 is always predicted from x0. The encoder takes the order with the
+ *              smaller sum of |residual| over the block.
+ *   partitions of ECG_RICE_PART residuals (the last one shorter), each:
+ *     k        4 bits: Rice parameter 0..14, or ECG_RICE_K_RAW = samples verbatim (12 bits)
+ *     codes    zigzag residual u = 2r (r >= 0) or -2r - 1: q = u >> k as q ones and a
+ *              zero, then the k low bits of u; q >= ECG_RICE_ESC is sent as
+ *              ECG_RICE_ESC ones followed by u in 15 bits
+ * The encoder picks k (or raw) per partition by exact bit cost around log2(mean u),
+ * so noisy stretches and QRS complexes do not inflate the quiet ones.
+ *
+ * The decoder only needs shifts and adds per sample, the same on the phone and the host.
+ */
+
+#define ECG_RICE_BLOCK      128u    /* most samples per block: 356ms @ 360Hz */
+#define ECG_RICE_PART       16u     /* residuals per Rice partition */
+#define ECG_RICE_K_RAW      15u     /* partition stored as 12-bit samples */
+#define ECG_RICE_ESC        16u     /* quotient escape: 16 ones, then u in 15 bits */
+
+/* Worst-case block size in bytes for n samples (every partition verbatim) */
+#define ECG_RICE_MAX_BYTES(n) \
+    ((12u + 1u + (((n) + ECG_RICE_PART - 2u) / ECG_RICE_PART) * 4u + ((n) - 1u) * 12u + 7u) / 8u)
+
+/**
+ * Encode n samples (1..ECG_RICE_BLOCK, 12-bit) into out (ECG_RICE_MAX_BYTES(n) bytes).
+ * - Returns: bytes written (the last byte is zero-padded)
+ */
+uint32_t ECG_Rice_Encode(const uint16_t *x, uint32_t n, uint8_t *out);
+
+/**
+ * Decode n samples from a block of len bytes.
+ * - Returns: bytes used, or 0 if the block is shorter than its codes
+ */
+uint32_t ECG_Rice_Decode(const uint8_t *in, uint32_t len, uint16_t *x, uint32_t n);
+
+#endif /* ECG_RICE_H */
@@ -0,0 +1,161 @@
+#ifndef ECG_SER_H
+#define ECG_SER_H
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Record serializer without sprintf, heap or intermediate buffer.
+ *
+ * A writer appends to a span of bytes. The span is either a linear buffer or the free
+ * part of a transmit ring (power-of-two size, written modulo its size: HC05_Begin,
+ * USART2_Begin), so a record is formatted straight into the ring and queued by
+ * publishing the new head. A record longer than the span keeps counting its length but
+ * stores nothing more; the caller sees ECG_Ser_Fits() == 0 and drops it whole.
+ *
+ * Decimal conversion writes two digits per division by 100 from a digit-pair table.
+ * The firmware's records take 2.5-3x fewer cycles than glibc's sprintf plus the ring
+ * copy on an x86 host (host/tools/ecg_ser_bench); SER_BENCHMARK in main.c measures
+ * the same records against newlib on the target.
+ *
+ * Records are built with one API in two formats: the mode of the writer decides what
+ * the field writers produce.
+ *
+ *   call                       ECG_SER_TEXT                    ECG_SER_BIN
+ *   ECG_Ser_Tag(c)             c                               c
+ *   ECG_Ser_FieldU(v, n)       ',' decimal v                   v as n little-endian bytes
+ *   ECG_Ser_FieldS(v, n)       ',' decimal v, '-' if < 0       v as n bytes, two's complement
+ *   ECG_Ser_FieldFix(v, d, n)  ',' v / 10^d with d decimals    v as n bytes
+ *   ECG_Ser_End()              "\r\n"                          nothing
+ *
+ * so the same code sends a record as a CSV line or packs it: hc05.c writes its text
+ * records this way, ecg_proto.c the header and the BEAT and PROF bodies of its frames.
+ * The plain writers (ECG_Ser_Dec, ECG_Ser_U16, ...) produce one format whatever the
+ * mode.
+ */
+
+#define ECG_SER_TEXT        0u
+#define ECG_SER_BIN         1u
+
+/* Longest decimal uint32_t; an int32_t adds the sign */
+#define ECG_SER_DEC_MAX     10u
+
+typedef struct {
+    uint8_t *buf;
+    uint32_t mask;              /* ring size - 1; UINT32_MAX for a linear buffer */
+    uint32_t start;             /* position of the first byte of the record */
+    uint32_t pos;               /* position of the next byte, also past room */
+    uint32_t room;              /* bytes the record may take */
+    uint8_t  mode;              /* ECG_SER_TEXT or ECG_SER_BIN */
+} ECG_Ser_t;
+
+/* Writer over a linear buffer of size bytes */
+void ECG_Ser_Buffer(ECG_Ser_t *w, void *buf, uint32_t size, uint8_t mode);
+
+/**
+ * Writer over the free part of a ring
+ * - ring, size: storage, size a power of two
+ * - head: free-running producer counter; the record starts at ring[head & (size - 1)]
+ * - room: free bytes from head on
+ */
+void ECG_Ser_Ring(ECG_Ser_t *w, uint8_t *ring, uint32_t size, uint32_t head, uint32_t room, uint8_t mode);
+
+/* Bytes written so far, stored or not */
+static inline uint32_t ECG_Ser_Len(const ECG_Ser_t *w) {
+    return w->pos - w->start;
+}
+
+/* 1 while everything written so far was stored */
+static inline uint8_t ECG_Ser_Fits(const ECG_Ser_t *w) {
+    return (w->pos - w->start) <= w->room;
+}
+
+static inline void ECG_Ser_Byte(ECG_Ser_t *w, uint8_t b) {
+    if ((w->pos - w->start) < w->room) w->buf[w->pos & w->mask] = b;
+    w->pos++;
+}
+
+void ECG_Ser_Bytes(ECG_Ser_t *w, const void *data, uint32_t n);
+
+static inline void ECG_Ser_Str(ECG_Ser_t *w, const char *s) {
+    ECG_Ser_Bytes(w, s, (uint32_t)strlen(s));
+}
+
+/* Decimal ASCII, no padding */
+void ECG_Ser_Dec(ECG_Ser_t *w, uint32_t v);
+void ECG_Ser_DecS(ECG_Ser_t *w, int32_t v);
+
+/* Decimal ASCII, zero-padded to at least width digits (ECG_SER_DEC_MAX at most) */
+void ECG_Ser_DecW(ECG_Ser_t *w, uint32_t v, uint32_t width);
+
+/* Fixed point: v / 10^frac_digits with frac_digits decimals, e.g. (1234, 2) -> "12.34", (-5, 1) -> "-0.5" */
+void ECG_Ser_Fix(ECG_Ser_t *w, int32_t v, uint32_t frac_digits);
+
+/* Binary packers, little-endian */
+static inline void ECG_Ser_U8(ECG_Ser_t *w, uint8_t v) {
+    ECG_Ser_Byte(w, v);
+}
+
+static inline void ECG_Ser_U16(ECG_Ser_t *w, uint16_t v) {
+    ECG_Ser_Byte(w, (uint8_t)v);
+    ECG_Ser_Byte(w, (uint8_t)(v >> 8));
+}
+
+static inline void ECG_Ser_U32(ECG_Ser_t *w, uint32_t v) {
+    ECG_Ser_Byte(w, (uint8_t)v);
+    ECG_Ser_Byte(w, (uint8_t)(v >> 8));
+    ECG_Ser_Byte(w, (uint8_t)(v >> 16));
+    ECG_Ser_Byte(w, (uint8_t)(v >> 24));
+}
+
+/* The low n bytes of v (1, 2 or 4) */
+static inline void ECG_Ser_UN(ECG_Ser_t *w, uint32_t v, uint32_t n) {
+    if (n == 1u) {
+        ECG_Ser_U8(w, (uint8_t)v);
+    } else if (n == 2u) {
+        ECG_Ser_U16(w, (uint16_t)v);
+    } else {
+        ECG_Ser_U32(w, v);
+    }
+}
+
+/* Record fields in the format of the writer (table above); n = bytes in ECG_SER_BIN */
+static inline void ECG_Ser_Tag(ECG_Ser_t *w, char tag) {
+    ECG_Ser_Byte(w, (uint8_t)tag);
+}
+
+static inline void ECG_Ser_FieldU(ECG_Ser_t *w, uint32_t v, uint32_t n) {
+    if (w->mode == ECG_SER_BIN) {
+        ECG_Ser_UN(w, v, n);
+    } else {
+        ECG_Ser_Byte(w, ',');
+        ECG_Ser_Dec(w, v);
+    }
+}
+
+static inline void ECG_Ser_FieldS(ECG_Ser_t *w, int32_t v, uint32_t n) {
+    if (w->mode == ECG_SER_BIN) {
+        ECG_Ser_UN(w, (uint32_t)v, n);
+    } else {
+        ECG_Ser_Byte(w, ',');
+        ECG_Ser_DecS(w, v);
+    }
+}
+
+static inline void ECG_Ser_FieldFix(ECG_Ser_t *w, int32_t v, uint32_t frac_digits, uint32_t n) {
+    if (w->mode == ECG_SER_BIN) {
+        ECG_Ser_UN(w, (uint32_t)v, n);
+    } else {
+        ECG_Ser_Byte(w, ',');
+        ECG_Ser_Fix(w, v, frac_digits);
+    }
+}
+
+static inline void ECG_Ser_End(ECG_Ser_t *w) {
+    if (w->mode != ECG_SER_BIN) {
+        ECG_Ser_Byte(w, '\r');
+        ECG_Ser_Byte(w, '\n');
+    }
+}
+
+#endif /* ECG_SER_H */
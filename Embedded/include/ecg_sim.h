@@ -5,8 +5,11 @@
 #include "arm_math.h"
 #include <stdint.h>
 
-/* Initialize ECG simulator */
-void ECG_Sim_Init(void);
+/**
+ * Initialize ECG simulator: 60 BPM, 0.5Hz wander and 50Hz mains at the sample rate the
+ * samples are taken at (0 = 360Hz)
+ */
+void ECG_Sim_Init(uint32_t sample_rate_hz);
 
 /* Get simulated ECG sample returns 12-bit value 0-4095 */
 uint16_t ECG_Sim_GetSample(void);
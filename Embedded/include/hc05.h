@@ -2,27 +2,238 @@
 #define HC05_H
 
 #include "stm32f4xx.h"
-#include <stdio.h>
+#include "hrv.h"
+#include "hrv_freq.h"
+#include "ecg_proto.h"
+#include "ecg_cmd.h"
+#include "ecg_ser.h"
+#include "dma_tx.h"
+#include "health.h"
+#include "sched.h"
 #include <string.h>
 
-/* Buffer size for sprintf in main */
-#define HC05_BUFFER_SIZE 50
+/* Beat-mode stream: raw samples per "W" waveform frame */
+#define HC05_FRAME_SAMPLES  12u
 
 #define HC05_BAUDRATE       115200UL
-#define APB2_CLOCK_FREQ     84000000UL
+
+/*
+ * Transmission: HC05_Send* only copy a record into hc05_tx, a dma_tx.h ring that DMA2
+ * Stream7 (channel 4) drains into USART1, so the main loop never waits on the UART.
+ * A record that does not fit in full is dropped and counted, never cut, so the receiver
+ * only loses whole lines. The text records are formatted in place in the free part of
+ * the ring (HC05_Begin, ecg_ser.h) and queued by HC05_Commit, without sprintf or a copy.
+ */
+
+/* Ring bytes, power of two: 1024 = 89ms of line time @ 115200 baud */
+#define HC05_TX_SIZE        1024u
+
+extern DMA_Tx_t hc05_tx;
+
+/*
+ * Reception: the USART1 interrupt (RXNE and IDLE) collects command lines; '\r', '\n' or
+ * an idle line (a command sent without terminator) ends one. Complete lines wait in a
+ * small queue (ECG_Cmd_Rx_t) for the main loop, which reads them between samples with
+ * HC05_ReadLine. Lines longer than ECG_CMD_LINE_MAX and lines arriving while the queue
+ * is full are dropped and counted.
+ */
+
+typedef struct {
+    ECG_Cmd_Rx_t lines;
+    uint32_t errors;                /* overrun, framing or noise errors */
+} HC05_Rx_t;
+
+extern HC05_Rx_t hc05_rx;
 
 /**
  * Initialize HC-05 Bluetooth Module
  * - Configures GPIOA PA9 as TX and PA10 as RX
- * - Configures USART1 with 9600 baudrate
+ * - Configures USART1 with HC05_BAUDRATE baudrate
+ * - Configures DMA2 Stream7 Channel4 (USART1 TX) and its transfer-complete interrupt
+ * - Enables the USART1 receive and idle-line interrupts for command lines
  */
 void HC05_Init(void);
 
-/* Send single character */
-void HC05_SendChar(char c);
+/* USART1 baud rate divider from the current PCLK2 (again after an HCLK change, power.h; transmitter idle) */
+void HC05_SetClock(void);
+
+/**
+ * Take the oldest received command line (non-blocking).
+ * - line: ECG_CMD_LINE_MAX + 1 bytes, NUL-terminated
+ * - Returns: 1 if a line was copied, 0 if none is waiting
+ */
+uint8_t HC05_ReadLine(char *line);
+
+/**
+ * Queue len bytes for transmission (non-blocking).
+ * - Returns: 1 if queued, 0 if dropped because the ring has less than len bytes free
+ */
+uint8_t HC05_Write(const char *data, uint32_t len);
+
+/* Bytes that can be queued right now */
+static inline uint32_t HC05_TxFree(void) {
+    return DMA_Tx_Free(&hc05_tx);
+}
+
+/**
+ * Start a record in the free part of hc05_tx (ECG_SER_TEXT writer); nothing is queued
+ * until HC05_Commit. Only the main loop may write between the two calls.
+ */
+void HC05_Begin(ECG_Ser_t *w);
+
+/**
+ * Queue the record written since HC05_Begin.
+ * - Returns: 1 if queued, 0 if dropped because it did not fit (counted like HC05_Write)
+ */
+uint8_t HC05_Commit(const ECG_Ser_t *w);
+
+/* Queue single character */
+uint8_t HC05_SendChar(char c);
+
+/* Queue string; returns 0 if it was dropped */
+uint8_t HC05_SendString(char *str);
+
+/* Send one sample of the text stream: "<ECG_VALUE>,<BPM>\r\n" */
+void HC05_SendSample(uint16_t value, int bpm);
+
+/**
+ * Send a waveform frame: "W,<tick>,<v0>,...,<vn-1>\r\n"
+ * - tick: tick of samples[0]
+ * - n: number of samples, at most HC05_FRAME_SAMPLES
+ */
+void HC05_SendFrame(uint32_t tick, const uint16_t *samples, uint32_t n);
+
+/**
+ * Send auxiliary inputs: "A,<tick>,<v0>,...,<vn-1>\r\n"
+ * - tick: tick of the sample the values belong to
+ * - v: n raw ADC values, AD8232_CH_AUX channels then AD8232_CH_MOTION, in scan order
+ */
+void HC05_SendAux(uint32_t tick, const uint16_t *v, uint32_t n);
+
+/**
+ * Send a beat record: "B,<r_tick>,<rr>,<amplitude>,<signal>,<noise>,<bpm>\r\n"
+ * - r_tick: R-peak tick, same numbering as the frames
+ * - rr: samples since the previous beat
+ * - amplitude: band-passed R-peak value
+ * - signal, noise: detector levels on the integrated signal
+ * - bpm: BPM after this beat
+ */
+void HC05_SendBeat(uint32_t r_tick, uint32_t rr, int32_t amplitude, int32_t signal, int32_t noise, int bpm);
+
+/**
+ * Send a reconnection record: "L,<off_ms>,<first_bpm_ms>,<bpm>\r\n"
+ * - off_ms: leads off until the re-arm (debounce included)
+ * - first_bpm_ms: re-arm until the first BPM of the new connection, which is bpm
+ */
+void HC05_SendLeads(uint32_t off_ms, uint32_t first_bpm_ms, int bpm);
+
+/**
+ * Send a binary SAMPLES frame (ecg_proto.h), sequence numbered across all binary frames
+ * - tick: tick of samples[0]
+ * - n: number of samples, at most ECG_PROTO_SAMPLES; 0 reports leads off
+ */
+void HC05_SendSamplesBin(uint32_t tick, const uint16_t *samples, uint32_t n, int bpm);
+
+/**
+ * Send a binary RICE frame (ecg_proto.h, ecg_rice.h): the samples losslessly compressed
+ * - tick: tick of samples[0]
+ * - n: number of samples, 1..ECG_RICE_BLOCK
+ */
+void HC05_SendRiceBin(uint32_t tick, const uint16_t *samples, uint32_t n, int bpm);
+
+/**
+ * Send a text record in the current stream format: as is in the text streams, as a TEXT
+ * frame (ecg_proto.h) without its "\r\n" in the binary ones
+ * - tick: current sample tick, for the TEXT frame header
+ */
+void HC05_SendRecord(uint8_t binary, uint32_t tick, const char *record, uint32_t len);
+
+/**
+ * Send a binary BEAT frame (ecg_proto.h)
+ * - r_tick: R-peak tick, same numbering as the samples
+ * - rr: samples since the previous beat, 0 if unknown
+ */
+void HC05_SendBeatBin(uint32_t r_tick, uint32_t rr, int bpm);
+
+/**
+ * Send HRV metrics of one window:
+ * "H,<window>,<n_rr>,<mean_rr_ms>,<sdnn_ms>,<rmssd_ms>,<pnn50>,<hr_min>,<hr_max>\r\n"
+ * - window: HRV_WINDOW_1MIN or HRV_WINDOW_5MIN
+ * - times in ms with one decimal, pnn50 in % with one decimal
+ */
+void HC05_SendHRV(uint32_t window, const HRV_Metrics *m);
+
+/**
+ * Send frequency-domain HRV and its scheduling cost:
+ * "F,<span_s>,<lf_ms2>,<hf_ms2>,<total_ms2>,<lf_hf>,<worst_slice_cycles>,<budget_cycles>,<overruns>\r\n"
+ * - powers in ms^2 (integers), lf_hf with two decimals
+ * - worst_slice_cycles: longest HRV_FreqStep slice so far; budget_cycles: one sample period
+ * - overruns: samples the main loop missed (ad8232_ring.dropped)
+ */
+void HC05_SendHRVFreq(const HRV_FreqResult *r, uint32_t worst_slice_cycles, uint32_t budget_cycles, uint32_t overruns);
+
+/**
+ * Send acquisition statistics:
+ * "S,<seq>,<dropped>,<high_water>,<size>,<isr_cycles>,<block_cycles>\r\n"
+ * - seq: sequence number of the sample being processed
+ * - dropped: samples lost to a full ring since boot
+ * - high_water: largest ring occupancy seen, out of size entries
+ * - isr_cycles: longest acquisition interrupt (decimation included); block_cycles: one block period
+ */
+void HC05_SendRingStats(uint32_t seq, uint32_t dropped, uint32_t high_water, uint32_t size,
+                        uint32_t isr_cycles, uint32_t block_cycles);
+
+/**
+ * Send transmit statistics of hc05_tx:
+ * "T,<sent>,<dropped>,<dropped_bytes>,<high_water>,<size>\r\n"
+ * - sent: bytes handed to USART1 since boot
+ * - dropped, dropped_bytes: records (and their bytes) lost to a full ring
+ * - high_water: largest ring occupancy seen, out of size bytes
+ */
+void HC05_SendTxStats(void);
+
+/**
+ * Send the statistics of one main-loop task (sched.h):
+ * "Q,<id>,<name>,<jobs>,<misses>,<merged>,<wcet>,<max_response>,<deadline>\r\n"
+ * - jobs, misses: jobs completed, and those completed after their deadline
+ * - merged: releases that found the previous job still pending
+ * - wcet: longest slice; max_response: longest release to completion; all in cycles
+ */
+void HC05_SendTaskStats(uint32_t id, const Sched_Task *t);
+
+/**
+ * Send the self-test results: "Y,<acq_stalls>,<tx_stalls>,<pt_faults>,<stack_used>,<stack_size>\r\n"
+ * - acq_stalls: self-test periods without a new sample
+ * - tx_stalls: periods in which the HC-05 transmit DMA made no progress
+ * - pt_faults: detector state found not finite (the detector was re-armed)
+ * - stack_used: deepest stack use seen, out of stack_size bytes reserved
+ */
+void HC05_SendSelfTest(uint32_t acq_stalls, uint32_t tx_stalls, uint32_t pt_faults,
+                       uint32_t stack_used, uint32_t stack_size);
 
-/* Send string */
-void HC05_SendString(char *str);
+/**
+ * Send the duty cycle of the last second (power.h):
+ * "P,<level>,<hclk_hz>,<awake_cycles>,<duty_permille>,<wakeups>,<switches>\r\n"
+ * - level, hclk_hz: HCLK level and frequency
+ * - awake_cycles: cycles not spent idle or asleep; duty_permille: the same out of hclk_hz
+ * - wakeups: WFI exits; switches: HCLK changes since boot
+ */
+void HC05_SendPower(uint32_t level, uint32_t hclk_hz, uint32_t awake_cycles, uint32_t duty_permille,
+                    uint32_t wakeups, uint32_t switches);
+
+/**
+ * Send the health counters of the last second (health.h) in the current stream format,
+ * like HC05_SendRecord:
+ * "G,<acquired>,<processed>,<overruns>,<late>,<tx_bytes>,<tx_dropped>,<dbg_dropped>,
+ *    <loop_max_us>,<leads_off_ms>,<reset_cause>,<wdt_resets>,<stall_task>\r\n"
+ * - acquired, processed: samples the acquisition produced and the main loop processed
+ * - overruns: samples lost to a full sample ring; late: sample-task deadline misses
+ * - tx_bytes, tx_dropped: bytes queued and dropped on the HC-05 link; dbg_dropped: USART2 lines dropped
+ * - loop_max_us: longest scheduler slice; leads_off_ms: time with the leads off
+ * - reset_cause: HEALTH_RESET_* of the last reset; wdt_resets: watchdog resets since power-on
+ * - stall_task: task id the last watchdog reset interrupted, 255 if none
+ */
+void HC05_SendHealth(uint8_t binary, uint32_t tick, const Health_t *h);
 
 #ifdef __cplusplus
 }
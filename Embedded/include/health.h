@@ -0,0 +1,112 @@
+#ifndef HEALTH_H
+#define HEALTH_H
+
+#include "stm32f4xx.h"
+#include "sched.h"
+#include <stdint.h>
+
+/*
+ * Run-time health: per-second counters and the independent watchdog.
+ *
+ * The main loop refreshes the IWDG after a scheduler slice (Health_Slice), but only if
+ * the sample task has taken samples since the previous refresh (Health_WatchdogFeed):
+ * the periodic soft tasks (self-test, stack check) cannot keep it alive on their own.
+ * The sample task runs at least once per DMA block (320ms at the lowest rate, 100Hz),
+ * so a loop that stops processing samples for HEALTH_WDT_MS resets the device: a slice
+ * that never returns, an interrupt storm, or an acquisition that stopped. The watchdog
+ * runs on the LSI (17..47kHz), so the timeout is 0.7..1.9s; it is frozen while a
+ * debugger halts the core. host/tests/test_health.c runs the stall path.
+ *
+ * The scheduler writes the id of the running slice to RTC backup register 0
+ * (Sched_SetTrace), and backup register 1 counts watchdog resets; both survive a reset,
+ * not a power cycle. At boot Health_Init() reads the reset cause from RCC_CSR and,
+ * after a watchdog reset, the task that was running, and logs them on USART2.
+ *
+ * Every second of samples Health_Account() closes the counters below. They go out
+ * in-band on the HC-05 link, in every stream format, as a "G" record (HC05_SendHealth).
+ */
+
+/* Watchdog timeout at the nominal 32kHz LSI, 1..4095 */
+#define HEALTH_WDT_MS       1000u
+
+/* Reset causes, from RCC_CSR */
+#define HEALTH_RESET_POWER      0u      /* power-on or brown-out */
+#define HEALTH_RESET_PIN        1u      /* NRST: reset button or debugger */
+#define HEALTH_RESET_SOFTWARE   2u      /* NVIC_SystemReset */
+#define HEALTH_RESET_IWDG       3u      /* independent watchdog: the main loop stalled */
+#define HEALTH_RESET_WWDG       4u
+#define HEALTH_RESET_LOW_POWER  5u
+
+typedef struct {
+    /* Since the last Health_Account */
+    uint32_t processed;             /* samples taken from ad8232_ring */
+    uint32_t leads_off;             /* of them, with the leads off */
+    uint32_t loop_max;              /* longest scheduler slice, cycles */
+
+    /* Watchdog feed */
+    uint32_t samples;               /* samples taken from ad8232_ring since boot */
+    uint32_t wdt_samples;           /* samples at the last watchdog refresh */
+
+    /* Counters at the last Health_Account */
+    uint32_t last_seq;              /* ad8232_ring.next_seq */
+    uint32_t last_overruns;         /* ad8232_ring.dropped */
+    uint32_t last_tx_bytes;         /* hc05_tx.head */
+    uint32_t last_tx_dropped;       /* hc05_tx.dropped_bytes */
+    uint32_t last_dbg_dropped;      /* usart2_tx.dropped */
+
+    /* Last second of samples */
+    uint32_t acquired_s;            /* samples the acquisition produced */
+    uint32_t processed_s;           /* samples the main loop processed */
+    uint32_t overruns_s;            /* samples lost to a full sample ring */
+    uint32_t late_s;                /* sample-task deadline misses */
+    uint32_t tx_bytes_s;            /* bytes queued on the HC-05 link */
+    uint32_t tx_dropped_s;          /* bytes dropped on the HC-05 link */
+    uint32_t dbg_dropped_s;         /* USART2 lines dropped */
+    uint32_t loop_max_us;           /* longest slice */
+    uint32_t leads_off_ms;          /* time with the leads off */
+
+    /* Since boot */
+    uint8_t  reset_cause;           /* HEALTH_RESET_* */
+    uint8_t  stall_task;            /* after a watchdog reset: task id it interrupted, else SCHED_NONE */
+    uint32_t wdt_resets;            /* watchdog resets since power-on */
+} Health_t;
+
+extern Health_t health;
+
+/**
+ * Read and clear the reset cause, log it on USART2, trace the slices of s in the backup
+ * domain and start the watchdog; call once the loop is about to run (it cannot be stopped)
+ */
+void Health_Init(Sched_t *s);
+
+/**
+ * After a scheduler slice that began at DWT->CYCCNT t0: longest slice, and the watchdog
+ * refresh when Health_WatchdogFeed allows it
+ */
+void Health_Slice(uint32_t t0);
+
+/* Sample task: one sample taken from ad8232_ring, and one found with the leads off */
+static inline void Health_Sample(void) {
+    health.processed++;
+    health.samples++;
+}
+
+/* Whether the watchdog may be refreshed: samples were taken since the last time it was */
+static inline uint8_t Health_WatchdogFeed(Health_t *h) {
+    if (h->samples == h->wdt_samples) return 0;
+    h->wdt_samples = h->samples;
+    return 1;
+}
+
+static inline void Health_LeadsOff(void) {
+    health.leads_off++;
+}
+
+/**
+ * Close one second of samples
+ * - sample_rate_hz: for the leads-off time
+ * - sample_misses: sample-task deadline misses in that second
+ */
+void Health_Account(uint32_t sample_rate_hz, uint32_t sample_misses);
+
+#endif /* HEALTH_H */
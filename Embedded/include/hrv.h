@@ -0,0 +1,106 @@
+#ifndef HRV_H
+#define HRV_H
+
+#include "pan_tompkins.h"
+#include <stdint.h>
+
+/*
+ * Incremental heart-rate variability over sliding time windows (1 min and 5 min by default).
+ *
+ * RR intervals (in samples) go into one ring shared by all windows. Each window keeps
+ * running sums that are updated as an interval enters it and as the oldest ones leave,
+ * so adding a beat is O(1) amortized and nothing is recomputed over the history:
+ * - mean RR / SDNN: Welford mean and M2, with the matching removal step
+ * - RMSSD / pNN50: sum of squared successive differences and count of |diff| > 50ms
+ * - min/max HR: monotonic queues of the shortest/longest RR in the window
+ *
+ * Intervals outside (PT_BPM_MIN, PT_BPM_MAX) are rejected, and a rejected interval or
+ * HRV_Break() (leads off) ends the successive-difference chain: no difference is taken
+ * across the gap.
+ */
+
+/* Window indices and default spans */
+#define HRV_WINDOW_1MIN       0u
+#define HRV_WINDOW_5MIN       1u
+#define HRV_N_WINDOWS         2u
+#define HRV_WINDOW_1MIN_S     60u
+#define HRV_WINDOW_5MIN_S     300u
+
+/* RR ring: 5 min at PT_BPM_MAX is 1000 beats. A window that would hold more drops its oldest */
+#define HRV_RR_RING_SIZE      1024u
+#define HRV_RR_RING_MASK      (HRV_RR_RING_SIZE - 1u)
+
+/* Ring entry: RR in samples (< 32768) with bit 15 set if it follows the previous entry without a gap */
+#define HRV_RR_LINKED         0x8000u
+#define HRV_RR_VALUE_MASK     0x7FFFu
+
+/* pNN50 threshold */
+#define HRV_NN50_MS           50u
+
+typedef struct {
+    uint32_t span_samples;      /* window length (sum of its RR intervals stays <= span) */
+    uint16_t head;              /* ring sequence number of the oldest interval in the window */
+    uint16_t count;             /* intervals in the window */
+    uint32_t rr_sum;            /* sum of the window's intervals, in samples */
+
+    /* Welford running mean / sum of squared deviations of RR (double: updated once per beat) */
+    double   mean;
+    double   m2;
+
+    /* Successive differences between linked intervals inside the window */
+    uint64_t diff_sq_sum;
+    uint16_t n_diff;
+    uint16_t nn50;
+
+    /* Monotonic queues of ring sequence numbers: RR increasing (min first) / decreasing (max first) */
+    uint16_t min_q[HRV_RR_RING_SIZE];
+    uint16_t max_q[HRV_RR_RING_SIZE];
+    uint16_t min_head, min_tail;
+    uint16_t max_head, max_tail;
+} HRV_Window_t;
+
+typedef struct {
+    uint32_t sample_rate_hz;
+    uint32_t bpm_num;           /* 60 * Fs */
+    uint32_t nn50_num;          /* HRV_NN50_MS * Fs: |diff| * 1000 > nn50_num counts toward pNN50 */
+
+    /* RR ring, indexed by free-running sequence number & HRV_RR_RING_MASK */
+    uint16_t rr[HRV_RR_RING_SIZE];
+    uint16_t tail;              /* sequence number of the next interval */
+    uint8_t  linked;            /* next interval continues the chain */
+
+    uint32_t rejected;          /* intervals rejected as out of range */
+
+    HRV_Window_t win[HRV_N_WINDOWS];
+} HRV_Handle_t;
+
+/* Metrics of one window; all zero until the window holds two intervals */
+typedef struct {
+    uint16_t  n_rr;             /* intervals in the window */
+    float32_t mean_rr_ms;
+    float32_t sdnn_ms;          /* sample standard deviation of RR */
+    float32_t rmssd_ms;         /* root mean square of successive differences */
+    float32_t pnn50;            /* % of successive differences > 50ms */
+    uint16_t  hr_min;           /* BPM of the longest RR */
+    uint16_t  hr_max;           /* BPM of the shortest RR */
+} HRV_Metrics;
+
+/* Initialize with the 1 min / 5 min windows */
+void HRV_Init(HRV_Handle_t *h, uint32_t sample_rate_hz);
+
+/* Initialize with custom window spans in seconds */
+void HRV_InitWindows(HRV_Handle_t *h, uint32_t sample_rate_hz, const uint32_t span_s[HRV_N_WINDOWS]);
+
+/*
+ * Add one RR interval in samples (e.g. PT_BeatEvent.rr). Returns 1 if accepted,
+ * 0 if rejected as outside the BPM range.
+ */
+uint8_t HRV_AddRR(HRV_Handle_t *h, uint32_t rr_samples);
+
+/* Mark a gap in the beat sequence (leads off, lost beats): the next interval is not differenced */
+void HRV_Break(HRV_Handle_t *h);
+
+/* Metrics of window w (HRV_WINDOW_1MIN, HRV_WINDOW_5MIN) */
+void HRV_GetMetrics(const HRV_Handle_t *h, uint32_t w, HRV_Metrics *m);
+
+#endif /* HRV_H */
@@ -0,0 +1,136 @@
+#ifndef HRV_FREQ_H
+#define HRV_FREQ_H
+
+#include "hrv.h"
+#include "arm_math.h"
+#include <stdint.h>
+
+/*
+ * Frequency-domain HRV (LF, HF, total power) from the RR ring of an HRV_Handle_t.
+ *
+ * HRV_FreqStart() takes the newest gap-free run of the 5 min window (at most 5 min),
+ * and HRV_FreqStep() then works through it one bounded slice per call:
+ * 1) SCAN: walk back over the run to find its start (HRV_FREQ_SCAN_CHUNK beats per slice)
+ * 2) RESAMPLE: cubic Hermite interpolation of the RR tachogram (tangents from the
+ *    neighbouring beats, so it needs no global spline solve) onto a 4Hz grid ending at
+ *    the newest beat (HRV_FREQ_RESAMPLE_CHUNK points per slice)
+ * 3) per 64s segment (Welch, 50% overlap, the last one ending at the newest beat):
+ *    WINDOW (mean removal + Hann), FFT (arm_rfft_fast_f32), ACCUM (|X|^2 into the PSD)
+ * 4) BANDS: integrate VLF/LF/HF, publish the result
+ *
+ * Slices are meant for the idle time between samples: the main loop calls
+ * HRV_FreqStep() only when no sample is pending. Every slice is timed with
+ * HRV_FREQ_CYCLES() (DWT->CYCCNT by default) and the worst case is kept per slice
+ * type, so it can be compared with the sample period.
+ *
+ * Bands (Task Force 1996): VLF < 0.04Hz, LF 0.04-0.15Hz, HF 0.15-0.40Hz, total < 0.40Hz.
+ */
+
+#define HRV_FREQ_FS_HZ          4u
+#define HRV_FREQ_FFT_LEN        256u    /* 64s segments, 4/256 = 0.0156Hz bins */
+#define HRV_FREQ_SEG_STEP       128u    /* 50% overlap */
+#define HRV_FREQ_MAX_SAMPLES    1200u   /* 5 min @ 4Hz */
+#define HRV_FREQ_N_BINS         (HRV_FREQ_FFT_LEN / 2u + 1u)
+
+/* Slice sizes */
+#define HRV_FREQ_SCAN_CHUNK     128u    /* beats walked per SCAN slice */
+#define HRV_FREQ_RESAMPLE_CHUNK 64u     /* grid points per RESAMPLE slice */
+
+/* Beats kept clear of the ring slots new beats overwrite while a run is analysed */
+#define HRV_FREQ_RING_MARGIN    64u
+
+/* Band edges in bins of HRV_FREQ_FS_HZ / HRV_FREQ_FFT_LEN (bin k is k * 0.015625Hz) */
+#define HRV_FREQ_LF_FIRST_BIN   3u      /* 0.047Hz, first bin >= 0.04Hz */
+#define HRV_FREQ_HF_FIRST_BIN   10u     /* 0.156Hz, first bin >= 0.15Hz */
+#define HRV_FREQ_HF_END_BIN     26u     /* 0.406Hz, first bin >= 0.40Hz */
+
+/* arm_rfft_fast_f32 tables for HRV_FREQ_FFT_LEN (src/hrv_fft_tables.c) */
+#define HRV_FREQ_BITREV_LEN     208u
+extern const float32_t hrv_fft_cfft_twiddle[HRV_FREQ_FFT_LEN];
+extern const float32_t hrv_fft_rfft_twiddle[HRV_FREQ_FFT_LEN];
+extern const uint16_t  hrv_fft_bitrev[HRV_FREQ_BITREV_LEN];
+
+typedef enum {
+    HRV_FREQ_IDLE = 0,
+    HRV_FREQ_SCAN,
+    HRV_FREQ_RESAMPLE,
+    HRV_FREQ_WINDOW,
+    HRV_FREQ_FFT,
+    HRV_FREQ_ACCUM,
+    HRV_FREQ_BANDS,
+    HRV_FREQ_SLICE_COUNT
+} HRV_FreqSlice;
+
+typedef struct {
+    float32_t vlf_ms2;          /* band powers in ms^2 */
+    float32_t lf_ms2;
+    float32_t hf_ms2;
+    float32_t total_ms2;
+    float32_t lf_hf;            /* LF / HF (0 if HF is 0) */
+    uint16_t  n_segments;       /* Welch segments averaged */
+    uint16_t  span_s;           /* seconds of tachogram analysed */
+} HRV_FreqResult;
+
+typedef struct {
+    const HRV_Handle_t *hrv;
+    arm_rfft_fast_instance_f32 rfft;
+    HRV_FreqSlice state;
+
+    /* Run being analysed: ring sequence numbers [first, end) */
+    uint16_t  first, end;
+    uint16_t  scan_left;        /* SCAN: beats `first` may still move back */
+    uint32_t  run_samples;      /* time from the end of beat `first` to the end of the run, in ECG samples */
+
+    /*
+     * RESAMPLE: times in ECG samples from the end of beat `first`; the next grid point
+     * lies between the ends of beats seg_seq - 1 and seg_seq. seg_t/seg_rr hold the
+     * times and RR (ms) of beats seg_seq - 2 .. seg_seq + 1, missing ends duplicated.
+     */
+    uint16_t  seg_seq;
+    uint32_t  seg_t[4];
+    float32_t seg_rr[4];
+    float32_t grid_t0;          /* time of tacho[0] */
+    float32_t grid_step;        /* Fs / HRV_FREQ_FS_HZ */
+    uint16_t  n_samples;        /* grid points in the run */
+    uint16_t  n_done;           /* grid points resampled */
+
+    /* Welch segments */
+    uint16_t  n_segments;
+    uint16_t  segment;
+
+    float32_t tacho[HRV_FREQ_MAX_SAMPLES];  /* RR in ms on the 4Hz grid */
+    float32_t fft_in[HRV_FREQ_FFT_LEN];     /* arm_rfft_fast_f32 overwrites its input */
+    float32_t fft_out[HRV_FREQ_FFT_LEN];
+    float32_t window[HRV_FREQ_FFT_LEN];     /* Hann */
+    float32_t window_power;                 /* sum of window^2 */
+    float32_t psd[HRV_FREQ_N_BINS];         /* sum of |X|^2 over the segments */
+
+    /* Latest finished analysis */
+    HRV_FreqResult result;
+    uint32_t  n_results;
+
+    /* Worst slice cost in HRV_FREQ_CYCLES() units, per slice type and overall */
+    uint32_t  slice_cycles_max[HRV_FREQ_SLICE_COUNT];
+    uint32_t  slice_cycles_worst;
+} HRV_Freq_Handle_t;
+
+/* Bind to the HRV engine whose RR ring is analysed */
+void HRV_FreqInit(HRV_Freq_Handle_t *hf, const HRV_Handle_t *hrv);
+
+/*
+ * Start an analysis of the newest gap-free run (O(1), safe next to sample processing).
+ * Returns 0, and stays idle, if one is already running or the 5 min window holds fewer
+ * than two intervals.
+ */
+uint8_t HRV_FreqStart(HRV_Freq_Handle_t *hf);
+
+/* Run one slice; returns 1 if a slice ran, 0 if idle */
+uint8_t HRV_FreqStep(HRV_Freq_Handle_t *hf);
+
+/*
+ * Latest result; returns 0 if no analysis has finished yet. A run shorter than one
+ * segment (64s) finishes without a result.
+ */
+uint8_t HRV_FreqGetResult(const HRV_Freq_Handle_t *hf, HRV_FreqResult *r);
+
+#endif /* HRV_FREQ_H */
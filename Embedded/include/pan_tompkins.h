@@ -6,7 +6,7 @@
 #include <stdint.h>
 
 /*
- * Pan–Tompkins sample-by-sample pipeline (Fs = 360Hz):
+ * Pan–Tompkins sample-by-sample pipeline (Fs configurable, 360Hz by default):
  * 1) DC removal: y[n] = 0.995*y[n-1] + x[n] - x[n-1]
  * 2) Bandpass = LPF + HPF (difference equations)
  * 3) Derivative (5-point), Squaring
@@ -14,7 +14,7 @@
  * 5) Local maxima + Adaptive thresholding (refractory 200ms)
  */
 
-/* Report sampling frequency: Fs = 360Hz */
+/* Report sampling frequency: Fs = 360Hz (default config, fixed rate of the Q31 engine) */
 #define SAMPLE_RATE_HZ        360.0f
 
 /* Time windows from report */
@@ -26,11 +26,78 @@
 #define HPF_DELAY_N           29u   /* round(16 * 360 / 200) */
 #define HPF_DIV_K             58.0f /* = 2*HPF_DELAY_N */
 
+/* BPM tracking: instantaneous rate accepted only within (40, 200) BPM */
+#define PT_BPM_NUM            ((uint32_t)(60.0f * SAMPLE_RATE_HZ))  /* 60*Fs: bpm = PT_BPM_NUM / duration */
+#define PT_BPM_MIN            40u
+#define PT_BPM_MAX            200u
+
+/* Chunk size used by PT_ProcessBlock (scratch buffers live on the stack) */
+#define PT_BLOCK_SIZE         32u
+
+/* PT_Process stages in order; a profiling build's PT_STAGE_MARK(stage) runs as each one ends */
+typedef enum {
+    PT_STAGE_DC = 0,
+    PT_STAGE_LPF,
+    PT_STAGE_HPF,
+    PT_STAGE_DERIV,
+    PT_STAGE_SQUARE,
+    PT_STAGE_MWI,
+    PT_STAGE_DETECT,
+    PT_STAGE_COUNT
+} PT_Stage;
+
 /* Optional: threshold decay if no beat for a long time (kept stable, not continuous) */
 #define NO_BEAT_TIMEOUT_S     15u
 #define NO_BEAT_TIMEOUT_SAMPLES ((uint32_t)(NO_BEAT_TIMEOUT_S * SAMPLE_RATE_HZ))
 
+/* Runtime sample-rate range; histories are sized for PT_MAX_SAMPLE_RATE_HZ */
+#define PT_MIN_SAMPLE_RATE_HZ 100u
+#define PT_MAX_SAMPLE_RATE_HZ 1000u
+#define PT_MAX_LPF_DELAY_M    30u   /* round(6 * 1000 / 200) */
+#define PT_MAX_HPF_DELAY_N    80u   /* round(16 * 1000 / 200) */
+#define PT_MAX_WINDOW         150u  /* 150ms @ 1000Hz */
+
+/* Power-of-two circular histories: index with (idx - delay) & MASK */
+#define PT_LPF_HIST_SIZE      64u   /* >= 2*PT_MAX_LPF_DELAY_M + 1 */
+#define PT_HPF_HIST_SIZE      256u  /* >= 2*PT_MAX_HPF_DELAY_N + 1 */
+#define PT_WIN_HIST_SIZE      256u  /* >= PT_MAX_WINDOW */
+#define PT_BP_HIST_SIZE       256u  /* >= PT_MAX_WINDOW + PT_BLOCK_SIZE + 4: R-peak look-back */
+#define PT_LPF_HIST_MASK      (PT_LPF_HIST_SIZE - 1u)
+#define PT_HPF_HIST_MASK      (PT_HPF_HIST_SIZE - 1u)
+#define PT_WIN_HIST_MASK      (PT_WIN_HIST_SIZE - 1u)
+#define PT_BP_HIST_MASK       (PT_BP_HIST_SIZE - 1u)
+
+/* Delays and windows derived from one sample rate (see PT_ConfigInit) */
+typedef struct {
+    uint32_t  sample_rate_hz;
+    uint16_t  lpf_delay_m;              /* round(6 * Fs / 200) */
+    uint16_t  hpf_delay_n;              /* round(16 * Fs / 200) */
+    uint16_t  integration_window;       /* 150ms */
+    uint16_t  refractory_samples;       /* 200ms */
+    uint32_t  no_beat_timeout_samples;  /* NO_BEAT_TIMEOUT_S */
+    uint32_t  bpm_num;                  /* 60 * Fs */
+    uint16_t  bp_delay;                 /* band-pass group delay (M - 1) + N */
+    float32_t hpf_scale;                /* 1 / (2N) */
+    float32_t mwi_scale;                /* 1 / integration_window */
+} PT_Config;
+
+/*
+ * Beat event: R peak located on the band-passed signal and moved back by its group
+ * delay, so r_tick is in input-sample ticks (same numbering as current_tick).
+ */
+typedef struct {
+    uint32_t  r_tick;           /* R-peak tick */
+    float32_t r_frac;           /* parabolic sub-sample offset in [-0.5, 0.5]: peak at r_tick + r_frac */
+    float32_t amplitude;        /* band-passed value at the peak (signed) */
+    uint32_t  rr;               /* r_tick - previous event's r_tick (0 for the first beat) */
+    uint32_t  detect_tick;      /* tick at which the detector fired */
+    uint16_t  latency;          /* detect_tick - r_tick, in samples */
+} PT_BeatEvent;
+
 typedef struct {
+    /* Rate-dependent delays and windows */
+    PT_Config cfg;
+
     /* Tick counter (one per sample) */
     uint32_t current_tick;
 
@@ -40,22 +107,25 @@ typedef struct {
 
     /* LPF state */
     float32_t lpf_y1, lpf_y2;
-    float32_t lpf_x_hist[2*LPF_DELAY_M + 1u];
-    uint16_t  lpf_idx;
+    float32_t lpf_x_hist[PT_LPF_HIST_SIZE];
+    uint16_t  lpf_idx;          /* free-running, masked on access */
 
     /* HPF state (input is LPF output) */
     float32_t hpf_y1;
-    float32_t hpf_x_hist[2*HPF_DELAY_N + 1u];
-    uint16_t  hpf_idx;
+    float32_t hpf_x_hist[PT_HPF_HIST_SIZE];
+    uint16_t  hpf_idx;          /* free-running, masked on access */
 
     /* Derivative buffer */
     float32_t deriv_buff[5];
 
     /* Moving window integration buffer */
-    float32_t win_buff[INTEGRATION_WINDOW];
-    uint16_t  win_idx;
+    float32_t win_buff[PT_WIN_HIST_SIZE];
+    uint16_t  win_idx;          /* free-running, masked on access */
     float32_t win_sum;
 
+    /* Band-passed (HPF output) look-back, indexed by tick */
+    float32_t bp_hist[PT_BP_HIST_SIZE];
+
     /* Local maxima detector state (on integrated signal) */
     float32_t int_prev2;
     float32_t int_prev1;
@@ -69,7 +139,10 @@ typedef struct {
     uint32_t last_beat_tick;
     uint32_t last_decay_tick;
     int      current_bpm;
+    uint8_t  bpm_seed;          /* set by PT_Rearm: the next accepted RR sets current_bpm unsmoothed */
 
+    /* Latest beat event (valid after PT_Process/PT_ProcessBlock report a beat) */
+    PT_BeatEvent beat_event;
 
     /* ---- Expose intermediate/output signals for app ---- */
     float32_t out_x_dc;
@@ -79,12 +152,75 @@ typedef struct {
 
 } PanTompkins_Handle_t;
 
+/*
+ * Derive every delay and window from sample_rate_hz (e.g. 250/360/500/1000Hz).
+ * Returns 1 on success, 0 if the rate is outside [PT_MIN_SAMPLE_RATE_HZ,
+ * PT_MAX_SAMPLE_RATE_HZ]; cfg then holds the 360Hz defaults.
+ */
+uint8_t PT_ConfigInit(PT_Config *cfg, uint32_t sample_rate_hz);
+
+/* Initialize for the default 360Hz configuration */
 void PT_Init(PanTompkins_Handle_t *ht);
 
+/* Initialize with a configuration from PT_ConfigInit */
+void PT_InitConfig(PanTompkins_Handle_t *ht, const PT_Config *cfg);
+
+/*
+ * Fast re-arm after an interruption of the input (leads off): the filters restart in the
+ * steady state of a constant input at raw_adc (the first valid sample), so the step to
+ * the new electrode offset produces no DC/LPF/HPF transient, and the detector restarts
+ * from its start-up levels instead of thresholds left by the disconnect. current_tick
+ * keeps counting; the first beat after re-arm only anchors the RR chain and the next
+ * accepted RR sets current_bpm directly instead of being smoothed in from 0.
+ * Call it in place of PT_Process for that first sample.
+ */
+void PT_Rearm(PanTompkins_Handle_t *ht, uint16_t raw_adc);
+
 /* Process one ECG sample and return 1 if a beat is detected at a local maximum */
 uint8_t PT_Process(PanTompkins_Handle_t *ht, uint16_t raw_adc);
 
+/*
+ * Process a block of n ECG samples. DC/LPF/HPF/derivative/squaring/MWI run
+ * stage by stage on CMSIS-DSP kernels, only thresholding stays per sample.
+ * State is shared with PT_Process, so both may be mixed on one handle and
+ * produce the same detections. Peak ticks of detected beats are written to
+ * beat_ticks (at most max_beats). Returns the number of beats written.
+ */
+uint32_t PT_ProcessBlock(PanTompkins_Handle_t *ht, const uint16_t *in, uint32_t n,
+                         uint32_t *beat_ticks, uint32_t max_beats);
+
+/*
+ * PT_Process that also hands out the beat event: on a beat, *ev receives the R-peak
+ * tick found in the band-passed look-back (searched over the MWI window behind the
+ * detection, refined by parabolic interpolation) and the detection latency.
+ */
+uint8_t PT_ProcessEvent(PanTompkins_Handle_t *ht, uint16_t raw_adc, PT_BeatEvent *ev);
+
 /* Get current BPM value */
 int PT_GetBPM(PanTompkins_Handle_t *ht);
 
+/*
+ * BPM smoothing shared by all engines: bpm = 0.9*bpm + 0.1*(60*Fs/duration), truncated.
+ * Evaluated as floor((9*bpm*duration + 60*Fs) / (10*duration)) so the result does not
+ * depend on float rounding. bpm_num is 60*Fs. Returns bpm unchanged if the rate is out of range.
+ */
+static inline int PT_UpdateBPM(int bpm, uint32_t duration, uint32_t bpm_num) {
+    if ((duration == 0u) ||
+        (bpm_num <= PT_BPM_MIN * duration) ||
+        (bpm_num >= PT_BPM_MAX * duration)) {
+        return bpm;
+    }
+    return (int)((9u * (uint32_t)bpm * duration + bpm_num) / (10u * duration));
+}
+
+/* Unsmoothed BPM of one RR (60*Fs/duration, truncated), 0 if the rate is out of range */
+static inline int PT_InstantBPM(uint32_t duration, uint32_t bpm_num) {
+    if ((duration == 0u) ||
+        (bpm_num <= PT_BPM_MIN * duration) ||
+        (bpm_num >= PT_BPM_MAX * duration)) {
+        return 0;
+    }
+    return (int)(bpm_num / duration);
+}
+
 #endif /* PAN_TOMPKINS_H */
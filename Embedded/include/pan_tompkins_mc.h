@@ -0,0 +1,85 @@
+#ifndef PAN_TOMPKINS_MC_H
+#define PAN_TOMPKINS_MC_H
+
+#include "pan_tompkins.h"
+#include <stddef.h>
+
+/*
+ * Multi-channel Pan–Tompkins engine (structure of arrays).
+ * Every state variable is an array over channels and every history is a ring of rows,
+ * one row per delay slot holding that slot for all channels. One call advances all
+ * channels by one sample, so each filter stage is a branch-free loop over contiguous
+ * channels that the compiler can vectorize (SSE/AVX on the host; the Cortex-M4 has no
+ * float SIMD and runs the same loop scalar).
+ *
+ * Per channel the arithmetic is PT_Process's, in the same order, so each channel
+ * detects exactly the beats a PanTompkins_Handle_t fed the same samples would.
+ *
+ * No allocation: PT_MC_MemSize() gives the bytes the caller provides to PT_MC_Init().
+ */
+
+/* Rows are padded to a multiple of PT_MC_ALIGN floats (32 bytes, one AVX vector) */
+#define PT_MC_ALIGN           8u
+
+/* Derivative history ring (5 taps) */
+#define PT_MC_DERIV_ROWS      8u
+#define PT_MC_DERIV_MASK      (PT_MC_DERIV_ROWS - 1u)
+
+typedef struct {
+    /* Rate-dependent delays and windows (shared by all channels) */
+    PT_Config cfg;
+
+    uint32_t n_channels;
+    uint32_t stride;            /* row length: n_channels rounded up to PT_MC_ALIGN */
+
+    /* Tick counter (one per sample, shared) */
+    uint32_t current_tick;
+
+    /* Ring sizes (powers of two fitted to cfg) and free-running row indices */
+    uint32_t lpf_mask, hpf_mask, win_mask;
+    uint16_t lpf_idx, hpf_idx, win_idx, deriv_idx;
+
+    /* Filter state, one value per channel */
+    float32_t *dc_y1, *dc_x1;
+    float32_t *lpf_y1, *lpf_y2;
+    float32_t *hpf_y1;
+    float32_t *win_sum;
+
+    /* Histories: [rows][stride] */
+    float32_t *lpf_hist;        /* lpf_mask + 1 rows */
+    float32_t *hpf_hist;        /* hpf_mask + 1 rows */
+    float32_t *deriv_hist;      /* PT_MC_DERIV_ROWS rows */
+    float32_t *win_hist;        /* win_mask + 1 rows */
+
+    /* Detector state, one value per channel */
+    float32_t *integrated;      /* MWI output of the last sample */
+    float32_t *int_prev2, *int_prev1;
+    float32_t *threshold_i, *signal_level, *noise_level;
+    uint32_t  *last_beat_tick, *last_decay_tick;
+    int32_t   *current_bpm;
+} PanTompkinsMC_Handle_t;
+
+/* Bytes of state memory needed for n_channels at cfg's rate (mem must be 8-byte aligned) */
+size_t PT_MC_MemSize(const PT_Config *cfg, uint32_t n_channels);
+
+/* Initialize n_channels detectors on caller memory of PT_MC_MemSize() bytes */
+void PT_MC_Init(PanTompkinsMC_Handle_t *ht, const PT_Config *cfg, uint32_t n_channels, void *mem);
+
+/*
+ * Advance every channel by one sample; in[ch] is channel ch's ADC value.
+ * beat[ch] is set to 1 where a beat was detected, 0 elsewhere (beat may be NULL).
+ * Returns the number of channels that detected a beat.
+ */
+uint32_t PT_MC_Process(PanTompkinsMC_Handle_t *ht, const uint16_t *in, uint8_t *beat);
+
+/*
+ * Advance every channel by n samples of interleaved frames (in[i * n_channels + ch]).
+ * beat, if not NULL, receives n frames of flags laid out like in.
+ * Returns the total number of beats detected.
+ */
+uint32_t PT_MC_ProcessBlock(PanTompkinsMC_Handle_t *ht, const uint16_t *in, uint32_t n, uint8_t *beat);
+
+/* Current BPM of one channel */
+int PT_MC_GetBPM(const PanTompkinsMC_Handle_t *ht, uint32_t channel);
+
+#endif /* PAN_TOMPKINS_MC_H */
@@ -0,0 +1,106 @@
+#ifndef PAN_TOMPKINS_Q31_H
+#define PAN_TOMPKINS_Q31_H
+
+#include "pan_tompkins.h"
+
+/*
+ * Integer-only Pan–Tompkins engine (same stages, delays and thresholds as PT_Process).
+ * Runs at the fixed 360Hz default configuration: its shifts are derived from 2N.
+ * No float arithmetic at run time; scaling is done with shifts. Every term of the DC,
+ * LPF and HPF recursions saturates (QADD/QSUB semantics, 64-bit accumulators for the
+ * products) instead of wrapping. The derivative needs no saturation: it works on the
+ * clamped HPF state >> 6, so its terms stay below 2^28.
+ *
+ * Fixed-point formats along the chain:
+ *  - DC removal:  state in Q16, output x_dc in Q3 (8 * float x_dc)
+ *  - LPF:         exact integer recursion on Q3 samples
+ *  - HPF:         state kept as 2N * yHP so the v/(2N) terms stay exact
+ *  - Derivative:  (2x[n] + x[n-1] - x[n-3] - 2x[n-4]) on (2N * yHP) >> 6, which equals
+ *                 2N * float derivative (>>6 undoes Q3 and the skipped /8)
+ *  - Squaring:    d^2 >> PT_Q31_SQ_SHIFT, clamped so the window sum cannot overflow
+ *  - MWI:         window sum, not divided by the window length
+ * The integrated signal and all thresholds are therefore float values scaled by
+ * PT_Q31_INT_GAIN / 2^PT_Q31_SQ_SHIFT (= (2N)^2 * 54 / 65536 ~= 2.77 at 360Hz).
+ */
+
+#define PT_Q31_DC_COEF        1068373115   /* 0.995 in Q30 */
+#define PT_Q31_DC_STATE_FRAC  16u
+#define PT_Q31_DC_OUT_FRAC    3u
+#define PT_Q31_HPF_SHIFT      (PT_Q31_DC_OUT_FRAC + 3u)  /* (2N * yHP) >> 6 feeds the derivative */
+#define PT_Q31_HPF_RECIP      37025580     /* round(2^31 / (2N)), only for out_y_hpf */
+#define PT_Q31_SQ_SHIFT       16u
+#define PT_Q31_SQ_MAX         ((q31_t)(INT32_MAX / (int32_t)INTEGRATION_WINDOW))
+#define PT_Q31_INT_GAIN       ((int32_t)(2u*HPF_DELAY_N) * (int32_t)(2u*HPF_DELAY_N) * (int32_t)INTEGRATION_WINDOW)
+
+/* Power-of-two circular histories for the fixed 360Hz delays (index with & MASK) */
+#define PT_Q31_LPF_HIST_SIZE  32u   /* >= 2*LPF_DELAY_M + 1 */
+#define PT_Q31_HPF_HIST_SIZE  64u   /* >= 2*HPF_DELAY_N + 1 */
+#define PT_Q31_WIN_HIST_SIZE  64u   /* >= INTEGRATION_WINDOW */
+#define PT_Q31_LPF_HIST_MASK  (PT_Q31_LPF_HIST_SIZE - 1u)
+#define PT_Q31_HPF_HIST_MASK  (PT_Q31_HPF_HIST_SIZE - 1u)
+#define PT_Q31_WIN_HIST_MASK  (PT_Q31_WIN_HIST_SIZE - 1u)
+
+/* Convert a float-engine threshold/integrated level (integer part) to the Q31 engine scale */
+#define PT_Q31_LEVEL(v)       ((q31_t)(((int64_t)(v) * PT_Q31_INT_GAIN) >> PT_Q31_SQ_SHIFT))
+
+typedef struct {
+    /* Tick counter (one per sample) */
+    uint32_t current_tick;
+
+    /* DC removal state */
+    q31_t   dc_y1;                         /* Q16 */
+    int32_t dc_x1;                         /* centred ADC */
+
+    /* LPF state (Q3) */
+    q31_t    lpf_y1, lpf_y2;
+    q31_t    lpf_x_hist[PT_Q31_LPF_HIST_SIZE];
+    uint16_t lpf_idx;                      /* free-running, masked on access */
+
+    /* HPF state: z = 2N * yHP */
+    q31_t    hpf_z1;
+    q31_t    hpf_x_hist[PT_Q31_HPF_HIST_SIZE];
+    uint16_t hpf_idx;                      /* free-running, masked on access */
+
+    /* Derivative buffer */
+    q31_t deriv_buff[5];
+
+    /* Moving window integration buffer */
+    q31_t    win_buff[PT_Q31_WIN_HIST_SIZE];
+    uint16_t win_idx;                      /* free-running, masked on access */
+    q31_t    win_sum;
+
+    /* Local maxima detector state (on integrated signal) */
+    q31_t int_prev2;
+    q31_t int_prev1;
+
+    /* Adaptive threshold variables */
+    q31_t threshold_i;
+    q31_t signal_level;
+    q31_t noise_level;
+
+    /* BPM tracking */
+    uint32_t last_beat_tick;
+    uint32_t last_decay_tick;
+    int      current_bpm;
+    uint8_t  bpm_seed;                     /* see PT_Rearm */
+
+    /* ---- Expose intermediate/output signals for app ---- */
+    q31_t out_x_dc;                        /* Q3 */
+    q31_t out_y_lpf;                       /* Q3 */
+    q31_t out_y_hpf;                       /* Q3 */
+    q31_t out_integrated;                  /* PT_Q31_LEVEL scale */
+
+} PanTompkinsQ31_Handle_t;
+
+void PT_InitQ31(PanTompkinsQ31_Handle_t *ht);
+
+/* PT_Rearm for the Q31 engine */
+void PT_RearmQ31(PanTompkinsQ31_Handle_t *ht, uint16_t raw_adc);
+
+/* Process one ECG sample and return 1 if a beat is detected at a local maximum */
+uint8_t PT_ProcessQ31(PanTompkinsQ31_Handle_t *ht, uint16_t raw_adc);
+
+/* Get current BPM value */
+int PT_GetBPMQ31(PanTompkinsQ31_Handle_t *ht);
+
+#endif /* PAN_TOMPKINS_Q31_H */
@@ -0,0 +1,92 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include "stm32f4xx.h"
+#include <stdint.h>
+
+/*
+ * Run modes of the main loop and their duty cycle.
+ *
+ * The main loop calls Power_Idle() when the scheduler has nothing to run. In
+ * POWER_MODE_SLEEP it re-checks for work with interrupts masked and sleeps with WFI
+ * until the next interrupt, so the core wakes once per DMA block (AD8232_BLOCK_SIZE
+ * samples, 89ms @ 360Hz) and for the transmit DMA, and drains each block as a batch.
+ * SysTick is stopped: nothing after boot uses the HAL tick, and it would wake the core
+ * every millisecond.
+ *
+ * POWER_MODE_SCALE also lowers HCLK when the load allows. The PLL keeps running at the
+ * 84MHz of SystemClock_Config; the AHB prescaler divides it down by levels:
+ *
+ *   level  HCLK    PCLK1   PCLK2   TIM3
+ *   0      84MHz   42MHz   84MHz   84MHz   (boot)
+ *   1      42MHz   42MHz   42MHz   42MHz
+ *   2      21MHz   21MHz   21MHz   21MHz
+ *
+ * A switch waits for both transmit paths to go idle. TIM3 and the USART1/USART2 baud
+ * rates are then re-derived from the new clocks. At most one sample period around the
+ * switch runs at the wrong rate, and a byte received during the switch may be lost.
+ * Every second of samples, Power_Account() compares the awake cycles with HCLK. It
+ * steps up at once when the load passes POWER_LOAD_UP_PCT or the sample task missed a
+ * deadline. It steps down after POWER_HOLD_S seconds below POWER_LOAD_DOWN_PCT, which
+ * leaves headroom below the up threshold once the clock has halved.
+ *
+ * Awake cycles are the DWT cycles outside idle polls and sleep, interrupts included, in
+ * every mode; in POWER_MODE_BUSY they measure the load without saving anything.
+ */
+
+#define POWER_MODE_BUSY     0u      /* poll at 84MHz */
+#define POWER_MODE_SLEEP    1u      /* WFI when idle */
+#define POWER_MODE_SCALE    2u      /* WFI when idle and HCLK scaled to the load */
+
+#define POWER_LEVELS        3u
+#define POWER_LOAD_UP_PCT   60u
+#define POWER_LOAD_DOWN_PCT 25u
+#define POWER_HOLD_S        5u
+
+typedef struct {
+    uint8_t  mode;
+    uint8_t  level;                 /* current HCLK level */
+    uint8_t  target;                /* level to switch to once the links are idle */
+    uint8_t  hold;                  /* seconds before the next step down */
+    uint32_t awake_start;           /* DWT->CYCCNT at the last wakeup */
+    uint32_t awake_cycles;          /* since the last Power_Account */
+    uint32_t wakeups;               /* WFI exits since the last Power_Account */
+    uint32_t switches;              /* HCLK changes since boot */
+
+    /* Last second of samples */
+    uint32_t awake_cycles_s;
+    uint32_t wakeups_s;
+    uint32_t duty_permille;         /* awake_cycles_s / HCLK */
+} Power_t;
+
+extern Power_t power;
+
+/* Select the run mode (POWER_MODE_*); the clock stays at level 0 until Power_Account asks for less */
+void Power_Init(uint8_t mode);
+
+/**
+ * Nothing to run: sleep until an interrupt in the WFI modes, or return at once.
+ * - idle_start: DWT->CYCCNT when the idle poll began, so the poll is not counted as awake
+ * - work_ready: re-checks for work with interrupts masked just before WFI, so an
+ *   interrupt that came after the poll does not wait for the next one
+ */
+void Power_Idle(uint32_t idle_start, uint8_t (*work_ready)(void));
+
+/**
+ * Close one second of samples: the duty-cycle statistics and, in POWER_MODE_SCALE, the
+ * next HCLK level.
+ * - deadline_misses: sample-task deadline misses in that second
+ */
+void Power_Account(uint32_t deadline_misses);
+
+/* 1 when an HCLK switch is due and both transmit DMA streams are idle */
+uint8_t Power_SwitchReady(void);
+
+/**
+ * Switch HCLK to the target level and re-derive TIM3 and the baud rates; DWT cycle
+ * budgets of the caller must be rescaled from SystemCoreClock afterwards
+ * - sample_rate_hz: current sample rate, for TIM3
+ */
+void Power_Switch(uint32_t sample_rate_hz);
+
+#endif /* POWER_H */
@@ -0,0 +1,110 @@
+#ifndef PROF_H
+#define PROF_H
+
+#include "stm32f4xx.h"
+#include "ecg_proto.h"
+#include "pan_tompkins.h"
+#include <stdint.h>
+
+/*
+ * Cycle profiler: named probes timed with the DWT cycle counter (on the host build,
+ * DWT->CYCCNT is the TSC or CLOCK_MONOTONIC ns, see host/include/stm32f4xx.h).
+ *
+ * Built in with -DPROF_ENABLE=1 (platformio.ini build_flags, or PT_HOST_PROF in CMake);
+ * without it the PROF_* macros compile to nothing and the firmware is unchanged.
+ *
+ * Each probe keeps the count, sum, min and max of its intervals and a log2 histogram:
+ * bin 0 counts intervals below 16 cycles, bin b (1..14) intervals in [2^(b+3), 2^(b+4)),
+ * bin 15 everything from 2^18 cycles (3.1ms @ 84MHz) up.
+ *
+ * Report: every period, one PROF frame (ecg_proto.h) per probe, one per sample while the
+ * transmit ring has room, each followed by a reset of that probe's statistics. Every
+ * frame starts with its own 0x00 so the text debug log around it does not corrupt it.
+ */
+
+#ifndef PROF_ENABLE
+#define PROF_ENABLE 0
+#endif
+
+/* Probes; the PT stages are in PT_Stage order, charged by PT_STAGE_MARK in PT_Process */
+typedef enum {
+    PROF_PT_STAGE = 0,                          /* + PT_Stage: DC, LPF, HPF, ... */
+    PROF_PT_PROCESS = PROF_PT_STAGE + PT_STAGE_COUNT,   /* PT_PROCESS / PT_REARM, whole */
+    PROF_STREAM,        /* everything the sample sends to the HC-05: formatting and queueing */
+    PROF_FORMAT,        /* text stream's "ECG_VALUE,BPM" line, formatted into the ring and queued */
+    PROF_HC05_WRITE,    /* HC05_Write: copy into the transmit ring */
+    PROF_USART2_WRITE,  /* USART2_Write: copy into the debug ring */
+    PROF_LOG,           /* USART2_LogSignals: formatting and queueing */
+    PROF_HRV_SLICE,     /* one HRV_FreqStep */
+    PROF_SAMPLE,        /* one sample with the leads on through the main loop, pop to report */
+    PROF_COUNT
+} Prof_Probe;
+
+#define PROF_HIST_BINS      ECG_PROTO_PROF_BINS
+
+typedef struct {
+    uint32_t count;
+    uint32_t sum;                   /* saturates at 0xFFFFFFFF */
+    uint32_t min;
+    uint32_t max;
+    uint16_t hist[PROF_HIST_BINS];  /* saturating */
+} Prof_Stats;
+
+typedef struct {
+    Prof_Stats probe[PROF_COUNT];
+    uint32_t mark;                  /* last Prof_Begin / Prof_Mark time */
+    uint32_t report_tick;           /* sample tick of the last report start */
+    uint32_t report_next;           /* next probe to send, PROF_COUNT when idle */
+    ECG_Proto_t proto;              /* PROF frame sequence, separate from the HC-05 stream */
+} Prof_t;
+
+extern Prof_t prof;
+
+/* Largest report frame: leading 0x00, then a PROF frame and its COBS code and delimiter */
+#define PROF_FRAME_MAX      (1u + ECG_PROTO_HEADER_SIZE + 1u + 4u * 4u + 2u * PROF_HIST_BINS + \
+                             ECG_PROTO_CRC_SIZE + 2u)
+
+void Prof_Init(void);
+
+/* Charge one interval to a probe */
+void Prof_Add(uint32_t probe, uint32_t cycles);
+
+/* Name of a probe, for reports */
+const char *Prof_Name(uint32_t probe);
+
+/**
+ * Report driver, once per sample: starts a report every period samples and encodes the
+ * next probe's frame into out (PROF_FRAME_MAX bytes) when room bytes are free.
+ * - Returns: bytes to send, 0 if nothing is due or it does not fit yet
+ */
+uint32_t Prof_ReportStep(uint32_t tick, uint32_t period, uint32_t room, uint8_t *out);
+
+/* Start of an interval; also the start for the Prof_Mark calls that follow */
+static inline uint32_t Prof_Begin(void) {
+    uint32_t t = DWT->CYCCNT;
+    prof.mark = t;
+    return t;
+}
+
+static inline void Prof_End(uint32_t probe, uint32_t t0) {
+    Prof_Add(probe, DWT->CYCCNT - t0);
+}
+
+/* Charge the time since the last Prof_Begin / Prof_Mark to probe */
+static inline void Prof_Mark(uint32_t probe) {
+    uint32_t t = DWT->CYCCNT;
+    Prof_Add(probe, t - prof.mark);
+    prof.mark = t;
+}
+
+#if PROF_ENABLE
+#define PROF_BEGIN(t)       uint32_t t = Prof_Begin()
+#define PROF_END(probe, t)  Prof_End(probe, t)
+#define PROF_MARK(probe)    Prof_Mark(probe)
+#else
+#define PROF_BEGIN(t)
+#define PROF_END(probe, t)
+#define PROF_MARK(probe)
+#endif
+
+#endif /* PROF_H */
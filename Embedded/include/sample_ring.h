@@ -0,0 +1,60 @@
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include "stm32f4xx.h"
+#include <stdint.h>
+
+/*
+ * Lock-free single-producer / single-consumer ring of (sequence, adc[]) samples between
+ * the acquisition ISR (producer) and the main loop (consumer).
+ *
+ * head and tail are free-running counters: only the producer writes head, only the
+ * consumer writes tail, and occupancy is head - tail. Entries are published by a
+ * barrier before the head store and released by a barrier before the tail store,
+ * so no interrupt masking is needed on either side.
+ *
+ * Every sample gets the next sequence number whether it is stored or not: a full
+ * ring drops the incoming samples, counts them in `dropped`, and the consumer sees
+ * the jump in sequence. `high_water` is the largest occupancy seen after a push.
+ */
+
+/* Entries, power of two: 256 = 711ms @ 360Hz of slack for a busy main loop */
+#define SAMPLE_RING_SIZE      256u
+#define SAMPLE_RING_MASK      (SAMPLE_RING_SIZE - 1u)
+
+/* Channels per entry (one scan frame); unused channels read 0 */
+#define SAMPLE_RING_CHANNELS  4u
+
+typedef struct {
+    uint32_t seq;               /* sample number since SampleRing_Init */
+    uint16_t adc[SAMPLE_RING_CHANNELS];
+} SampleRing_Entry;
+
+typedef struct {
+    SampleRing_Entry buf[SAMPLE_RING_SIZE];
+    volatile uint32_t head;     /* producer: entries written */
+    volatile uint32_t tail;     /* consumer: entries read */
+    uint32_t next_seq;          /* producer: sequence number of the next sample */
+
+    /* Producer statistics */
+    volatile uint32_t dropped;      /* samples lost to a full ring */
+    volatile uint32_t high_water;   /* largest occupancy seen */
+} SampleRing_t;
+
+void SampleRing_Init(SampleRing_t *r);
+
+/*
+ * Producer: store n consecutive samples given as interleaved frames of n_ch channels
+ * (n_ch <= SAMPLE_RING_CHANNELS), dropping those that do not fit. Returns the number stored.
+ */
+uint32_t SampleRing_PushBlock(SampleRing_t *r, const volatile uint16_t *frames, uint32_t n_ch, uint32_t n);
+
+/* Consumer: take the oldest sample; returns 0 if the ring is empty */
+uint8_t SampleRing_Pop(SampleRing_t *r, SampleRing_Entry *e);
+
+/* Entries waiting (either side) */
+static inline uint32_t SampleRing_Count(const SampleRing_t *r) {
+    return r->head - r->tail;
+}
+
+#endif /* SAMPLE_RING_H */
@@ -0,0 +1,109 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+#include "stm32f4xx.h"
+#include <stdint.h>
+
+/*
+ * Static cooperative scheduler for the main loop. Times are DWT->CYCCNT cycles.
+ *
+ * A task has jobs. A job is released by the task's ready() poll, by its period, or by
+ * Sched_Release() from another task, and runs as one or more slices: run() returns 1
+ * when the job is complete, 0 to be called again. Each Sched_Step() runs one slice of
+ * the first task with a pending job, in class order (HARD, then SOFT, then IDLE) and,
+ * within a class, in the order the tasks were added. Nothing preempts a slice, so a
+ * hard task waits at most for the longest slice of any other task: keep slices short.
+ *
+ * Per task: jobs completed, the longest slice (WCET), the longest release-to-completion
+ * time and the jobs that completed later than their deadline after release.
+ * A job released while the previous one is still pending merges into it (counted in
+ * `merged`); a periodic task that falls more than one period behind skips the lost
+ * periods instead of running them back to back.
+ *
+ * Optionally Sched_Step() writes the id of the slice it starts to a trace word, and
+ * SCHED_NONE when the slice returns; kept in memory that survives a reset, it names the
+ * task a watchdog reset interrupted (health.h).
+ */
+
+#define SCHED_MAX_TASKS     8u
+#define SCHED_NONE          0xFFu
+
+typedef enum {
+    SCHED_HARD = 0,     /* sample processing: its deadline decides whether data is lost */
+    SCHED_SOFT,         /* telemetry, analysis, self-test: late is tolerable, counted */
+    SCHED_IDLE          /* background work, only when nothing else is pending */
+} Sched_Class;
+
+/* Returns 1 when there is work (ready) or the job is complete (run) */
+typedef uint8_t (*Sched_Fn)(void);
+
+typedef struct {
+    const char *name;
+    Sched_Fn ready;             /* polled while no job is pending; NULL: period or Sched_Release only */
+    Sched_Fn run;
+    uint32_t period;            /* cycles between releases, 0 = not periodic */
+    uint32_t deadline;          /* cycles from release to completion, 0 = none */
+    uint8_t  cls;               /* Sched_Class */
+
+    uint8_t  pending;
+    uint32_t release;           /* release time of the pending job */
+    uint32_t next_release;      /* periodic tasks: next release time */
+
+    /* Statistics since Sched_ClearStats */
+    uint32_t jobs;
+    uint32_t misses;
+    uint32_t merged;
+    uint32_t wcet;              /* longest slice */
+    uint32_t max_response;      /* longest release to completion */
+} Sched_Task;
+
+typedef struct {
+    Sched_Task task[SCHED_MAX_TASKS];   /* by id */
+    uint8_t  order[SCHED_MAX_TASKS];    /* ids in run order */
+    uint32_t n_tasks;
+    uint32_t idle_steps;                /* Sched_Step calls with nothing pending */
+    volatile uint32_t *trace;           /* id of the running slice, SCHED_NONE between slices; NULL = off */
+} Sched_t;
+
+void Sched_Init(Sched_t *s);
+
+/**
+ * Add a task; it runs after every task of its class added before it. Ids are stable
+ * and follow the order of the calls, whatever the class.
+ * - period: cycles between releases, 0 = released by ready() or Sched_Release() only;
+ *   the first periodic release is one period from now
+ * - Returns: task id, SCHED_NONE if the table is full
+ */
+uint8_t Sched_Add(Sched_t *s, const char *name, Sched_Class cls, Sched_Fn ready, Sched_Fn run,
+                  uint32_t period, uint32_t deadline);
+
+/* Release a job of task id now (merged into the pending one, if any) */
+void Sched_Release(Sched_t *s, uint8_t id);
+
+/* Write the id of every slice to *trace while it runs (NULL turns it off) */
+void Sched_SetTrace(Sched_t *s, volatile uint32_t *trace);
+
+/* Change the period and deadline of task id (e.g. after a sample rate change) */
+void Sched_SetTiming(Sched_t *s, uint8_t id, uint32_t period, uint32_t deadline);
+
+/**
+ * Release what is due and run one slice of the highest-priority pending task.
+ * - Returns: id of the task that ran, SCHED_NONE if nothing was pending
+ */
+uint8_t Sched_Step(Sched_t *s);
+
+/**
+ * Whether a Sched_Step would run something: a pending job, a period due or a ready()
+ * poll with work. Nothing is released or run; used for the check before sleeping.
+ * Periods are DWT cycles, which stop while the core sleeps: a loop that sleeps
+ * releases its periodic work from an interrupt-paced source instead.
+ */
+uint8_t Sched_Ready(const Sched_t *s);
+
+/* Task by id */
+const Sched_Task *Sched_Get(const Sched_t *s, uint8_t id);
+
+/* Zero the statistics of every task */
+void Sched_ClearStats(Sched_t *s);
+
+#endif /* SCHED_H */
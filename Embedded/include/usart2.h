@@ -2,37 +2,118 @@
 #define USART2_H
 
 #include "stm32f4xx.h"
-#include <stdio.h>
+#include "ecg_ser.h"
+#include "dma_tx.h"
 #include <string.h>
 
 #define USART2_BAUDRATE 115200
 
+/*
+ * Debug output. Like the HC-05 link, USART2 never blocks: lines are copied into
+ * usart2_tx, a dma_tx.h ring that DMA1 Stream6 (channel 4) drains into USART2. The
+ * stream has the lowest
+ * DMA priority and its interrupt the lowest NVIC priority, so debug output can only use
+ * time nothing else needs. A line that does not fit is dropped whole and counted.
+ *
+ * Signal log: USART2_SetLog() picks at run time which detector signals are written
+ * (mask of USART2_SIG_BIT()) and on every how many samples; one CSV line per logged
+ * sample holds the selected signals in USART2_Signal order.
+ */
+
+/* Ring bytes, power of two: 512 = 44ms of line time @ 115200 baud */
+#define USART2_TX_SIZE      512u
+
+/* Detector signals the log can carry, in column order */
+typedef enum {
+    USART2_SIG_DC = 0,          /* out_x_dc: DC-removed input, ADC units */
+    USART2_SIG_LPF,             /* out_y_lpf: low-pass output, ADC units times the filter gain */
+    USART2_SIG_HPF,             /* out_y_hpf: band-passed output, ADC units */
+    USART2_SIG_INTEGRATED,      /* out_integrated: moving-window integral, / 4000 */
+    USART2_SIG_THRESHOLD,       /* threshold_i, / 4000 */
+    USART2_SIG_SIGNAL,          /* signal_level, / 4000 */
+    USART2_SIG_NOISE,           /* noise_level, / 4000 */
+    USART2_SIG_COUNT
+} USART2_Signal;
+
+#define USART2_SIG_BIT(s)   (1u << (s))
+#define USART2_SIG_ALL      (USART2_SIG_BIT(USART2_SIG_COUNT) - 1u)
+
+/* Longest log line: every signal as "-2147483648," plus "\r\n" */
+#define USART2_LOG_LINE_MAX (USART2_SIG_COUNT * 12u + 2u)
+
+typedef struct {
+    uint32_t mask;                  /* USART2_SIG_BIT() of the logged signals, 0 = off */
+    uint32_t decim;                 /* log every decim-th sample */
+    uint32_t count;                 /* samples since the last logged one */
+} USART2_Log_t;
+
+/* Lines dropped because they did not fit: usart2_tx.dropped */
+extern DMA_Tx_t usart2_tx;
+extern USART2_Log_t usart2_log;
+
 /**
  * Initialize USART2
  * - Configures GPIOA PA2 as TX and PA3 as RX
  * - Configures USART2 with 115200 baudrate
+ * - Configures DMA1 Stream6 Channel4 (USART2 TX) and its transfer-complete interrupt
+ * - Signal log off until USART2_SetLog()
  */
 void USART2_Init(void);
 
+/* USART2 baud rate divider from the current PCLK1 (again after an HCLK change, power.h; transmitter idle) */
+void USART2_SetClock(void);
+
 /**
- * Send single character via USART2
+ * Queue len bytes for transmission (non-blocking).
+ * - Returns: 1 if queued, 0 if dropped because the ring has less than len bytes free
+ */
+uint8_t USART2_Write(const char *data, uint32_t len);
+
+/* Bytes that can be queued right now */
+static inline uint32_t USART2_TxFree(void) {
+    return DMA_Tx_Free(&usart2_tx);
+}
+
+/* Start a line in the free part of usart2_tx (ECG_SER_TEXT writer, ecg_ser.h); main loop only */
+void USART2_Begin(ECG_Ser_t *w);
+
+/**
+ * Queue the line written since USART2_Begin.
+ * - Returns: 1 if queued, 0 if dropped because it did not fit (counted)
+ */
+uint8_t USART2_Commit(const ECG_Ser_t *w);
+
+/**
+ * Queue single character via USART2
  * - c: character to send
  */
-void USART2_SendChar(char c);
+uint8_t USART2_SendChar(char c);
 
 /**
- * Send string via USART2
+ * Queue string via USART2; returns 0 if it was dropped
  * - str: null-terminated string to send
  */
-void USART2_SendString(char *str);
+uint8_t USART2_SendString(char *str);
+
+/**
+ * Select the signal log
+ * - mask: USART2_SIG_BIT() of the signals to write, 0 turns the log off
+ * - decim: write every decim-th sample (0 is taken as 1)
+ */
+void USART2_SetLog(uint32_t mask, uint32_t decim);
+
+/**
+ * Count one sample; returns 1 if it is to be logged with USART2_LogSignals().
+ * A sample due while the ring cannot take a full line is dropped here (counted),
+ * before any formatting work.
+ */
+uint8_t USART2_LogDue(void);
 
 /**
- * Log signals via USART2
- * - raw: raw ECG signal
- * - filtered: filtered ECG signal
- * - integrated: integrated ECG signal
- * - thresh: threshold value
+ * Log signals via USART2: one CSV line with the selected entries of v, formatted in
+ * place in the ring
+ * - v: USART2_SIG_COUNT values indexed by USART2_Signal (unselected ones are ignored)
  */
-void USART2_LogSignals(int16_t raw, int16_t filtered, int16_t integrated, int16_t thresh);
+void USART2_LogSignals(const int32_t *v);
 
-#endif /* USART2_H */
\ No newline at end of file
+#endif /* USART2_H */
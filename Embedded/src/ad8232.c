@@ -1,60 +1,194 @@
 #include "ad8232.h"
 
-/* Global flag for sample ready signal */
-volatile uint8_t  ad8232_sample_ready = 0;
-volatile uint16_t ad8232_latest_adc   = 0;
+/* DMA target: two halves of AD8232_BLOCK_SIZE * oversample frames of n_ch conversions, filled alternately */
+static volatile uint16_t ad8232_dma_buf[AD8232_DMA_BUF_SIZE];
 
-void AD8232_Init(uint32_t sample_rate_hz) {
-    /* GPIO Configuration PA0 Analog, PA1/PA4 Input */
-    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN;
+/* Scan list, conversions per output sample (1: no decimation) and one decimator per lead */
+static AD8232_Channel ad8232_channels[AD8232_MAX_CHANNELS];
+static uint32_t ad8232_n_ch = 0;
+static uint32_t ad8232_oversample = 1u;
+static ADC_Decim_t ad8232_decim[AD8232_MAX_LEADS];
+
+/* Samples handed from the DMA ISR to the main loop */
+SampleRing_t ad8232_ring;
+
+volatile uint32_t ad8232_isr_cycles_max = 0;
+
+/* Leads-off pins: latched by the EXTI handlers, debounced per sample by AD8232_UpdateLeads */
+volatile uint32_t ad8232_lo_edges = 0;
+static volatile uint8_t ad8232_lo_pins = 0;
+static uint32_t ad8232_debounce_samples = 0;
+static uint32_t ad8232_lo_seen_edges = 0;
+static uint32_t ad8232_lo_stable_seq = 0;
+static uint8_t  ad8232_leads_off = 0;
+
+/* Analog mode on the pin of ADC1 channel ch: IN0-7 PA0-7, IN8-9 PB0-1, IN10-15 PC0-5 */
+static void ad8232_pin_analog(uint32_t ch) {
+    if (ch < 8u) {
+        RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN;
+        GPIOA->MODER |= (3u << (2u * ch));
+    } else if (ch < 10u) {
+        RCC->AHB1ENR |= RCC_AHB1ENR_GPIOBEN;
+        GPIOB->MODER |= (3u << (2u * (ch - 8u)));
+    } else {
+        RCC->AHB1ENR |= RCC_AHB1ENR_GPIOCEN;
+        GPIOC->MODER |= (3u << (2u * (ch - 10u)));
+    }
+}
+
+/*
+ * Conversion rate Fc = sample_rate_hz * oversample from TIM3_CLK (PCLK1, doubled when
+ * the APB1 prescaler is not 1: 84MHz at the boot clock, less after Power_ apply a lower
+ * HCLK): the smallest prescaler that lets ARR fit 16 bits keeps the rate error below
+ * 1e-5 from 360Hz up to 32x oversampling.
+ */
+static void ad8232_timer(uint32_t sample_rate_hz) {
+    uint32_t ppre1 = APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos];
+    uint32_t tim_clk = (SystemCoreClock >> ppre1) << ((ppre1 != 0u) ? 1u : 0u);
+    uint32_t ticks = (tim_clk + (sample_rate_hz * ad8232_oversample) / 2u) / (sample_rate_hz * ad8232_oversample);
+    uint32_t psc = (ticks - 1u) >> 16;
+    TIM3->PSC = (uint16_t)psc;
+    TIM3->ARR = (uint16_t)((ticks + (psc + 1u) / 2u) / (psc + 1u) - 1u);
+}
+
+void AD8232_Init(uint32_t sample_rate_hz, uint32_t oversample) {
+    static const AD8232_Channel lead = { 0u, AD8232_CH_LEAD };
+    AD8232_InitScan(sample_rate_hz, oversample, &lead, 1u);
+}
+
+uint8_t AD8232_InitScan(uint32_t sample_rate_hz, uint32_t oversample, const AD8232_Channel *ch, uint32_t n_ch) {
+    uint32_t n_leads = 0;
+
+    if ((n_ch == 0u) || (n_ch > AD8232_MAX_CHANNELS)) return 0;
+    for (uint32_t c = 0; c < n_ch; c++) {
+        if ((ch[c].adc_channel > 15u) || (ch[c].adc_channel == 1u) || (ch[c].adc_channel == 4u)) return 0;
+        if (ch[c].kind == AD8232_CH_LEAD) n_leads++;
+    }
+    if (n_leads > AD8232_MAX_LEADS) return 0;
+
+    SampleRing_Init(&ad8232_ring);
+    for (uint32_t c = 0; c < n_ch; c++) ad8232_channels[c] = ch[c];
+    ad8232_n_ch = n_ch;
 
-    /* PA0 Analog Mode */
-    GPIOA->MODER |= (3u << 0);
+    if (sample_rate_hz == 0u) sample_rate_hz = 360u;
+    ad8232_oversample = 1u;
+    if ((oversample > 1u) && (oversample * n_ch <= AD8232_MAX_CONVERSIONS)) {
+        uint8_t ok = 1;
+        for (uint32_t l = 0; l < n_leads; l++) {
+            ok &= ADC_DecimInit(&ad8232_decim[l], oversample, AD8232_BLOCK_SIZE);
+        }
+        if (ok) ad8232_oversample = oversample;
+    }
+    uint32_t half_len = AD8232_BLOCK_SIZE * ad8232_oversample * n_ch;
+
+    /* GPIO Configuration: scanned inputs Analog, PA1/PA4 Input */
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN;
+    for (uint32_t c = 0; c < n_ch; c++) ad8232_pin_analog(ch[c].adc_channel);
 
     /* PA1 PA4 Input Mode */
     GPIOA->MODER &= ~((3u << 2) | (3u << 8));
 
+    /* PA1 -> EXTI1, PA4 -> EXTI4 on both edges */
+    RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;
+    SYSCFG->EXTICR[0] &= ~SYSCFG_EXTICR1_EXTI1;
+    SYSCFG->EXTICR[1] &= ~SYSCFG_EXTICR2_EXTI4;
+    EXTI->RTSR |= EXTI_RTSR_TR1 | EXTI_RTSR_TR4;
+    EXTI->FTSR |= EXTI_FTSR_TR1 | EXTI_FTSR_TR4;
+    EXTI->PR    = EXTI_PR_PR1 | EXTI_PR_PR4;
+    EXTI->IMR  |= EXTI_IMR_MR1 | EXTI_IMR_MR4;
+
+    ad8232_debounce_samples = (AD8232_LEADS_DEBOUNCE_MS * sample_rate_hz + 999u) / 1000u;
+    ad8232_lo_pins = AD8232_IsLeadsOff();
+    ad8232_leads_off = ad8232_lo_pins;
+
+    NVIC_SetPriority(EXTI1_IRQn, 2);
+    NVIC_SetPriority(EXTI4_IRQn, 2);
+    NVIC_EnableIRQ(EXTI1_IRQn);
+    NVIC_EnableIRQ(EXTI4_IRQn);
+
     /* ADC1 Configuration */
     RCC->APB2ENR |= RCC_APB2ENR_ADC1EN;
 
-    /* Sample Time Channel 0 */
-    ADC1->SMPR2 |= (4u << 0);
-
-    /* Channel Sequence */
+    /* Sample time setting 4 on every scanned channel, regular sequence in list order */
+    ADC1->SQR1 = (n_ch - 1u) << 20;     /* L: sequence length - 1 */
     ADC1->SQR3 = 0;
+    for (uint32_t c = 0; c < n_ch; c++) {
+        uint32_t in = ch[c].adc_channel;
+        if (in < 10u) {
+            ADC1->SMPR2 = (ADC1->SMPR2 & ~(7u << (3u * in))) | (4u << (3u * in));
+        } else {
+            ADC1->SMPR1 = (ADC1->SMPR1 & ~(7u << (3u * (in - 10u)))) | (4u << (3u * (in - 10u)));
+        }
+        ADC1->SQR3 |= in << (5u * c);
+    }
+
+    /* Scan the whole sequence on every trigger (single channel: plain conversion) */
+    if (n_ch > 1u) {
+        ADC1->CR1 |= ADC_CR1_SCAN;
+    } else {
+        ADC1->CR1 &= ~ADC_CR1_SCAN;
+    }
+
+    /* DMA2 Stream0 Channel0 <- ADC1: circular, 16-bit, interrupts at half and full buffer */
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+    DMA2_Stream0->CR &= ~DMA_SxCR_EN;
+    while (DMA2_Stream0->CR & DMA_SxCR_EN);
+    DMA2->LIFCR = DMA_LIFCR_CTCIF0 | DMA_LIFCR_CHTIF0 | DMA_LIFCR_CTEIF0 | DMA_LIFCR_CDMEIF0 | DMA_LIFCR_CFEIF0;
+
+    DMA2_Stream0->PAR  = (uint32_t)&ADC1->DR;
+    DMA2_Stream0->M0AR = (uint32_t)ad8232_dma_buf;
+    DMA2_Stream0->NDTR = 2u * half_len;
+    DMA2_Stream0->CR   = DMA_SxCR_PL_1 |                        /* high priority, channel 0 */
+                         DMA_SxCR_MSIZE_0 | DMA_SxCR_PSIZE_0 |  /* half-words */
+                         DMA_SxCR_MINC | DMA_SxCR_CIRC |
+                         DMA_SxCR_HTIE | DMA_SxCR_TCIE;
+    DMA2_Stream0->CR  |= DMA_SxCR_EN;
+
+    NVIC_SetPriority(DMA2_Stream0_IRQn, 1);
+    NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+
+    /* ADC1: conversion on the rising edge of TIM3 TRGO (EXTSEL = 1000), DMA requests kept on */
+    ADC1->CR2 &= ~(ADC_CR2_EXTEN | ADC_CR2_EXTSEL);
+    ADC1->CR2 |= ADC_CR2_EXTEN_0 | ADC_CR2_EXTSEL_3 | ADC_CR2_DMA | ADC_CR2_DDS;
 
     /* Enable ADC */
     ADC1->CR2 |= ADC_CR2_ADON;
 
     /* TIM3 Configuration for Sample Rate Management */
     RCC->APB1ENR |= RCC_APB1ENR_TIM3EN;
+    ad8232_timer(sample_rate_hz);
 
-    /*
-     * Use timer tick = 1MHz for good ARR resolution:
-     *   TIM3_CLK = 84MHz (APB1 timer clock on STM32F4 when APB1 prescaler != 1)
-     *   PSC = 83 => 84MHz/(83+1)=1MHz
-     * ARR = round(1e6 / Fs) - 1
-     */
-    TIM3->PSC = 83u;
+    /* Update event as TRGO: each period starts one conversion (one scan) in hardware, no TIM3 interrupt */
+    TIM3->CR2 = (TIM3->CR2 & ~TIM_CR2_MMS) | TIM_CR2_MMS_1;
 
-    if (sample_rate_hz > 0u) {
-        uint32_t arr = (1000000u + (sample_rate_hz / 2u)) / sample_rate_hz;
-        if (arr > 0u) arr -= 1u;
-        if (arr > 0xFFFFu) arr = 0xFFFFu;
-        TIM3->ARR = (uint16_t)arr;
-    } else {
-        TIM3->ARR = 2777u; /* default ~360Hz */
-    }
+    /* Enable Timer */
+    TIM3->CR1 |= TIM_CR1_CEN;
+
+    return 1;
+}
 
-    /* Enable Update Interrupt */
-    TIM3->DIER |= TIM_DIER_UIE;
+void AD8232_SetRate(uint32_t sample_rate_hz) {
+    if (sample_rate_hz == 0u) sample_rate_hz = 360u;
 
-    /* Enable Timer */
+    /*
+     * No trigger while PSC/ARR change; the conversions already in the DMA block keep their
+     * place. PSC is buffered until the next update (a UG would trigger a conversion), so
+     * only the first period after the change runs on the old prescaler.
+     */
+    TIM3->CR1 &= ~TIM_CR1_CEN;
+    ad8232_timer(sample_rate_hz);
+    TIM3->CNT = 0;
+    ad8232_debounce_samples = (AD8232_LEADS_DEBOUNCE_MS * sample_rate_hz + 999u) / 1000u;
     TIM3->CR1 |= TIM_CR1_CEN;
+}
+
+uint32_t AD8232_GetChannels(const SampleRing_Entry *s, uint8_t kind, uint16_t *out) {
+    uint32_t n = 0;
 
-    /* NVIC Configuration */
-    NVIC_EnableIRQ(TIM3_IRQn);
-    NVIC_SetPriority(TIM3_IRQn, 1);
+    for (uint32_t c = 0; c < ad8232_n_ch; c++) {
+        if (ad8232_channels[c].kind == kind) out[n++] = s->adc[c];
+    }
+    return n;
 }
 
 uint16_t AD8232_ReadValue(void) {
@@ -76,21 +210,90 @@ uint8_t AD8232_IsLeadsOff(void) {
     return 0;
 }
 
-/* Timer 3 Interrupt Handler (report flow: trigger ADC, wait EOC, read sample) */
-void TIM3_IRQHandler(void) {
-    if (TIM3->SR & TIM_SR_UIF) {
-        TIM3->SR &= ~TIM_SR_UIF;
+uint8_t AD8232_UpdateLeads(uint32_t seq) {
+    uint32_t edges = ad8232_lo_edges;
+    uint8_t  off = ad8232_lo_pins;
+
+    /* Any edge or an off level restarts the quiet time */
+    if (off || (edges != ad8232_lo_seen_edges)) {
+        ad8232_lo_seen_edges = edges;
+        ad8232_lo_stable_seq = seq;
+    }
+
+    if (off) {
+        ad8232_leads_off = 1;
+        return AD8232_LEADS_OFF;
+    }
+    if (ad8232_leads_off) {
+        if ((seq - ad8232_lo_stable_seq) < ad8232_debounce_samples) return AD8232_LEADS_OFF;
+        ad8232_leads_off = 0;
+        return AD8232_LEADS_REARM;
+    }
+    return AD8232_LEADS_ON;
+}
+
+/* LO+ / LO- edge: latch the pins */
+static void ad8232_lo_edge(uint32_t pr_mask) {
+    EXTI->PR = pr_mask;
+    ad8232_lo_pins = AD8232_IsLeadsOff();
+    ad8232_lo_edges++;
+}
+
+void EXTI1_IRQHandler(void) {
+    ad8232_lo_edge(EXTI_PR_PR1);
+}
+
+void EXTI4_IRQHandler(void) {
+    ad8232_lo_edge(EXTI_PR_PR4);
+}
+
+/*
+ * One half of the DMA buffer to the ring. Oversampled halves are reduced per channel
+ * first: leads through their FIR decimator, the other channels by group averages.
+ */
+static void ad8232_queue(const volatile uint16_t *half) {
+    static uint16_t frames[AD8232_BLOCK_SIZE * AD8232_MAX_CHANNELS];
+    const uint32_t n_ch = ad8232_n_ch;
+    const uint32_t m = ad8232_oversample;
 
-        /* 1) Trigger ADC conversion */
-        ADC1->CR2 |= ADC_CR2_SWSTART;
+    if (m == 1u) {
+        SampleRing_PushBlock(&ad8232_ring, half, n_ch, AD8232_BLOCK_SIZE);
+        return;
+    }
 
-        /* 2) Wait for EOC (few us) */
-        while (!(ADC1->SR & ADC_SR_EOC));
+    uint32_t lead = 0;
+    for (uint32_t c = 0; c < n_ch; c++) {
+        if (ad8232_channels[c].kind == AD8232_CH_LEAD) {
+            ADC_DecimBlock(&ad8232_decim[lead++], &half[c], n_ch, &frames[c]);
+            continue;
+        }
+        const volatile uint16_t *raw = &half[c];
+        for (uint32_t i = 0; i < AD8232_BLOCK_SIZE; i++) {
+            uint32_t sum = 0;
+            for (uint32_t k = 0; k < m; k++) sum += raw[(i * m + k) * n_ch];
+            frames[i * n_ch + c] = (uint16_t)((sum + m / 2u) / m);
+        }
+    }
+    SampleRing_PushBlock(&ad8232_ring, frames, n_ch, AD8232_BLOCK_SIZE);
+}
 
-        /* 3) Read ADC */
-        ad8232_latest_adc = (uint16_t)(ADC1->DR);
+/* DMA2 Stream0: a half of the ADC buffer is complete (HT: first half, TC: second half), queue it */
+void DMA2_Stream0_IRQHandler(void) {
+    uint32_t t0 = DWT->CYCCNT;
+    uint32_t lisr = DMA2->LISR;
 
-        /* 4) Signal main loop */
-        ad8232_sample_ready = 1;
+    if (lisr & DMA_LISR_HTIF0) {
+        DMA2->LIFCR = DMA_LIFCR_CHTIF0;
+        ad8232_queue(&ad8232_dma_buf[0]);
+    }
+    if (lisr & DMA_LISR_TCIF0) {
+        DMA2->LIFCR = DMA_LIFCR_CTCIF0;
+        ad8232_queue(&ad8232_dma_buf[AD8232_BLOCK_SIZE * ad8232_oversample * ad8232_n_ch]);
     }
+    if (lisr & (DMA_LISR_TEIF0 | DMA_LISR_DMEIF0 | DMA_LISR_FEIF0)) {
+        DMA2->LIFCR = DMA_LIFCR_CTEIF0 | DMA_LIFCR_CDMEIF0 | DMA_LIFCR_CFEIF0;
+    }
+
+    uint32_t cycles = DWT->CYCCNT - t0;
+    if (cycles > ad8232_isr_cycles_max) ad8232_isr_cycles_max = cycles;
 }
@@ -0,0 +1,39 @@
+#include "adc_decim.h"
+#include <string.h>
+
+static float32_t adc_decim_in[ADC_DECIM_MAX_IN];
+
+uint8_t ADC_DecimInit(ADC_Decim_t *d, uint32_t factor, uint32_t block_out) {
+    const ADC_Decim_Filter *f = NULL;
+
+    memset(d, 0, sizeof(*d));
+
+    for (uint32_t k = 0; k < ADC_DECIM_N_FACTORS; k++) {
+        if (adc_decim_filters[k].factor == factor) f = &adc_decim_filters[k];
+    }
+    if ((f == NULL) || (block_out == 0u) || (block_out > ADC_DECIM_MAX_BLOCK)) return 0;
+
+    d->factor = factor;
+    d->block_out = block_out;
+    arm_fir_decimate_init_f32(&d->fir, f->n_taps, (uint8_t)factor, f->taps, d->state, factor * block_out);
+
+    /* Start from mid-scale so the filter does not ramp up from 0 */
+    for (uint32_t i = 0; i < (uint32_t)f->n_taps - 1u; i++) d->state[i] = 2048.0f;
+
+    return 1;
+}
+
+void ADC_DecimBlock(ADC_Decim_t *d, const volatile uint16_t *raw, uint32_t stride, uint16_t *out) {
+    uint32_t n_in = d->factor * d->block_out;
+
+    for (uint32_t i = 0; i < n_in; i++) adc_decim_in[i] = (float32_t)raw[i * stride];
+
+    arm_fir_decimate_f32(&d->fir, adc_decim_in, d->out, n_in);
+
+    for (uint32_t i = 0; i < d->block_out; i++) {
+        float32_t v = d->out[i] + 0.5f;
+        if (v < 0.0f) v = 0.0f;
+        if (v > 4095.0f) v = 4095.0f;
+        out[i * stride] = (uint16_t)v;
+    }
+}
@@ -0,0 +1,308 @@
+#include "adc_decim.h"
+
+/*
+ * Anti-alias lowpass filters for adc_decim, generated by host/tools/gen_decim_fir.c.
+ * Kaiser windowed sinc, passband 0.35 * Fo, stopband from 0.5 * Fo, 60dB. Do not edit.
+ */
+
+static const float32_t adc_decim_taps_16[388] = {
+    2.582993511e-05f, 2.388010398e-05f, 2.057884376e-05f, 1.586313556e-05f,
+    9.722892173e-06f, 2.207065108e-06f, -6.572074199e-06f, -1.643684482e-05f,
+    -2.714450420e-05f, -3.839021883e-05f, -4.981278835e-05f, -6.100308019e-05f,
+    -7.151514728e-05f, -8.087972674e-05f, -8.861987590e-05f, -9.426828183e-05f,
+    -9.738575318e-05f, -9.758027591e-05f, -9.452593804e-05f, -8.798109047e-05f,
+    -7.780492888e-05f, -6.397179823e-05f, -4.658251783e-05f, -2.587206654e-05f,
+    -2.213115067e-06f, 2.388512257e-05f, 5.178295032e-05f, 8.072138007e-05f,
+    1.098383946e-04f, 1.381901238e-04f, 1.647765166e-04f, 1.885710080e-04f,
+    2.085532760e-04f, 2.237444714e-04f, 2.332434669e-04f, 2.362633677e-04f,
+    2.321667562e-04f, 2.204984485e-04f, 2.010146272e-04f, 1.737068087e-04f,
+    1.388197707e-04f, 9.686226986e-05f, 4.860968693e-05f, -4.901930424e-06f,
+    -6.239087088e-05f, -1.223539293e-04f, -1.830994734e-04f, -2.427889558e-04f,
+    -2.994859824e-04f, -3.512119001e-04f, -3.960063914e-04f, -4.319913860e-04f,
+    -4.574367485e-04f, -4.708250926e-04f, -4.709140048e-04f, -4.567937285e-04f,
+    -4.279373097e-04f, -3.842419828e-04f, -3.260596131e-04f, -2.542144211e-04f,
+    -1.700068824e-04f, -7.520272629e-05f, 2.799343565e-05f, 1.369798410e-04f,
+    2.488143800e-04f, 3.602855431e-04f, 4.679956764e-04f, 5.684554926e-04f,
+    6.581862108e-04f, 7.338279975e-04f, 7.922504446e-04f, 8.306620875e-04f,
+    8.467164007e-04f, 8.386088884e-04f, 8.051635814e-04f, 7.459046319e-04f,
+    6.611105637e-04f, 5.518477410e-04f, 4.199818068e-04f, 2.681654005e-04f,
+    9.980055620e-05f, -8.102335414e-05f, -2.696163428e-04f, -4.607972223e-04f,
+    -6.490238593e-04f, -8.285412914e-04f, -9.935440030e-04f, -1.138347900e-03f,
+    -1.257568481e-03f, -1.346297329e-03f, -1.400275505e-03f, -1.416053972e-03f,
+    -1.391139580e-03f, -1.324118697e-03f, -1.214754535e-03f, -1.064054901e-03f,
+    -8.743047947e-04f, -6.490639062e-04f, -3.931245301e-04f, -1.124313712e-04f,
+    1.860369812e-04f, 4.944233224e-04f, 8.041806868e-04f, 1.106290962e-03f,
+    1.391507569e-03f, 1.650617458e-03f, 1.874714042e-03f, 2.055474091e-03f,
+    2.185431542e-03f, 2.258238150e-03f, 2.268904122e-03f, 2.214010339e-03f,
+    2.091885312e-03f, 1.902737538e-03f, 1.648740727e-03f, 1.334066037e-03f,
+    9.648560081e-04f, 5.491418415e-04f, 9.670050349e-05f, -3.811444330e-04f,
+    -8.717763121e-04f, -1.361588016e-03f, -1.836327254e-03f, -2.281476511e-03f,
+    -2.682657680e-03f, -3.026052844e-03f, -3.298826981e-03f, -3.489543684e-03f,
+    -3.588558640e-03f, -3.588383086e-03f, -3.483999753e-03f, -3.273127368e-03f,
+    -2.956416225e-03f, -2.537574153e-03f, -2.023409819e-03f, -1.423793845e-03f,
+    -7.515295292e-04f, -2.213920197e-05f, 7.464365335e-04f, 1.534219948e-03f,
+    2.319650957e-03f, 3.080107272e-03f, 3.792477073e-03f, 4.433771595e-03f,
+    4.981765058e-03f, 5.415642168e-03f, 5.716637708e-03f, 5.868655164e-03f,
+    5.858838093e-03f, 5.678088404e-03f, 5.321506411e-03f, 4.788745195e-03f,
+    4.084262066e-03f, 3.217458492e-03f, 2.202702221e-03f, 1.059224363e-03f,
+    -1.891091233e-04f, -1.514151692e-03f, -2.883949317e-03f, -4.263328388e-03f,
+    -5.614582449e-03f, -6.898251362e-03f, -8.073968813e-03f, -9.101367556e-03f,
+    -9.941010736e-03f, -1.055534743e-02f, -1.090964209e-02f, -1.097288448e-02f,
+    -1.071863435e-02f, -1.012579072e-02f, -9.179265238e-03f, -7.870538160e-03f,
+    -6.198080257e-03f, -4.167628940e-03f, -1.792315161e-03f, 9.073785041e-04f,
+    3.903819248e-03f, 7.162588648e-03f, 1.064300537e-02f, 1.429879572e-02f,
+    1.807889529e-02f, 2.192837931e-02f, 2.578948066e-02f, 2.960269712e-02f,
+    3.330794722e-02f, 3.684575111e-02f, 4.015842453e-02f, 4.319123924e-02f,
+    4.589354619e-02f, 4.821978882e-02f, 5.013047531e-02f, 5.159297213e-02f,
+    5.258218199e-02f, 5.308109149e-02f, 5.308109149e-02f, 5.258218199e-02f,
+    5.159297213e-02f, 5.013047531e-02f, 4.821978882e-02f, 4.589354619e-02f,
+    4.319123924e-02f, 4.015842453e-02f, 3.684575111e-02f, 3.330794722e-02f,
+    2.960269712e-02f, 2.578948066e-02f, 2.192837931e-02f, 1.807889529e-02f,
+    1.429879572e-02f, 1.064300537e-02f, 7.162588648e-03f, 3.903819248e-03f,
+    9.073785041e-04f, -1.792315161e-03f, -4.167628940e-03f, -6.198080257e-03f,
+    -7.870538160e-03f, -9.179265238e-03f, -1.012579072e-02f, -1.071863435e-02f,
+    -1.097288448e-02f, -1.090964209e-02f, -1.055534743e-02f, -9.941010736e-03f,
+    -9.101367556e-03f, -8.073968813e-03f, -6.898251362e-03f, -5.614582449e-03f,
+    -4.263328388e-03f, -2.883949317e-03f, -1.514151692e-03f, -1.891091233e-04f,
+    1.059224363e-03f, 2.202702221e-03f, 3.217458492e-03f, 4.084262066e-03f,
+    4.788745195e-03f, 5.321506411e-03f, 5.678088404e-03f, 5.858838093e-03f,
+    5.868655164e-03f, 5.716637708e-03f, 5.415642168e-03f, 4.981765058e-03f,
+    4.433771595e-03f, 3.792477073e-03f, 3.080107272e-03f, 2.319650957e-03f,
+    1.534219948e-03f, 7.464365335e-04f, -2.213920197e-05f, -7.515295292e-04f,
+    -1.423793845e-03f, -2.023409819e-03f, -2.537574153e-03f, -2.956416225e-03f,
+    -3.273127368e-03f, -3.483999753e-03f, -3.588383086e-03f, -3.588558640e-03f,
+    -3.489543684e-03f, -3.298826981e-03f, -3.026052844e-03f, -2.682657680e-03f,
+    -2.281476511e-03f, -1.836327254e-03f, -1.361588016e-03f, -8.717763121e-04f,
+    -3.811444330e-04f, 9.670050349e-05f, 5.491418415e-04f, 9.648560081e-04f,
+    1.334066037e-03f, 1.648740727e-03f, 1.902737538e-03f, 2.091885312e-03f,
+    2.214010339e-03f, 2.268904122e-03f, 2.258238150e-03f, 2.185431542e-03f,
+    2.055474091e-03f, 1.874714042e-03f, 1.650617458e-03f, 1.391507569e-03f,
+    1.106290962e-03f, 8.041806868e-04f, 4.944233224e-04f, 1.860369812e-04f,
+    -1.124313712e-04f, -3.931245301e-04f, -6.490639062e-04f, -8.743047947e-04f,
+    -1.064054901e-03f, -1.214754535e-03f, -1.324118697e-03f, -1.391139580e-03f,
+    -1.416053972e-03f, -1.400275505e-03f, -1.346297329e-03f, -1.257568481e-03f,
+    -1.138347900e-03f, -9.935440030e-04f, -8.285412914e-04f, -6.490238593e-04f,
+    -4.607972223e-04f, -2.696163428e-04f, -8.102335414e-05f, 9.980055620e-05f,
+    2.681654005e-04f, 4.199818068e-04f, 5.518477410e-04f, 6.611105637e-04f,
+    7.459046319e-04f, 8.051635814e-04f, 8.386088884e-04f, 8.467164007e-04f,
+    8.306620875e-04f, 7.922504446e-04f, 7.338279975e-04f, 6.581862108e-04f,
+    5.684554926e-04f, 4.679956764e-04f, 3.602855431e-04f, 2.488143800e-04f,
+    1.369798410e-04f, 2.799343565e-05f, -7.520272629e-05f, -1.700068824e-04f,
+    -2.542144211e-04f, -3.260596131e-04f, -3.842419828e-04f, -4.279373097e-04f,
+    -4.567937285e-04f, -4.709140048e-04f, -4.708250926e-04f, -4.574367485e-04f,
+    -4.319913860e-04f, -3.960063914e-04f, -3.512119001e-04f, -2.994859824e-04f,
+    -2.427889558e-04f, -1.830994734e-04f, -1.223539293e-04f, -6.239087088e-05f,
+    -4.901930424e-06f, 4.860968693e-05f, 9.686226986e-05f, 1.388197707e-04f,
+    1.737068087e-04f, 2.010146272e-04f, 2.204984485e-04f, 2.321667562e-04f,
+    2.362633677e-04f, 2.332434669e-04f, 2.237444714e-04f, 2.085532760e-04f,
+    1.885710080e-04f, 1.647765166e-04f, 1.381901238e-04f, 1.098383946e-04f,
+    8.072138007e-05f, 5.178295032e-05f, 2.388512257e-05f, -2.213115067e-06f,
+    -2.587206654e-05f, -4.658251783e-05f, -6.397179823e-05f, -7.780492888e-05f,
+    -8.798109047e-05f, -9.452593804e-05f, -9.758027591e-05f, -9.738575318e-05f,
+    -9.426828183e-05f, -8.861987590e-05f, -8.087972674e-05f, -7.151514728e-05f,
+    -6.100308019e-05f, -4.981278835e-05f, -3.839021883e-05f, -2.714450420e-05f,
+    -1.643684482e-05f, -6.572074199e-06f, 2.207065108e-06f, 9.722892173e-06f,
+    1.586313556e-05f, 2.057884376e-05f, 2.388010398e-05f, 2.582993511e-05f,
+};
+
+static const float32_t adc_decim_taps_32[774] = {
+    1.247353339e-05f, 1.200295628e-05f, 1.136843275e-05f, 1.056443034e-05f,
+    9.586882697e-06f, 8.433304174e-06f, 7.102903055e-06f, 5.596672963e-06f,
+    3.917481536e-06f, 2.070136134e-06f, 6.143672238e-08f, -2.099790208e-06f,
+    -4.402675131e-06f, -6.834309261e-06f, -9.379767107e-06f, -1.202215208e-05f,
+    -1.474266264e-05f, -1.752067874e-05f, -2.033386772e-05f, -2.315832171e-05f,
+    -2.596869854e-05f, -2.873840458e-05f, -3.143977665e-05f, -3.404428935e-05f,
+    -3.652280066e-05f, -3.884577018e-05f, -4.098353020e-05f, -4.290655124e-05f,
+    -4.458572585e-05f, -4.599265594e-05f, -4.709993664e-05f, -4.788146907e-05f,
+    -4.831275146e-05f, -4.837117376e-05f, -4.803630509e-05f, -4.729019565e-05f,
+    -4.611762779e-05f, -4.450639244e-05f, -4.244752927e-05f, -3.993554128e-05f,
+    -3.696862041e-05f, -3.354880391e-05f, -2.968214176e-05f, -2.537880391e-05f,
+    -2.065318949e-05f, -1.552397407e-05f, -1.001412784e-05f, -4.150910172e-06f,
+    2.034188128e-06f, 8.505538062e-06f, 1.522350158e-05f, 2.214460619e-05f,
+    2.922175190e-05f, 3.640447176e-05f, 4.363920743e-05f, 5.086966121e-05f,
+    5.803713066e-05f, 6.508093065e-05f, 7.193882630e-05f, 7.854746946e-05f,
+    8.484291902e-05f, 9.076111746e-05f, 9.623846563e-05f, 1.012123175e-04f,
+    1.056216061e-04f, 1.094073523e-04f, 1.125132549e-04f, 1.148862866e-04f,
+    1.164772184e-04f, 1.172411939e-04f, 1.171382683e-04f, 1.161339023e-04f,
+    1.141994653e-04f, 1.113127073e-04f, 1.074581305e-04f, 1.026274258e-04f,
+    9.681974916e-05f, 9.004206368e-05f, 8.230930689e-05f, 7.364461635e-05f,
+    6.407940236e-05f, 5.365341349e-05f, 4.241469651e-05f, 3.041952914e-05f,
+    1.773224358e-05f, 4.425005045e-06f, -9.422496078e-06f, -2.372341623e-05f,
+    -3.838420162e-05f, -5.330510976e-05f, -6.838078116e-05f, -8.350088319e-05f,
+    -9.855083044e-05f, -1.134125487e-04f, -1.279652643e-04f, -1.420864282e-04f,
+    -1.556525676e-04f, -1.685402531e-04f, -1.806270884e-04f, -1.917927148e-04f,
+    -2.019197855e-04f, -2.108950430e-04f, -2.186102938e-04f, -2.249634999e-04f,
+    -2.298596664e-04f, -2.332119475e-04f, -2.349424758e-04f, -2.349833230e-04f,
+    -2.332773729e-04f, -2.297790197e-04f, -2.244550124e-04f, -2.172849927e-04f,
+    -2.082621650e-04f, -1.973936887e-04f, -1.847011299e-04f, -1.702206791e-04f,
+    -1.540033845e-04f, -1.361152244e-04f, -1.166369693e-04f, -9.566413064e-05f,
+    -7.330658991e-05f, -4.968823487e-05f, -2.494640830e-05f, 7.687269203e-07f,
+    2.729496009e-05f, 5.445892020e-05f, 8.207707288e-05f, 1.099568181e-04f,
+    1.378977031e-04f, 1.656927343e-04f, 1.931297447e-04f, 2.199928858e-04f,
+    2.460641845e-04f, 2.711250854e-04f, 2.949582122e-04f, 3.173489240e-04f,
+    3.380871203e-04f, 3.569689870e-04f, 3.737986844e-04f, 3.883900354e-04f,
+    4.005683004e-04f, 4.101718077e-04f, 4.170535249e-04f, 4.210825718e-04f,
+    4.221457639e-04f, 4.201488337e-04f, 4.150177701e-04f, 4.067000118e-04f,
+    3.951652325e-04f, 3.804063890e-04f, 3.624403325e-04f, 3.413083614e-04f,
+    3.170765413e-04f, 2.898359962e-04f, 2.597028215e-04f, 2.268178650e-04f,
+    1.913464366e-04f, 1.534777257e-04f, 1.134239064e-04f, 7.141932292e-05f,
+    2.771922664e-05f, -1.740153857e-05f, -6.365006993e-05f, -1.107171265e-04f,
+    -1.582789846e-04f, -2.059995168e-04f, -2.535323147e-04f, -3.005230392e-04f,
+    -3.466118942e-04f, -3.914361005e-04f, -4.346325004e-04f, -4.758404102e-04f,
+    -5.147041520e-04f, -5.508759641e-04f, -5.840188824e-04f, -6.138092722e-04f,
+    -6.399397389e-04f, -6.621219800e-04f, -6.800889969e-04f, -6.935980637e-04f,
+    -7.024328806e-04f, -7.064060192e-04f, -7.053607842e-04f, -6.991734845e-04f,
+    -6.877550040e-04f, -6.710524322e-04f, -6.490501110e-04f, -6.217711489e-04f,
+    -5.892778281e-04f, -5.516722449e-04f, -5.090966006e-04f, -4.617333179e-04f,
+    -4.098042846e-04f, -3.535705910e-04f, -2.933314245e-04f, -2.294228325e-04f,
+    -1.622161944e-04f, -9.211632278e-05f, -1.955939479e-05f, 5.498954488e-05f,
+    1.310392399e-04f, 2.080751874e-04f, 2.855628263e-04f, 3.629509883e-04f,
+    4.396754375e-04f, 5.151628284e-04f, 5.888345186e-04f, 6.601107307e-04f,
+    7.284147432e-04f, 7.931771688e-04f, 8.538403781e-04f, 9.098626324e-04f,
+    9.607226239e-04f, 1.005923725e-03f, 1.044997945e-03f, 1.077510533e-03f,
+    1.103063463e-03f, 1.121299341e-03f, 1.131905010e-03f, 1.134615042e-03f,
+    1.129214652e-03f, 1.115542371e-03f, 1.093492494e-03f, 1.063017407e-03f,
+    1.024129451e-03f, 9.769015014e-04f, 9.214687743e-04f, 8.580289432e-04f,
+    7.868420216e-04f, 7.082303637e-04f, 6.225776742e-04f, 5.303274957e-04f,
+    4.319818108e-04f, 3.280986275e-04f, 2.192892280e-04f, 1.062152587e-04f,
+    -1.041498308e-05f, -1.298504503e-04f, -2.513017098e-04f, -3.739457170e-04f,
+    -4.969308502e-04f, -6.193823065e-04f, -7.404079079e-04f, -8.591039223e-04f,
+    -9.745614370e-04f, -1.085872296e-03f, -1.192136086e-03f, -1.292466419e-03f,
+    -1.385997632e-03f, -1.471891534e-03f, -1.549343695e-03f, -1.617590548e-03f,
+    -1.675914857e-03f, -1.723653055e-03f, -1.760200248e-03f, -1.785016153e-03f,
+    -1.797630917e-03f, -1.797649544e-03f, -1.784756547e-03f, -1.758720493e-03f,
+    -1.719397143e-03f, -1.666732831e-03f, -1.600767020e-03f, -1.521634287e-03f,
+    -1.429565367e-03f, -1.324888319e-03f, -1.208028058e-03f, -1.079506357e-03f,
+    -9.399401606e-04f, -7.900394849e-04f, -6.306050345e-04f, -4.625247675e-04f,
+    -2.867697622e-04f, -1.043896409e-04f, 8.349288692e-05f, 2.756878966e-04f,
+    4.709448549e-04f, 6.679597427e-04f, 8.653827244e-04f, 1.061826246e-03f,
+    1.255873591e-03f, 1.446088078e-03f, 1.631022082e-03f, 1.809226698e-03f,
+    1.979262102e-03f, 2.139706397e-03f, 2.289167373e-03f, 2.426291350e-03f,
+    2.549773315e-03f, 2.658368321e-03f, 2.750899643e-03f, 2.826269716e-03f,
+    2.883468987e-03f, 2.921585226e-03f, 2.939811442e-03f, 2.937454730e-03f,
+    2.913943492e-03f, 2.868834650e-03f, 2.801819239e-03f, 2.712728688e-03f,
+    2.601539483e-03f, 2.468376886e-03f, 2.313517733e-03f, 2.137393691e-03f,
+    1.940591494e-03f, 1.723853755e-03f, 1.488078618e-03f, 1.234317548e-03f,
+    9.637732292e-04f, 6.777958479e-04f, 3.778784885e-04f, 6.565156946e-05f,
+    -2.571234945e-04f, -5.885618157e-04f, -9.266634006e-04f, -1.269322238e-03f,
+    -1.614336157e-03f, -1.959418179e-03f, -2.302207518e-03f, -2.640281804e-03f,
+    -2.971170004e-03f, -3.292365465e-03f, -3.601340810e-03f, -3.895559814e-03f,
+    -4.172494635e-03f, -4.429637920e-03f, -4.664519336e-03f, -4.874720704e-03f,
+    -5.057888571e-03f, -5.211751908e-03f, -5.334133282e-03f, -5.422966555e-03f,
+    -5.476308055e-03f, -5.492350552e-03f, -5.469437223e-03f, -5.406071898e-03f,
+    -5.300931633e-03f, -5.152876023e-03f, -4.960958846e-03f, -4.724435043e-03f,
+    -4.442769103e-03f, -4.115642048e-03f, -3.742955392e-03f, -3.324837890e-03f,
+    -2.861646935e-03f, -2.353971358e-03f, -1.802631421e-03f, -1.208678936e-03f,
+    -5.733948201e-04f, 1.017137765e-04f, 8.149179048e-04f, 1.564272679e-03f,
+    2.347623929e-03f, 3.162617097e-03f, 4.006705713e-03f, 4.877162166e-03f,
+    5.771089811e-03f, 6.685434841e-03f, 7.617000490e-03f, 8.562461473e-03f,
+    9.518377483e-03f, 1.048121415e-02f, 1.144735236e-02f, 1.241311338e-02f,
+    1.337477006e-02f, 1.432857011e-02f, 1.527075004e-02f, 1.619755663e-02f,
+    1.710526831e-02f, 1.799020357e-02f, 1.884875074e-02f, 1.967738196e-02f,
+    2.047266811e-02f, 2.123130299e-02f, 2.195011452e-02f, 2.262607962e-02f,
+    2.325634658e-02f, 2.383824624e-02f, 2.436930500e-02f, 2.484725788e-02f,
+    2.527006157e-02f, 2.563590184e-02f, 2.594320662e-02f, 2.619065717e-02f,
+    2.637718618e-02f, 2.650198713e-02f, 2.656452172e-02f, 2.656452172e-02f,
+    2.650198713e-02f, 2.637718618e-02f, 2.619065717e-02f, 2.594320662e-02f,
+    2.563590184e-02f, 2.527006157e-02f, 2.484725788e-02f, 2.436930500e-02f,
+    2.383824624e-02f, 2.325634658e-02f, 2.262607962e-02f, 2.195011452e-02f,
+    2.123130299e-02f, 2.047266811e-02f, 1.967738196e-02f, 1.884875074e-02f,
+    1.799020357e-02f, 1.710526831e-02f, 1.619755663e-02f, 1.527075004e-02f,
+    1.432857011e-02f, 1.337477006e-02f, 1.241311338e-02f, 1.144735236e-02f,
+    1.048121415e-02f, 9.518377483e-03f, 8.562461473e-03f, 7.617000490e-03f,
+    6.685434841e-03f, 5.771089811e-03f, 4.877162166e-03f, 4.006705713e-03f,
+    3.162617097e-03f, 2.347623929e-03f, 1.564272679e-03f, 8.149179048e-04f,
+    1.017137765e-04f, -5.733948201e-04f, -1.208678936e-03f, -1.802631421e-03f,
+    -2.353971358e-03f, -2.861646935e-03f, -3.324837890e-03f, -3.742955392e-03f,
+    -4.115642048e-03f, -4.442769103e-03f, -4.724435043e-03f, -4.960958846e-03f,
+    -5.152876023e-03f, -5.300931633e-03f, -5.406071898e-03f, -5.469437223e-03f,
+    -5.492350552e-03f, -5.476308055e-03f, -5.422966555e-03f, -5.334133282e-03f,
+    -5.211751908e-03f, -5.057888571e-03f, -4.874720704e-03f, -4.664519336e-03f,
+    -4.429637920e-03f, -4.172494635e-03f, -3.895559814e-03f, -3.601340810e-03f,
+    -3.292365465e-03f, -2.971170004e-03f, -2.640281804e-03f, -2.302207518e-03f,
+    -1.959418179e-03f, -1.614336157e-03f, -1.269322238e-03f, -9.266634006e-04f,
+    -5.885618157e-04f, -2.571234945e-04f, 6.565156946e-05f, 3.778784885e-04f,
+    6.777958479e-04f, 9.637732292e-04f, 1.234317548e-03f, 1.488078618e-03f,
+    1.723853755e-03f, 1.940591494e-03f, 2.137393691e-03f, 2.313517733e-03f,
+    2.468376886e-03f, 2.601539483e-03f, 2.712728688e-03f, 2.801819239e-03f,
+    2.868834650e-03f, 2.913943492e-03f, 2.937454730e-03f, 2.939811442e-03f,
+    2.921585226e-03f, 2.883468987e-03f, 2.826269716e-03f, 2.750899643e-03f,
+    2.658368321e-03f, 2.549773315e-03f, 2.426291350e-03f, 2.289167373e-03f,
+    2.139706397e-03f, 1.979262102e-03f, 1.809226698e-03f, 1.631022082e-03f,
+    1.446088078e-03f, 1.255873591e-03f, 1.061826246e-03f, 8.653827244e-04f,
+    6.679597427e-04f, 4.709448549e-04f, 2.756878966e-04f, 8.349288692e-05f,
+    -1.043896409e-04f, -2.867697622e-04f, -4.625247675e-04f, -6.306050345e-04f,
+    -7.900394849e-04f, -9.399401606e-04f, -1.079506357e-03f, -1.208028058e-03f,
+    -1.324888319e-03f, -1.429565367e-03f, -1.521634287e-03f, -1.600767020e-03f,
+    -1.666732831e-03f, -1.719397143e-03f, -1.758720493e-03f, -1.784756547e-03f,
+    -1.797649544e-03f, -1.797630917e-03f, -1.785016153e-03f, -1.760200248e-03f,
+    -1.723653055e-03f, -1.675914857e-03f, -1.617590548e-03f, -1.549343695e-03f,
+    -1.471891534e-03f, -1.385997632e-03f, -1.292466419e-03f, -1.192136086e-03f,
+    -1.085872296e-03f, -9.745614370e-04f, -8.591039223e-04f, -7.404079079e-04f,
+    -6.193823065e-04f, -4.969308502e-04f, -3.739457170e-04f, -2.513017098e-04f,
+    -1.298504503e-04f, -1.041498308e-05f, 1.062152587e-04f, 2.192892280e-04f,
+    3.280986275e-04f, 4.319818108e-04f, 5.303274957e-04f, 6.225776742e-04f,
+    7.082303637e-04f, 7.868420216e-04f, 8.580289432e-04f, 9.214687743e-04f,
+    9.769015014e-04f, 1.024129451e-03f, 1.063017407e-03f, 1.093492494e-03f,
+    1.115542371e-03f, 1.129214652e-03f, 1.134615042e-03f, 1.131905010e-03f,
+    1.121299341e-03f, 1.103063463e-03f, 1.077510533e-03f, 1.044997945e-03f,
+    1.005923725e-03f, 9.607226239e-04f, 9.098626324e-04f, 8.538403781e-04f,
+    7.931771688e-04f, 7.284147432e-04f, 6.601107307e-04f, 5.888345186e-04f,
+    5.151628284e-04f, 4.396754375e-04f, 3.629509883e-04f, 2.855628263e-04f,
+    2.080751874e-04f, 1.310392399e-04f, 5.498954488e-05f, -1.955939479e-05f,
+    -9.211632278e-05f, -1.622161944e-04f, -2.294228325e-04f, -2.933314245e-04f,
+    -3.535705910e-04f, -4.098042846e-04f, -4.617333179e-04f, -5.090966006e-04f,
+    -5.516722449e-04f, -5.892778281e-04f, -6.217711489e-04f, -6.490501110e-04f,
+    -6.710524322e-04f, -6.877550040e-04f, -6.991734845e-04f, -7.053607842e-04f,
+    -7.064060192e-04f, -7.024328806e-04f, -6.935980637e-04f, -6.800889969e-04f,
+    -6.621219800e-04f, -6.399397389e-04f, -6.138092722e-04f, -5.840188824e-04f,
+    -5.508759641e-04f, -5.147041520e-04f, -4.758404102e-04f, -4.346325004e-04f,
+    -3.914361005e-04f, -3.466118942e-04f, -3.005230392e-04f, -2.535323147e-04f,
+    -2.059995168e-04f, -1.582789846e-04f, -1.107171265e-04f, -6.365006993e-05f,
+    -1.740153857e-05f, 2.771922664e-05f, 7.141932292e-05f, 1.134239064e-04f,
+    1.534777257e-04f, 1.913464366e-04f, 2.268178650e-04f, 2.597028215e-04f,
+    2.898359962e-04f, 3.170765413e-04f, 3.413083614e-04f, 3.624403325e-04f,
+    3.804063890e-04f, 3.951652325e-04f, 4.067000118e-04f, 4.150177701e-04f,
+    4.201488337e-04f, 4.221457639e-04f, 4.210825718e-04f, 4.170535249e-04f,
+    4.101718077e-04f, 4.005683004e-04f, 3.883900354e-04f, 3.737986844e-04f,
+    3.569689870e-04f, 3.380871203e-04f, 3.173489240e-04f, 2.949582122e-04f,
+    2.711250854e-04f, 2.460641845e-04f, 2.199928858e-04f, 1.931297447e-04f,
+    1.656927343e-04f, 1.378977031e-04f, 1.099568181e-04f, 8.207707288e-05f,
+    5.445892020e-05f, 2.729496009e-05f, 7.687269203e-07f, -2.494640830e-05f,
+    -4.968823487e-05f, -7.330658991e-05f, -9.566413064e-05f, -1.166369693e-04f,
+    -1.361152244e-04f, -1.540033845e-04f, -1.702206791e-04f, -1.847011299e-04f,
+    -1.973936887e-04f, -2.082621650e-04f, -2.172849927e-04f, -2.244550124e-04f,
+    -2.297790197e-04f, -2.332773729e-04f, -2.349833230e-04f, -2.349424758e-04f,
+    -2.332119475e-04f, -2.298596664e-04f, -2.249634999e-04f, -2.186102938e-04f,
+    -2.108950430e-04f, -2.019197855e-04f, -1.917927148e-04f, -1.806270884e-04f,
+    -1.685402531e-04f, -1.556525676e-04f, -1.420864282e-04f, -1.279652643e-04f,
+    -1.134125487e-04f, -9.855083044e-05f, -8.350088319e-05f, -6.838078116e-05f,
+    -5.330510976e-05f, -3.838420162e-05f, -2.372341623e-05f, -9.422496078e-06f,
+    4.425005045e-06f, 1.773224358e-05f, 3.041952914e-05f, 4.241469651e-05f,
+    5.365341349e-05f, 6.407940236e-05f, 7.364461635e-05f, 8.230930689e-05f,
+    9.004206368e-05f, 9.681974916e-05f, 1.026274258e-04f, 1.074581305e-04f,
+    1.113127073e-04f, 1.141994653e-04f, 1.161339023e-04f, 1.171382683e-04f,
+    1.172411939e-04f, 1.164772184e-04f, 1.148862866e-04f, 1.125132549e-04f,
+    1.094073523e-04f, 1.056216061e-04f, 1.012123175e-04f, 9.623846563e-05f,
+    9.076111746e-05f, 8.484291902e-05f, 7.854746946e-05f, 7.193882630e-05f,
+    6.508093065e-05f, 5.803713066e-05f, 5.086966121e-05f, 4.363920743e-05f,
+    3.640447176e-05f, 2.922175190e-05f, 2.214460619e-05f, 1.522350158e-05f,
+    8.505538062e-06f, 2.034188128e-06f, -4.150910172e-06f, -1.001412784e-05f,
+    -1.552397407e-05f, -2.065318949e-05f, -2.537880391e-05f, -2.968214176e-05f,
+    -3.354880391e-05f, -3.696862041e-05f, -3.993554128e-05f, -4.244752927e-05f,
+    -4.450639244e-05f, -4.611762779e-05f, -4.729019565e-05f, -4.803630509e-05f,
+    -4.837117376e-05f, -4.831275146e-05f, -4.788146907e-05f, -4.709993664e-05f,
+    -4.599265594e-05f, -4.458572585e-05f, -4.290655124e-05f, -4.098353020e-05f,
+    -3.884577018e-05f, -3.652280066e-05f, -3.404428935e-05f, -3.143977665e-05f,
+    -2.873840458e-05f, -2.596869854e-05f, -2.315832171e-05f, -2.033386772e-05f,
+    -1.752067874e-05f, -1.474266264e-05f, -1.202215208e-05f, -9.379767107e-06f,
+    -6.834309261e-06f, -4.402675131e-06f, -2.099790208e-06f, 6.143672238e-08f,
+    2.070136134e-06f, 3.917481536e-06f, 5.596672963e-06f, 7.102903055e-06f,
+    8.433304174e-06f, 9.586882697e-06f, 1.056443034e-05f, 1.136843275e-05f,
+    1.200295628e-05f, 1.247353339e-05f,
+};
+
+const ADC_Decim_Filter adc_decim_filters[ADC_DECIM_N_FACTORS] = {
+    { 16, 388, adc_decim_taps_16 },
+    { 32, 774, adc_decim_taps_32 },
+};
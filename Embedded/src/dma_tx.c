@@ -0,0 +1,111 @@
+#include "dma_tx.h"
+#include <string.h>
+
+/* Stream flags within a LISR/HISR group: FEIF, DMEIF, TEIF, HTIF, TCIF */
+#define DMA_TX_FEIF     (1u << 0)
+#define DMA_TX_DMEIF    (1u << 2)
+#define DMA_TX_TEIF     (1u << 3)
+#define DMA_TX_HTIF     (1u << 4)
+#define DMA_TX_TCIF     (1u << 5)
+#define DMA_TX_ALL      (DMA_TX_FEIF | DMA_TX_DMEIF | DMA_TX_TEIF | DMA_TX_HTIF | DMA_TX_TCIF)
+
+/* Position of the flags of streams 0..3 (LISR) and 4..7 (HISR) */
+static const uint8_t dma_tx_flag_pos[4] = { 0u, 6u, 16u, 22u };
+
+/* Hand the next contiguous region of the ring to the stream (stream disabled, idle) */
+static void dma_tx_start(DMA_Tx_t *tx) {
+    uint32_t tail = tx->tail;
+    uint32_t off = tail & (tx->size - 1u);
+    uint32_t n = tx->head - tail;
+
+    if (n > tx->size - off) n = tx->size - off;
+    tx->dma_len = n;
+    if (n == 0u) return;
+
+    *tx->ifcr = DMA_TX_ALL << tx->flag_pos;
+    tx->stream->M0AR = (uint32_t)&tx->buf[off];
+    tx->stream->NDTR = n;
+    tx->stream->CR  |= DMA_SxCR_EN;
+}
+
+/* Queue the len bytes written from head on */
+static void dma_tx_publish(DMA_Tx_t *tx, uint32_t head, uint32_t len) {
+    /* Publish the bytes before the head */
+    __DMB();
+    tx->head = head + len;
+
+    uint32_t used = tx->head - tx->tail;
+    if (used > tx->high_water) tx->high_water = used;
+
+    /*
+     * Idle stream: start it here. Otherwise the interrupt of the transfer in flight
+     * sees the new head and chains it; it cannot run between this test and the start,
+     * since no transfer is in flight.
+     */
+    if (tx->dma_len == 0u) dma_tx_start(tx);
+}
+
+void DMA_Tx_Init(DMA_Tx_t *tx, uint8_t *buf, uint32_t size,
+                 DMA_TypeDef *dma, DMA_Stream_TypeDef *stream, uint32_t n) {
+    memset(tx, 0, sizeof(*tx));
+    tx->buf = buf;
+    tx->size = size;
+    tx->stream = stream;
+    tx->isr = (n < 4u) ? &dma->LISR : &dma->HISR;
+    tx->ifcr = (n < 4u) ? &dma->LIFCR : &dma->HIFCR;
+    tx->flag_pos = dma_tx_flag_pos[n & 3u];
+
+    stream->CR &= ~DMA_SxCR_EN;
+    while (stream->CR & DMA_SxCR_EN);
+    *tx->ifcr = DMA_TX_ALL << tx->flag_pos;
+}
+
+uint8_t DMA_Tx_Write(DMA_Tx_t *tx, const void *data, uint32_t len) {
+    uint32_t head = tx->head;
+    uint32_t used = head - tx->tail;
+
+    if (len > tx->size - used) {
+        tx->dropped++;
+        tx->dropped_bytes += len;
+        return 0;
+    }
+
+    /* Copy, wrapping at the end of the buffer */
+    uint32_t off = head & (tx->size - 1u);
+    uint32_t first = tx->size - off;
+    if (first > len) first = len;
+    memcpy(&tx->buf[off], data, first);
+    memcpy(tx->buf, (const uint8_t *)data + first, len - first);
+
+    dma_tx_publish(tx, head, len);
+    return 1;
+}
+
+void DMA_Tx_Begin(DMA_Tx_t *tx, ECG_Ser_t *w) {
+    uint32_t head = tx->head;
+    ECG_Ser_Ring(w, tx->buf, tx->size, head, tx->size - (head - tx->tail), ECG_SER_TEXT);
+}
+
+uint8_t DMA_Tx_Commit(DMA_Tx_t *tx, const ECG_Ser_t *w) {
+    uint32_t len = ECG_Ser_Len(w);
+
+    if (!ECG_Ser_Fits(w)) {
+        tx->dropped++;
+        tx->dropped_bytes += len;
+        return 0;
+    }
+    dma_tx_publish(tx, w->start, len);
+    return 1;
+}
+
+void DMA_Tx_IRQHandler(DMA_Tx_t *tx) {
+    uint32_t flags = *tx->isr >> tx->flag_pos;
+
+    /* A transfer error disables the stream: the region is given up like a sent one */
+    if (flags & (DMA_TX_TCIF | DMA_TX_TEIF)) {
+        *tx->ifcr = (DMA_TX_TCIF | DMA_TX_TEIF | DMA_TX_DMEIF | DMA_TX_FEIF) << tx->flag_pos;
+        __DMB();
+        tx->tail += tx->dma_len;
+        dma_tx_start(tx);
+    }
+}
@@ -0,0 +1,113 @@
+#include "ecg_cmd.h"
+#include "ecg_ser.h"
+#include "stm32f4xx.h"
+#include <string.h>
+
+#define ECG_CMD_MAX_ARGS 2u
+
+/*
+ * Decimal arguments after the command letter: ",<n>" up to max times, nothing else.
+ * - Returns: number of arguments, or -1 if the line is malformed
+ */
+static int ecg_cmd_args(const char *p, uint32_t *arg, uint32_t max) {
+    uint32_t n = 0;
+
+    while (*p == ',') {
+        uint32_t v = 0;
+        uint32_t digits = 0;
+
+        if (n == max) return -1;
+        for (p++; (*p >= '0') && (*p <= '9'); p++, digits++) {
+            if (v > 99999999u) return -1;       /* keep it far from overflow */
+            v = v * 10u + (uint32_t)(*p - '0');
+        }
+        if (digits == 0u) return -1;
+        arg[n++] = v;
+    }
+    return (*p == '\0') ? (int)n : -1;
+}
+
+uint8_t ECG_Cmd_Parse(const char *line, ECG_Cmd_Config *cfg) {
+    uint32_t arg[ECG_CMD_MAX_ARGS];
+    int n = ecg_cmd_args(&line[1], arg, ECG_CMD_MAX_ARGS);
+
+    switch (line[0]) {
+    case 'M':
+        if ((n != 1) || (arg[0] >= ECG_STREAM_COUNT)) return ECG_CMD_BAD_ARG;
+        cfg->stream = arg[0];
+        return ECG_CMD_OK;
+    case 'R':
+        if ((n != 1) || (arg[0] == 0u)) return ECG_CMD_BAD_ARG;
+        cfg->sample_rate_hz = arg[0];
+        return ECG_CMD_OK;
+    case 'D':
+        if ((n != 2) || (arg[1] == 0u)) return ECG_CMD_BAD_ARG;
+        cfg->log_mask = arg[0];
+        cfg->log_decim = arg[1];
+        return ECG_CMD_OK;
+    case 'S':
+        if ((n != 1) || (arg[0] > 1u)) return ECG_CMD_BAD_ARG;
+        cfg->sim = arg[0];
+        return ECG_CMD_OK;
+    case '?':
+        return (n == 0) ? ECG_CMD_OK : ECG_CMD_BAD_ARG;
+    default:
+        return ECG_CMD_UNKNOWN;
+    }
+}
+
+uint32_t ECG_Cmd_FormatAck(char *out, char cmd, uint8_t status, const ECG_Cmd_Config *cfg) {
+    /* Keep the record parseable whatever the first character was */
+    if ((cmd < '!') || (cmd > '~') || (cmd == ',')) cmd = '?';
+
+    ECG_Ser_t w;
+    ECG_Ser_Buffer(&w, out, ECG_CMD_ACK_MAX, ECG_SER_TEXT);
+    ECG_Ser_Tag(&w, 'K');
+    ECG_Ser_Byte(&w, ',');
+    ECG_Ser_Byte(&w, (uint8_t)cmd);
+    ECG_Ser_FieldU(&w, status, 1u);
+    ECG_Ser_FieldU(&w, cfg->stream, 4u);
+    ECG_Ser_FieldU(&w, cfg->sample_rate_hz, 4u);
+    ECG_Ser_FieldU(&w, cfg->sim, 4u);
+    ECG_Ser_FieldU(&w, cfg->log_mask, 4u);
+    ECG_Ser_FieldU(&w, cfg->log_decim, 4u);
+    ECG_Ser_End(&w);
+    return ECG_Ser_Fits(&w) ? ECG_Ser_Len(&w) : 0u;
+}
+
+void ECG_Cmd_RxByte(ECG_Cmd_Rx_t *rx, char c) {
+    if ((c == '\r') || (c == '\n')) {
+        ECG_Cmd_RxEnd(rx);
+    } else if ((rx->fill < ECG_CMD_LINE_MAX) && (rx->head - rx->tail < ECG_CMD_RX_LINES)) {
+        rx->line[rx->head & (ECG_CMD_RX_LINES - 1u)][rx->fill++] = c;
+    } else {
+        /* Too long, or the free slot is missing: the oldest line is still unread */
+        rx->discard = 1;
+    }
+}
+
+void ECG_Cmd_RxEnd(ECG_Cmd_Rx_t *rx) {
+    uint32_t head = rx->head;
+
+    if (rx->discard) {
+        rx->dropped++;
+    } else if (rx->fill != 0u) {
+        rx->line[head & (ECG_CMD_RX_LINES - 1u)][rx->fill] = '\0';
+        /* Line visible before the new head */
+        __DMB();
+        rx->head = head + 1u;
+    }
+    rx->fill = 0;
+    rx->discard = 0;
+}
+
+uint8_t ECG_Cmd_RxRead(ECG_Cmd_Rx_t *rx, char *line) {
+    uint32_t tail = rx->tail;
+
+    if (rx->head == tail) return 0;
+    __DMB();
+    memcpy(line, rx->line[tail & (ECG_CMD_RX_LINES - 1u)], ECG_CMD_LINE_MAX + 1u);
+    __DMB();
+    rx->tail = tail + 1u;
+    return 1;
+}
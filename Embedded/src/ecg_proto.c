@@ -0,0 +1,140 @@
+#include "ecg_proto.h"
+#include "ecg_ser.h"
+
+void ECG_Proto_Init(ECG_Proto_t *p) {
+    p->seq = 0;
+}
+
+uint16_t ECG_Proto_CRC16(const uint8_t *data, uint32_t n) {
+    uint16_t crc = 0xFFFFu;
+
+    for (uint32_t i = 0; i < n; i++) {
+        crc ^= (uint16_t)((uint16_t)data[i] << 8);
+        for (uint32_t b = 0; b < 8u; b++) {
+            crc = (crc & 0x8000u) ? (uint16_t)((crc << 1) ^ 0x1021u) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+uint32_t ECG_Proto_COBS(const uint8_t *in, uint32_t n, uint8_t *out) {
+    uint32_t code_pos = 0;      /* where the length code of the current block goes */
+    uint32_t len = 1;
+    uint8_t code = 1;
+
+    for (uint32_t i = 0; i < n; i++) {
+        if (in[i] != 0u) {
+            out[len++] = in[i];
+            code++;
+        }
+        /* A zero, or a full block of 254 non-zero bytes, closes the block */
+        if (in[i] == 0u || code == 0xFFu) {
+            out[code_pos] = code;
+            code_pos = len++;
+            code = 1;
+        }
+    }
+    out[code_pos] = code;
+    out[len++] = 0x00u;
+    return len;
+}
+
+/* Common header; returns its size */
+static uint32_t ecg_proto_header(ECG_Proto_t *p, uint8_t *raw, uint8_t type, uint32_t tick) {
+    ECG_Ser_t w;
+    ECG_Ser_Buffer(&w, raw, ECG_PROTO_HEADER_SIZE, ECG_SER_BIN);
+    ECG_Ser_Tag(&w, (char)((ECG_PROTO_VERSION << 4) | type));
+    ECG_Ser_FieldU(&w, p->seq, 2u);
+    ECG_Ser_FieldU(&w, tick, 4u);
+    p->seq++;
+    return ECG_Ser_Len(&w);
+}
+
+/* CRC over raw[0 .. len), then COBS into out */
+static uint32_t ecg_proto_finish(uint8_t *raw, uint32_t len, uint8_t *out) {
+    uint16_t crc = ECG_Proto_CRC16(raw, len);
+    raw[len++] = (uint8_t)crc;
+    raw[len++] = (uint8_t)(crc >> 8);
+    return ECG_Proto_COBS(raw, len, out);
+}
+
+static uint8_t ecg_proto_bpm(int bpm) {
+    if (bpm < 0) return 0;
+    if (bpm > 255) return 255;
+    return (uint8_t)bpm;
+}
+
+uint32_t ECG_Proto_Samples(ECG_Proto_t *p, uint8_t *out, uint32_t tick, const uint16_t *samples, uint32_t n, int bpm) {
+    uint8_t raw[ECG_PROTO_MAX_RAW];
+    uint32_t len = ecg_proto_header(p, raw, ECG_PROTO_TYPE_SAMPLES, tick);
+
+    if (n > ECG_PROTO_SAMPLES) n = ECG_PROTO_SAMPLES;
+    raw[len++] = (uint8_t)n;
+    raw[len++] = ecg_proto_bpm(bpm);
+
+    /* 12-bit samples, two in three bytes */
+    uint32_t i = 0;
+    for (; i + 1u < n; i += 2u) {
+        uint16_t a = samples[i] & 0x0FFFu;
+        uint16_t b = samples[i + 1u] & 0x0FFFu;
+        raw[len++] = (uint8_t)a;
+        raw[len++] = (uint8_t)((a >> 8) | (b << 4));
+        raw[len++] = (uint8_t)(b >> 4);
+    }
+    if (i < n) {
+        uint16_t a = samples[i] & 0x0FFFu;
+        raw[len++] = (uint8_t)a;
+        raw[len++] = (uint8_t)(a >> 8);
+    }
+
+    return ecg_proto_finish(raw, len, out);
+}
+
+uint32_t ECG_Proto_Beat(ECG_Proto_t *p, uint8_t *out, uint32_t r_tick, uint32_t rr, int bpm) {
+    uint8_t raw[ECG_PROTO_HEADER_SIZE + 3u + ECG_PROTO_CRC_SIZE];
+    uint32_t len = ecg_proto_header(p, raw, ECG_PROTO_TYPE_BEAT, r_tick);
+
+    /* Body fields as in the text "B" record (hc05.c), packed */
+    ECG_Ser_t w;
+    ECG_Ser_Buffer(&w, &raw[len], 3u, ECG_SER_BIN);
+    ECG_Ser_FieldU(&w, (rr > 0xFFFFu) ? 0xFFFFu : rr, 2u);
+    ECG_Ser_FieldU(&w, ecg_proto_bpm(bpm), 1u);
+
+    return ecg_proto_finish(raw, len + ECG_Ser_Len(&w), out);
+}
+
+uint32_t ECG_Proto_Rice(ECG_Proto_t *p, uint8_t *out, uint32_t tick, const uint16_t *samples, uint32_t n, int bpm) {
+    uint8_t raw[ECG_PROTO_MAX_RAW];
+    uint32_t len = ecg_proto_header(p, raw, ECG_PROTO_TYPE_RICE, tick);
+
+    if (n > ECG_RICE_BLOCK) n = ECG_RICE_BLOCK;
+    raw[len++] = (uint8_t)n;
+    raw[len++] = ecg_proto_bpm(bpm);
+    len += ECG_Rice_Encode(samples, n, &raw[len]);
+
+    return ecg_proto_finish(raw, len, out);
+}
+
+uint32_t ECG_Proto_Text(ECG_Proto_t *p, uint8_t *out, uint32_t tick, const char *text, uint32_t len) {
+    uint8_t raw[ECG_PROTO_HEADER_SIZE + ECG_PROTO_TEXT_MAX + ECG_PROTO_CRC_SIZE];
+    uint32_t n = ecg_proto_header(p, raw, ECG_PROTO_TYPE_TEXT, tick);
+
+    if (len > ECG_PROTO_TEXT_MAX) len = ECG_PROTO_TEXT_MAX;
+    for (uint32_t i = 0; i < len; i++) raw[n++] = (uint8_t)text[i];
+
+    return ecg_proto_finish(raw, n, out);
+}
+
+uint32_t ECG_Proto_Prof(ECG_Proto_t *p, uint8_t *out, uint32_t tick, uint8_t probe,
+                        const uint32_t *stats, const uint16_t *hist) {
+    uint8_t raw[ECG_PROTO_HEADER_SIZE + 1u + 4u * 4u + 2u * ECG_PROTO_PROF_BINS + ECG_PROTO_CRC_SIZE];
+    uint32_t len = ecg_proto_header(p, raw, ECG_PROTO_TYPE_PROF, tick);
+
+    ECG_Ser_t w;
+    ECG_Ser_Buffer(&w, &raw[len], 1u + 4u * 4u + 2u * ECG_PROTO_PROF_BINS, ECG_SER_BIN);
+    ECG_Ser_FieldU(&w, probe, 1u);
+    for (uint32_t i = 0; i < 4u; i++) ECG_Ser_FieldU(&w, stats[i], 4u);
+    for (uint32_t i = 0; i < ECG_PROTO_PROF_BINS; i++) ECG_Ser_FieldU(&w, hist[i], 2u);
+
+    return ecg_proto_finish(raw, len + ECG_Ser_Len(&w), out);
+}
@@ -0,0 +1,158 @@
+#include "ecg_rice.h"
+
+/* MSB-first bit writer; acc keeps the bits not yet flushed in its low `bits` bits */
+typedef struct {
+    uint8_t *p;
+    uint32_t acc;
+    uint32_t bits;
+} ecg_rice_writer;
+
+static inline void ecg_rice_put(ecg_rice_writer *w, uint32_t v, uint32_t n) {
+    w->acc = (w->acc << n) | v;
+    w->bits += n;
+    while (w->bits >= 8u) {
+        w->bits -= 8u;
+        *w->p++ = (uint8_t)(w->acc >> w->bits);
+    }
+}
+
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+    uint32_t acc;
+    uint32_t bits;
+} ecg_rice_reader;
+
+/* Read n <= 24 bits; past the end reads zeros and marks the reader (p > end) */
+static inline uint32_t ecg_rice_get(ecg_rice_reader *r, uint32_t n) {
+    while (r->bits < n) {
+        r->acc = (r->acc << 8) | ((r->p < r->end) ? *r->p : 0u);
+        r->p++;
+        r->bits += 8u;
+    }
+    r->bits -= n;
+    return (r->acc >> r->bits) & ((1u << n) - 1u);
+}
+
+static inline uint32_t ecg_rice_zigzag(int32_t r) {
+    return (r >= 0) ? (uint32_t)r << 1 : ((uint32_t)(-r) << 1) - 1u;
+}
+
+static inline int32_t ecg_rice_unzigzag(uint32_t u) {
+    return (u & 1u) ? -(int32_t)((u + 1u) >> 1) : (int32_t)(u >> 1);
+}
+
+/* Exact bits of one partition coded with parameter k */
+static uint32_t ecg_rice_cost(const uint32_t *u, uint32_t m, uint32_t k) {
+    uint32_t bits = 0;
+    for (uint32_t i = 0; i < m; i++) {
+        uint32_t q = u[i] >> k;
+        bits += (q < ECG_RICE_ESC) ? q + 1u + k : ECG_RICE_ESC + 15u;
+    }
+    return bits;
+}
+
+uint32_t ECG_Rice_Encode(const uint16_t *x, uint32_t n, uint8_t *out) {
+    ecg_rice_writer w = { out, 0u, 0u };
+    uint32_t u[ECG_RICE_BLOCK];
+
+    if (n == 0u) return 0;
+    if (n > ECG_RICE_BLOCK) n = ECG_RICE_BLOCK;
+
+    /* Predictor order: the one with the smaller absolute residual sum */
+    uint32_t sum1 = 0;
+    uint32_t sum2 = 0;
+    for (uint32_t i = 2; i < n; i++) {
+        int32_t d1 = (int32_t)x[i] - (int32_t)x[i - 1u];
+        int32_t d2 = d1 - ((int32_t)x[i - 1u] - (int32_t)x[i - 2u]);
+        sum1 += (uint32_t)((d1 < 0) ? -d1 : d1);
+        sum2 += (uint32_t)((d2 < 0) ? -d2 : d2);
+    }
+    uint32_t order2 = (sum2 < sum1) ? 1u : 0u;
+
+    ecg_rice_put(&w, x[0] & 0x0FFFu, 12u);
+    ecg_rice_put(&w, order2, 1u);
+
+    for (uint32_t i = 1; i < n; i++) {
+        int32_t pred = (order2 && i >= 2u) ? 2 * (int32_t)x[i - 1u] - (int32_t)x[i - 2u] : (int32_t)x[i - 1u];
+        u[i - 1u] = ecg_rice_zigzag((int32_t)(x[i] & 0x0FFFu) - pred);
+    }
+
+    for (uint32_t first = 0; first < n - 1u; first += ECG_RICE_PART) {
+        uint32_t m = n - 1u - first;
+        if (m > ECG_RICE_PART) m = ECG_RICE_PART;
+        const uint32_t *pu = &u[first];
+
+        /* Best k near log2 of the mean, against storing the samples verbatim */
+        uint32_t sum = 0;
+        for (uint32_t i = 0; i < m; i++) sum += pu[i];
+        uint32_t mean = sum / m;
+        uint32_t k0 = 0;
+        while ((k0 < 14u) && ((2u << k0) <= mean)) k0++;
+
+        uint32_t best_k = ECG_RICE_K_RAW;
+        uint32_t best_bits = 12u * m;
+        for (uint32_t k = (k0 > 1u) ? k0 - 1u : 0u; (k <= k0 + 1u) && (k < ECG_RICE_K_RAW); k++) {
+            uint32_t bits = ecg_rice_cost(pu, m, k);
+            if (bits < best_bits) {
+                best_bits = bits;
+                best_k = k;
+            }
+        }
+
+        ecg_rice_put(&w, best_k, 4u);
+        if (best_k == ECG_RICE_K_RAW) {
+            for (uint32_t i = 0; i < m; i++) ecg_rice_put(&w, x[first + 1u + i] & 0x0FFFu, 12u);
+            continue;
+        }
+        for (uint32_t i = 0; i < m; i++) {
+            uint32_t q = pu[i] >> best_k;
+            if (q < ECG_RICE_ESC) {
+                /* q ones and a zero (q + 1 <= 16 bits), then the low bits */
+                ecg_rice_put(&w, ((1u << q) - 1u) << 1, q + 1u);
+                if (best_k != 0u) ecg_rice_put(&w, pu[i] & ((1u << best_k) - 1u), best_k);
+            } else {
+                ecg_rice_put(&w, (1u << ECG_RICE_ESC) - 1u, ECG_RICE_ESC);
+                ecg_rice_put(&w, pu[i], 15u);
+            }
+        }
+    }
+
+    /* Zero-pad the last byte */
+    if (w.bits != 0u) ecg_rice_put(&w, 0u, 8u - w.bits);
+    return (uint32_t)(w.p - out);
+}
+
+uint32_t ECG_Rice_Decode(const uint8_t *in, uint32_t len, uint16_t *x, uint32_t n) {
+    ecg_rice_reader r = { in, in + len, 0u, 0u };
+
+    if (n == 0u) return 0;
+    if (n > ECG_RICE_BLOCK) n = ECG_RICE_BLOCK;
+
+    x[0] = (uint16_t)ecg_rice_get(&r, 12u);
+    uint32_t order2 = ecg_rice_get(&r, 1u);
+
+    uint32_t i = 1;
+    while (i < n) {
+        uint32_t m = n - i;
+        if (m > ECG_RICE_PART) m = ECG_RICE_PART;
+        uint32_t k = ecg_rice_get(&r, 4u);
+
+        for (uint32_t end = i + m; i < end; i++) {
+            if (k == ECG_RICE_K_RAW) {
+                x[i] = (uint16_t)ecg_rice_get(&r, 12u);
+                continue;
+            }
+            uint32_t q = 0;
+            while ((q < ECG_RICE_ESC) && ecg_rice_get(&r, 1u)) q++;
+            uint32_t u = (q < ECG_RICE_ESC) ? (q << k) | ((k != 0u) ? ecg_rice_get(&r, k) : 0u)
+                                            : ecg_rice_get(&r, 15u);
+            int32_t pred = (order2 && i >= 2u) ? 2 * (int32_t)x[i - 1u] - (int32_t)x[i - 2u] : (int32_t)x[i - 1u];
+            x[i] = (uint16_t)((pred + ecg_rice_unzigzag(u)) & 0x0FFF);
+        }
+        if (r.p > r.end) return 0;
+    }
+
+    if (r.p > r.end) return 0;
+    return (uint32_t)(r.p - in);
+}
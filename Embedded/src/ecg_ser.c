@@ -0,0 +1,121 @@
+#include "ecg_ser.h"
+
+/* "00" "01" ... "99" */
+static const char ecg_ser_pairs[200] = {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9',
+};
+
+static const uint32_t ecg_ser_pow10[ECG_SER_DEC_MAX] = {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u,
+};
+
+void ECG_Ser_Buffer(ECG_Ser_t *w, void *buf, uint32_t size, uint8_t mode) {
+    w->buf = (uint8_t *)buf;
+    w->mask = UINT32_MAX;
+    w->start = 0;
+    w->pos = 0;
+    w->room = size;
+    w->mode = mode;
+}
+
+void ECG_Ser_Ring(ECG_Ser_t *w, uint8_t *ring, uint32_t size, uint32_t head, uint32_t room, uint8_t mode) {
+    w->buf = ring;
+    w->mask = size - 1u;
+    w->start = head;
+    w->pos = head;
+    w->room = room;
+    w->mode = mode;
+}
+
+void ECG_Ser_Bytes(ECG_Ser_t *w, const void *data, uint32_t n) {
+    uint32_t used = w->pos - w->start;
+
+    /* A record that no longer fits is dropped whole: only its length matters */
+    if ((n == 0u) || (used > w->room) || (n > w->room - used)) {
+        w->pos += n;
+        return;
+    }
+
+    /* Copy, wrapping at the end of a ring */
+    const uint8_t *src = (const uint8_t *)data;
+    uint32_t off = w->pos & w->mask;
+    if (n - 1u <= w->mask - off) {
+        memcpy(&w->buf[off], src, n);
+    } else {
+        uint32_t first = w->mask - off + 1u;
+        memcpy(&w->buf[off], src, first);
+        memcpy(w->buf, src + first, n - first);
+    }
+    w->pos += n;
+}
+
+/* Digits of v right-aligned in tmp[ECG_SER_DEC_MAX], at least width of them; returns the first index */
+static uint32_t ecg_ser_digits(char *tmp, uint32_t v, uint32_t width) {
+    uint32_t i = ECG_SER_DEC_MAX;
+
+    while (v >= 100u) {
+        uint32_t r = (v % 100u) * 2u;
+        v /= 100u;
+        tmp[--i] = ecg_ser_pairs[r + 1u];
+        tmp[--i] = ecg_ser_pairs[r];
+    }
+    if (v >= 10u) {
+        tmp[--i] = ecg_ser_pairs[v * 2u + 1u];
+        tmp[--i] = ecg_ser_pairs[v * 2u];
+    } else {
+        tmp[--i] = (char)('0' + v);
+    }
+
+    if (width > ECG_SER_DEC_MAX) width = ECG_SER_DEC_MAX;
+    while (ECG_SER_DEC_MAX - i < width) tmp[--i] = '0';
+    return i;
+}
+
+void ECG_Ser_Dec(ECG_Ser_t *w, uint32_t v) {
+    char tmp[ECG_SER_DEC_MAX];
+    uint32_t i = ecg_ser_digits(tmp, v, 0u);
+    ECG_Ser_Bytes(w, &tmp[i], ECG_SER_DEC_MAX - i);
+}
+
+void ECG_Ser_DecS(ECG_Ser_t *w, int32_t v) {
+    uint32_t u = (uint32_t)v;
+
+    if (v < 0) {
+        ECG_Ser_Byte(w, '-');
+        u = 0u - u;
+    }
+    ECG_Ser_Dec(w, u);
+}
+
+void ECG_Ser_DecW(ECG_Ser_t *w, uint32_t v, uint32_t width) {
+    char tmp[ECG_SER_DEC_MAX];
+    uint32_t i = ecg_ser_digits(tmp, v, width);
+    ECG_Ser_Bytes(w, &tmp[i], ECG_SER_DEC_MAX - i);
+}
+
+void ECG_Ser_Fix(ECG_Ser_t *w, int32_t v, uint32_t frac_digits) {
+    uint32_t u = (uint32_t)v;
+
+    if (frac_digits >= ECG_SER_DEC_MAX) frac_digits = ECG_SER_DEC_MAX - 1u;
+    if (v < 0) {
+        ECG_Ser_Byte(w, '-');
+        u = 0u - u;
+    }
+    if (frac_digits == 0u) {
+        ECG_Ser_Dec(w, u);
+        return;
+    }
+    uint32_t p = ecg_ser_pow10[frac_digits];
+    ECG_Ser_Dec(w, u / p);
+    ECG_Ser_Byte(w, '.');
+    ECG_Ser_DecW(w, u % p, frac_digits);
+}
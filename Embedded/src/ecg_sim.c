@@ -1,7 +1,6 @@
 #include "ecg_sim.h"
 #include <stdlib.h>
 
-#define ECG_SIM_FS_HZ      360.0f
 #define ECG_SIM_BPM        60.0f
 #define ECG_LUT_LEN        200u
 
@@ -10,6 +9,11 @@ static float32_t ecg_phase = 0.0f;
 static float32_t wander_phase = 0.0f;
 static float32_t noise50hz_phase = 0.0f;
 
+/* Phase increments per sample at the rate given to ECG_Sim_Init */
+static float32_t ecg_inc = 0.0f;
+static float32_t wander_inc = 0.0f;
+static float32_t noise50hz_inc = 0.0f;
+
 /* Standard ECG waveform lookup table one cycle normalized amplitude */
 const int16_t ecg_lut[ECG_LUT_LEN] = {
       0,   0,   0,   0,   0,   0,   0,   5,  10,  15,  20,  25,  30,  30,  30,  25,  20,  15,  10,   5,
@@ -24,7 +28,15 @@ const int16_t ecg_lut[ECG_LUT_LEN] = {
       0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0
 };
 
-void ECG_Sim_Init(void) {
+void ECG_Sim_Init(uint32_t sample_rate_hz) {
+    float32_t fs = (float32_t)((sample_rate_hz != 0u) ? sample_rate_hz : 360u);
+
+    /* Desired samples per heartbeat at Fs: one LUT cycle spans them */
+    float32_t samples_per_cycle = (fs * 60.0f) / ECG_SIM_BPM;
+    ecg_inc = (float32_t)ECG_LUT_LEN / samples_per_cycle;
+    wander_inc = 2.0f * 3.1415926f * 0.5f / fs;
+    noise50hz_inc = 2.0f * 3.1415926f * 50.0f / fs;
+
     ecg_phase = 0.0f;
     wander_phase = 0.0f;
     noise50hz_phase = 0.0f;
@@ -33,12 +45,8 @@ void ECG_Sim_Init(void) {
 uint16_t ECG_Sim_GetSample(void) {
     float32_t sample_val = 0.0f;
 
-    /* Desired samples per heartbeat at current Fs */
-    float32_t samples_per_cycle = (ECG_SIM_FS_HZ * 60.0f) / ECG_SIM_BPM;
-
-    /* Advance LUT phase so that one LUT cycle spans samples_per_cycle samples */
-    float32_t phase_inc = (float32_t)ECG_LUT_LEN / samples_per_cycle;
-    ecg_phase += phase_inc;
+    /* Advance LUT phase so that one LUT cycle spans one heartbeat */
+    ecg_phase += ecg_inc;
     while (ecg_phase >= (float32_t)ECG_LUT_LEN) ecg_phase -= (float32_t)ECG_LUT_LEN;
 
     uint16_t idx = (uint16_t)ecg_phase;
@@ -46,12 +54,12 @@ uint16_t ECG_Sim_GetSample(void) {
 
     /* Add baseline wander 0.5Hz simulates respiration */
     sample_val += 150.0f * arm_sin_f32(wander_phase);
-    wander_phase += (2.0f * 3.1415926f * 0.5f / ECG_SIM_FS_HZ);
+    wander_phase += wander_inc;
     if (wander_phase > 6.2831852f) wander_phase -= 6.2831852f;
 
     /* Add 50Hz powerline noise */
     sample_val += 30.0f * arm_sin_f32(noise50hz_phase);
-    noise50hz_phase += (2.0f * 3.1415926f * 50.0f / ECG_SIM_FS_HZ);
+    noise50hz_phase += noise50hz_inc;
     if (noise50hz_phase > 6.2831852f) noise50hz_phase -= 6.2831852f;
 
     /* Add random noise EMG simulation */
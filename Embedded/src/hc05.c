@@ -1,4 +1,12 @@
 #include "hc05.h"
+#include "prof.h"
+
+DMA_Tx_t hc05_tx;
+static uint8_t hc05_tx_buf[HC05_TX_SIZE];
+HC05_Rx_t hc05_rx;
+
+/* Binary frame sequence: a frame dropped by a full ring still takes its number */
+static ECG_Proto_t hc05_proto;
 
 void HC05_Init(void) {
     /* Enable GPIOA and USART1 clocks */
@@ -24,23 +32,285 @@ void HC05_Init(void) {
     USART1->CR1 = 0;
     
     /* Baudrate configuration */
-    uint32_t brr_val = (APB2_CLOCK_FREQ + (HC05_BAUDRATE / 2)) / HC05_BAUDRATE;
-    USART1->BRR = (uint16_t)brr_val;
+    HC05_SetClock();
+
+    /* Enable Transmitter Receiver and USART, transmit requests to DMA, receive and idle-line interrupts */
+    memset(&hc05_rx, 0, sizeof(hc05_rx));
+    USART1->CR3 |= USART_CR3_DMAT;
+    USART1->CR1 |= USART_CR1_TE | USART_CR1_RE | USART_CR1_RXNEIE | USART_CR1_IDLEIE | USART_CR1_UE;
+
+    /* DMA2 Stream7 Channel4 -> USART1: byte-wise, memory to peripheral, one region per transfer */
+    ECG_Proto_Init(&hc05_proto);
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+    DMA_Tx_Init(&hc05_tx, hc05_tx_buf, HC05_TX_SIZE, DMA2, DMA2_Stream7, 7u);
+
+    DMA2_Stream7->PAR = (uint32_t)&USART1->DR;
+    DMA2_Stream7->CR  = DMA_SxCR_CHSEL_2 |                      /* channel 4, low priority */
+                        DMA_SxCR_DIR_0 | DMA_SxCR_MINC |
+                        DMA_SxCR_TCIE | DMA_SxCR_TEIE;
 
-    /* Enable Transmitter Receiver and USART */
-    USART1->CR1 |= USART_CR1_TE | USART_CR1_RE | USART_CR1_UE;
+    /* Below the acquisition interrupts: a late TX refill only delays the line */
+    NVIC_SetPriority(DMA2_Stream7_IRQn, 3);
+    NVIC_EnableIRQ(DMA2_Stream7_IRQn);
+
+    /* Commands: one byte per 87us at most, below the transmit refill */
+    NVIC_SetPriority(USART1_IRQn, 4);
+    NVIC_EnableIRQ(USART1_IRQn);
 }
 
-void HC05_SendChar(char c) {
-    /* Wait until transmit data register is empty */
-    while (!(USART1->SR & USART_SR_TXE));
-    
-    /* Write data to register */
-    USART1->DR = c;
+void HC05_SetClock(void) {
+    /* USART1 runs on PCLK2: 84MHz at the boot clock */
+    uint32_t pclk2 = SystemCoreClock >> APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos];
+    USART1->BRR = (uint16_t)((pclk2 + (HC05_BAUDRATE / 2u)) / HC05_BAUDRATE);
+}
+
+uint8_t HC05_Write(const char *data, uint32_t len) {
+    PROF_BEGIN(t_prof);
+    uint8_t queued = DMA_Tx_Write(&hc05_tx, data, len);
+    PROF_END(PROF_HC05_WRITE, t_prof);
+    return queued;
+}
+
+void HC05_Begin(ECG_Ser_t *w) {
+    DMA_Tx_Begin(&hc05_tx, w);
+}
+
+uint8_t HC05_Commit(const ECG_Ser_t *w) {
+    PROF_BEGIN(t_prof);
+    uint8_t queued = DMA_Tx_Commit(&hc05_tx, w);
+    PROF_END(PROF_HC05_WRITE, t_prof);
+    return queued;
+}
+
+uint8_t HC05_SendChar(char c) {
+    return HC05_Write(&c, 1u);
+}
+
+uint8_t HC05_SendString(char *str) {
+    return HC05_Write(str, (uint32_t)strlen(str));
 }
 
-void HC05_SendString(char *str) {
-    while (*str) {
-        HC05_SendChar(*str++);
+/* DMA2 Stream7: a region is in USART1, release it and chain the next one */
+void DMA2_Stream7_IRQHandler(void) {
+    DMA_Tx_IRQHandler(&hc05_tx);
+}
+
+/* USART1: one received byte (RXNE) or the end of a burst (IDLE) */
+void USART1_IRQHandler(void) {
+    uint32_t sr = USART1->SR;
+
+    if (sr & (USART_SR_RXNE | USART_SR_ORE | USART_SR_FE | USART_SR_NE)) {
+        /* Reading DR after SR clears RXNE and the error flags (and IDLE) */
+        char c = (char)USART1->DR;
+
+        if (sr & (USART_SR_ORE | USART_SR_FE | USART_SR_NE)) hc05_rx.errors++;
+        ECG_Cmd_RxByte(&hc05_rx.lines, c);
+    } else if (sr & USART_SR_IDLE) {
+        (void)USART1->DR;
+        ECG_Cmd_RxEnd(&hc05_rx.lines);
     }
-}
\ No newline at end of file
+}
+
+uint8_t HC05_ReadLine(char *line) {
+    return ECG_Cmd_RxRead(&hc05_rx.lines, line);
+}
+
+void HC05_SendSample(uint16_t value, int bpm) {
+    ECG_Ser_t w;
+    HC05_Begin(&w);
+    ECG_Ser_Dec(&w, value);
+    ECG_Ser_FieldS(&w, bpm, 2u);
+    ECG_Ser_End(&w);
+    HC05_Commit(&w);
+}
+
+void HC05_SendFrame(uint32_t tick, const uint16_t *samples, uint32_t n) {
+    ECG_Ser_t w;
+    HC05_Begin(&w);
+    ECG_Ser_Tag(&w, 'W');
+    ECG_Ser_FieldU(&w, tick, 4u);
+
+    if (n > HC05_FRAME_SAMPLES) n = HC05_FRAME_SAMPLES;
+    for (uint32_t i = 0; i < n; i++) {
+        ECG_Ser_FieldU(&w, samples[i], 2u);
+    }
+    ECG_Ser_End(&w);
+    HC05_Commit(&w);
+}
+
+void HC05_SendAux(uint32_t tick, const uint16_t *v, uint32_t n) {
+    ECG_Ser_t w;
+    HC05_Begin(&w);
+    ECG_Ser_Tag(&w, 'A');
+    ECG_Ser_FieldU(&w, tick, 4u);
+
+    if (n > 4u) n = 4u;
+    for (uint32_t i = 0; i < n; i++) {
+        ECG_Ser_FieldU(&w, v[i], 2u);
+    }
+    ECG_Ser_End(&w);
+    HC05_Commit(&w);
+}
+
+void HC05_SendBeat(uint32_t r_tick, uint32_t rr, int32_t amplitude, int32_t signal, int32_t noise, int bpm) {
+    ECG_Ser_t w;
+    HC05_Begin(&w);
+    ECG_Ser_Tag(&w, 'B');
+    ECG_Ser_FieldU(&w, r_tick, 4u);
+    ECG_Ser_FieldU(&w, rr, 4u);
+    ECG_Ser_FieldS(&w, amplitude, 4u);
+    ECG_Ser_FieldS(&w, signal, 4u);
+    ECG_Ser_FieldS(&w, noise, 4u);
+    ECG_Ser_FieldS(&w, bpm, 2u);
+    ECG_Ser_End(&w);
+    HC05_Commit(&w);
+}
+
+void HC05_SendLeads(uint32_t off_ms, uint32_t first_bpm_ms, int bpm) {
+    ECG_Ser_t w;
+    HC05_Begin(&w);
+    ECG_Ser_Tag(&w, 'L');
+    ECG_Ser_FieldU(&w, off_ms, 4u);
+    ECG_Ser_FieldU(&w, first_bpm_ms, 4u);
+    ECG_Ser_FieldS(&w, bpm, 2u);
+    ECG_Ser_End(&w);
+    HC05_Commit(&w);
+}
+
+void HC05_SendSamplesBin(uint32_t tick, const uint16_t *samples, uint32_t n, int bpm) {
+    uint8_t frame[ECG_PROTO_MAX_FRAME];
+    uint32_t len = ECG_Proto_Samples(&hc05_proto, frame, tick, samples, n, bpm);
+    HC05_Write((const char *)frame, len);
+}
+
+void HC05_SendRiceBin(uint32_t tick, const uint16_t *samples, uint32_t n, int bpm) {
+    uint8_t frame[ECG_PROTO_MAX_FRAME];
+    uint32_t len = ECG_Proto_Rice(&hc05_proto, frame, tick, samples, n, bpm);
+    HC05_Write((const char *)frame, len);
+}
+
+void HC05_SendRecord(uint8_t binary, uint32_t tick, const char *record, uint32_t len) {
+    if (binary) {
+        uint8_t frame[ECG_PROTO_MAX_FRAME];
+        while ((len > 0u) && ((record[len - 1u] == '\r') || (record[len - 1u] == '\n'))) len--;
+        HC05_Write((const char *)frame, ECG_Proto_Text(&hc05_proto, frame, tick, record, len));
+    } else {
+        HC05_Write(record, len);
+    }
+}
+
+void HC05_SendBeatBin(uint32_t r_tick, uint32_t rr, int bpm) {
+    uint8_t frame[ECG_PROTO_MAX_FRAME];
+    uint32_t len = ECG_Proto_Beat(&hc05_proto, frame, r_tick, rr, bpm);
+    HC05_Write((const char *)frame, len);
+}
+
+void HC05_SendHRV(uint32_t window, const HRV_Metrics *m) {
+    ECG_Ser_t w;
+    HC05_Begin(&w);
+    ECG_Ser_Tag(&w, 'H');
+    ECG_Ser_FieldU(&w, window, 1u);
+    ECG_Ser_FieldU(&w, m->n_rr, 2u);
+    /* Tenths as integers: no float formatting */
+    ECG_Ser_FieldFix(&w, (int32_t)(m->mean_rr_ms * 10.0f + 0.5f), 1u, 4u);
+    ECG_Ser_FieldFix(&w, (int32_t)(m->sdnn_ms * 10.0f + 0.5f), 1u, 4u);
+    ECG_Ser_FieldFix(&w, (int32_t)(m->rmssd_ms * 10.0f + 0.5f), 1u, 4u);
+    ECG_Ser_FieldFix(&w, (int32_t)(m->pnn50 * 10.0f + 0.5f), 1u, 4u);
+    ECG_Ser_FieldU(&w, m->hr_min, 2u);
+    ECG_Ser_FieldU(&w, m->hr_max, 2u);
+    ECG_Ser_End(&w);
+    HC05_Commit(&w);
+}
+
+void HC05_SendHRVFreq(const HRV_FreqResult *r, uint32_t worst_slice_cycles, uint32_t budget_cycles, uint32_t overruns) {
+    ECG_Ser_t w;
+    HC05_Begin(&w);
+    ECG_Ser_Tag(&w, 'F');
+    ECG_Ser_FieldU(&w, r->span_s, 2u);
+    ECG_Ser_FieldS(&w, (int32_t)(r->lf_ms2 + 0.5f), 4u);
+    ECG_Ser_FieldS(&w, (int32_t)(r->hf_ms2 + 0.5f), 4u);
+    ECG_Ser_FieldS(&w, (int32_t)(r->total_ms2 + 0.5f), 4u);
+    ECG_Ser_FieldFix(&w, (int32_t)(r->lf_hf * 100.0f + 0.5f), 2u, 4u);
+    ECG_Ser_FieldU(&w, worst_slice_cycles, 4u);
+    ECG_Ser_FieldU(&w, budget_cycles, 4u);
+    ECG_Ser_FieldU(&w, overruns, 4u);
+    ECG_Ser_End(&w);
+    HC05_Commit(&w);
+}
+
+/* "<tag>,<v[0]>,...,<v[n-1]>\r\n" */
+static void hc05_send_u32s(char tag, const uint32_t *v, uint32_t n) {
+    ECG_Ser_t w;
+    HC05_Begin(&w);
+    ECG_Ser_Tag(&w, tag);
+    for (uint32_t i = 0; i < n; i++) ECG_Ser_FieldU(&w, v[i], 4u);
+    ECG_Ser_End(&w);
+    HC05_Commit(&w);
+}
+
+void HC05_SendRingStats(uint32_t seq, uint32_t dropped, uint32_t high_water, uint32_t size,
+                        uint32_t isr_cycles, uint32_t block_cycles) {
+    const uint32_t v[] = { seq, dropped, high_water, size, isr_cycles, block_cycles };
+    hc05_send_u32s('S', v, sizeof(v) / sizeof(v[0]));
+}
+
+void HC05_SendTxStats(void) {
+    const uint32_t v[] = { hc05_tx.tail, hc05_tx.dropped, hc05_tx.dropped_bytes, hc05_tx.high_water, HC05_TX_SIZE };
+    hc05_send_u32s('T', v, sizeof(v) / sizeof(v[0]));
+}
+
+void HC05_SendTaskStats(uint32_t id, const Sched_Task *t) {
+    ECG_Ser_t w;
+    HC05_Begin(&w);
+    ECG_Ser_Tag(&w, 'Q');
+    ECG_Ser_FieldU(&w, id, 1u);
+    ECG_Ser_Byte(&w, ',');
+    ECG_Ser_Str(&w, t->name);
+    ECG_Ser_FieldU(&w, t->jobs, 4u);
+    ECG_Ser_FieldU(&w, t->misses, 4u);
+    ECG_Ser_FieldU(&w, t->merged, 4u);
+    ECG_Ser_FieldU(&w, t->wcet, 4u);
+    ECG_Ser_FieldU(&w, t->max_response, 4u);
+    ECG_Ser_FieldU(&w, t->deadline, 4u);
+    ECG_Ser_End(&w);
+    HC05_Commit(&w);
+}
+
+void HC05_SendSelfTest(uint32_t acq_stalls, uint32_t tx_stalls, uint32_t pt_faults,
+                       uint32_t stack_used, uint32_t stack_size) {
+    const uint32_t v[] = { acq_stalls, tx_stalls, pt_faults, stack_used, stack_size };
+    hc05_send_u32s('Y', v, sizeof(v) / sizeof(v[0]));
+}
+
+void HC05_SendPower(uint32_t level, uint32_t hclk_hz, uint32_t awake_cycles, uint32_t duty_permille,
+                    uint32_t wakeups, uint32_t switches) {
+    const uint32_t v[] = { level, hclk_hz, awake_cycles, duty_permille, wakeups, switches };
+    hc05_send_u32s('P', v, sizeof(v) / sizeof(v[0]));
+}
+
+void HC05_SendHealth(uint8_t binary, uint32_t tick, const Health_t *h) {
+    char rec[ECG_PROTO_TEXT_MAX];
+    ECG_Ser_t w;
+
+    ECG_Ser_Buffer(&w, rec, sizeof(rec), ECG_SER_TEXT);
+    ECG_Ser_Tag(&w, 'G');
+    ECG_Ser_FieldU(&w, h->acquired_s, 4u);
+    ECG_Ser_FieldU(&w, h->processed_s, 4u);
+    ECG_Ser_FieldU(&w, h->overruns_s, 4u);
+    ECG_Ser_FieldU(&w, h->late_s, 4u);
+    ECG_Ser_FieldU(&w, h->tx_bytes_s, 4u);
+    ECG_Ser_FieldU(&w, h->tx_dropped_s, 4u);
+    ECG_Ser_FieldU(&w, h->dbg_dropped_s, 4u);
+    ECG_Ser_FieldU(&w, h->loop_max_us, 4u);
+    ECG_Ser_FieldU(&w, h->leads_off_ms, 4u);
+    ECG_Ser_FieldU(&w, h->reset_cause, 1u);
+    ECG_Ser_FieldU(&w, h->wdt_resets, 4u);
+    ECG_Ser_FieldU(&w, h->stall_task, 1u);
+    ECG_Ser_End(&w);
+    if (!ECG_Ser_Fits(&w)) {
+        hc05_tx.dropped++;
+        hc05_tx.dropped_bytes += ECG_Ser_Len(&w);
+        return;
+    }
+    HC05_SendRecord(binary, tick, rec, ECG_Ser_Len(&w));
+}
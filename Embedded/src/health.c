@@ -0,0 +1,127 @@
+#include "health.h"
+#include "ad8232.h"
+#include "hc05.h"
+#include "usart2.h"
+
+Health_t health;
+
+/* IWDG_KR keys */
+#define HEALTH_IWDG_RELOAD  0xAAAAu
+#define HEALTH_IWDG_UNLOCK  0x5555u
+#define HEALTH_IWDG_START   0xCCCCu
+
+/* Bounds the waits on the LSI and the IWDG register updates (a few LSI periods) */
+#define HEALTH_LSI_SPINS    100000u
+
+/* Backup registers: slice trace (Sched_SetTrace) and watchdog reset count */
+#define HEALTH_BKP_TRACE    (RTC->BKP0R)
+#define HEALTH_BKP_RESETS   (RTC->BKP1R)
+
+static const char *const health_reset_name[] = {
+    "power", "pin", "software", "watchdog", "window-watchdog", "low-power",
+};
+
+/* RCC_CSR flags, most specific first: an internal reset also pulls NRST, a power-on also sets BORRSTF */
+static uint8_t health_reset_cause(uint32_t csr) {
+    if (csr & RCC_CSR_IWDGRSTF) return HEALTH_RESET_IWDG;
+    if (csr & RCC_CSR_WWDGRSTF) return HEALTH_RESET_WWDG;
+    if (csr & RCC_CSR_LPWRRSTF) return HEALTH_RESET_LOW_POWER;
+    if (csr & RCC_CSR_SFTRSTF) return HEALTH_RESET_SOFTWARE;
+    if (csr & (RCC_CSR_PORRSTF | RCC_CSR_BORRSTF)) return HEALTH_RESET_POWER;
+    return HEALTH_RESET_PIN;
+}
+
+void Health_Init(Sched_t *s) {
+    /* LSI: clock of the watchdog and of the RTC domain */
+    RCC->CSR |= RCC_CSR_LSION;
+    for (uint32_t i = 0; (i < HEALTH_LSI_SPINS) && !(RCC->CSR & RCC_CSR_LSIRDY); i++) {
+    }
+
+    /* Backup registers: write access, RTC domain clocked unless already set up */
+    RCC->APB1ENR |= RCC_APB1ENR_PWREN;
+    PWR->CR |= PWR_CR_DBP;
+    if ((RCC->BDCR & RCC_BDCR_RTCSEL) == 0u) RCC->BDCR |= RCC_BDCR_RTCSEL_1;   /* LSI */
+    RCC->BDCR |= RCC_BDCR_RTCEN;
+
+    /* Reset cause; after a watchdog reset the trace holds the slice it interrupted */
+    uint32_t csr = RCC->CSR;
+    RCC->CSR |= RCC_CSR_RMVF;
+    health.reset_cause = health_reset_cause(csr);
+    health.stall_task = SCHED_NONE;
+    if (health.reset_cause == HEALTH_RESET_IWDG) {
+        uint32_t id = HEALTH_BKP_TRACE;
+        if (id < s->n_tasks) health.stall_task = (uint8_t)id;
+        HEALTH_BKP_RESETS = HEALTH_BKP_RESETS + 1u;
+    } else if (health.reset_cause == HEALTH_RESET_POWER) {
+        HEALTH_BKP_RESETS = 0;
+    }
+    health.wdt_resets = HEALTH_BKP_RESETS;
+
+    /* "RESET,<cause>,<task>,<wdt_resets>" */
+    ECG_Ser_t w;
+    USART2_Begin(&w);
+    ECG_Ser_Str(&w, "RESET,");
+    ECG_Ser_Str(&w, health_reset_name[health.reset_cause]);
+    ECG_Ser_Byte(&w, ',');
+    ECG_Ser_Str(&w, (health.stall_task != SCHED_NONE) ? Sched_Get(s, health.stall_task)->name : "none");
+    ECG_Ser_FieldU(&w, health.wdt_resets, 4u);
+    ECG_Ser_End(&w);
+    USART2_Commit(&w);
+
+    /* Counters start now */
+    health.processed = 0;
+    health.leads_off = 0;
+    health.loop_max = 0;
+    health.wdt_samples = health.samples;
+    health.last_seq = ad8232_ring.next_seq;
+    health.last_overruns = ad8232_ring.dropped;
+    health.last_tx_bytes = hc05_tx.head;
+    health.last_tx_dropped = hc05_tx.dropped_bytes;
+    health.last_dbg_dropped = usart2_tx.dropped;
+
+    Sched_SetTrace(s, &HEALTH_BKP_TRACE);
+
+    /* Watchdog: LSI / 32 = 1kHz nominal, HEALTH_WDT_MS counts; frozen while the debugger halts the core */
+    DBGMCU->APB1FZ |= DBGMCU_APB1_FZ_DBG_IWDG_STOP;
+    IWDG->KR = HEALTH_IWDG_START;
+    IWDG->KR = HEALTH_IWDG_UNLOCK;
+    IWDG->PR = IWDG_PR_PR_1 | IWDG_PR_PR_0;
+    IWDG->RLR = HEALTH_WDT_MS;
+    for (uint32_t i = 0; (i < HEALTH_LSI_SPINS) && (IWDG->SR != 0u); i++) {
+    }
+    IWDG->KR = HEALTH_IWDG_RELOAD;
+}
+
+void Health_Slice(uint32_t t0) {
+    uint32_t cycles = DWT->CYCCNT - t0;
+
+    if (cycles > health.loop_max) health.loop_max = cycles;
+    if (Health_WatchdogFeed(&health)) IWDG->KR = HEALTH_IWDG_RELOAD;
+}
+
+void Health_Account(uint32_t sample_rate_hz, uint32_t sample_misses) {
+    uint32_t seq = ad8232_ring.next_seq;
+    uint32_t overruns = ad8232_ring.dropped;
+    uint32_t tx_bytes = hc05_tx.head;
+    uint32_t tx_dropped = hc05_tx.dropped_bytes;
+    uint32_t dbg_dropped = usart2_tx.dropped;
+
+    health.acquired_s = seq - health.last_seq;
+    health.overruns_s = overruns - health.last_overruns;
+    health.tx_bytes_s = tx_bytes - health.last_tx_bytes;
+    health.tx_dropped_s = tx_dropped - health.last_tx_dropped;
+    health.dbg_dropped_s = dbg_dropped - health.last_dbg_dropped;
+    health.last_seq = seq;
+    health.last_overruns = overruns;
+    health.last_tx_bytes = tx_bytes;
+    health.last_tx_dropped = tx_dropped;
+    health.last_dbg_dropped = dbg_dropped;
+
+    health.processed_s = health.processed;
+    health.late_s = sample_misses;
+    health.loop_max_us = health.loop_max / (SystemCoreClock / 1000000u);
+    health.leads_off_ms = (uint32_t)(((uint64_t)health.leads_off * 1000u) / sample_rate_hz);
+    health.processed = 0;
+    health.leads_off = 0;
+    health.loop_max = 0;
+}
@@ -0,0 +1,155 @@
+#include "hrv.h"
+#include <string.h>
+
+static inline uint32_t hrv_rr(const HRV_Handle_t *h, uint16_t seq) {
+    return h->rr[seq & HRV_RR_RING_MASK] & HRV_RR_VALUE_MASK;
+}
+
+static inline uint8_t hrv_linked(const HRV_Handle_t *h, uint16_t seq) {
+    return (h->rr[seq & HRV_RR_RING_MASK] & HRV_RR_LINKED) != 0u;
+}
+
+/* Successive difference b - a enters (sign = +1) or leaves (sign = -1) the window */
+static void hrv_diff_update(const HRV_Handle_t *h, HRV_Window_t *w, uint32_t a, uint32_t b, int sign) {
+    uint32_t d = (b > a) ? (b - a) : (a - b);
+    uint8_t nn50 = (d * 1000u > h->nn50_num);
+
+    if (sign > 0) {
+        w->diff_sq_sum += (uint64_t)d * d;
+        w->n_diff++;
+        w->nn50 += nn50;
+    } else {
+        w->diff_sq_sum -= (uint64_t)d * d;
+        w->n_diff--;
+        w->nn50 -= nn50;
+    }
+}
+
+/* Interval seq (value x) enters the window at its tail */
+static void hrv_window_push(const HRV_Handle_t *h, HRV_Window_t *w, uint16_t seq, uint32_t x) {
+    if ((w->count > 0u) && hrv_linked(h, seq)) {
+        hrv_diff_update(h, w, hrv_rr(h, (uint16_t)(seq - 1u)), x, 1);
+    }
+
+    /* Welford */
+    w->count++;
+    w->rr_sum += x;
+    double delta = (double)x - w->mean;
+    w->mean += delta / (double)w->count;
+    w->m2   += delta * ((double)x - w->mean);
+
+    /* Queues keep only intervals that can still become the window's min/max */
+    while ((w->min_tail != w->min_head) &&
+           (hrv_rr(h, w->min_q[(uint16_t)(w->min_tail - 1u) & HRV_RR_RING_MASK]) >= x)) {
+        w->min_tail--;
+    }
+    w->min_q[w->min_tail++ & HRV_RR_RING_MASK] = seq;
+
+    while ((w->max_tail != w->max_head) &&
+           (hrv_rr(h, w->max_q[(uint16_t)(w->max_tail - 1u) & HRV_RR_RING_MASK]) <= x)) {
+        w->max_tail--;
+    }
+    w->max_q[w->max_tail++ & HRV_RR_RING_MASK] = seq;
+}
+
+/* Oldest interval leaves the window */
+static void hrv_window_pop(const HRV_Handle_t *h, HRV_Window_t *w) {
+    uint16_t seq = w->head;
+    uint32_t x = hrv_rr(h, seq);
+
+    w->head++;
+    w->count--;
+    w->rr_sum -= x;
+
+    if ((w->count > 0u) && hrv_linked(h, w->head)) {
+        hrv_diff_update(h, w, x, hrv_rr(h, w->head), -1);
+    }
+
+    /* Welford removal */
+    if (w->count == 0u) {
+        w->mean = 0.0;
+        w->m2   = 0.0;
+    } else {
+        double delta = (double)x - w->mean;
+        w->mean -= delta / (double)w->count;
+        w->m2   -= delta * ((double)x - w->mean);
+        if (w->m2 < 0.0) w->m2 = 0.0;
+    }
+
+    if (w->min_q[w->min_head & HRV_RR_RING_MASK] == seq) w->min_head++;
+    if (w->max_q[w->max_head & HRV_RR_RING_MASK] == seq) w->max_head++;
+}
+
+void HRV_InitWindows(HRV_Handle_t *h, uint32_t sample_rate_hz, const uint32_t span_s[HRV_N_WINDOWS]) {
+    memset(h, 0, sizeof(*h));
+
+    h->sample_rate_hz = sample_rate_hz;
+    h->bpm_num  = 60u * sample_rate_hz;
+    h->nn50_num = HRV_NN50_MS * sample_rate_hz;
+
+    for (uint32_t i = 0; i < HRV_N_WINDOWS; i++) {
+        h->win[i].span_samples = span_s[i] * sample_rate_hz;
+    }
+}
+
+void HRV_Init(HRV_Handle_t *h, uint32_t sample_rate_hz) {
+    static const uint32_t spans[HRV_N_WINDOWS] = { HRV_WINDOW_1MIN_S, HRV_WINDOW_5MIN_S };
+    HRV_InitWindows(h, sample_rate_hz, spans);
+}
+
+uint8_t HRV_AddRR(HRV_Handle_t *h, uint32_t rr_samples) {
+    /* Same acceptance range as PT_UpdateBPM */
+    if ((rr_samples == 0u) ||
+        (h->bpm_num <= PT_BPM_MIN * rr_samples) ||
+        (h->bpm_num >= PT_BPM_MAX * rr_samples)) {
+        h->rejected++;
+        h->linked = 0;
+        return 0;
+    }
+
+    uint16_t seq = h->tail++;
+    h->rr[seq & HRV_RR_RING_MASK] = (uint16_t)(rr_samples | (h->linked ? HRV_RR_LINKED : 0u));
+    h->linked = 1;
+
+    for (uint32_t i = 0; i < HRV_N_WINDOWS; i++) {
+        HRV_Window_t *w = &h->win[i];
+
+        hrv_window_push(h, w, seq, rr_samples);
+
+        /* Keep the newest interval even if it alone exceeds the span; never hold the slot written next */
+        while ((w->count > 1u) &&
+               ((w->rr_sum > w->span_samples) || (w->count > HRV_RR_RING_SIZE - 1u))) {
+            hrv_window_pop(h, w);
+        }
+    }
+
+    return 1;
+}
+
+void HRV_Break(HRV_Handle_t *h) {
+    h->linked = 0;
+}
+
+void HRV_GetMetrics(const HRV_Handle_t *h, uint32_t w_idx, HRV_Metrics *m) {
+    const HRV_Window_t *w = &h->win[w_idx];
+    const float32_t ms_per_sample = 1000.0f / (float32_t)h->sample_rate_hz;
+
+    memset(m, 0, sizeof(*m));
+    m->n_rr = w->count;
+    if (w->count < 2u) return;
+
+    m->mean_rr_ms = (float32_t)w->mean * ms_per_sample;
+    arm_sqrt_f32((float32_t)(w->m2 / (double)(w->count - 1u)), &m->sdnn_ms);
+    m->sdnn_ms *= ms_per_sample;
+
+    if (w->n_diff > 0u) {
+        arm_sqrt_f32((float32_t)w->diff_sq_sum / (float32_t)w->n_diff, &m->rmssd_ms);
+        m->rmssd_ms *= ms_per_sample;
+        m->pnn50 = 100.0f * (float32_t)w->nn50 / (float32_t)w->n_diff;
+    }
+
+    uint32_t rr_min = hrv_rr(h, w->min_q[w->min_head & HRV_RR_RING_MASK]);
+    uint32_t rr_max = hrv_rr(h, w->max_q[w->max_head & HRV_RR_RING_MASK]);
+    m->hr_min = (uint16_t)((h->bpm_num + rr_max / 2u) / rr_max);
+    m->hr_max = (uint16_t)((h->bpm_num + rr_min / 2u) / rr_min);
+}
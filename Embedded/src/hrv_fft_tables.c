@@ -0,0 +1,161 @@
+#include "hrv_freq.h"
+
+/*
+ * arm_rfft_fast_f32 tables for HRV_FREQ_FFT_LEN = 256, generated by
+ * host/tools/gen_rfft_tables.c (lib/DSP has no arm_common_tables.c). Do not edit.
+ */
+
+const float32_t hrv_fft_cfft_twiddle[256] = {
+    1.000000000e+00f, 0.000000000e+00f, 9.987954497e-01f, 4.906767607e-02f,
+    9.951847196e-01f, 9.801714122e-02f, 9.891765118e-01f, 1.467304677e-01f,
+    9.807852507e-01f, 1.950903237e-01f, 9.700312614e-01f, 2.429801822e-01f,
+    9.569403529e-01f, 2.902846634e-01f, 9.415440559e-01f, 3.368898630e-01f,
+    9.238795042e-01f, 3.826834261e-01f, 9.039893150e-01f, 4.275550842e-01f,
+    8.819212914e-01f, 4.713967443e-01f, 8.577286005e-01f, 5.141027570e-01f,
+    8.314695954e-01f, 5.555702448e-01f, 8.032075167e-01f, 5.956993103e-01f,
+    7.730104327e-01f, 6.343932748e-01f, 7.409511209e-01f, 6.715589762e-01f,
+    7.071067691e-01f, 7.071067691e-01f, 6.715589762e-01f, 7.409511209e-01f,
+    6.343932748e-01f, 7.730104327e-01f, 5.956993103e-01f, 8.032075167e-01f,
+    5.555702448e-01f, 8.314695954e-01f, 5.141027570e-01f, 8.577286005e-01f,
+    4.713967443e-01f, 8.819212914e-01f, 4.275550842e-01f, 9.039893150e-01f,
+    3.826834261e-01f, 9.238795042e-01f, 3.368898630e-01f, 9.415440559e-01f,
+    2.902846634e-01f, 9.569403529e-01f, 2.429801822e-01f, 9.700312614e-01f,
+    1.950903237e-01f, 9.807852507e-01f, 1.467304677e-01f, 9.891765118e-01f,
+    9.801714122e-02f, 9.951847196e-01f, 4.906767607e-02f, 9.987954497e-01f,
+    6.123234263e-17f, 1.000000000e+00f, -4.906767607e-02f, 9.987954497e-01f,
+    -9.801714122e-02f, 9.951847196e-01f, -1.467304677e-01f, 9.891765118e-01f,
+    -1.950903237e-01f, 9.807852507e-01f, -2.429801822e-01f, 9.700312614e-01f,
+    -2.902846634e-01f, 9.569403529e-01f, -3.368898630e-01f, 9.415440559e-01f,
+    -3.826834261e-01f, 9.238795042e-01f, -4.275550842e-01f, 9.039893150e-01f,
+    -4.713967443e-01f, 8.819212914e-01f, -5.141027570e-01f, 8.577286005e-01f,
+    -5.555702448e-01f, 8.314695954e-01f, -5.956993103e-01f, 8.032075167e-01f,
+    -6.343932748e-01f, 7.730104327e-01f, -6.715589762e-01f, 7.409511209e-01f,
+    -7.071067691e-01f, 7.071067691e-01f, -7.409511209e-01f, 6.715589762e-01f,
+    -7.730104327e-01f, 6.343932748e-01f, -8.032075167e-01f, 5.956993103e-01f,
+    -8.314695954e-01f, 5.555702448e-01f, -8.577286005e-01f, 5.141027570e-01f,
+    -8.819212914e-01f, 4.713967443e-01f, -9.039893150e-01f, 4.275550842e-01f,
+    -9.238795042e-01f, 3.826834261e-01f, -9.415440559e-01f, 3.368898630e-01f,
+    -9.569403529e-01f, 2.902846634e-01f, -9.700312614e-01f, 2.429801822e-01f,
+    -9.807852507e-01f, 1.950903237e-01f, -9.891765118e-01f, 1.467304677e-01f,
+    -9.951847196e-01f, 9.801714122e-02f, -9.987954497e-01f, 4.906767607e-02f,
+    -1.000000000e+00f, 1.224646853e-16f, -9.987954497e-01f, -4.906767607e-02f,
+    -9.951847196e-01f, -9.801714122e-02f, -9.891765118e-01f, -1.467304677e-01f,
+    -9.807852507e-01f, -1.950903237e-01f, -9.700312614e-01f, -2.429801822e-01f,
+    -9.569403529e-01f, -2.902846634e-01f, -9.415440559e-01f, -3.368898630e-01f,
+    -9.238795042e-01f, -3.826834261e-01f, -9.039893150e-01f, -4.275550842e-01f,
+    -8.819212914e-01f, -4.713967443e-01f, -8.577286005e-01f, -5.141027570e-01f,
+    -8.314695954e-01f, -5.555702448e-01f, -8.032075167e-01f, -5.956993103e-01f,
+    -7.730104327e-01f, -6.343932748e-01f, -7.409511209e-01f, -6.715589762e-01f,
+    -7.071067691e-01f, -7.071067691e-01f, -6.715589762e-01f, -7.409511209e-01f,
+    -6.343932748e-01f, -7.730104327e-01f, -5.956993103e-01f, -8.032075167e-01f,
+    -5.555702448e-01f, -8.314695954e-01f, -5.141027570e-01f, -8.577286005e-01f,
+    -4.713967443e-01f, -8.819212914e-01f, -4.275550842e-01f, -9.039893150e-01f,
+    -3.826834261e-01f, -9.238795042e-01f, -3.368898630e-01f, -9.415440559e-01f,
+    -2.902846634e-01f, -9.569403529e-01f, -2.429801822e-01f, -9.700312614e-01f,
+    -1.950903237e-01f, -9.807852507e-01f, -1.467304677e-01f, -9.891765118e-01f,
+    -9.801714122e-02f, -9.951847196e-01f, -4.906767607e-02f, -9.987954497e-01f,
+    -1.836970147e-16f, -1.000000000e+00f, 4.906767607e-02f, -9.987954497e-01f,
+    9.801714122e-02f, -9.951847196e-01f, 1.467304677e-01f, -9.891765118e-01f,
+    1.950903237e-01f, -9.807852507e-01f, 2.429801822e-01f, -9.700312614e-01f,
+    2.902846634e-01f, -9.569403529e-01f, 3.368898630e-01f, -9.415440559e-01f,
+    3.826834261e-01f, -9.238795042e-01f, 4.275550842e-01f, -9.039893150e-01f,
+    4.713967443e-01f, -8.819212914e-01f, 5.141027570e-01f, -8.577286005e-01f,
+    5.555702448e-01f, -8.314695954e-01f, 5.956993103e-01f, -8.032075167e-01f,
+    6.343932748e-01f, -7.730104327e-01f, 6.715589762e-01f, -7.409511209e-01f,
+    7.071067691e-01f, -7.071067691e-01f, 7.409511209e-01f, -6.715589762e-01f,
+    7.730104327e-01f, -6.343932748e-01f, 8.032075167e-01f, -5.956993103e-01f,
+    8.314695954e-01f, -5.555702448e-01f, 8.577286005e-01f, -5.141027570e-01f,
+    8.819212914e-01f, -4.713967443e-01f, 9.039893150e-01f, -4.275550842e-01f,
+    9.238795042e-01f, -3.826834261e-01f, 9.415440559e-01f, -3.368898630e-01f,
+    9.569403529e-01f, -2.902846634e-01f, 9.700312614e-01f, -2.429801822e-01f,
+    9.807852507e-01f, -1.950903237e-01f, 9.891765118e-01f, -1.467304677e-01f,
+    9.951847196e-01f, -9.801714122e-02f, 9.987954497e-01f, -4.906767607e-02f,
+};
+
+const float32_t hrv_fft_rfft_twiddle[256] = {
+    0.000000000e+00f, 1.000000000e+00f, 2.454122901e-02f, 9.996988177e-01f,
+    4.906767607e-02f, 9.987954497e-01f, 7.356456667e-02f, 9.972904325e-01f,
+    9.801714122e-02f, 9.951847196e-01f, 1.224106774e-01f, 9.924795628e-01f,
+    1.467304677e-01f, 9.891765118e-01f, 1.709618866e-01f, 9.852776527e-01f,
+    1.950903237e-01f, 9.807852507e-01f, 2.191012353e-01f, 9.757021070e-01f,
+    2.429801822e-01f, 9.700312614e-01f, 2.667127550e-01f, 9.637760520e-01f,
+    2.902846634e-01f, 9.569403529e-01f, 3.136817515e-01f, 9.495281577e-01f,
+    3.368898630e-01f, 9.415440559e-01f, 3.598950505e-01f, 9.329928160e-01f,
+    3.826834261e-01f, 9.238795042e-01f, 4.052413106e-01f, 9.142097831e-01f,
+    4.275550842e-01f, 9.039893150e-01f, 4.496113360e-01f, 8.932242990e-01f,
+    4.713967443e-01f, 8.819212914e-01f, 4.928981960e-01f, 8.700869679e-01f,
+    5.141027570e-01f, 8.577286005e-01f, 5.349976420e-01f, 8.448535800e-01f,
+    5.555702448e-01f, 8.314695954e-01f, 5.758081675e-01f, 8.175848126e-01f,
+    5.956993103e-01f, 8.032075167e-01f, 6.152315736e-01f, 7.883464098e-01f,
+    6.343932748e-01f, 7.730104327e-01f, 6.531728506e-01f, 7.572088242e-01f,
+    6.715589762e-01f, 7.409511209e-01f, 6.895405650e-01f, 7.242470980e-01f,
+    7.071067691e-01f, 7.071067691e-01f, 7.242470980e-01f, 6.895405650e-01f,
+    7.409511209e-01f, 6.715589762e-01f, 7.572088242e-01f, 6.531728506e-01f,
+    7.730104327e-01f, 6.343932748e-01f, 7.883464098e-01f, 6.152315736e-01f,
+    8.032075167e-01f, 5.956993103e-01f, 8.175848126e-01f, 5.758081675e-01f,
+    8.314695954e-01f, 5.555702448e-01f, 8.448535800e-01f, 5.349976420e-01f,
+    8.577286005e-01f, 5.141027570e-01f, 8.700869679e-01f, 4.928981960e-01f,
+    8.819212914e-01f, 4.713967443e-01f, 8.932242990e-01f, 4.496113360e-01f,
+    9.039893150e-01f, 4.275550842e-01f, 9.142097831e-01f, 4.052413106e-01f,
+    9.238795042e-01f, 3.826834261e-01f, 9.329928160e-01f, 3.598950505e-01f,
+    9.415440559e-01f, 3.368898630e-01f, 9.495281577e-01f, 3.136817515e-01f,
+    9.569403529e-01f, 2.902846634e-01f, 9.637760520e-01f, 2.667127550e-01f,
+    9.700312614e-01f, 2.429801822e-01f, 9.757021070e-01f, 2.191012353e-01f,
+    9.807852507e-01f, 1.950903237e-01f, 9.852776527e-01f, 1.709618866e-01f,
+    9.891765118e-01f, 1.467304677e-01f, 9.924795628e-01f, 1.224106774e-01f,
+    9.951847196e-01f, 9.801714122e-02f, 9.972904325e-01f, 7.356456667e-02f,
+    9.987954497e-01f, 4.906767607e-02f, 9.996988177e-01f, 2.454122901e-02f,
+    1.000000000e+00f, 6.123234263e-17f, 9.996988177e-01f, -2.454122901e-02f,
+    9.987954497e-01f, -4.906767607e-02f, 9.972904325e-01f, -7.356456667e-02f,
+    9.951847196e-01f, -9.801714122e-02f, 9.924795628e-01f, -1.224106774e-01f,
+    9.891765118e-01f, -1.467304677e-01f, 9.852776527e-01f, -1.709618866e-01f,
+    9.807852507e-01f, -1.950903237e-01f, 9.757021070e-01f, -2.191012353e-01f,
+    9.700312614e-01f, -2.429801822e-01f, 9.637760520e-01f, -2.667127550e-01f,
+    9.569403529e-01f, -2.902846634e-01f, 9.495281577e-01f, -3.136817515e-01f,
+    9.415440559e-01f, -3.368898630e-01f, 9.329928160e-01f, -3.598950505e-01f,
+    9.238795042e-01f, -3.826834261e-01f, 9.142097831e-01f, -4.052413106e-01f,
+    9.039893150e-01f, -4.275550842e-01f, 8.932242990e-01f, -4.496113360e-01f,
+    8.819212914e-01f, -4.713967443e-01f, 8.700869679e-01f, -4.928981960e-01f,
+    8.577286005e-01f, -5.141027570e-01f, 8.448535800e-01f, -5.349976420e-01f,
+    8.314695954e-01f, -5.555702448e-01f, 8.175848126e-01f, -5.758081675e-01f,
+    8.032075167e-01f, -5.956993103e-01f, 7.883464098e-01f, -6.152315736e-01f,
+    7.730104327e-01f, -6.343932748e-01f, 7.572088242e-01f, -6.531728506e-01f,
+    7.409511209e-01f, -6.715589762e-01f, 7.242470980e-01f, -6.895405650e-01f,
+    7.071067691e-01f, -7.071067691e-01f, 6.895405650e-01f, -7.242470980e-01f,
+    6.715589762e-01f, -7.409511209e-01f, 6.531728506e-01f, -7.572088242e-01f,
+    6.343932748e-01f, -7.730104327e-01f, 6.152315736e-01f, -7.883464098e-01f,
+    5.956993103e-01f, -8.032075167e-01f, 5.758081675e-01f, -8.175848126e-01f,
+    5.555702448e-01f, -8.314695954e-01f, 5.349976420e-01f, -8.448535800e-01f,
+    5.141027570e-01f, -8.577286005e-01f, 4.928981960e-01f, -8.700869679e-01f,
+    4.713967443e-01f, -8.819212914e-01f, 4.496113360e-01f, -8.932242990e-01f,
+    4.275550842e-01f, -9.039893150e-01f, 4.052413106e-01f, -9.142097831e-01f,
+    3.826834261e-01f, -9.238795042e-01f, 3.598950505e-01f, -9.329928160e-01f,
+    3.368898630e-01f, -9.415440559e-01f, 3.136817515e-01f, -9.495281577e-01f,
+    2.902846634e-01f, -9.569403529e-01f, 2.667127550e-01f, -9.637760520e-01f,
+    2.429801822e-01f, -9.700312614e-01f, 2.191012353e-01f, -9.757021070e-01f,
+    1.950903237e-01f, -9.807852507e-01f, 1.709618866e-01f, -9.852776527e-01f,
+    1.467304677e-01f, -9.891765118e-01f, 1.224106774e-01f, -9.924795628e-01f,
+    9.801714122e-02f, -9.951847196e-01f, 7.356456667e-02f, -9.972904325e-01f,
+    4.906767607e-02f, -9.987954497e-01f, 2.454122901e-02f, -9.996988177e-01f,
+};
+
+const uint16_t hrv_fft_bitrev[208] = {
+       8,  512,   16,   64,   24,  576,   32,  128,   40,  640,   48,  192,
+      56,  704,   64,  256,   72,  768,   80,  320,   88,  832,   96,  384,
+     104,  896,  112,  448,  120,  960,  128,  512,  136,  520,  144,  768,
+     152,  584,  160,  520,  168,  648,  176,  200,  184,  712,  192,  264,
+     200,  776,  208,  328,  216,  840,  224,  392,  232,  904,  240,  456,
+     248,  968,  264,  528,  272,  320,  280,  592,  288,  768,  296,  656,
+     304,  328,  312,  720,  328,  784,  344,  848,  352,  400,  360,  912,
+     368,  464,  376,  976,  384,  576,  392,  536,  400,  832,  408,  600,
+     416,  584,  424,  664,  432,  840,  440,  728,  448,  592,  456,  792,
+     464,  848,  472,  856,  480,  600,  488,  920,  496,  856,  504,  984,
+     520,  544,  528,  576,  536,  608,  552,  672,  560,  608,  568,  736,
+     576,  768,  584,  800,  592,  832,  600,  864,  608,  800,  616,  928,
+     624,  864,  632,  992,  648,  672,  656,  896,  664,  928,  688,  904,
+     696,  744,  704,  896,  712,  808,  720,  912,  728,  872,  736,  928,
+     744,  936,  752,  920,  760, 1000,  776,  800,  784,  832,  792,  864,
+     808,  904,  816,  864,  824,  920,  840,  864,  856,  880,  872,  944,
+     888, 1008,  904,  928,  912,  960,  920,  992,  944,  968,  952, 1000,
+     968,  992,  984, 1008,
+};
@@ -0,0 +1,242 @@
+#include "hrv_freq.h"
+#include <string.h>
+
+/* Cycle counter for slice costs (enabled by main; the host stub maps it to the TSC) */
+#ifndef HRV_FREQ_CYCLES
+#define HRV_FREQ_CYCLES() (DWT->CYCCNT)
+#endif
+
+static inline uint32_t hf_rr(const HRV_Freq_Handle_t *hf, uint16_t seq) {
+    return hf->hrv->rr[seq & HRV_RR_RING_MASK] & HRV_RR_VALUE_MASK;
+}
+
+static inline uint8_t hf_linked(const HRV_Freq_Handle_t *hf, uint16_t seq) {
+    return (hf->hrv->rr[seq & HRV_RR_RING_MASK] & HRV_RR_LINKED) != 0u;
+}
+
+static inline float32_t hf_rr_ms(const HRV_Freq_Handle_t *hf, uint16_t seq) {
+    return (float32_t)hf_rr(hf, seq) * 1000.0f / (float32_t)hf->hrv->sample_rate_hz;
+}
+
+void HRV_FreqInit(HRV_Freq_Handle_t *hf, const HRV_Handle_t *hrv) {
+    memset(hf, 0, sizeof(*hf));
+    hf->hrv = hrv;
+
+    /* Same instance arm_rfft_fast_init_256_f32 builds, on the tables in hrv_fft_tables.c */
+    hf->rfft.Sint.fftLen       = HRV_FREQ_FFT_LEN / 2u;
+    hf->rfft.Sint.pTwiddle     = hrv_fft_cfft_twiddle;
+    hf->rfft.Sint.pBitRevTable = hrv_fft_bitrev;
+    hf->rfft.Sint.bitRevLength = HRV_FREQ_BITREV_LEN;
+    hf->rfft.fftLenRFFT        = HRV_FREQ_FFT_LEN;
+    hf->rfft.pTwiddleRFFT      = hrv_fft_rfft_twiddle;
+
+    /* Hann, w[n] = 0.5 - 0.5*cos(2*pi*n/N): the cosines are the odd rfft twiddles (n < N/2) */
+    hf->window_power = 0.0f;
+    for (uint32_t n = 0; n < HRV_FREQ_FFT_LEN; n++) {
+        uint32_t m = (n <= HRV_FREQ_FFT_LEN / 2u) ? n : (HRV_FREQ_FFT_LEN - n);
+        float32_t c = (m < HRV_FREQ_FFT_LEN / 2u) ? hrv_fft_rfft_twiddle[2u * m + 1u] : -1.0f;
+        hf->window[n] = 0.5f - 0.5f * c;
+        hf->window_power += hf->window[n] * hf->window[n];
+    }
+}
+
+uint8_t HRV_FreqStart(HRV_Freq_Handle_t *hf) {
+    const HRV_Window_t *w = &hf->hrv->win[HRV_WINDOW_5MIN];
+
+    if (hf->state != HRV_FREQ_IDLE) return 0;
+
+    /* The run may reach back over the 5 min window, short of slots new beats will overwrite */
+    uint16_t avail = w->count;
+    if (avail > HRV_RR_RING_SIZE - HRV_FREQ_RING_MARGIN) avail = HRV_RR_RING_SIZE - HRV_FREQ_RING_MARGIN;
+    if (avail <= 1u) return 0;     /* no tachogram to resample */
+
+    hf->end = hf->hrv->tail;
+    hf->first = (uint16_t)(hf->end - 1u);
+    hf->scan_left = (uint16_t)(avail - 1u);
+    hf->run_samples = 0;
+    hf->state = HRV_FREQ_SCAN;
+
+    return 1;
+}
+
+/* seg_t[3]/seg_rr[3] from beat seg_seq + 1, or a copy of seg_seq at the end of the run */
+static void hf_load_next(HRV_Freq_Handle_t *hf) {
+    uint16_t next = (uint16_t)(hf->seg_seq + 1u);
+
+    if (next != hf->end) {
+        hf->seg_t[3]  = hf->seg_t[2] + hf_rr(hf, next);
+        hf->seg_rr[3] = hf_rr_ms(hf, next);
+    } else {
+        hf->seg_t[3]  = hf->seg_t[2];
+        hf->seg_rr[3] = hf->seg_rr[2];
+    }
+}
+
+/* Slope between two loaded beats in ms per ECG sample (0 if they are the same duplicated beat) */
+static inline float32_t hf_slope(const HRV_Freq_Handle_t *hf, uint32_t a, uint32_t b) {
+    uint32_t dt = hf->seg_t[b] - hf->seg_t[a];
+    return (dt != 0u) ? ((hf->seg_rr[b] - hf->seg_rr[a]) / (float32_t)dt) : 0.0f;
+}
+
+/* `first` can move back: the beat before it is in the window, linked, and the run is under 5 min */
+static inline uint8_t hf_scan_more(const HRV_Freq_Handle_t *hf) {
+    return (hf->scan_left != 0u) && hf_linked(hf, hf->first) &&
+           (hf->run_samples * HRV_FREQ_FS_HZ < (HRV_FREQ_MAX_SAMPLES - 1u) * hf->hrv->sample_rate_hz);
+}
+
+/* Walk `first` back over linked beats until the run spans 5 min */
+static void hf_scan(HRV_Freq_Handle_t *hf) {
+    const uint32_t fs = hf->hrv->sample_rate_hz;
+
+    for (uint32_t i = 0; (i < HRV_FREQ_SCAN_CHUNK) && hf_scan_more(hf); i++) {
+        hf->run_samples += hf_rr(hf, hf->first);
+        hf->first--;
+        hf->scan_left--;
+    }
+    if (hf_scan_more(hf)) return;
+
+    /* Grid of 4Hz points ending at the newest beat */
+    uint32_t n = hf->run_samples * HRV_FREQ_FS_HZ / fs + 1u;
+    if (n > HRV_FREQ_MAX_SAMPLES) n = HRV_FREQ_MAX_SAMPLES;
+    if (n < HRV_FREQ_FFT_LEN) {
+        hf->state = HRV_FREQ_IDLE;  /* shorter than one segment */
+        return;
+    }
+
+    hf->n_samples = (uint16_t)n;
+    hf->n_done    = 0;
+    hf->grid_step = (float32_t)fs / (float32_t)HRV_FREQ_FS_HZ;
+    hf->grid_t0   = (float32_t)hf->run_samples - (float32_t)(n - 1u) * hf->grid_step;
+
+    /* First segment: beats first (t = 0) and first + 1, no beat before the run */
+    hf->seg_seq   = (uint16_t)(hf->first + 1u);
+    hf->seg_t[1]  = 0;
+    hf->seg_rr[1] = hf_rr_ms(hf, hf->first);
+    hf->seg_t[0]  = hf->seg_t[1];
+    hf->seg_rr[0] = hf->seg_rr[1];
+    hf->seg_t[2]  = hf_rr(hf, hf->seg_seq);
+    hf->seg_rr[2] = hf_rr_ms(hf, hf->seg_seq);
+    hf_load_next(hf);
+    hf->state = HRV_FREQ_RESAMPLE;
+}
+
+/*
+ * Cubic Hermite interpolation of the tachogram (RR at the end of each beat) onto the grid.
+ * The tangent at a beat averages the slopes to its neighbours; at the ends of the run it is
+ * the one slope available. Linear interpolation would lose ~1dB of HF power at 75 BPM.
+ */
+static void hf_resample(HRV_Freq_Handle_t *hf) {
+    for (uint32_t i = 0; (i < HRV_FREQ_RESAMPLE_CHUNK) && (hf->n_done < hf->n_samples); i++) {
+        float32_t t = hf->grid_t0 + (float32_t)hf->n_done * hf->grid_step;
+
+        while ((t > (float32_t)hf->seg_t[2]) && ((uint16_t)(hf->seg_seq + 1u) != hf->end)) {
+            hf->seg_seq++;
+            for (uint32_t k = 0; k < 3u; k++) {
+                hf->seg_t[k]  = hf->seg_t[k + 1u];
+                hf->seg_rr[k] = hf->seg_rr[k + 1u];
+            }
+            hf_load_next(hf);
+        }
+
+        float32_t h  = (float32_t)(hf->seg_t[2] - hf->seg_t[1]);
+        float32_t s  = (t - (float32_t)hf->seg_t[1]) / h;
+        float32_t d  = hf_slope(hf, 1u, 2u);
+        float32_t m1 = (hf->seg_t[0] != hf->seg_t[1]) ? 0.5f * (hf_slope(hf, 0u, 1u) + d) : d;
+        float32_t m2 = (hf->seg_t[3] != hf->seg_t[2]) ? 0.5f * (d + hf_slope(hf, 2u, 3u)) : d;
+        float32_t s2 = s * s;
+        float32_t s3 = s2 * s;
+
+        hf->tacho[hf->n_done++] = (2.0f*s3 - 3.0f*s2 + 1.0f) * hf->seg_rr[1] +
+                                  (s3 - 2.0f*s2 + s) * h * m1 +
+                                  (-2.0f*s3 + 3.0f*s2) * hf->seg_rr[2] +
+                                  (s3 - s2) * h * m2;
+    }
+
+    if (hf->n_done == hf->n_samples) {
+        hf->n_segments = (uint16_t)((hf->n_samples - HRV_FREQ_FFT_LEN) / HRV_FREQ_SEG_STEP + 1u);
+        hf->segment = 0;
+        memset(hf->psd, 0, sizeof(hf->psd));
+        hf->state = HRV_FREQ_WINDOW;
+    }
+}
+
+/* Segments end at the newest grid point and step back by HRV_FREQ_SEG_STEP */
+static void hf_window(HRV_Freq_Handle_t *hf) {
+    uint32_t off = (uint32_t)hf->n_samples - HRV_FREQ_FFT_LEN -
+                   (uint32_t)(hf->n_segments - 1u - hf->segment) * HRV_FREQ_SEG_STEP;
+    float32_t mean;
+
+    arm_mean_f32(&hf->tacho[off], HRV_FREQ_FFT_LEN, &mean);
+    arm_offset_f32(&hf->tacho[off], -mean, hf->fft_in, HRV_FREQ_FFT_LEN);
+    arm_mult_f32(hf->fft_in, hf->window, hf->fft_in, HRV_FREQ_FFT_LEN);
+    hf->state = HRV_FREQ_FFT;
+}
+
+static void hf_fft(HRV_Freq_Handle_t *hf) {
+    arm_rfft_fast_f32(&hf->rfft, hf->fft_in, hf->fft_out, 0);
+    hf->state = HRV_FREQ_ACCUM;
+}
+
+/* fft_out is [X0, X(N/2), re1, im1, ...]; fft_in is free again and holds |Xk|^2 */
+static void hf_accum(HRV_Freq_Handle_t *hf) {
+    const uint32_t half = HRV_FREQ_FFT_LEN / 2u;
+
+    hf->psd[0]    += hf->fft_out[0] * hf->fft_out[0];
+    hf->psd[half] += hf->fft_out[1] * hf->fft_out[1];
+    arm_cmplx_mag_squared_f32(&hf->fft_out[2], hf->fft_in, half - 1u);
+    arm_add_f32(&hf->psd[1], hf->fft_in, &hf->psd[1], half - 1u);
+
+    hf->segment++;
+    hf->state = (hf->segment < hf->n_segments) ? HRV_FREQ_WINDOW : HRV_FREQ_BANDS;
+}
+
+static void hf_bands(HRV_Freq_Handle_t *hf) {
+    /* One-sided Welch PSD times the bin width: 2|Xk|^2 / (N * sum(w^2)) per segment */
+    const float32_t scale = 2.0f / ((float32_t)HRV_FREQ_FFT_LEN * hf->window_power * (float32_t)hf->n_segments);
+    float32_t vlf = 0.0f, lf = 0.0f, hf_pow = 0.0f;
+    HRV_FreqResult *r = &hf->result;
+
+    for (uint32_t k = 1; k < HRV_FREQ_LF_FIRST_BIN; k++)                     vlf    += hf->psd[k];
+    for (uint32_t k = HRV_FREQ_LF_FIRST_BIN; k < HRV_FREQ_HF_FIRST_BIN; k++) lf     += hf->psd[k];
+    for (uint32_t k = HRV_FREQ_HF_FIRST_BIN; k < HRV_FREQ_HF_END_BIN; k++)   hf_pow += hf->psd[k];
+
+    r->vlf_ms2    = vlf * scale;
+    r->lf_ms2     = lf * scale;
+    r->hf_ms2     = hf_pow * scale;
+    r->total_ms2  = r->vlf_ms2 + r->lf_ms2 + r->hf_ms2;
+    r->lf_hf      = (r->hf_ms2 > 0.0f) ? (r->lf_ms2 / r->hf_ms2) : 0.0f;
+    r->n_segments = hf->n_segments;
+    r->span_s     = (uint16_t)(hf->n_samples / HRV_FREQ_FS_HZ);
+    hf->n_results++;
+
+    hf->state = HRV_FREQ_IDLE;
+}
+
+uint8_t HRV_FreqStep(HRV_Freq_Handle_t *hf) {
+    HRV_FreqSlice slice = hf->state;
+
+    if (slice == HRV_FREQ_IDLE) return 0;
+
+    uint32_t t0 = HRV_FREQ_CYCLES();
+    switch (slice) {
+        case HRV_FREQ_SCAN:     hf_scan(hf);     break;
+        case HRV_FREQ_RESAMPLE: hf_resample(hf); break;
+        case HRV_FREQ_WINDOW:   hf_window(hf);   break;
+        case HRV_FREQ_FFT:      hf_fft(hf);      break;
+        case HRV_FREQ_ACCUM:    hf_accum(hf);    break;
+        case HRV_FREQ_BANDS:    hf_bands(hf);    break;
+        default:                hf->state = HRV_FREQ_IDLE; break;
+    }
+    uint32_t dt = HRV_FREQ_CYCLES() - t0;
+
+    if (dt > hf->slice_cycles_max[slice]) hf->slice_cycles_max[slice] = dt;
+    if (dt > hf->slice_cycles_worst)      hf->slice_cycles_worst = dt;
+
+    return 1;
+}
+
+uint8_t HRV_FreqGetResult(const HRV_Freq_Handle_t *hf, HRV_FreqResult *r) {
+    if (hf->n_results == 0u) return 0;
+    *r = hf->result;
+    return 1;
+}
@@ -1,83 +1,955 @@
 #include "main.h"
 
 #include <stdio.h>
+#include <string.h>
 
 #include "ad8232.h"
+#include "ecg_cmd.h"
+#include "ecg_rice.h"
 #include "ecg_sim.h"
 #include "hc05.h"
+#include "health.h"
+#include "hrv.h"
+#include "hrv_freq.h"
 #include "pan_tompkins.h"
+#include "pan_tompkins_q31.h"
+#include "power.h"
+#include "prof.h"
+#include "sched.h"
 #include "usart2.h"
 
-/* Set to 1 to use ECG simulator instead of AD8232 */
+/* Set to 1 to start with the ECG simulator instead of AD8232 ("S" command at run time) */
 #define USE_ECG_SIM 0
 
+/* Set to 1 to run the integer-only (Q31) Pan-Tompkins engine instead of float32 */
+#define PT_USE_Q31 0
+
+/* Set to 1 to print PT_Process / PT_ProcessBlock / PT_ProcessQ31 cycles/sample on USART2 at boot */
+#define PT_BENCHMARK 0
+
+/* Set to 1 to print sprintf against ecg_ser.h cycles per record on USART2 at boot (links newlib's sprintf) */
+#define SER_BENCHMARK 0
+
+/* Set to 1 to print ecg_rice encode/decode cycles/sample and link bytes/sample on USART2 at boot */
+#define RICE_BENCHMARK 0
+
+/*
+ * HC-05 stream at boot ("M" command at run time, ecg_cmd.h): 0 = one "ECG_VALUE,BPM"
+ * line per sample, 1 = "W" waveform frames of HC05_FRAME_SAMPLES samples plus one "B"
+ * record per beat
+ */
+#define HC05_STREAM_BEATS 0
+
+/*
+ * Set to 1 to stream the binary protocol (ecg_proto.h) instead of text: COBS frames of
+ * ECG_PROTO_SAMPLES packed 12-bit samples with sequence number, tick, BPM and CRC-16,
+ * plus one BEAT frame per beat. Replaces both text formats and their records.
+ * 2 = the same with RICE frames: ECG_RICE_BLOCK samples losslessly compressed
+ * (ecg_rice.h), about half the link bytes of 1 on the simulator
+ */
+#define HC05_STREAM_BINARY 0
+
+#if HC05_STREAM_BINARY && HC05_STREAM_BEATS
+#error "HC05_STREAM_BINARY replaces HC05_STREAM_BEATS: set only one"
+#endif
+
+#if HC05_STREAM_BINARY == 2
+#define HC05_STREAM_BOOT ECG_STREAM_RICE
+#elif HC05_STREAM_BINARY
+#define HC05_STREAM_BOOT ECG_STREAM_BINARY
+#elif HC05_STREAM_BEATS
+#define HC05_STREAM_BOOT ECG_STREAM_BEATS
+#else
+#define HC05_STREAM_BOOT ECG_STREAM_TEXT
+#endif
+
+/*
+ * Every HRV_REPORT_S seconds a frequency-domain HRV analysis starts (run in slices
+ * between samples, due before the next one starts); beat mode also sends the 1 min /
+ * 5 min metrics as "H" records, the latest LF/HF result with its worst slice cost as an
+ * "F" record, the sample ring's drop count, high-water mark and acquisition interrupt
+ * cost as an "S" record, the scheduler statistics as "Q" and "Y" records and the
+ * duty cycle as a "P" record
+ */
+#define HRV_REPORT_S 10u
+
+/*
+ * Main-loop tasks (sched.h): the hard sample task must drain the ring within one DMA
+ * block; command lines and the periodic records are due within these deadlines, and
+ * the self-test and the stack check run every SELFTEST_PERIOD_MS
+ */
+#define CMD_DEADLINE_MS       100u
+#define TELEMETRY_DEADLINE_MS 100u
+#define SELFTEST_PERIOD_MS    1000u
+
+/*
+ * Idle behaviour of the main loop (power.h): 0 = poll, 1 = sleep with WFI until the
+ * next interrupt, 2 = sleep and also lower HCLK from 84MHz to 42 or 21MHz when the load
+ * allows. Beat mode reports the duty cycle of each second as a "P" record.
+ * A debugger may lose the core in WFI: keep 0 while debugging.
+ */
+#define LOW_POWER 0
+
+/*
+ * Builds with -DPROF_ENABLE=1 (platformio.ini) time the PT stages, formatting and
+ * transmit calls with DWT probes (prof.h) and send their statistics on USART2 as PROF
+ * frames every PROF_REPORT_S seconds (host/tools/prof_dump decodes them)
+ */
+#define PROF_REPORT_S 10u
+
+/* Sampling frequency at boot ("R" command at run time); the float engine derives its delays from it */
+#define ECG_SAMPLE_RATE_HZ 360u
+
+/*
+ * ADC conversions per sample: 1 = one conversion per sample, 16 or 32 = oversample and
+ * decimate to ECG_SAMPLE_RATE_HZ in the DMA interrupt (adc_decim)
+ */
+#define ADC_OVERSAMPLE 1u
+
+/*
+ * Set to 1 to scan auxiliary inputs with the lead: PA6 (electrode impedance / battery
+ * divider) and PA7 (accelerometer axis). Beat mode sends them with every "W" frame as
+ * an "A" record
+ */
+#define ADC_SCAN_AUX 0
+
+/*
+ * USART2 debug log at boot ("D" command at run time): signals as USART2_SIG_BIT() mask
+ * (0 = off) and decimation.
+ * Lines are dropped, never waited for, when the link cannot keep up.
+ */
+#define DEBUG_LOG_SIGNALS (USART2_SIG_BIT(USART2_SIG_DC) | USART2_SIG_BIT(USART2_SIG_HPF) | \
+                           USART2_SIG_BIT(USART2_SIG_INTEGRATED) | USART2_SIG_BIT(USART2_SIG_THRESHOLD))
+#define DEBUG_LOG_DECIM   1u
+
+#if PT_USE_Q31
+/* The Q31 engine is fixed to the 360Hz delays, cfg is ignored */
+typedef PanTompkinsQ31_Handle_t PT_Handle_t;
+#define PT_INIT(h, cfg)       PT_InitQ31(h)
+#define PT_REARM(h, x)        PT_RearmQ31(h, x)
+#define PT_PROCESS(h, x)      PT_ProcessQ31(h, x)
+#define PT_GET_BPM(h)         PT_GetBPMQ31(h)
+#define PT_HPF_ADC(v)         ((v) >> PT_Q31_DC_OUT_FRAC)        /* Q3 -> ADC units */
+#define PT_LEVEL_DEBUG(v)     ((v) / PT_Q31_LEVEL(4000))         /* same units as float / 4000 */
+#define PT_LEVEL_INT(v)       ((int32_t)(((int64_t)(v) << PT_Q31_SQ_SHIFT) / PT_Q31_INT_GAIN))
+/* No beat events: R tick is the integrated-signal peak, amplitude not available */
+#define PT_BEAT_R_TICK(h)     ((h)->last_beat_tick)
+#define PT_BEAT_AMPLITUDE(h)  0
+#define PT_BPM_SEEDED(h)      ((h)->bpm_seed == 0u)
+#else
+typedef PanTompkins_Handle_t PT_Handle_t;
+#define PT_INIT(h, cfg)       PT_InitConfig(h, cfg)
+#define PT_REARM(h, x)        PT_Rearm(h, x)
+#define PT_PROCESS(h, x)      PT_Process(h, x)
+#define PT_GET_BPM(h)         PT_GetBPM(h)
+#define PT_HPF_ADC(v)         (v)
+#define PT_LEVEL_DEBUG(v)     ((v) / 4000.0f)
+#define PT_LEVEL_INT(v)       ((int32_t)(v))
+#define PT_BEAT_R_TICK(h)     ((h)->beat_event.r_tick)
+#define PT_BEAT_AMPLITUDE(h)  ((int32_t)(h)->beat_event.amplitude)
+#define PT_BPM_SEEDED(h)      ((h)->bpm_seed == 0u)
+#endif
+
 void SystemClock_Config(void);
 void Error_Handler(void);
 
-char msg_buffer[HC05_BUFFER_SIZE];
-PanTompkins_Handle_t pt_handle;
+PT_Config pt_config;
+PT_Handle_t pt_handle;
+HRV_Handle_t hrv_handle;
+HRV_Freq_Handle_t hrv_freq;
+
+/* R tick of the previous beat, 0 after reset, leads-off or dropped samples */
+static uint32_t prev_r_tick;
+
+/* Sequence number the next sample from ad8232_ring should carry */
+static uint32_t next_seq;
+
+/* Stream, rate, simulator and debug log in use; HC-05 commands change them */
+static ECG_Cmd_Config run_cfg;
+
+/* Restart the detector from the next sample (simulator switch or new rate) */
+static uint8_t cmd_rearm;
+
+#if ADC_SCAN_AUX
+/* Scan order = order of the values in every sample frame */
+static const AD8232_Channel adc_scan[] = {
+    { 0u, AD8232_CH_LEAD },     /* PA0: AD8232 OUT */
+    { 6u, AD8232_CH_AUX },      /* PA6: electrode impedance / battery */
+    { 7u, AD8232_CH_MOTION },   /* PA7: accelerometer axis */
+};
+#endif
+
+/* Reconnection timing: first off sample, re-arm sample, waiting for the first BPM */
+static uint32_t leads_off_seq;
+static uint32_t leads_rearm_seq;
+static uint8_t  leads_was_on = 1;
+static uint8_t  leads_bpm_pending;
+
+/* Samples batched for one "W", SAMPLES or RICE frame: room for the largest */
+static uint16_t frame_buf[ECG_RICE_BLOCK];
+static uint32_t frame_len;
+static uint32_t frame_tick;
+static uint32_t hrv_report_tick;
+
+/* Scheduler; task ids in the order main() adds them */
+enum { TASK_SAMPLE = 0, TASK_COMMAND, TASK_TELEMETRY, TASK_HRV, TASK_SELFTEST, TASK_STACK, TASK_POWER, TASK_CLOCK };
+static Sched_t sched;
+
+/*
+ * Sequence numbers of the last self-test and power releases: the sample task paces
+ * them when the core sleeps, as DWT cycles stop in WFI
+ */
+static uint32_t selftest_seq;
+static uint32_t power_seq;
+
+/* Sample-task deadline misses at the last power accounting */
+static uint32_t power_misses;
+
+#define CYCLES_MS(ms) (SystemCoreClock / 1000u * (ms))
+
+/* Self-test results, sent in the "Y" record */
+static struct {
+    uint32_t last_seq;          /* ad8232_ring.next_seq at the previous run */
+    uint32_t last_tx_tail;      /* hc05_tx.tail at the previous run */
+    uint32_t acq_stalls;        /* runs without a new sample */
+    uint32_t tx_stalls;         /* runs without HC-05 DMA progress while a transfer was in flight */
+    uint32_t pt_faults;         /* detector state not finite: re-armed */
+    uint32_t stack_used;        /* deepest stack use seen, bytes below _estack */
+    uint32_t stack_size;        /* _Min_Stack_Size */
+} selftest;
+
+/* Linker script symbols, as in sysmem.c */
+extern uint8_t _estack;
+extern uint32_t _Min_Stack_Size;
+
+#define STACK_PAINT         0xA5A5A5A5u
+#define STACK_PAINT_MARGIN  64u     /* bytes below the painting frame left alone */
+#define STACK_SCAN_WORDS    32u     /* words checked per idle slice */
+
+static uint32_t *stack_bottom;
+static uint32_t *stack_scan;
+static uint32_t *stack_deepest;
+
+#if PT_BENCHMARK
+#define PT_BENCH_SAMPLES   3600u   /* 10s @ 360Hz */
+#define PT_BENCH_MAX_BEATS 64u
+
+static uint16_t bench_in[PT_BENCH_SAMPLES];
+static uint32_t bench_beats_ref[PT_BENCH_MAX_BEATS];
+static uint32_t bench_beats_blk[PT_BENCH_MAX_BEATS];
+static uint32_t bench_beats_q31[PT_BENCH_MAX_BEATS];
+static PanTompkins_Handle_t bench_ref, bench_blk;
+static PanTompkinsQ31_Handle_t bench_q31;
+
+/*
+ * Run the simulator through every PT engine, timing each with the DWT cycle counter.
+ * The float per-sample path is the golden reference: the block path must match it
+ * bit for bit. For the Q31 engine only the beat counts and final BPM are shown; the
+ * beat-by-beat comparison is the host test host/tests/test_pt_q31.c.
+ */
+static void PT_RunBenchmark(void) {
+    char buff[96];
+    uint32_t n_ref = 0;
+    uint32_t n_q31 = 0;
+
+    ECG_Sim_Init((uint32_t)SAMPLE_RATE_HZ);
+    for (uint32_t i = 0; i < PT_BENCH_SAMPLES; i++) bench_in[i] = ECG_Sim_GetSample();
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    PT_Init(&bench_ref);
+    uint32_t t0 = DWT->CYCCNT;
+    for (uint32_t i = 0; i < PT_BENCH_SAMPLES; i++) {
+        if (PT_Process(&bench_ref, bench_in[i]) && (n_ref < PT_BENCH_MAX_BEATS)) {
+            bench_beats_ref[n_ref++] = bench_ref.last_beat_tick;
+        }
+    }
+    uint32_t t1 = DWT->CYCCNT;
+
+    PT_Init(&bench_blk);
+    uint32_t t2 = DWT->CYCCNT;
+    uint32_t n_blk = PT_ProcessBlock(&bench_blk, bench_in, PT_BENCH_SAMPLES, bench_beats_blk, PT_BENCH_MAX_BEATS);
+    uint32_t t3 = DWT->CYCCNT;
+
+    PT_InitQ31(&bench_q31);
+    uint32_t t4 = DWT->CYCCNT;
+    for (uint32_t i = 0; i < PT_BENCH_SAMPLES; i++) {
+        if (PT_ProcessQ31(&bench_q31, bench_in[i]) && (n_q31 < PT_BENCH_MAX_BEATS)) {
+            bench_beats_q31[n_q31++] = bench_q31.last_beat_tick;
+        }
+    }
+    uint32_t t5 = DWT->CYCCNT;
+
+    uint8_t match = (n_ref == n_blk) &&
+                    (memcmp(bench_beats_ref, bench_beats_blk, n_ref * sizeof(uint32_t)) == 0);
+
+    /* cycles/sample with one decimal */
+    uint32_t ref_x10 = ((t1 - t0) * 10u) / PT_BENCH_SAMPLES;
+    uint32_t blk_x10 = ((t3 - t2) * 10u) / PT_BENCH_SAMPLES;
+    uint32_t q31_x10 = ((t5 - t4) * 10u) / PT_BENCH_SAMPLES;
+
+    sprintf(buff, "PT cyc/sample: sample=%lu.%lu block=%lu.%lu beats=%lu/%lu %s\r\n",
+            ref_x10 / 10u, ref_x10 % 10u, blk_x10 / 10u, blk_x10 % 10u,
+            n_ref, n_blk, match ? "MATCH" : "MISMATCH");
+    USART2_SendString(buff);
+
+    sprintf(buff, "PT Q31 cyc/sample=%lu.%lu beats=%lu/%lu bpm=%d/%d\r\n",
+            q31_x10 / 10u, q31_x10 % 10u, n_ref, n_q31,
+            PT_GetBPM(&bench_ref), PT_GetBPMQ31(&bench_q31));
+    USART2_SendString(buff);
+}
+#endif
+
+#if SER_BENCHMARK
+#define SER_BENCH_RECORDS 1000u
+#define SER_BENCH_KINDS   3u
+#define SER_BENCH_RING    1024u
+
+static uint8_t ser_ring_printf[SER_BENCH_RING];
+static uint8_t ser_ring_ser[SER_BENCH_RING];
+
+/* Record kind k with sprintf: text stream line, 4-signal log line, "B" record */
+static uint32_t Ser_BenchPrintf(uint32_t k, char *out, int32_t x, int32_t i) {
+    switch (k) {
+    case 0:  return (uint32_t)sprintf(out, "%d,%d\r\n", (int)x, 72);
+    case 1:  return (uint32_t)sprintf(out, "%ld,%ld,%ld,%ld\r\n", (long)(x - 2048), (long)(x * 3),
+                                      (long)(-i * 37), (long)(i * 1001));
+    default: return (uint32_t)sprintf(out, "B,%lu,%lu,%ld,%ld,%ld,%d\r\n", (unsigned long)(i * 300),
+                                      300ul, (long)x, (long)(x * 40), (long)(x * 9), 72);
+    }
+}
+
+/* The same record with ecg_ser.h */
+static void Ser_BenchSer(uint32_t k, ECG_Ser_t *w, int32_t x, int32_t i) {
+    switch (k) {
+    case 0:
+        ECG_Ser_DecS(w, x);
+        ECG_Ser_FieldS(w, 72, 2u);
+        break;
+    case 1:
+        ECG_Ser_DecS(w, x - 2048);
+        ECG_Ser_FieldS(w, x * 3, 4u);
+        ECG_Ser_FieldS(w, -i * 37, 4u);
+        ECG_Ser_FieldS(w, i * 1001, 4u);
+        break;
+    default:
+        ECG_Ser_Tag(w, 'B');
+        ECG_Ser_FieldU(w, (uint32_t)(i * 300), 4u);
+        ECG_Ser_FieldU(w, 300u, 4u);
+        ECG_Ser_FieldS(w, x, 4u);
+        ECG_Ser_FieldS(w, x * 40, 4u);
+        ECG_Ser_FieldS(w, x * 9, 4u);
+        ECG_Ser_FieldS(w, 72, 2u);
+        break;
+    }
+    ECG_Ser_End(w);
+}
+
+/*
+ * Format each record kind SER_BENCH_RECORDS times from simulator samples: sprintf plus
+ * the copy into a ring (the HC05_Write path), against ecg_ser.h straight into a ring.
+ * Both are timed with the DWT cycle counter and must produce the same bytes.
+ */
+static void Ser_RunBenchmark(void) {
+    static const char *const kind[SER_BENCH_KINDS] = { "sample", "log", "beat" };
+    char buff[96];
+    uint32_t cyc_printf[SER_BENCH_KINDS] = { 0 };
+    uint32_t cyc_ser[SER_BENCH_KINDS] = { 0 };
+    uint32_t pos = 0;
+    uint8_t match = 1;
+
+    ECG_Sim_Init((uint32_t)SAMPLE_RATE_HZ);
+    for (uint32_t i = 0; i < SER_BENCH_RECORDS; i++) {
+        int32_t x = (int32_t)ECG_Sim_GetSample();
+
+        for (uint32_t k = 0; k < SER_BENCH_KINDS; k++) {
+            uint32_t t0 = DWT->CYCCNT;
+            uint32_t len = Ser_BenchPrintf(k, buff, x, (int32_t)i);
+            uint32_t off = pos & (SER_BENCH_RING - 1u);
+            uint32_t first = (len < SER_BENCH_RING - off) ? len : SER_BENCH_RING - off;
+            memcpy(&ser_ring_printf[off], buff, first);
+            memcpy(ser_ring_printf, &buff[first], len - first);
+            uint32_t t1 = DWT->CYCCNT;
+
+            ECG_Ser_t w;
+            ECG_Ser_Ring(&w, ser_ring_ser, SER_BENCH_RING, pos, SER_BENCH_RING, ECG_SER_TEXT);
+            Ser_BenchSer(k, &w, x, (int32_t)i);
+            uint32_t t2 = DWT->CYCCNT;
+
+            cyc_printf[k] += t1 - t0;
+            cyc_ser[k] += t2 - t1;
+            if (ECG_Ser_Len(&w) != len) match = 0;
+            for (uint32_t b = 0; b < len; b++) {
+                uint32_t o = (pos + b) & (SER_BENCH_RING - 1u);
+                if (ser_ring_printf[o] != ser_ring_ser[o]) match = 0;
+            }
+            pos += len;
+        }
+    }
+
+    for (uint32_t k = 0; k < SER_BENCH_KINDS; k++) {
+        sprintf(buff, "SER %s cyc/record: sprintf=%lu ecg_ser=%lu %s\r\n", kind[k],
+                cyc_printf[k] / SER_BENCH_RECORDS, cyc_ser[k] / SER_BENCH_RECORDS, match ? "MATCH" : "MISMATCH");
+        USART2_SendString(buff);
+    }
+}
+#endif
+
+#if RICE_BENCHMARK
+#define RICE_BENCH_BLOCKS 50u      /* 6400 samples, 17.8s @ 360Hz */
+
+static uint16_t rice_in[ECG_RICE_BLOCK];
+static uint16_t rice_dec[ECG_RICE_BLOCK];
+static uint8_t rice_coded[ECG_RICE_MAX_BYTES(ECG_RICE_BLOCK)];
+static uint8_t rice_frame[ECG_PROTO_MAX_FRAME];
+
+/*
+ * Encode and decode RICE_BENCH_BLOCKS simulator blocks as HC05_STREAM_BINARY 2 does,
+ * timing both with the DWT cycle counter: the on-target figures for ecg_rice_bench,
+ * whose cycles are the host's. Every block must decode back to its input. The link
+ * bytes are those of the RICE frames against SAMPLES frames of the same samples.
+ */
+static void Rice_RunBenchmark(void) {
+    char buff[96];
+    ECG_Proto_t proto;
+    uint32_t cyc_enc = 0, cyc_dec = 0;
+    uint32_t link_rice = 0, link_samples = 0;
+    uint8_t match = 1;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    ECG_Sim_Init((uint32_t)SAMPLE_RATE_HZ);
+    ECG_Proto_Init(&proto);
+    for (uint32_t b = 0; b < RICE_BENCH_BLOCKS; b++) {
+        uint32_t tick = b * ECG_RICE_BLOCK;
+        for (uint32_t i = 0; i < ECG_RICE_BLOCK; i++) rice_in[i] = ECG_Sim_GetSample();
+
+        uint32_t t0 = DWT->CYCCNT;
+        uint32_t len = ECG_Rice_Encode(rice_in, ECG_RICE_BLOCK, rice_coded);
+        uint32_t t1 = DWT->CYCCNT;
+        uint32_t used = ECG_Rice_Decode(rice_coded, len, rice_dec, ECG_RICE_BLOCK);
+        uint32_t t2 = DWT->CYCCNT;
+
+        cyc_enc += t1 - t0;
+        cyc_dec += t2 - t1;
+        if ((used != len) || (memcmp(rice_dec, rice_in, sizeof(rice_in)) != 0)) match = 0;
+
+        link_rice += ECG_Proto_Rice(&proto, rice_frame, tick, rice_in, ECG_RICE_BLOCK, 60);
+        for (uint32_t j = 0; j < ECG_RICE_BLOCK; j += ECG_PROTO_SAMPLES) {
+            uint32_t m = (ECG_RICE_BLOCK - j < ECG_PROTO_SAMPLES) ? ECG_RICE_BLOCK - j : ECG_PROTO_SAMPLES;
+            link_samples += ECG_Proto_Samples(&proto, rice_frame, tick + j, &rice_in[j], m, 60);
+        }
+    }
+
+    /* Per sample with one or two decimals */
+    uint32_t samples = RICE_BENCH_BLOCKS * ECG_RICE_BLOCK;
+    uint32_t enc_x10 = (cyc_enc * 10u) / samples;
+    uint32_t dec_x10 = (cyc_dec * 10u) / samples;
+    uint32_t rice_x100 = (link_rice * 100u) / samples;
+    uint32_t samples_x100 = (link_samples * 100u) / samples;
+    uint32_t ratio_x100 = (link_samples * 100u) / link_rice;
+
+    sprintf(buff, "RICE cyc/sample: encode=%lu.%lu decode=%lu.%lu %s\r\n",
+            enc_x10 / 10u, enc_x10 % 10u, dec_x10 / 10u, dec_x10 % 10u, match ? "LOSSLESS" : "MISMATCH");
+    USART2_SendString(buff);
+    sprintf(buff, "RICE B/sample: rice=%lu.%02lu samples=%lu.%02lu (%lu.%02lux)\r\n",
+            rice_x100 / 100u, rice_x100 % 100u, samples_x100 / 100u, samples_x100 % 100u,
+            ratio_x100 / 100u, ratio_x100 % 100u);
+    USART2_SendString(buff);
+}
+#endif
+
+/* Task deadlines in cycles of the current HCLK: at boot, on a rate change and after a clock switch */
+static void Tasks_SetTiming(uint32_t sample_rate_hz) {
+    Sched_SetTiming(&sched, TASK_SAMPLE, 0u, SystemCoreClock / sample_rate_hz * AD8232_BLOCK_SIZE);
+    Sched_SetTiming(&sched, TASK_COMMAND, 0u, CYCLES_MS(CMD_DEADLINE_MS));
+    Sched_SetTiming(&sched, TASK_TELEMETRY, 0u, CYCLES_MS(TELEMETRY_DEADLINE_MS));
+    Sched_SetTiming(&sched, TASK_HRV, 0u, CYCLES_MS(HRV_REPORT_S * 1000u));
+    Sched_SetTiming(&sched, TASK_SELFTEST, (LOW_POWER == 0) ? CYCLES_MS(SELFTEST_PERIOD_MS) : 0u,
+                    CYCLES_MS(SELFTEST_PERIOD_MS));
+    Sched_SetTiming(&sched, TASK_STACK, (LOW_POWER == 0) ? CYCLES_MS(SELFTEST_PERIOD_MS) : 0u, 0u);
+    Sched_SetTiming(&sched, TASK_POWER, 0u, CYCLES_MS(TELEMETRY_DEADLINE_MS));
+}
+
+/*
+ * Run one command line from the HC-05 (ecg_cmd.h). The acknowledgement goes out in the
+ * stream format in use, before the change, so the receiver reads it and then follows.
+ */
+static void Command_Run(const char *line) {
+    ECG_Cmd_Config next = run_cfg;
+    char ack[ECG_CMD_ACK_MAX];
+    uint8_t status = ECG_Cmd_Parse(line, &next);
+
+    /* A rate the detector cannot run at is refused before anything changes */
+    if ((status == ECG_CMD_OK) && (next.sample_rate_hz != run_cfg.sample_rate_hz)) {
+#if PT_USE_Q31
+        status = ECG_CMD_BAD_ARG;   /* fixed 360Hz delays */
+#else
+        PT_Config cfg;
+        if (!PT_ConfigInit(&cfg, next.sample_rate_hz)) status = ECG_CMD_BAD_ARG;
+#endif
+    }
+    if (status != ECG_CMD_OK) next = run_cfg;
+    next.log_mask &= USART2_SIG_ALL;
+
+    uint32_t len = ECG_Cmd_FormatAck(ack, line[0], status, &next);
+    HC05_SendRecord(ECG_STREAM_IS_BINARY(run_cfg.stream), pt_handle.current_tick, ack, len);
+
+    /* The partial frame of the old format is dropped */
+    if (next.stream != run_cfg.stream) frame_len = 0;
+
+    if ((next.log_mask != run_cfg.log_mask) || (next.log_decim != run_cfg.log_decim)) {
+        USART2_SetLog(next.log_mask, next.log_decim);
+    }
+
+    /* A different signal: restart the detector, beat timing is lost */
+    if (next.sim != run_cfg.sim) {
+        if (next.sim) ECG_Sim_Init(next.sample_rate_hz);
+        leads_was_on = 1;
+        leads_bpm_pending = 0;
+        cmd_rearm = 1;
+        prev_r_tick = 0;
+        HRV_Break(&hrv_handle);
+    }
+
+#if !PT_USE_Q31
+    /* New rate: TIM3, detector delays (applied by the re-arm) and HRV windows */
+    if (next.sample_rate_hz != run_cfg.sample_rate_hz) {
+        PT_ConfigInit(&pt_config, next.sample_rate_hz);
+        AD8232_SetRate(next.sample_rate_hz);
+        if (next.sim) ECG_Sim_Init(next.sample_rate_hz);   /* beat and mains in real time */
+        pt_handle.cfg = pt_config;
+        Tasks_SetTiming(next.sample_rate_hz);
+        cmd_rearm = 1;
+        prev_r_tick = 0;
+        HRV_Init(&hrv_handle, next.sample_rate_hz);
+        HRV_FreqInit(&hrv_freq, &hrv_handle);
+        hrv_report_tick = pt_handle.current_tick;
+    }
+#endif
+
+    run_cfg = next;
+}
+
+/*
+ * Hard task: one sample from ad8232_ring per slice, the job is done when the ring is
+ * empty. Its deadline is one DMA block: a ring that is not drained before the next
+ * block arrives is falling behind.
+ */
+static uint8_t Task_SampleReady(void) {
+    return SampleRing_Count(&ad8232_ring) != 0u;
+}
+
+static uint8_t Task_Sample(void) {
+    SampleRing_Entry s;
+    if (!SampleRing_Pop(&ad8232_ring, &s)) return 1;
+
+    PROF_BEGIN(t_sample);
+    Health_Sample();
+    uint16_t ecg_val = 0;
+    uint8_t rearm = cmd_rearm;
+    uint32_t sample_rate_hz = run_cfg.sample_rate_hz;
+    uint32_t stream = run_cfg.stream;
+
+    cmd_rearm = 0;
+
+    /* Samples dropped by a full ring: beat timing across the gap is unknown */
+    if (s.seq != next_seq) {
+        prev_r_tick = 0;
+        HRV_Break(&hrv_handle);
+    }
+    next_seq = s.seq + 1u;
+
+    /*
+     * Power and health accounting, and the self-test and stack check when the core sleeps:
+     * also while the leads are off
+     */
+    if ((LOW_POWER != 0) && ((s.seq - selftest_seq) >= SELFTEST_PERIOD_MS * sample_rate_hz / 1000u)) {
+        selftest_seq = s.seq;
+        Sched_Release(&sched, TASK_SELFTEST);
+        Sched_Release(&sched, TASK_STACK);
+    }
+    if ((s.seq - power_seq) >= sample_rate_hz) {
+        power_seq = s.seq;
+        Sched_Release(&sched, TASK_POWER);
+    }
+
+    if (run_cfg.sim) {
+        /* Simulation mode (still paced by the ADC) */
+        ecg_val = ECG_Sim_GetSample();
+    } else {
+        /* Real hardware mode: leads state from the EXTI edges, debounced */
+        uint8_t lo_state = AD8232_UpdateLeads(s.seq);
+        if (lo_state == AD8232_LEADS_OFF) {
+            Health_LeadsOff();
+            if (leads_was_on) leads_off_seq = s.seq;
+            leads_was_on = 0;
+            leads_bpm_pending = 0;
+            if (ECG_STREAM_IS_BINARY(stream)) {
+                /* One empty frame when the leads come off */
+                if (s.seq == leads_off_seq) {
+                    HC05_SendSamplesBin(pt_handle.current_tick, frame_buf, 0u, 0);
+                }
+            } else if (stream == ECG_STREAM_TEXT) {
+                HC05_SendSample(0u, 0);
+            }
+            /* Beat records: the W frames stop, the L record reports the gap on reconnection */
+            pt_handle.current_bpm = 0;
+            prev_r_tick = 0;
+            HRV_Break(&hrv_handle);
+            frame_len = 0;  /* drop the partial frame */
+            PROF_END(PROF_SAMPLE, t_sample);
+            return SampleRing_Count(&ad8232_ring) == 0u;
+        }
+        /* TIM3 TRGO sampled it, DMA2 stored it, the DMA ISR queued it: first lead of the frame */
+        uint16_t leads[AD8232_MAX_CHANNELS];
+        AD8232_GetChannels(&s, AD8232_CH_LEAD, leads);
+        ecg_val = leads[0];
+
+        if (lo_state == AD8232_LEADS_REARM) {
+            leads_was_on = 1;
+            leads_rearm_seq = s.seq;
+            leads_bpm_pending = 1;
+            rearm = 1;
+        }
+    }
+
+    /* Process signal with Pan–Tompkins; after reconnection restart from this sample */
+    uint8_t is_beat = 0;
+    PROF_BEGIN(t_pt);
+    if (rearm) {
+        PT_REARM(&pt_handle, ecg_val);
+    } else {
+        is_beat = PT_PROCESS(&pt_handle, ecg_val);
+    }
+    PROF_END(PROF_PT_PROCESS, t_pt);
+
+    /* Get BPM and send */
+    int bpm = PT_GET_BPM(&pt_handle);
+    int32_t tmp = (int32_t)(PT_HPF_ADC(pt_handle.out_y_hpf) / 8) + 2048;
+    if (tmp < 0) tmp = 0;
+    if (tmp > 4095) tmp = 4095;
+    uint16_t ecg_filtered = (uint16_t)tmp;
+
+    /* Time from re-arm to the first BPM of the new connection */
+    if (leads_bpm_pending && PT_BPM_SEEDED(&pt_handle)) {
+        leads_bpm_pending = 0;
+        if (stream == ECG_STREAM_BEATS) {
+            HC05_SendLeads((uint32_t)((uint64_t)(leads_rearm_seq - leads_off_seq) * 1000u / sample_rate_hz),
+                           (uint32_t)((uint64_t)(s.seq - leads_rearm_seq) * 1000u / sample_rate_hz), bpm);
+        }
+    }
+
+    /* RR intervals feed the HRV windows */
+    uint32_t rr = 0;
+    if (is_beat) {
+        uint32_t r_tick = PT_BEAT_R_TICK(&pt_handle);
+        if (prev_r_tick != 0u) {
+            rr = r_tick - prev_r_tick;
+            HRV_AddRR(&hrv_handle, rr);
+        }
+        prev_r_tick = r_tick;
+    }
+
+    PROF_BEGIN(t_stream);
+    if (stream == ECG_STREAM_BEATS) {
+        /* Batch raw samples into frames; a beat record goes out between frames */
+        if (frame_len == 0u) frame_tick = pt_handle.current_tick;
+        frame_buf[frame_len++] = ecg_val;
+        if (frame_len == HC05_FRAME_SAMPLES) {
+            HC05_SendFrame(frame_tick, frame_buf, frame_len);
+            frame_len = 0;
+#if ADC_SCAN_AUX
+            /* Auxiliary and motion inputs once per frame, at its last sample */
+            uint16_t aux[AD8232_MAX_CHANNELS];
+            uint32_t n_aux = AD8232_GetChannels(&s, AD8232_CH_AUX, aux);
+            n_aux += AD8232_GetChannels(&s, AD8232_CH_MOTION, &aux[n_aux]);
+            HC05_SendAux(pt_handle.current_tick - 1u, aux, n_aux);
+#endif
+        }
+
+        if (is_beat) {
+            HC05_SendBeat(prev_r_tick, rr, PT_BEAT_AMPLITUDE(&pt_handle),
+                          PT_LEVEL_INT(pt_handle.signal_level), PT_LEVEL_INT(pt_handle.noise_level), bpm);
+        }
+    } else if (ECG_STREAM_IS_BINARY(stream)) {
+        /* Batch raw samples into binary frames; a beat frame goes out between them */
+        if (frame_len == 0u) frame_tick = pt_handle.current_tick;
+        frame_buf[frame_len++] = ecg_val;
+        if ((stream == ECG_STREAM_RICE) && (frame_len == ECG_RICE_BLOCK)) {
+            HC05_SendRiceBin(frame_tick, frame_buf, frame_len, bpm);
+            frame_len = 0;
+        } else if ((stream == ECG_STREAM_BINARY) && (frame_len == ECG_PROTO_SAMPLES)) {
+            HC05_SendSamplesBin(frame_tick, frame_buf, frame_len, bpm);
+            frame_len = 0;
+        }
+
+        if (is_beat) {
+            HC05_SendBeatBin(prev_r_tick, rr, bpm);
+        }
+    } else {
+        PROF_BEGIN(t_format);
+        HC05_SendSample(ecg_val, bpm);
+        PROF_END(PROF_FORMAT, t_format);
+    }
+    PROF_END(PROF_STREAM, t_stream);
+
+    /* Every HRV_REPORT_S: the periodic records and the next frequency-domain analysis */
+    if ((pt_handle.current_tick - hrv_report_tick) >= HRV_REPORT_S * sample_rate_hz) {
+        hrv_report_tick = pt_handle.current_tick;
+        Sched_Release(&sched, TASK_TELEMETRY);
+    }
+
+    /* Debug: only on logged samples, formatting skipped when the line would be dropped */
+    if (USART2_LogDue()) {
+        int32_t dbg[USART2_SIG_COUNT];
+        dbg[USART2_SIG_DC]         = (int32_t)PT_HPF_ADC(pt_handle.out_x_dc);
+        dbg[USART2_SIG_LPF]        = (int32_t)PT_HPF_ADC(pt_handle.out_y_lpf);
+        dbg[USART2_SIG_HPF]        = (int32_t)PT_HPF_ADC(pt_handle.out_y_hpf);
+        dbg[USART2_SIG_INTEGRATED] = (int32_t)PT_LEVEL_DEBUG(pt_handle.out_integrated);
+        dbg[USART2_SIG_THRESHOLD]  = (int32_t)PT_LEVEL_DEBUG(pt_handle.threshold_i);
+        dbg[USART2_SIG_SIGNAL]     = (int32_t)PT_LEVEL_DEBUG(pt_handle.signal_level);
+        dbg[USART2_SIG_NOISE]      = (int32_t)PT_LEVEL_DEBUG(pt_handle.noise_level);
+        PROF_BEGIN(t_log);
+        USART2_LogSignals(dbg);
+        PROF_END(PROF_LOG, t_log);
+    }
+
+#if PROF_ENABLE
+    /* Profile report: one probe per sample while the debug ring has room for its frame */
+    uint8_t prof_frame[PROF_FRAME_MAX];
+    uint32_t prof_len = Prof_ReportStep(pt_handle.current_tick, PROF_REPORT_S * sample_rate_hz,
+                                        USART2_TxFree(), prof_frame);
+    if (prof_len != 0u) USART2_Write((const char *)prof_frame, prof_len);
+#endif
+    PROF_END(PROF_SAMPLE, t_sample);
+    return SampleRing_Count(&ad8232_ring) == 0u;
+}
+
+/* Soft task: one command line from the HC-05 */
+static uint8_t Task_CommandReady(void) {
+    return ECG_Cmd_RxCount(&hc05_rx.lines) != 0u;
+}
+
+static uint8_t Task_Command(void) {
+    char line[ECG_CMD_LINE_MAX + 1u];
+    if (HC05_ReadLine(line)) Command_Run(line);
+    return 1;
+}
+
+/*
+ * Soft task, released by the sample task every HRV_REPORT_S: beat mode sends the 1 min /
+ * 5 min metrics as "H" records, the latest LF/HF result with its worst slice cost as an
+ * "F" record, the sample ring as an "S" record, the transmit ring as a "T" record, the
+ * scheduler as "Q" and "Y" records and the last second's duty cycle as a "P" record;
+ * then the next frequency-domain analysis starts
+ */
+static uint8_t Task_Telemetry(void) {
+    uint32_t sample_rate_hz = run_cfg.sample_rate_hz;
+
+    if (run_cfg.stream == ECG_STREAM_BEATS) {
+        for (uint32_t w = 0; w < HRV_N_WINDOWS; w++) {
+            HRV_Metrics m;
+            HRV_GetMetrics(&hrv_handle, w, &m);
+            HC05_SendHRV(w, &m);
+        }
+        HRV_FreqResult fr;
+        if (HRV_FreqGetResult(&hrv_freq, &fr)) {
+            HC05_SendHRVFreq(&fr, hrv_freq.slice_cycles_worst, SystemCoreClock / sample_rate_hz,
+                             ad8232_ring.dropped);
+        }
+        HC05_SendRingStats(next_seq - 1u, ad8232_ring.dropped, ad8232_ring.high_water, SAMPLE_RING_SIZE,
+                           ad8232_isr_cycles_max, SystemCoreClock / sample_rate_hz * AD8232_BLOCK_SIZE);
+        HC05_SendTxStats();
+        for (uint32_t id = 0; id < sched.n_tasks; id++) {
+            HC05_SendTaskStats(id, Sched_Get(&sched, (uint8_t)id));
+        }
+        HC05_SendSelfTest(selftest.acq_stalls, selftest.tx_stalls, selftest.pt_faults,
+                          selftest.stack_used, selftest.stack_size);
+        HC05_SendPower(power.level, SystemCoreClock, power.awake_cycles_s, power.duty_permille,
+                       power.wakeups_s, power.switches);
+    }
+    if (HRV_FreqStart(&hrv_freq)) Sched_Release(&sched, TASK_HRV);
+    return 1;
+}
+
+/* Soft task: the frequency-domain analysis, one bounded slice at a time until it finishes */
+static uint8_t Task_HRV(void) {
+    PROF_BEGIN(t_hrv);
+    HRV_FreqStep(&hrv_freq);
+    PROF_END(PROF_HRV_SLICE, t_hrv);
+    return hrv_freq.state == HRV_FREQ_IDLE;
+}
+
+#if !PT_USE_Q31
+/* Infinity or NaN, tested on the bits: -ffast-math folds isfinite() to 1 */
+static uint8_t SelfTest_Finite(float32_t v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return (bits & 0x7F800000u) != 0x7F800000u;
+}
+#endif
+
+/*
+ * Soft task, every SELFTEST_PERIOD_MS: acquisition still producing samples, HC-05
+ * transmit DMA still moving, float detector state finite (re-armed if not). With
+ * LOW_POWER the samples pace it, so a stopped acquisition stops it too and is not counted.
+ */
+static uint8_t Task_SelfTest(void) {
+    uint32_t seq = ad8232_ring.next_seq;
+    uint32_t tail = hc05_tx.tail;
+
+    if (seq == selftest.last_seq) selftest.acq_stalls++;
+    if ((hc05_tx.dma_len != 0u) && (tail == selftest.last_tx_tail)) selftest.tx_stalls++;
+    selftest.last_seq = seq;
+    selftest.last_tx_tail = tail;
+
+#if !PT_USE_Q31
+    if (!SelfTest_Finite(pt_handle.out_integrated) || !SelfTest_Finite(pt_handle.threshold_i) ||
+        !SelfTest_Finite(pt_handle.signal_level) || !SelfTest_Finite(pt_handle.noise_level)) {
+        selftest.pt_faults++;
+        cmd_rearm = 1;
+    }
+#endif
+    return 1;
+}
+
+/*
+ * Idle task, every SELFTEST_PERIOD_MS: stack high-water mark. main() paints the
+ * reserved stack (_Min_Stack_Size below _estack) with STACK_PAINT; each slice checks
+ * STACK_SCAN_WORDS words from the bottom up towards the deepest use found so far.
+ */
+static uint8_t Task_Stack(void) {
+    for (uint32_t n = 0; n < STACK_SCAN_WORDS; n++, stack_scan++) {
+        if ((stack_scan >= stack_deepest) || (*stack_scan != STACK_PAINT)) {
+            stack_deepest = stack_scan;
+            selftest.stack_used = (uint32_t)&_estack - (uint32_t)stack_deepest;
+            stack_scan = stack_bottom;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Soft task, every second of samples: duty cycle and, with LOW_POWER 2, the next HCLK
+ * level; the health counters, sent as a "G" record in every stream format
+ */
+static uint8_t Task_Power(void) {
+    uint32_t misses = Sched_Get(&sched, TASK_SAMPLE)->misses;
+
+    Power_Account(misses - power_misses);
+    Health_Account(run_cfg.sample_rate_hz, misses - power_misses);
+    power_misses = misses;
+    HC05_SendHealth(ECG_STREAM_IS_BINARY(run_cfg.stream), pt_handle.current_tick, &health);
+    return 1;
+}
+
+/* Soft task: a pending HCLK switch, once both transmit links are idle */
+static uint8_t Task_Clock(void) {
+    Power_Switch(run_cfg.sample_rate_hz);
+    Tasks_SetTiming(run_cfg.sample_rate_hz);
+    return 1;
+}
+
+/* Whether the scheduler has work, for the check before sleeping */
+static uint8_t Tasks_Ready(void) {
+    return Sched_Ready(&sched);
+}
+
+/* Paint the stack below this frame, up to _Min_Stack_Size from the top of RAM */
+static void Stack_Paint(void) {
+    uint32_t *sp = (uint32_t *)(__get_MSP() - STACK_PAINT_MARGIN);
+
+    stack_bottom = (uint32_t *)((uint32_t)&_estack - (uint32_t)&_Min_Stack_Size);
+    for (uint32_t *p = stack_bottom; p < sp; p++) *p = STACK_PAINT;
+    stack_scan = stack_bottom;
+    stack_deepest = sp;
+    selftest.stack_size = (uint32_t)&_Min_Stack_Size;
+    selftest.stack_used = (uint32_t)&_estack - (uint32_t)sp;
+}
 
 int main(void) {
+    Stack_Paint();
     HAL_Init();
     SystemClock_Config();
 
     /* Initialize HC-05 */
     HC05_Init();
 
-    /* Sampling frequency: 360Hz */
-    AD8232_Init(360);
+    /* Sampling frequency: ECG_SAMPLE_RATE_HZ, out-of-range rates fall back to 360Hz */
+    uint32_t sample_rate_hz = ECG_SAMPLE_RATE_HZ;
+#if PT_USE_Q31
+    sample_rate_hz = (uint32_t)SAMPLE_RATE_HZ;
+#endif
+    if (!PT_ConfigInit(&pt_config, sample_rate_hz)) {
+        sample_rate_hz = pt_config.sample_rate_hz;
+    }
+
+    /* DWT cycle counter times the acquisition interrupt and the HRV slices */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#if PROF_ENABLE
+    Prof_Init();
+#endif
+
+#if ADC_SCAN_AUX
+    AD8232_InitScan(sample_rate_hz, ADC_OVERSAMPLE, adc_scan, sizeof(adc_scan) / sizeof(adc_scan[0]));
+#else
+    AD8232_Init(sample_rate_hz, ADC_OVERSAMPLE);
+#endif
 
     USART2_Init();
+    USART2_SetLog(DEBUG_LOG_SIGNALS, DEBUG_LOG_DECIM);
 
-#if USE_ECG_SIM
-    ECG_Sim_Init();
+    run_cfg.stream = HC05_STREAM_BOOT;
+    run_cfg.sample_rate_hz = sample_rate_hz;
+    run_cfg.sim = USE_ECG_SIM;
+    run_cfg.log_mask = usart2_log.mask;
+    run_cfg.log_decim = usart2_log.decim;
+
+#if PT_BENCHMARK
+    PT_RunBenchmark();
+#endif
+#if SER_BENCHMARK
+    Ser_RunBenchmark();
+#endif
+#if RICE_BENCHMARK
+    Rice_RunBenchmark();
 #endif
 
-    /* Initialize Pan-Tompkins algorithm */
-    PT_Init(&pt_handle);
+    ECG_Sim_Init(sample_rate_hz);
 
-    while (1) {
-        if (ad8232_sample_ready == 1) {
-            ad8232_sample_ready = 0;
+    /* Initialize Pan-Tompkins algorithm */
+    PT_INIT(&pt_handle, &pt_config);
+    HRV_Init(&hrv_handle, sample_rate_hz);
+    HRV_FreqInit(&hrv_freq, &hrv_handle);
 
-            uint16_t ecg_val = 0;
+    /* Tasks, in TASK_* id order */
+    Sched_Init(&sched);
+    Sched_Add(&sched, "sample", SCHED_HARD, Task_SampleReady, Task_Sample, 0u, 0u);
+    Sched_Add(&sched, "command", SCHED_SOFT, Task_CommandReady, Task_Command, 0u, 0u);
+    Sched_Add(&sched, "telemetry", SCHED_SOFT, NULL, Task_Telemetry, 0u, 0u);
+    Sched_Add(&sched, "hrv", SCHED_SOFT, NULL, Task_HRV, 0u, 0u);
+    Sched_Add(&sched, "selftest", SCHED_SOFT, NULL, Task_SelfTest, 0u, 0u);
+    Sched_Add(&sched, "stack", SCHED_IDLE, NULL, Task_Stack, 0u, 0u);
+    Sched_Add(&sched, "power", SCHED_SOFT, NULL, Task_Power, 0u, 0u);
+    Sched_Add(&sched, "clock", SCHED_SOFT, Power_SwitchReady, Task_Clock, 0u, 0u);
+    Tasks_SetTiming(sample_rate_hz);
 
-#if USE_ECG_SIM
-            /* Simulation mode (still paced by TIM3 @ 360Hz) */
-            ecg_val = ECG_Sim_GetSample();
-#else
-            /* Real hardware mode */
-            if (AD8232_IsLeadsOff()) {
-                sprintf(msg_buffer, "0,0\r\n");
-                HC05_SendString(msg_buffer);
-                pt_handle.current_bpm = 0;
-                continue;
-            }
-            /* TIM3_IRQHandler already sampled ADC into ad8232_latest_adc */
-            ecg_val = ad8232_latest_adc;
-#endif
-
-            /* Process signal with Pan–Tompkins */
-            PT_Process(&pt_handle, ecg_val);
-
-            /* Get BPM and send */
-            int bpm = PT_GetBPM(&pt_handle);
-            int32_t tmp = (int32_t)(pt_handle.out_y_hpf / 8.0f) + 2048;
-            if (tmp < 0) tmp = 0;
-            if (tmp > 4095) tmp = 4095;
-            uint16_t ecg_filtered = (uint16_t)tmp;
-
-            sprintf(msg_buffer, "%d,%d\r\n", ecg_val, bpm);
-            HC05_SendString(msg_buffer);
-
-            /* Debug */
-            int16_t integrated_scaled = (int16_t)(pt_handle.out_integrated / 4000.0f);
-            int16_t threshold_scaled = (int16_t)(pt_handle.threshold_i / 4000.0f);
-            USART2_LogSignals((int16_t)(ecg_val - 2048),          /* Raw centered */
-                              (int16_t)pt_handle.out_y_hpf,       /* Filtered */
-                              integrated_scaled,                  /* Integrated */
-                              threshold_scaled                    /* Threshold */
-            );
+    Power_Init(LOW_POWER);
+    Health_Init(&sched);
+    while (1) {
+        uint32_t t0 = DWT->CYCCNT;
+        if (Sched_Step(&sched) == SCHED_NONE) {
+            Power_Idle(t0, Tasks_Ready);
+        } else {
+            Health_Slice(t0);
         }
     }
 }
@@ -1,23 +1,129 @@
 #include "pan_tompkins.h"
 #include <string.h>
 
-/* Helper: circular history access for LPF/HPF */
-static inline float32_t hist_get(const float32_t *hist, uint16_t size, uint16_t idx, uint16_t delay) {
-    /* hist[idx] is the newest sample written at current idx */
-    int32_t pos = (int32_t)idx - (int32_t)delay;
-    while (pos < 0) pos += (int32_t)size;
-    return hist[(uint16_t)pos];
+/* Helper: circular history access for LPF/HPF (power-of-two size, mask = size - 1) */
+static inline float32_t hist_get(const float32_t *hist, uint32_t mask, uint32_t idx, uint32_t delay) {
+    /* hist[idx & mask] is the newest sample written at current idx */
+    return hist[(idx - delay) & mask];
 }
 
 /*
- * Difference equations adjusted for Fs = 360Hz by scaling Pan–Tompkins integer-filter delays:
- *  - LPF (scaled): yLP[n] = 2yLP[n-1] - yLP[n-2] + x[n] - 2x[n-M] + x[n-2M],  M=11
- *  - HPF (scaled): yHP[n] = yHP[n-1] - v[n]/(2N) + v[n-N] - v[n-(N+1)] + v[n-2N]/(2N), N=29
+ * Difference equations adjusted for Fs by scaling Pan–Tompkins integer-filter delays:
+ *  - LPF (scaled): yLP[n] = 2yLP[n-1] - yLP[n-2] + x[n] - 2x[n-M] + x[n-2M],  M=round(6*Fs/200)  (11 @ 360Hz)
+ *  - HPF (scaled): yHP[n] = yHP[n-1] - v[n]/(2N) + v[n-N] - v[n-(N+1)] + v[n-2N]/(2N), N=round(16*Fs/200)  (29 @ 360Hz)
  * where v[n] is LPF output (input to HPF).
+ *
+ * PT_ProcessBlock runs the same equations through CMSIS-DSP kernels:
+ *  - DC removal:  1 biquad   {b0=1, b1=-1, a1=0.995}
+ *  - LPF:         comb x[n] + x[n-2M] - 2x[n-M], then biquad {b0=1, a1=2, a2=-1}
+ *  - HPF:         comb (v[n-2N]-v[n])/(2N) + v[n-N] - v[n-N-1], then biquad {b0=1, a1=1}
+ *  - Derivative:  5-tap FIR
+ * The per-sample expressions below are grouped in the same order as those kernels
+ * evaluate them, so both paths round identically and detect the same beats.
  */
 
+/* DF2T biquad coefficients {b0, b1, b2, a1, a2} (CMSIS sign convention: +a1*y[n-1]) */
+static const float32_t dc_coeffs[5]  = { 1.0f, -1.0f, 0.0f, 0.995f,  0.0f };
+static const float32_t lpf_coeffs[5] = { 1.0f,  0.0f, 0.0f, 2.0f,   -1.0f };
+static const float32_t hpf_coeffs[5] = { 1.0f,  0.0f, 0.0f, 1.0f,    0.0f };
+
+/* 5-point derivative (2x[n] + x[n-1] - x[n-3] - 2x[n-4]) / 8, oldest tap first as arm_fir_f32 expects */
+#define DERIV_TAPS 5u
+static const float32_t deriv_coeffs[DERIV_TAPS] = { -0.25f, -0.125f, 0.0f, 0.125f, 0.25f };
+
+/*
+ * Stage boundary hook: charges the time since the caller's PROF_BEGIN (or the previous
+ * stage) to the stage in PROF_ENABLE builds (prof.h); host/tools/pt_replay_stages.c
+ * defines its own. Empty otherwise.
+ */
+#if PROF_ENABLE && !defined(PT_STAGE_MARK)
+#include "prof.h"
+#define PT_STAGE_MARK(stage) Prof_Mark(PROF_PT_STAGE + (stage))
+#endif
+#ifndef PT_STAGE_MARK
+#define PT_STAGE_MARK(stage)
+#endif
+
+/* Stage 5: local maxima + adaptive thresholding on one integrated sample (current_tick already advanced) */
+static uint8_t pt_detect(PanTompkins_Handle_t *ht, float32_t int_curr);
+
+/*
+ * Fill beat_event for an MWI peak at peak_tick. The QRS energy under that peak entered
+ * the window over the last W samples, behind the 2-sample derivative delay, so the
+ * largest |band-pass| in [peak_tick - W - 2, peak_tick] is the R peak.
+ */
+static void pt_locate_r(PanTompkins_Handle_t *ht, uint32_t peak_tick) {
+    const uint32_t span = ht->cfg.integration_window + 2u;
+    uint32_t  k = peak_tick;
+    float32_t best = 0.0f;
+
+    for (uint32_t t = peak_tick - span; t != peak_tick + 1u; t++) {
+        float32_t v = ht->bp_hist[t & PT_BP_HIST_MASK];
+        if (v < 0.0f) v = -v;
+        if (v > best) {
+            best = v;
+            k = t;
+        }
+    }
+
+    /* Parabola through |y| at k-1, k, k+1 (k+1 <= current_tick is always in the buffer) */
+    float32_t a = ht->bp_hist[(k - 1u) & PT_BP_HIST_MASK];
+    float32_t b = ht->bp_hist[k & PT_BP_HIST_MASK];
+    float32_t c = ht->bp_hist[(k + 1u) & PT_BP_HIST_MASK];
+    if (b < 0.0f) {
+        a = -a;
+        b = -b;
+        c = -c;
+    }
+    float32_t den = a - 2.0f*b + c;
+    float32_t frac = (den < 0.0f) ? 0.5f * (a - c) / den : 0.0f;
+    if (frac >  0.5f) frac =  0.5f;
+    if (frac < -0.5f) frac = -0.5f;
+
+    PT_BeatEvent *ev = &ht->beat_event;
+    uint32_t r_tick = k - ht->cfg.bp_delay;
+
+    ev->rr          = (ev->detect_tick != 0u) ? (r_tick - ev->r_tick) : 0u;
+    ev->r_tick      = r_tick;
+    ev->r_frac      = frac;
+    ev->amplitude   = ht->bp_hist[k & PT_BP_HIST_MASK];
+    ev->detect_tick = ht->current_tick;
+    ev->latency     = (uint16_t)(ht->current_tick - r_tick);
+}
+
+uint8_t PT_ConfigInit(PT_Config *cfg, uint32_t sample_rate_hz) {
+    uint8_t ok = 1;
+
+    if ((sample_rate_hz < PT_MIN_SAMPLE_RATE_HZ) || (sample_rate_hz > PT_MAX_SAMPLE_RATE_HZ)) {
+        sample_rate_hz = (uint32_t)SAMPLE_RATE_HZ;
+        ok = 0;
+    }
+
+    /* Same rounding as the 360Hz constants in pan_tompkins.h */
+    cfg->sample_rate_hz          = sample_rate_hz;
+    cfg->lpf_delay_m             = (uint16_t)((6u * sample_rate_hz + 100u) / 200u);
+    cfg->hpf_delay_n             = (uint16_t)((16u * sample_rate_hz + 100u) / 200u);
+    cfg->integration_window      = (uint16_t)((150u * sample_rate_hz + 500u) / 1000u);
+    cfg->refractory_samples      = (uint16_t)((200u * sample_rate_hz + 500u) / 1000u);
+    cfg->no_beat_timeout_samples = NO_BEAT_TIMEOUT_S * sample_rate_hz;
+    cfg->bpm_num                 = 60u * sample_rate_hz;
+    cfg->bp_delay                = (uint16_t)(cfg->lpf_delay_m - 1u + cfg->hpf_delay_n);
+    cfg->hpf_scale               = 1.0f / (float32_t)(2u * cfg->hpf_delay_n);
+    cfg->mwi_scale               = 1.0f / (float32_t)cfg->integration_window;
+
+    return ok;
+}
+
 void PT_Init(PanTompkins_Handle_t *ht) {
+    PT_Config cfg;
+
+    PT_ConfigInit(&cfg, (uint32_t)SAMPLE_RATE_HZ);
+    PT_InitConfig(ht, &cfg);
+}
+
+void PT_InitConfig(PanTompkins_Handle_t *ht, const PT_Config *cfg) {
     memset(ht, 0, sizeof(*ht));
+    ht->cfg = *cfg;
 
     /* Conservative start-up values (will adapt) */
     ht->threshold_i  = 1000.0f;
@@ -33,7 +139,26 @@ void PT_Init(PanTompkins_Handle_t *ht) {
     ht->int_prev1 = 0.0f;
 }
 
+void PT_Rearm(PanTompkins_Handle_t *ht, uint16_t raw_adc) {
+    PT_Config cfg = ht->cfg;
+    uint32_t tick = ht->current_tick + 1u;
+
+    PT_InitConfig(ht, &cfg);
+    ht->current_tick = tick;
+
+    /* Constant input at raw_adc: DC removal output 0, every later stage at rest */
+    ht->dc_x1 = (float32_t)raw_adc - 2048.0f;
+
+    /* No beat yet: a first RR from here is out of range (< PT_BPM_MIN), so it only anchors */
+    ht->last_beat_tick  = tick - cfg.bpm_num / PT_BPM_MIN;
+    ht->last_decay_tick = tick;
+    ht->bpm_seed = 1;
+}
+
 uint8_t PT_Process(PanTompkins_Handle_t *ht, uint16_t raw_adc) {
+    const uint32_t M = ht->cfg.lpf_delay_m;
+    const uint32_t N = ht->cfg.hpf_delay_n;
+
     ht->current_tick++;
 
     /* Convert ADC to centered float (rough DC at mid-scale). Report then applies DC-removal filter. */
@@ -41,86 +166,88 @@ uint8_t PT_Process(PanTompkins_Handle_t *ht, uint16_t raw_adc) {
 
     /* Stage 0: DC removal (report equation) */
     /* y[n] = 0.995*y[n-1] + x[n] - x[n-1] */
-    float32_t x_dc = 0.995f * ht->dc_y1 + (x - ht->dc_x1);
+    float32_t x_dc = x + (0.995f * ht->dc_y1 - ht->dc_x1);
     ht->dc_x1 = x;
     ht->dc_y1 = x_dc;
     ht->out_x_dc = x_dc;
+    PT_STAGE_MARK(PT_STAGE_DC);
 
     /* Stage 1a: LPF (scaled integer structure) */
-    const uint16_t lpf_size = (uint16_t)(2u*LPF_DELAY_M + 1u);
-
     /* write newest x_dc */
-    ht->lpf_x_hist[ht->lpf_idx] = x_dc;
+    ht->lpf_x_hist[ht->lpf_idx & PT_LPF_HIST_MASK] = x_dc;
 
-    float32_t x_n    = hist_get(ht->lpf_x_hist, lpf_size, ht->lpf_idx, 0);
-    float32_t x_n_M  = hist_get(ht->lpf_x_hist, lpf_size, ht->lpf_idx, LPF_DELAY_M);
-    float32_t x_n_2M = hist_get(ht->lpf_x_hist, lpf_size, ht->lpf_idx, 2u*LPF_DELAY_M);
+    float32_t x_n    = hist_get(ht->lpf_x_hist, PT_LPF_HIST_MASK, ht->lpf_idx, 0);
+    float32_t x_n_M  = hist_get(ht->lpf_x_hist, PT_LPF_HIST_MASK, ht->lpf_idx, M);
+    float32_t x_n_2M = hist_get(ht->lpf_x_hist, PT_LPF_HIST_MASK, ht->lpf_idx, 2u*M);
 
-    float32_t y_lpf = 2.0f*ht->lpf_y1 - ht->lpf_y2 + x_n - 2.0f*x_n_M + x_n_2M;
+    float32_t y_lpf = (2.0f*ht->lpf_y1 - ht->lpf_y2) + ((x_n + x_n_2M) - 2.0f*x_n_M);
 
     ht->lpf_y2 = ht->lpf_y1;
     ht->lpf_y1 = y_lpf;
     ht->out_y_lpf = y_lpf;
 
     ht->lpf_idx++;
-    if (ht->lpf_idx >= lpf_size) ht->lpf_idx = 0;
+    PT_STAGE_MARK(PT_STAGE_LPF);
 
     /* Stage 1b: HPF (scaled) - input is LPF output */
-    const uint16_t hpf_size = (uint16_t)(2u*HPF_DELAY_N + 1u);
-
-    ht->hpf_x_hist[ht->hpf_idx] = y_lpf;
+    ht->hpf_x_hist[ht->hpf_idx & PT_HPF_HIST_MASK] = y_lpf;
 
-    float32_t v_n      = hist_get(ht->hpf_x_hist, hpf_size, ht->hpf_idx, 0);
-    float32_t v_n_N    = hist_get(ht->hpf_x_hist, hpf_size, ht->hpf_idx, HPF_DELAY_N);
-    float32_t v_n_N1   = hist_get(ht->hpf_x_hist, hpf_size, ht->hpf_idx, (uint16_t)(HPF_DELAY_N + 1u));
-    float32_t v_n_2N   = hist_get(ht->hpf_x_hist, hpf_size, ht->hpf_idx, (uint16_t)(2u*HPF_DELAY_N));
+    float32_t v_n      = hist_get(ht->hpf_x_hist, PT_HPF_HIST_MASK, ht->hpf_idx, 0);
+    float32_t v_n_N    = hist_get(ht->hpf_x_hist, PT_HPF_HIST_MASK, ht->hpf_idx, N);
+    float32_t v_n_N1   = hist_get(ht->hpf_x_hist, PT_HPF_HIST_MASK, ht->hpf_idx, N + 1u);
+    float32_t v_n_2N   = hist_get(ht->hpf_x_hist, PT_HPF_HIST_MASK, ht->hpf_idx, 2u*N);
 
-    float32_t y_hpf = ht->hpf_y1
-                      - (v_n / HPF_DIV_K)
-                      + v_n_N
-                      - v_n_N1
-                      + (v_n_2N / HPF_DIV_K);
+    float32_t y_hpf = ((v_n_2N - v_n) * ht->cfg.hpf_scale + (v_n_N - v_n_N1)) + ht->hpf_y1;
 
     ht->hpf_y1 = y_hpf;
     ht->out_y_hpf = y_hpf;
+    ht->bp_hist[ht->current_tick & PT_BP_HIST_MASK] = y_hpf;
 
     ht->hpf_idx++;
-    if (ht->hpf_idx >= hpf_size) ht->hpf_idx = 0;
+    PT_STAGE_MARK(PT_STAGE_HPF);
 
     /* Stage 2: Derivative (5-point) */
     for (int i = 4; i > 0; i--) ht->deriv_buff[i] = ht->deriv_buff[i - 1];
     ht->deriv_buff[0] = y_hpf;
 
-    float32_t deriv = (2.0f*ht->deriv_buff[0]
-                     + ht->deriv_buff[1]
-                     - ht->deriv_buff[3]
-                     - 2.0f*ht->deriv_buff[4]) / 8.0f;
+    float32_t deriv = 0.0f;
+    for (uint32_t k = 0; k < DERIV_TAPS; k++) {
+        deriv += ht->deriv_buff[DERIV_TAPS - 1u - k] * deriv_coeffs[k];
+    }
+    PT_STAGE_MARK(PT_STAGE_DERIV);
 
     /* Stage 3: Squaring */
     float32_t squared = deriv * deriv;
+    PT_STAGE_MARK(PT_STAGE_SQUARE);
 
     /* Stage 4: Moving Window Integration (150ms @ 360Hz -> 54 samples) */
-    ht->win_sum -= ht->win_buff[ht->win_idx];
-    ht->win_buff[ht->win_idx] = squared;
+    ht->win_sum -= ht->win_buff[(uint16_t)(ht->win_idx - ht->cfg.integration_window) & PT_WIN_HIST_MASK];
+    ht->win_buff[ht->win_idx & PT_WIN_HIST_MASK] = squared;
     ht->win_sum += squared;
 
     ht->win_idx++;
-    if (ht->win_idx >= INTEGRATION_WINDOW) ht->win_idx = 0;
 
-    float32_t integrated = ht->win_sum / (float32_t)INTEGRATION_WINDOW;
+    float32_t integrated = ht->win_sum * ht->cfg.mwi_scale;
     ht->out_integrated = integrated;
+    PT_STAGE_MARK(PT_STAGE_MWI);
+
+    uint8_t is_beat = pt_detect(ht, integrated);
+    PT_STAGE_MARK(PT_STAGE_DETECT);
 
+    return is_beat;
+}
+
+static uint8_t pt_detect(PanTompkins_Handle_t *ht, float32_t int_curr) {
     /* Stage 5: Local maxima detection on integrated signal (per report) */
     uint8_t is_beat = 0;
 
-    float32_t int_curr = integrated;
     /* A local maximum occurs at int_prev1 if int_prev1 > int_prev2 and int_prev1 > int_curr */
     if ((ht->int_prev1 > ht->int_prev2) && (ht->int_prev1 > int_curr)) {
         float32_t peak_val = ht->int_prev1;
         uint32_t  peak_tick = ht->current_tick - 1u; /* peak at previous sample */
 
         /* Refractory period: 200ms */
-        if ((peak_tick - ht->last_beat_tick) > REFRACTORY_SAMPLES) {
+        if ((peak_tick - ht->last_beat_tick) > ht->cfg.refractory_samples) {
             if (peak_val > ht->threshold_i) {
                 /* QRS detected */
                 ht->signal_level = 0.125f * peak_val + 0.875f * ht->signal_level;
@@ -130,12 +257,17 @@ uint8_t PT_Process(PanTompkins_Handle_t *ht, uint16_t raw_adc) {
                 uint32_t duration = peak_tick - ht->last_beat_tick;
                 ht->last_beat_tick = peak_tick;
 
-                if (duration > 0) {
-                    float32_t instant_bpm = (60.0f * SAMPLE_RATE_HZ) / (float32_t)duration;
-                    if (instant_bpm > 40.0f && instant_bpm < 200.0f) {
-                        ht->current_bpm = (int)(0.9f * (float32_t)ht->current_bpm + 0.1f * instant_bpm);
+                if (ht->bpm_seed) {
+                    int bpm = PT_InstantBPM(duration, ht->cfg.bpm_num);
+                    if (bpm != 0) {
+                        ht->current_bpm = bpm;
+                        ht->bpm_seed = 0;
                     }
+                } else {
+                    ht->current_bpm = PT_UpdateBPM(ht->current_bpm, duration, ht->cfg.bpm_num);
                 }
+
+                pt_locate_r(ht, peak_tick);
             } else {
                 /* Not a QRS peak -> treat as noise peak */
                 ht->noise_level = 0.125f * peak_val + 0.875f * ht->noise_level;
@@ -151,8 +283,8 @@ uint8_t PT_Process(PanTompkins_Handle_t *ht, uint16_t raw_adc) {
     }
 
     /* Threshold decay (stable): if no beat for too long, reduce threshold periodically */
-    if ((ht->current_tick - ht->last_beat_tick) > NO_BEAT_TIMEOUT_SAMPLES) {
-        uint32_t decay_period = (uint32_t)SAMPLE_RATE_HZ; /* once per second */
+    if ((ht->current_tick - ht->last_beat_tick) > ht->cfg.no_beat_timeout_samples) {
+        uint32_t decay_period = ht->cfg.sample_rate_hz; /* once per second */
         if ((ht->current_tick - ht->last_decay_tick) > decay_period) {
             ht->threshold_i *= 0.5f;
             ht->last_decay_tick = ht->current_tick;
@@ -168,6 +300,135 @@ uint8_t PT_Process(PanTompkins_Handle_t *ht, uint16_t raw_adc) {
     return is_beat;
 }
 
+/* Stages 0-4 for one chunk (m <= PT_BLOCK_SIZE); writes the integrated signal to integ */
+static void pt_front_end_block(PanTompkins_Handle_t *ht, const uint16_t *in, uint32_t m, float32_t *integ) {
+    const uint32_t M = ht->cfg.lpf_delay_m;
+    const uint32_t N = ht->cfg.hpf_delay_n;
+    const uint32_t W = ht->cfg.integration_window;
+
+    /* Linear views: [history | chunk], so every delayed tap is a plain offset */
+    float32_t lpf_lin[2u*PT_MAX_LPF_DELAY_M + PT_BLOCK_SIZE];
+    float32_t hpf_lin[2u*PT_MAX_HPF_DELAY_N + PT_BLOCK_SIZE];
+    float32_t der_lin[(DERIV_TAPS - 1u) + PT_BLOCK_SIZE];
+    float32_t fir_state[(DERIV_TAPS - 1u) + PT_BLOCK_SIZE];
+    float32_t buf_a[PT_BLOCK_SIZE];
+    float32_t buf_b[PT_BLOCK_SIZE];
+    float32_t bq_state[2];
+
+    arm_biquad_cascade_df2T_instance_f32 bq;
+    arm_fir_instance_f32 fir;
+
+    /* Centre ADC samples */
+    for (uint32_t i = 0; i < m; i++) buf_a[i] = (float32_t)in[i] - 2048.0f;
+
+    /* Stage 0: DC removal -> lpf_lin[2M..] */
+    arm_biquad_cascade_df2T_init_f32(&bq, 1u, dc_coeffs, bq_state);
+    bq_state[0] = 0.995f * ht->dc_y1 - ht->dc_x1;
+    arm_biquad_cascade_df2T_f32(&bq, buf_a, &lpf_lin[2u*M], m);
+    ht->dc_x1 = buf_a[m - 1u];
+    ht->dc_y1 = lpf_lin[2u*M + m - 1u];
+
+    /* Stage 1a: LPF. lpf_idx is the next write slot, so the newest sample sits at lpf_idx - 1. */
+    for (uint32_t k = 0; k < 2u*M; k++) {
+        lpf_lin[k] = hist_get(ht->lpf_x_hist, PT_LPF_HIST_MASK, ht->lpf_idx, 2u*M - k);
+    }
+    for (uint32_t i = 0; i < m; i++) {
+        ht->lpf_x_hist[(ht->lpf_idx + i) & PT_LPF_HIST_MASK] = lpf_lin[2u*M + i];
+        buf_a[i] = (lpf_lin[2u*M + i] + lpf_lin[i]) - 2.0f*lpf_lin[M + i];
+    }
+    ht->lpf_idx = (uint16_t)(ht->lpf_idx + m);
+
+    arm_biquad_cascade_df2T_init_f32(&bq, 1u, lpf_coeffs, bq_state);
+    bq_state[0] = 2.0f * ht->lpf_y1 - ht->lpf_y2;
+    bq_state[1] = -ht->lpf_y1;
+    arm_biquad_cascade_df2T_f32(&bq, buf_a, &hpf_lin[2u*N], m);
+
+    ht->lpf_y2 = (m > 1u) ? hpf_lin[2u*N + m - 2u] : ht->lpf_y1;
+    ht->lpf_y1 = hpf_lin[2u*N + m - 1u];
+
+    /* Stage 1b: HPF -> der_lin[4..] */
+    for (uint32_t k = 0; k < 2u*N; k++) {
+        hpf_lin[k] = hist_get(ht->hpf_x_hist, PT_HPF_HIST_MASK, ht->hpf_idx, 2u*N - k);
+    }
+    for (uint32_t i = 0; i < m; i++) {
+        ht->hpf_x_hist[(ht->hpf_idx + i) & PT_HPF_HIST_MASK] = hpf_lin[2u*N + i];
+        buf_a[i] = (hpf_lin[i] - hpf_lin[2u*N + i]) * ht->cfg.hpf_scale
+                 + (hpf_lin[N + i] - hpf_lin[N - 1u + i]);
+    }
+    ht->hpf_idx = (uint16_t)(ht->hpf_idx + m);
+
+    arm_biquad_cascade_df2T_init_f32(&bq, 1u, hpf_coeffs, bq_state);
+    bq_state[0] = ht->hpf_y1;
+    arm_biquad_cascade_df2T_f32(&bq, buf_a, &der_lin[DERIV_TAPS - 1u], m);
+
+    ht->hpf_y1 = der_lin[DERIV_TAPS - 1u + m - 1u];
+
+    /* R-peak look-back: these samples get ticks current_tick + 1 .. current_tick + m */
+    for (uint32_t i = 0; i < m; i++) {
+        ht->bp_hist[(ht->current_tick + 1u + i) & PT_BP_HIST_MASK] = der_lin[DERIV_TAPS - 1u + i];
+    }
+
+    /* Stage 2: Derivative (5-tap FIR) */
+    for (uint32_t k = 0; k < DERIV_TAPS - 1u; k++) der_lin[k] = ht->deriv_buff[DERIV_TAPS - 2u - k];
+    arm_fir_init_f32(&fir, (uint16_t)DERIV_TAPS, deriv_coeffs, fir_state, PT_BLOCK_SIZE);
+    memcpy(fir_state, der_lin, (DERIV_TAPS - 1u) * sizeof(float32_t));
+    arm_fir_f32(&fir, &der_lin[DERIV_TAPS - 1u], buf_a, m);
+    for (uint32_t k = 0; k < DERIV_TAPS; k++) ht->deriv_buff[k] = der_lin[DERIV_TAPS - 1u + m - 1u - k];
+
+    /* Stage 3: Squaring */
+    arm_mult_f32(buf_a, buf_a, buf_a, m);
+
+    /* Stage 4: Moving Window Integration (running sum is inherently sequential) */
+    for (uint32_t i = 0; i < m; i++) {
+        ht->win_sum -= ht->win_buff[(uint16_t)(ht->win_idx - W) & PT_WIN_HIST_MASK];
+        ht->win_buff[ht->win_idx & PT_WIN_HIST_MASK] = buf_a[i];
+        ht->win_sum += buf_a[i];
+
+        ht->win_idx++;
+
+        buf_b[i] = ht->win_sum;
+    }
+    arm_scale_f32(buf_b, ht->cfg.mwi_scale, integ, m);
+
+    ht->out_x_dc       = ht->dc_y1;
+    ht->out_y_lpf      = ht->lpf_y1;
+    ht->out_y_hpf      = ht->hpf_y1;
+    ht->out_integrated = integ[m - 1u];
+}
+
+uint32_t PT_ProcessBlock(PanTompkins_Handle_t *ht, const uint16_t *in, uint32_t n,
+                         uint32_t *beat_ticks, uint32_t max_beats) {
+    float32_t integ[PT_BLOCK_SIZE];
+    uint32_t beats = 0;
+
+    while (n > 0u) {
+        uint32_t m = (n > PT_BLOCK_SIZE) ? PT_BLOCK_SIZE : n;
+
+        pt_front_end_block(ht, in, m, integ);
+
+        /* Stage 5 stays per sample */
+        for (uint32_t i = 0; i < m; i++) {
+            ht->current_tick++;
+            if (pt_detect(ht, integ[i]) && (beats < max_beats)) {
+                beat_ticks[beats++] = ht->last_beat_tick;
+            }
+        }
+
+        in += m;
+        n  -= m;
+    }
+
+    return beats;
+}
+
+uint8_t PT_ProcessEvent(PanTompkins_Handle_t *ht, uint16_t raw_adc, PT_BeatEvent *ev) {
+    uint8_t is_beat = PT_Process(ht, raw_adc);
+
+    if (is_beat) *ev = ht->beat_event;
+
+    return is_beat;
+}
+
 int PT_GetBPM(PanTompkins_Handle_t *ht) {
     return ht->current_bpm;
 }
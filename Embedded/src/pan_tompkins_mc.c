@@ -0,0 +1,251 @@
+#include "pan_tompkins_mc.h"
+#include <string.h>
+
+/* Same 5-point derivative taps as pan_tompkins.c, oldest sample first */
+static const float32_t mc_deriv_coeffs[5] = { -0.25f, -0.125f, 0.0f, 0.125f, 0.25f };
+
+/* Smallest power of two >= n */
+static uint32_t mc_pow2(uint32_t n) {
+    uint32_t p = 1u;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+/*
+ * Lay the arrays out back to back from base (NULL only sizes them).
+ * Every array is a whole number of stride-long rows, so rows stay aligned to base.
+ * Returns the bytes used.
+ */
+static size_t mc_layout(PanTompkinsMC_Handle_t *ht, uint8_t *base) {
+    const size_t row = (size_t)ht->stride * sizeof(float32_t);
+    size_t off = 0;
+
+#define MC_CARVE(field, rows) do { \
+        ht->field = (base != NULL) ? (void *)(base + off) : NULL; \
+        off += (size_t)(rows) * row; \
+    } while (0)
+
+    MC_CARVE(dc_y1, 1u);
+    MC_CARVE(dc_x1, 1u);
+    MC_CARVE(lpf_y1, 1u);
+    MC_CARVE(lpf_y2, 1u);
+    MC_CARVE(hpf_y1, 1u);
+    MC_CARVE(win_sum, 1u);
+    MC_CARVE(lpf_hist, ht->lpf_mask + 1u);
+    MC_CARVE(hpf_hist, ht->hpf_mask + 1u);
+    MC_CARVE(deriv_hist, PT_MC_DERIV_ROWS);
+    MC_CARVE(win_hist, ht->win_mask + 1u);
+    MC_CARVE(integrated, 1u);
+    MC_CARVE(int_prev2, 1u);
+    MC_CARVE(int_prev1, 1u);
+    MC_CARVE(threshold_i, 1u);
+    MC_CARVE(signal_level, 1u);
+    MC_CARVE(noise_level, 1u);
+    MC_CARVE(last_beat_tick, 1u);    /* 32-bit like float32_t */
+    MC_CARVE(last_decay_tick, 1u);
+    MC_CARVE(current_bpm, 1u);
+
+#undef MC_CARVE
+
+    return off;
+}
+
+static void mc_geometry(PanTompkinsMC_Handle_t *ht, const PT_Config *cfg, uint32_t n_channels) {
+    ht->cfg        = *cfg;
+    ht->n_channels = n_channels;
+    ht->stride     = (n_channels + PT_MC_ALIGN - 1u) & ~(PT_MC_ALIGN - 1u);
+    ht->lpf_mask   = mc_pow2(2u * cfg->lpf_delay_m + 1u) - 1u;
+    ht->hpf_mask   = mc_pow2(2u * cfg->hpf_delay_n + 1u) - 1u;
+    ht->win_mask   = mc_pow2(cfg->integration_window + 1u) - 1u;  /* row W back is never the row written */
+}
+
+size_t PT_MC_MemSize(const PT_Config *cfg, uint32_t n_channels) {
+    PanTompkinsMC_Handle_t tmp;
+
+    mc_geometry(&tmp, cfg, n_channels);
+    return mc_layout(&tmp, NULL);
+}
+
+void PT_MC_Init(PanTompkinsMC_Handle_t *ht, const PT_Config *cfg, uint32_t n_channels, void *mem) {
+    memset(ht, 0, sizeof(*ht));
+    mc_geometry(ht, cfg, n_channels);
+
+    size_t bytes = mc_layout(ht, (uint8_t *)mem);
+    memset(mem, 0, bytes);
+
+    /* Same conservative start-up values as PT_InitConfig */
+    for (uint32_t ch = 0; ch < ht->stride; ch++) {
+        ht->threshold_i[ch]  = 1000.0f;
+        ht->signal_level[ch] = 2000.0f;
+    }
+}
+
+/* Stage 5 for one channel: identical to pt_detect in pan_tompkins.c */
+static uint8_t mc_detect(PanTompkinsMC_Handle_t *ht, uint32_t ch, float32_t int_curr) {
+    uint8_t is_beat = 0;
+    float32_t prev1 = ht->int_prev1[ch];
+
+    if ((prev1 > ht->int_prev2[ch]) && (prev1 > int_curr)) {
+        uint32_t peak_tick = ht->current_tick - 1u;
+
+        if ((peak_tick - ht->last_beat_tick[ch]) > ht->cfg.refractory_samples) {
+            if (prev1 > ht->threshold_i[ch]) {
+                ht->signal_level[ch] = 0.125f * prev1 + 0.875f * ht->signal_level[ch];
+                is_beat = 1;
+
+                uint32_t duration = peak_tick - ht->last_beat_tick[ch];
+                ht->last_beat_tick[ch] = peak_tick;
+                ht->current_bpm[ch] = PT_UpdateBPM(ht->current_bpm[ch], duration, ht->cfg.bpm_num);
+            } else {
+                ht->noise_level[ch] = 0.125f * prev1 + 0.875f * ht->noise_level[ch];
+            }
+        } else {
+            ht->noise_level[ch] = 0.125f * prev1 + 0.875f * ht->noise_level[ch];
+        }
+        ht->threshold_i[ch] = ht->noise_level[ch] + 0.25f * (ht->signal_level[ch] - ht->noise_level[ch]);
+    }
+
+    if ((ht->current_tick - ht->last_beat_tick[ch]) > ht->cfg.no_beat_timeout_samples) {
+        if ((ht->current_tick - ht->last_decay_tick[ch]) > ht->cfg.sample_rate_hz) {
+            ht->threshold_i[ch] *= 0.5f;
+            ht->last_decay_tick[ch] = ht->current_tick;
+        }
+    } else {
+        ht->last_decay_tick[ch] = ht->current_tick;
+    }
+
+    ht->int_prev2[ch] = prev1;
+    ht->int_prev1[ch] = int_curr;
+
+    return is_beat;
+}
+
+/*
+ * Stages 0-4 as one loop over channels each, same expressions and order as PT_Process.
+ * Each stage writes its output straight into the next stage's history row. The rows
+ * passed to one call are distinct, so the restrict parameters hold and the loops vectorize.
+ */
+static void mc_dc(uint32_t n, const uint16_t *restrict in, float32_t *restrict y1,
+                  float32_t *restrict x1, float32_t *restrict out) {
+    for (uint32_t ch = 0; ch < n; ch++) {
+        float32_t x = (float32_t)in[ch] - 2048.0f;
+        float32_t x_dc = x + (0.995f * y1[ch] - x1[ch]);
+        x1[ch] = x;
+        y1[ch] = x_dc;
+        out[ch] = x_dc;
+    }
+}
+
+static void mc_lpf(uint32_t n, const float32_t *restrict x_n, const float32_t *restrict x_M,
+                   const float32_t *restrict x_2M, float32_t *restrict y1, float32_t *restrict y2,
+                   float32_t *restrict out) {
+    for (uint32_t ch = 0; ch < n; ch++) {
+        float32_t y = (2.0f*y1[ch] - y2[ch]) + ((x_n[ch] + x_2M[ch]) - 2.0f*x_M[ch]);
+        y2[ch] = y1[ch];
+        y1[ch] = y;
+        out[ch] = y;
+    }
+}
+
+static void mc_hpf(uint32_t n, float32_t scale, const float32_t *restrict v_n, const float32_t *restrict v_N,
+                   const float32_t *restrict v_N1, const float32_t *restrict v_2N, float32_t *restrict y1,
+                   float32_t *restrict out) {
+    for (uint32_t ch = 0; ch < n; ch++) {
+        float32_t y = ((v_2N[ch] - v_n[ch]) * scale + (v_N[ch] - v_N1[ch])) + y1[ch];
+        y1[ch] = y;
+        out[ch] = y;
+    }
+}
+
+/* Derivative (oldest tap first), squaring and MWI */
+static void mc_deriv_mwi(uint32_t n, float32_t scale, const float32_t *restrict d0, const float32_t *restrict d1,
+                         const float32_t *restrict d2, const float32_t *restrict d3, const float32_t *restrict d4,
+                         const float32_t *restrict w_old, float32_t *restrict w_new,
+                         float32_t *restrict sum, float32_t *restrict integ) {
+    for (uint32_t ch = 0; ch < n; ch++) {
+        float32_t deriv = 0.0f;
+        deriv += d4[ch] * mc_deriv_coeffs[0];
+        deriv += d3[ch] * mc_deriv_coeffs[1];
+        deriv += d2[ch] * mc_deriv_coeffs[2];
+        deriv += d1[ch] * mc_deriv_coeffs[3];
+        deriv += d0[ch] * mc_deriv_coeffs[4];
+
+        float32_t squared = deriv * deriv;
+        float32_t s = sum[ch] - w_old[ch];
+        w_new[ch] = squared;
+        s += squared;
+        sum[ch] = s;
+
+        integ[ch] = s * scale;
+    }
+}
+
+/* Row `delay` samples back in a ring of rows */
+static inline float32_t *mc_row(float32_t *hist, uint32_t mask, uint32_t stride, uint16_t idx, uint32_t delay) {
+    return &hist[((uint16_t)(idx - delay) & mask) * stride];
+}
+
+uint32_t PT_MC_Process(PanTompkinsMC_Handle_t *ht, const uint16_t *in, uint8_t *beat) {
+    const uint32_t n_ch   = ht->n_channels;
+    const uint32_t stride = ht->stride;
+    const uint32_t M = ht->cfg.lpf_delay_m;
+    const uint32_t N = ht->cfg.hpf_delay_n;
+    const uint32_t W = ht->cfg.integration_window;
+
+    float32_t *lpf_n = mc_row(ht->lpf_hist, ht->lpf_mask, stride, ht->lpf_idx, 0u);
+    float32_t *hpf_n = mc_row(ht->hpf_hist, ht->hpf_mask, stride, ht->hpf_idx, 0u);
+    float32_t *d0    = mc_row(ht->deriv_hist, PT_MC_DERIV_MASK, stride, ht->deriv_idx, 0u);
+
+    ht->current_tick++;
+
+    mc_dc(n_ch, in, ht->dc_y1, ht->dc_x1, lpf_n);
+
+    mc_lpf(n_ch, lpf_n,
+           mc_row(ht->lpf_hist, ht->lpf_mask, stride, ht->lpf_idx, M),
+           mc_row(ht->lpf_hist, ht->lpf_mask, stride, ht->lpf_idx, 2u*M),
+           ht->lpf_y1, ht->lpf_y2, hpf_n);
+
+    mc_hpf(n_ch, ht->cfg.hpf_scale, hpf_n,
+           mc_row(ht->hpf_hist, ht->hpf_mask, stride, ht->hpf_idx, N),
+           mc_row(ht->hpf_hist, ht->hpf_mask, stride, ht->hpf_idx, N + 1u),
+           mc_row(ht->hpf_hist, ht->hpf_mask, stride, ht->hpf_idx, 2u*N),
+           ht->hpf_y1, d0);
+
+    mc_deriv_mwi(n_ch, ht->cfg.mwi_scale, d0,
+                 mc_row(ht->deriv_hist, PT_MC_DERIV_MASK, stride, ht->deriv_idx, 1u),
+                 mc_row(ht->deriv_hist, PT_MC_DERIV_MASK, stride, ht->deriv_idx, 2u),
+                 mc_row(ht->deriv_hist, PT_MC_DERIV_MASK, stride, ht->deriv_idx, 3u),
+                 mc_row(ht->deriv_hist, PT_MC_DERIV_MASK, stride, ht->deriv_idx, 4u),
+                 mc_row(ht->win_hist, ht->win_mask, stride, ht->win_idx, W),
+                 mc_row(ht->win_hist, ht->win_mask, stride, ht->win_idx, 0u),
+                 ht->win_sum, ht->integrated);
+
+    ht->lpf_idx++;
+    ht->hpf_idx++;
+    ht->deriv_idx++;
+    ht->win_idx++;
+
+    /* Stage 5 per channel (data-dependent branches) */
+    uint32_t beats = 0;
+    for (uint32_t ch = 0; ch < n_ch; ch++) {
+        uint8_t b = mc_detect(ht, ch, ht->integrated[ch]);
+        beats += b;
+        if (beat != NULL) beat[ch] = b;
+    }
+
+    return beats;
+}
+
+uint32_t PT_MC_ProcessBlock(PanTompkinsMC_Handle_t *ht, const uint16_t *in, uint32_t n, uint8_t *beat) {
+    uint32_t beats = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        beats += PT_MC_Process(ht, &in[i * ht->n_channels], (beat != NULL) ? &beat[i * ht->n_channels] : NULL);
+    }
+
+    return beats;
+}
+
+int PT_MC_GetBPM(const PanTompkinsMC_Handle_t *ht, uint32_t channel) {
+    return ht->current_bpm[channel];
+}
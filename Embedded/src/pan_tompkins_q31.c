@@ -0,0 +1,186 @@
+#include "pan_tompkins_q31.h"
+#include <string.h>
+
+/* Helper: circular history access for LPF/HPF (power-of-two size, mask = size - 1) */
+static inline q31_t hist_get_q31(const q31_t *hist, uint32_t mask, uint32_t idx, uint32_t delay) {
+    /* hist[idx & mask] is the newest sample written at current idx */
+    return hist[(idx - delay) & mask];
+}
+
+/* Saturating add/sub (QADD/QSUB semantics) */
+static inline q31_t q31_add_sat(q31_t a, q31_t b) {
+    return clip_q63_to_q31((q63_t)a + (q63_t)b);
+}
+
+static inline q31_t q31_sub_sat(q31_t a, q31_t b) {
+    return clip_q63_to_q31((q63_t)a - (q63_t)b);
+}
+
+/*
+ * Same difference equations as pan_tompkins.c, in integers:
+ *  - DC:  y[n] = 0.995*y[n-1] + x[n] - x[n-1]                      (Q16 state, Q30 coefficient)
+ *  - LPF: yLP[n] = 2yLP[n-1] - yLP[n-2] + x[n] - 2x[n-M] + x[n-2M]  (exact)
+ *  - HPF: z[n] = z[n-1] - v[n] + 2N*(v[n-N] - v[n-N-1]) + v[n-2N]  with z = 2N*yHP (exact)
+ */
+
+void PT_InitQ31(PanTompkinsQ31_Handle_t *ht) {
+    memset(ht, 0, sizeof(*ht));
+
+    /* Same start-up values as the float engine, on the integrated scale */
+    ht->threshold_i  = PT_Q31_LEVEL(1000);
+    ht->signal_level = PT_Q31_LEVEL(2000);
+    ht->noise_level  = 0;
+
+    ht->last_beat_tick  = 0;
+    ht->last_decay_tick = 0;
+    ht->current_bpm     = 0;
+}
+
+void PT_RearmQ31(PanTompkinsQ31_Handle_t *ht, uint16_t raw_adc) {
+    uint32_t tick = ht->current_tick + 1u;
+
+    PT_InitQ31(ht);
+    ht->current_tick = tick;
+
+    /* Constant input at raw_adc: DC removal output 0, every later stage at rest */
+    ht->dc_x1 = (int32_t)raw_adc - 2048;
+
+    /* No beat yet: a first RR from here is out of range (< PT_BPM_MIN), so it only anchors */
+    ht->last_beat_tick  = tick - PT_BPM_NUM / PT_BPM_MIN;
+    ht->last_decay_tick = tick;
+    ht->bpm_seed = 1;
+}
+
+uint8_t PT_ProcessQ31(PanTompkinsQ31_Handle_t *ht, uint16_t raw_adc) {
+    ht->current_tick++;
+
+    /* Centred ADC sample (integer) */
+    int32_t x = (int32_t)raw_adc - 2048;
+
+    /* Stage 0: DC removal, y[n] = 0.995*y[n-1] + x[n] - x[n-1] */
+    q63_t dc_acc = ((q63_t)ht->dc_y1 * PT_Q31_DC_COEF + (1LL << 29)) >> 30;
+    dc_acc += (q63_t)(x - ht->dc_x1) << PT_Q31_DC_STATE_FRAC;
+    ht->dc_y1 = clip_q63_to_q31(dc_acc);
+    ht->dc_x1 = x;
+
+    const uint32_t dc_shift = PT_Q31_DC_STATE_FRAC - PT_Q31_DC_OUT_FRAC;
+    q31_t x_dc = (q31_t)(((q63_t)ht->dc_y1 + (1LL << (dc_shift - 1u))) >> dc_shift);
+    ht->out_x_dc = x_dc;
+
+    /* Stage 1a: LPF (integer structure, exact on Q3 input) */
+    ht->lpf_x_hist[ht->lpf_idx & PT_Q31_LPF_HIST_MASK] = x_dc;
+
+    q31_t x_n    = hist_get_q31(ht->lpf_x_hist, PT_Q31_LPF_HIST_MASK, ht->lpf_idx, 0);
+    q31_t x_n_M  = hist_get_q31(ht->lpf_x_hist, PT_Q31_LPF_HIST_MASK, ht->lpf_idx, LPF_DELAY_M);
+    q31_t x_n_2M = hist_get_q31(ht->lpf_x_hist, PT_Q31_LPF_HIST_MASK, ht->lpf_idx, 2u*LPF_DELAY_M);
+
+    q31_t y_lpf = q31_add_sat(q31_sub_sat(q31_add_sat(ht->lpf_y1, ht->lpf_y1), ht->lpf_y2),
+                              q31_sub_sat(q31_add_sat(x_n, x_n_2M), q31_add_sat(x_n_M, x_n_M)));
+
+    ht->lpf_y2 = ht->lpf_y1;
+    ht->lpf_y1 = y_lpf;
+    ht->out_y_lpf = y_lpf;
+
+    ht->lpf_idx++;
+
+    /* Stage 1b: HPF on z = 2N*yHP - input is LPF output */
+    ht->hpf_x_hist[ht->hpf_idx & PT_Q31_HPF_HIST_MASK] = y_lpf;
+
+    q31_t v_n    = hist_get_q31(ht->hpf_x_hist, PT_Q31_HPF_HIST_MASK, ht->hpf_idx, 0);
+    q31_t v_n_N  = hist_get_q31(ht->hpf_x_hist, PT_Q31_HPF_HIST_MASK, ht->hpf_idx, HPF_DELAY_N);
+    q31_t v_n_N1 = hist_get_q31(ht->hpf_x_hist, PT_Q31_HPF_HIST_MASK, ht->hpf_idx, HPF_DELAY_N + 1u);
+    q31_t v_n_2N = hist_get_q31(ht->hpf_x_hist, PT_Q31_HPF_HIST_MASK, ht->hpf_idx, 2u*HPF_DELAY_N);
+
+    q63_t hpf_acc = (q63_t)ht->hpf_z1 + ((q63_t)v_n_2N - v_n);
+    hpf_acc += ((q63_t)v_n_N - v_n_N1) * (q63_t)(2u*HPF_DELAY_N);
+    q31_t z = clip_q63_to_q31(hpf_acc);
+
+    ht->hpf_z1 = z;
+    ht->out_y_hpf = (q31_t)(((q63_t)z * PT_Q31_HPF_RECIP) >> 31);
+
+    ht->hpf_idx++;
+
+    /* Stage 2: Derivative (5-point, x8) */
+    for (int i = 4; i > 0; i--) ht->deriv_buff[i] = ht->deriv_buff[i - 1];
+    ht->deriv_buff[0] = z >> PT_Q31_HPF_SHIFT;
+
+    q31_t deriv = 2*ht->deriv_buff[0]
+                + ht->deriv_buff[1]
+                - ht->deriv_buff[3]
+                - 2*ht->deriv_buff[4];
+
+    /* Stage 3: Squaring (64-bit product, shifted and clamped to the window budget) */
+    q63_t sq64 = ((q63_t)deriv * deriv) >> PT_Q31_SQ_SHIFT;
+    q31_t squared = (sq64 > PT_Q31_SQ_MAX) ? PT_Q31_SQ_MAX : (q31_t)sq64;
+
+    /* Stage 4: Moving Window Integration (sum only, no divide) */
+    ht->win_sum -= ht->win_buff[(uint16_t)(ht->win_idx - INTEGRATION_WINDOW) & PT_Q31_WIN_HIST_MASK];
+    ht->win_buff[ht->win_idx & PT_Q31_WIN_HIST_MASK] = squared;
+    ht->win_sum += squared;
+
+    ht->win_idx++;
+
+    q31_t integrated = ht->win_sum;
+    ht->out_integrated = integrated;
+
+    /* Stage 5: Local maxima detection on integrated signal */
+    uint8_t is_beat = 0;
+
+    q31_t int_curr = integrated;
+    if ((ht->int_prev1 > ht->int_prev2) && (ht->int_prev1 > int_curr)) {
+        q31_t    peak_val  = ht->int_prev1;
+        uint32_t peak_tick = ht->current_tick - 1u;
+
+        /* Refractory period: 200ms */
+        if ((peak_tick - ht->last_beat_tick) > REFRACTORY_SAMPLES) {
+            if (peak_val > ht->threshold_i) {
+                /* QRS detected: signal = 0.125*peak + 0.875*signal */
+                ht->signal_level += (peak_val - ht->signal_level) >> 3;
+                is_beat = 1;
+
+                uint32_t duration = peak_tick - ht->last_beat_tick;
+                ht->last_beat_tick = peak_tick;
+                if (ht->bpm_seed) {
+                    int bpm = PT_InstantBPM(duration, PT_BPM_NUM);
+                    if (bpm != 0) {
+                        ht->current_bpm = bpm;
+                        ht->bpm_seed = 0;
+                    }
+                } else {
+                    ht->current_bpm = PT_UpdateBPM(ht->current_bpm, duration, PT_BPM_NUM);
+                }
+            } else {
+                /* Noise peak: noise = 0.125*peak + 0.875*noise */
+                ht->noise_level += (peak_val - ht->noise_level) >> 3;
+            }
+
+            /* threshold = noise + 0.25*(signal - noise) */
+            ht->threshold_i = ht->noise_level + ((ht->signal_level - ht->noise_level) >> 2);
+        } else {
+            /* Within refractory: ignore for beat detection, but still update noise mildly */
+            ht->noise_level += (peak_val - ht->noise_level) >> 3;
+            ht->threshold_i = ht->noise_level + ((ht->signal_level - ht->noise_level) >> 2);
+        }
+    }
+
+    /* Threshold decay (stable): if no beat for too long, halve threshold once per second */
+    if ((ht->current_tick - ht->last_beat_tick) > NO_BEAT_TIMEOUT_SAMPLES) {
+        uint32_t decay_period = (uint32_t)SAMPLE_RATE_HZ;
+        if ((ht->current_tick - ht->last_decay_tick) > decay_period) {
+            ht->threshold_i >>= 1;
+            ht->last_decay_tick = ht->current_tick;
+        }
+    } else {
+        ht->last_decay_tick = ht->current_tick;
+    }
+
+    /* shift local maxima tracker */
+    ht->int_prev2 = ht->int_prev1;
+    ht->int_prev1 = int_curr;
+
+    return is_beat;
+}
+
+int PT_GetBPMQ31(PanTompkinsQ31_Handle_t *ht) {
+    return ht->current_bpm;
+}
@@ -0,0 +1,91 @@
+#include "power.h"
+#include "ad8232.h"
+#include "hc05.h"
+#include "usart2.h"
+
+Power_t power;
+
+/* CFGR prescalers per level, as in the power.h table */
+static const uint32_t power_cfgr[POWER_LEVELS] = {
+    RCC_CFGR_HPRE_DIV1 | RCC_CFGR_PPRE1_DIV2 | RCC_CFGR_PPRE2_DIV1,
+    RCC_CFGR_HPRE_DIV2 | RCC_CFGR_PPRE1_DIV1 | RCC_CFGR_PPRE2_DIV1,
+    RCC_CFGR_HPRE_DIV4 | RCC_CFGR_PPRE1_DIV1 | RCC_CFGR_PPRE2_DIV1,
+};
+
+/* Bounds the wait for the last byte: 2 characters at 115200 baud are 174us, 15k cycles @ 84MHz */
+#define POWER_TC_SPINS 100000u
+
+void Power_Init(uint8_t mode) {
+    power.mode = mode;
+    power.level = 0;
+    power.target = 0;
+    power.hold = POWER_HOLD_S;
+    power.awake_start = DWT->CYCCNT;
+    power.awake_cycles = 0;
+    power.wakeups = 0;
+    power.switches = 0;
+
+    /* The HAL tick would wake the core every millisecond */
+    if (mode != POWER_MODE_BUSY) SysTick->CTRL &= ~SysTick_CTRL_TICKINT_Msk;
+}
+
+void Power_Idle(uint32_t idle_start, uint8_t (*work_ready)(void)) {
+    power.awake_cycles += idle_start - power.awake_start;
+
+    if (power.mode != POWER_MODE_BUSY) {
+        /* A pending interrupt ends WFI even while masked; it runs after __enable_irq */
+        __disable_irq();
+        if (!work_ready()) {
+            __DSB();
+            __WFI();
+            power.wakeups++;
+        }
+        __enable_irq();
+    }
+    power.awake_start = DWT->CYCCNT;
+}
+
+void Power_Account(uint32_t deadline_misses) {
+    uint32_t now = DWT->CYCCNT;
+
+    power.awake_cycles += now - power.awake_start;
+    power.awake_start = now;
+    power.awake_cycles_s = power.awake_cycles;
+    power.wakeups_s = power.wakeups;
+    power.duty_permille = (uint32_t)(((uint64_t)power.awake_cycles * 1000u) / SystemCoreClock);
+    power.awake_cycles = 0;
+    power.wakeups = 0;
+
+    if (power.mode != POWER_MODE_SCALE) return;
+
+    /* Up at once when loaded or late, down only after a quiet hold */
+    if ((deadline_misses != 0u) || (power.duty_permille > POWER_LOAD_UP_PCT * 10u)) {
+        if (power.level > 0u) power.target = power.level - 1u;
+        power.hold = POWER_HOLD_S;
+    } else if (power.hold != 0u) {
+        power.hold--;
+    } else if ((power.duty_permille < POWER_LOAD_DOWN_PCT * 10u) && (power.level + 1u < POWER_LEVELS)) {
+        power.target = power.level + 1u;
+        power.hold = POWER_HOLD_S;
+    }
+}
+
+uint8_t Power_SwitchReady(void) {
+    return (power.target != power.level) && (hc05_tx.dma_len == 0u) && (usart2_tx.dma_len == 0u);
+}
+
+void Power_Switch(uint32_t sample_rate_hz) {
+    /* The DMA streams are idle; let the USARTs shift out their last bytes */
+    for (uint32_t i = 0; (i < POWER_TC_SPINS) && !((USART1->SR & USART_SR_TC) && (USART2->SR & USART_SR_TC)); i++) {
+    }
+
+    RCC->CFGR = (RCC->CFGR & ~(RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2)) | power_cfgr[power.target];
+    SystemCoreClockUpdate();
+
+    HC05_SetClock();
+    USART2_SetClock();
+    AD8232_SetRate(sample_rate_hz);
+
+    power.level = power.target;
+    power.switches++;
+}
@@ -0,0 +1,77 @@
+#include "prof.h"
+
+Prof_t prof;
+
+static const char *const prof_names[PROF_COUNT] = {
+    [PROF_PT_STAGE + PT_STAGE_DC]     = "pt_dc",
+    [PROF_PT_STAGE + PT_STAGE_LPF]    = "pt_lpf",
+    [PROF_PT_STAGE + PT_STAGE_HPF]    = "pt_hpf",
+    [PROF_PT_STAGE + PT_STAGE_DERIV]  = "pt_deriv",
+    [PROF_PT_STAGE + PT_STAGE_SQUARE] = "pt_square",
+    [PROF_PT_STAGE + PT_STAGE_MWI]    = "pt_mwi",
+    [PROF_PT_STAGE + PT_STAGE_DETECT] = "pt_detect",
+    [PROF_PT_PROCESS]                 = "pt_process",
+    [PROF_STREAM]                     = "stream",
+    [PROF_FORMAT]                     = "format",
+    [PROF_HC05_WRITE]                 = "hc05_write",
+    [PROF_USART2_WRITE]               = "usart2_write",
+    [PROF_LOG]                        = "log",
+    [PROF_HRV_SLICE]                  = "hrv_slice",
+    [PROF_SAMPLE]                     = "sample",
+};
+
+static void prof_reset(Prof_Stats *p) {
+    p->count = 0;
+    p->sum = 0;
+    p->min = 0xFFFFFFFFu;
+    p->max = 0;
+    for (uint32_t b = 0; b < PROF_HIST_BINS; b++) p->hist[b] = 0;
+}
+
+void Prof_Init(void) {
+    for (uint32_t i = 0; i < PROF_COUNT; i++) prof_reset(&prof.probe[i]);
+    prof.mark = DWT->CYCCNT;
+    prof.report_tick = 0;
+    prof.report_next = PROF_COUNT;
+    ECG_Proto_Init(&prof.proto);
+}
+
+void Prof_Add(uint32_t probe, uint32_t cycles) {
+    Prof_Stats *p = &prof.probe[probe];
+
+    p->count++;
+    p->sum = (cycles > 0xFFFFFFFFu - p->sum) ? 0xFFFFFFFFu : p->sum + cycles;
+    if (cycles < p->min) p->min = cycles;
+    if (cycles > p->max) p->max = cycles;
+
+    /* log2 bin: < 16 -> 0, [2^(b+3), 2^(b+4)) -> b, the last bin takes the rest */
+    uint32_t b = 0;
+    if (cycles >= 16u) {
+        b = 28u - (uint32_t)__builtin_clz(cycles);
+        if (b >= PROF_HIST_BINS) b = PROF_HIST_BINS - 1u;
+    }
+    if (p->hist[b] != 0xFFFFu) p->hist[b]++;
+}
+
+const char *Prof_Name(uint32_t probe) {
+    return (probe < PROF_COUNT) ? prof_names[probe] : "?";
+}
+
+uint32_t Prof_ReportStep(uint32_t tick, uint32_t period, uint32_t room, uint8_t *out) {
+    if (prof.report_next >= PROF_COUNT) {
+        if ((tick - prof.report_tick) < period) return 0;
+        prof.report_tick = tick;
+        prof.report_next = 0;
+    }
+    if (room < PROF_FRAME_MAX) return 0;
+
+    /* The probe restarts from the moment its statistics leave */
+    Prof_Stats *p = &prof.probe[prof.report_next];
+    uint32_t stats[4] = { p->count, p->sum, (p->count != 0u) ? p->min : 0u, p->max };
+
+    out[0] = 0x00u;
+    uint32_t len = 1u + ECG_Proto_Prof(&prof.proto, &out[1], tick, (uint8_t)prof.report_next, stats, p->hist);
+    prof_reset(p);
+    prof.report_next++;
+    return len;
+}
@@ -0,0 +1,45 @@
+#include "sample_ring.h"
+#include <string.h>
+
+void SampleRing_Init(SampleRing_t *r) {
+    memset(r, 0, sizeof(*r));
+}
+
+uint32_t SampleRing_PushBlock(SampleRing_t *r, const volatile uint16_t *frames, uint32_t n_ch, uint32_t n) {
+    uint32_t head = r->head;
+    uint32_t space = SAMPLE_RING_SIZE - (head - r->tail);
+    uint32_t stored = (n < space) ? n : space;
+
+    for (uint32_t i = 0; i < stored; i++) {
+        SampleRing_Entry *e = &r->buf[(head + i) & SAMPLE_RING_MASK];
+        e->seq = r->next_seq + i;
+        for (uint32_t c = 0; c < SAMPLE_RING_CHANNELS; c++) {
+            e->adc[c] = (c < n_ch) ? frames[i * n_ch + c] : 0u;
+        }
+    }
+    r->next_seq += n;
+    r->dropped  += n - stored;
+
+    /* Entries are visible before the new head */
+    __DMB();
+    r->head = head + stored;
+
+    uint32_t used = head + stored - r->tail;
+    if (used > r->high_water) r->high_water = used;
+
+    return stored;
+}
+
+uint8_t SampleRing_Pop(SampleRing_t *r, SampleRing_Entry *e) {
+    uint32_t tail = r->tail;
+
+    if (r->head == tail) return 0;
+
+    /* Entry read after the head that published it, and before its slot is released */
+    __DMB();
+    *e = r->buf[tail & SAMPLE_RING_MASK];
+    __DMB();
+    r->tail = tail + 1u;
+
+    return 1;
+}
@@ -0,0 +1,132 @@
+#include "sched.h"
+#include <string.h>
+
+void Sched_Init(Sched_t *s) {
+    memset(s, 0, sizeof(*s));
+}
+
+uint8_t Sched_Add(Sched_t *s, const char *name, Sched_Class cls, Sched_Fn ready, Sched_Fn run,
+                  uint32_t period, uint32_t deadline) {
+    if (s->n_tasks >= SCHED_MAX_TASKS) return SCHED_NONE;
+
+    uint8_t id = (uint8_t)s->n_tasks++;
+    Sched_Task *t = &s->task[id];
+    memset(t, 0, sizeof(*t));
+    t->name = name;
+    t->ready = ready;
+    t->run = run;
+    t->period = period;
+    t->deadline = deadline;
+    t->cls = (uint8_t)cls;
+    t->next_release = DWT->CYCCNT + period;
+
+    /* Insert after the last task of the same or a higher class */
+    uint32_t pos = id;
+    while ((pos > 0u) && (s->task[s->order[pos - 1u]].cls > t->cls)) {
+        s->order[pos] = s->order[pos - 1u];
+        pos--;
+    }
+    s->order[pos] = id;
+    return id;
+}
+
+void Sched_Release(Sched_t *s, uint8_t id) {
+    Sched_Task *t = &s->task[id];
+
+    if (t->pending) {
+        t->merged++;
+        return;
+    }
+    t->pending = 1;
+    t->release = DWT->CYCCNT;
+}
+
+void Sched_SetTrace(Sched_t *s, volatile uint32_t *trace) {
+    s->trace = trace;
+    if (trace != NULL) *trace = SCHED_NONE;
+}
+
+void Sched_SetTiming(Sched_t *s, uint8_t id, uint32_t period, uint32_t deadline) {
+    Sched_Task *t = &s->task[id];
+
+    t->period = period;
+    t->deadline = deadline;
+    t->next_release = DWT->CYCCNT + period;
+}
+
+uint8_t Sched_Step(Sched_t *s) {
+    uint32_t now = DWT->CYCCNT;
+    uint8_t id = SCHED_NONE;
+
+    /* Releases: periods that came due, then the polls of tasks without a job */
+    for (uint32_t k = 0; k < s->n_tasks; k++) {
+        Sched_Task *t = &s->task[s->order[k]];
+
+        if ((t->period != 0u) && ((int32_t)(now - t->next_release) >= 0)) {
+            if (t->pending) {
+                t->merged++;
+            } else {
+                t->pending = 1;
+                t->release = t->next_release;
+            }
+            t->next_release += t->period;
+            if ((int32_t)(now - t->next_release) >= 0) t->next_release = now + t->period;
+        } else if (!t->pending && (t->ready != NULL) && t->ready()) {
+            t->pending = 1;
+            t->release = now;
+        }
+        if (t->pending && (id == SCHED_NONE)) id = s->order[k];
+    }
+
+    if (id == SCHED_NONE) {
+        s->idle_steps++;
+        return SCHED_NONE;
+    }
+
+    /* One slice of the highest-priority pending job */
+    Sched_Task *t = &s->task[id];
+    if (s->trace != NULL) *s->trace = id;
+    uint32_t t0 = DWT->CYCCNT;
+    uint8_t done = t->run();
+    uint32_t t1 = DWT->CYCCNT;
+    if (s->trace != NULL) *s->trace = SCHED_NONE;
+
+    if ((t1 - t0) > t->wcet) t->wcet = t1 - t0;
+    if (done) {
+        uint32_t response = t1 - t->release;
+        t->pending = 0;
+        t->jobs++;
+        if (response > t->max_response) t->max_response = response;
+        if ((t->deadline != 0u) && (response > t->deadline)) t->misses++;
+    }
+    return id;
+}
+
+uint8_t Sched_Ready(const Sched_t *s) {
+    uint32_t now = DWT->CYCCNT;
+
+    for (uint32_t k = 0; k < s->n_tasks; k++) {
+        const Sched_Task *t = &s->task[s->order[k]];
+
+        if (t->pending) return 1;
+        if ((t->period != 0u) && ((int32_t)(now - t->next_release) >= 0)) return 1;
+        if ((t->ready != NULL) && t->ready()) return 1;
+    }
+    return 0;
+}
+
+const Sched_Task *Sched_Get(const Sched_t *s, uint8_t id) {
+    return &s->task[id];
+}
+
+void Sched_ClearStats(Sched_t *s) {
+    for (uint32_t i = 0; i < s->n_tasks; i++) {
+        Sched_Task *t = &s->task[i];
+        t->jobs = 0;
+        t->misses = 0;
+        t->merged = 0;
+        t->wcet = 0;
+        t->max_response = 0;
+    }
+    s->idle_steps = 0;
+}
@@ -1,4 +1,9 @@
 #include "usart2.h"
+#include "prof.h"
+
+DMA_Tx_t usart2_tx;
+USART2_Log_t usart2_log;
+static uint8_t usart2_tx_buf[USART2_TX_SIZE];
 
 void USART2_Init(void) {
     /* Enable Clock for GPIOA and USART2 */
@@ -17,35 +22,99 @@ void USART2_Init(void) {
     /* Reset CR1 */
     USART2->CR1 = 0; 
 
-    /* Configure Baudrate. 
-     * PCLK1 = 42MHz 
-     * Baud = 115200
-     * USARTDIV = 42000000 / 115200 = 364.58
-     */
-    uint32_t pclk1 = 42000000U;
-    uint32_t brr = (pclk1 + (USART2_BAUDRATE / 2)) / USART2_BAUDRATE;
-    USART2->BRR = (uint16_t)brr;
+    /* Configure Baudrate: USARTDIV = 42000000 / 115200 = 364.58 at the boot clock */
+    USART2_SetClock();
 
-    /* Enable TX, RX and USART */
+    /* Enable TX, RX and USART, transmit requests to DMA */
+    USART2->CR3 |= USART_CR3_DMAT;
     USART2->CR1 |= (USART_CR1_TE | USART_CR1_RE | USART_CR1_UE);
+
+    memset(&usart2_log, 0, sizeof(usart2_log));
+    usart2_log.decim = 1;
+
+    /* DMA1 Stream6 Channel4 -> USART2: byte-wise, memory to peripheral, lowest priority */
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN;
+    DMA_Tx_Init(&usart2_tx, usart2_tx_buf, USART2_TX_SIZE, DMA1, DMA1_Stream6, 6u);
+
+    DMA1_Stream6->PAR = (uint32_t)&USART2->DR;
+    DMA1_Stream6->CR  = DMA_SxCR_CHSEL_2 |                      /* channel 4, PL = low */
+                        DMA_SxCR_DIR_0 | DMA_SxCR_MINC |
+                        DMA_SxCR_TCIE | DMA_SxCR_TEIE;
+
+    NVIC_SetPriority(DMA1_Stream6_IRQn, 15);
+    NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+}
+
+void USART2_SetClock(void) {
+    /* USART2 runs on PCLK1: 42MHz at the boot clock */
+    uint32_t pclk1 = SystemCoreClock >> APBPrescTable[(RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos];
+    USART2->BRR = (uint16_t)((pclk1 + (USART2_BAUDRATE / 2u)) / USART2_BAUDRATE);
+}
+
+uint8_t USART2_Write(const char *data, uint32_t len) {
+    PROF_BEGIN(t_prof);
+    uint8_t queued = DMA_Tx_Write(&usart2_tx, data, len);
+    PROF_END(PROF_USART2_WRITE, t_prof);
+    return queued;
+}
+
+void USART2_Begin(ECG_Ser_t *w) {
+    DMA_Tx_Begin(&usart2_tx, w);
+}
+
+uint8_t USART2_Commit(const ECG_Ser_t *w) {
+    PROF_BEGIN(t_prof);
+    uint8_t queued = DMA_Tx_Commit(&usart2_tx, w);
+    PROF_END(PROF_USART2_WRITE, t_prof);
+    return queued;
+}
+
+uint8_t USART2_SendChar(char c) {
+    return USART2_Write(&c, 1u);
+}
+
+uint8_t USART2_SendString(char *str) {
+    return USART2_Write(str, (uint32_t)strlen(str));
+}
+
+/* DMA1 Stream6: a region is in USART2, release it and chain the next one */
+void DMA1_Stream6_IRQHandler(void) {
+    DMA_Tx_IRQHandler(&usart2_tx);
 }
 
-void USART2_SendChar(char c) {
-    /* Wait until the transmit data register is empty */
-    while (!(USART2->SR & USART_SR_TXE));
-    /* Write data to the DR register */
-    USART2->DR = c;
+void USART2_SetLog(uint32_t mask, uint32_t decim) {
+    usart2_log.mask = mask & USART2_SIG_ALL;
+    usart2_log.decim = (decim == 0u) ? 1u : decim;
+    usart2_log.count = 0;
 }
 
-void USART2_SendString(char *str) {
-    while (*str) {
-        USART2_SendChar(*str++);
+uint8_t USART2_LogDue(void) {
+    if (usart2_log.mask == 0u) return 0;
+    if (++usart2_log.count < usart2_log.decim) return 0;
+    usart2_log.count = 0;
+
+    if (USART2_TxFree() < USART2_LOG_LINE_MAX) {
+        usart2_tx.dropped++;
+        return 0;
     }
+    return 1;
 }
 
-void USART2_LogSignals(int16_t raw, int16_t filtered, int16_t integrated, int16_t thresh) {
-    char buff[64];
-    /* Format CSV: Col1,Col2,Col3,Col4 new line */
-    sprintf(buff, "%d,%d,%d,%d\r\n", raw, filtered, integrated, thresh);
-    USART2_SendString(buff);
-}
\ No newline at end of file
+void USART2_LogSignals(const int32_t *v) {
+    ECG_Ser_t w;
+    uint8_t first = 1;
+
+    if (usart2_log.mask == 0u) return;
+
+    /* CSV in place in the ring: selected signals in USART2_Signal order, new line */
+    USART2_Begin(&w);
+    for (uint32_t i = 0; i < USART2_SIG_COUNT; i++) {
+        if (usart2_log.mask & USART2_SIG_BIT(i)) {
+            if (!first) ECG_Ser_Byte(&w, ',');
+            ECG_Ser_DecS(&w, v[i]);
+            first = 0;
+        }
+    }
+    ECG_Ser_End(&w);
+    USART2_Commit(&w);
+}